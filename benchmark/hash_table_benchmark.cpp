@@ -0,0 +1,765 @@
+// Throughput and latency of the hash table builders on synthetic multi-chunk
+// join columns.
+//
+//   hash_table_benchmark [--rows=N] [--chunks=N] [--elem-size=1|2|4|8]
+//                        [--column-type=signed|unsigned|small-date|double]
+//                        [--null-fraction=F] [--key-range=N] [--zipf=S]
+//                        [--key-columns=1|2] [--reps=N] [--seed=N]
+//                        [--backend=default|cpu|gpu|host] [--threads=N]
+//                        [--stages=SUBSTRING] [--csv] [--trace=PATH]
+//
+// Every stage runs once to warm up (JIT, page faults) and then --reps times.
+// Only the builder call is timed, its inputs are reset before every run.
+// rows/s is relative to the rows of the build column(s), GB/s to the bytes of
+// the key columns read plus the bytes of the table written. --trace writes
+// the kernels of all the runs as a Chrome trace (see KernelProfiler).
+
+#include <CL/sycl.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "hash_table/BaselineHashTable/BaselineHashTableBuilder.h"
+#include "hash_table/BaselineHashTable/BucketizedBaselineHashTableLayout.h"
+#include "hash_table/BaselineHashTable/PartitionedBaselineHashTableLayout.h"
+#include "hash_table/GenericKeyHandler.h"
+#include "hash_table/PerfectHashTable/PerfectHashTableBuilder.h"
+#include "hash_table/Shared/BloomFilter.h"
+#include "hash_table/Shared/ColumnStats.h"
+#include "hash_table/Shared/ExecutionContext.h"
+#include "hash_table/Shared/MultiDeviceContext.h"
+#include "hash_table/Shared/Profiling.h"
+#include "hash_table/Shared/Shared.h"
+#include "hash_table/Shared/Sharding.h"
+#include "hash_table/Types.h"
+
+namespace {
+
+struct BenchmarkConfig {
+  size_t rows{size_t{1} << 24};
+  size_t chunks{16};
+  size_t elem_size{4};
+  ColumnType column_type{ColumnType::Signed};
+  double null_fraction{0};
+  int64_t key_range{int64_t{1} << 20};
+  double zipf{0};
+  size_t key_columns{2};
+  size_t reps{5};
+  uint64_t seed{42};
+  std::string backend{"default"};
+  size_t threads{0};
+  std::string stages;
+  bool csv{false};
+  std::string trace;
+};
+
+bool parse_arg(const char *arg, const char *name, std::string &value) {
+  const size_t len = std::strlen(name);
+  if (std::strncmp(arg, name, len) || arg[len] != '=') {
+    return false;
+  }
+  value = arg + len + 1;
+  return true;
+}
+
+ColumnType parse_column_type(const std::string &name) {
+  if (name == "signed") {
+    return ColumnType::Signed;
+  }
+  if (name == "unsigned") {
+    return ColumnType::Unsigned;
+  }
+  if (name == "small-date") {
+    return ColumnType::SmallDate;
+  }
+  if (name == "double") {
+    return ColumnType::Double;
+  }
+  std::fprintf(stderr, "unknown column type %s\n", name.c_str());
+  std::exit(1);
+}
+
+BenchmarkConfig parse_config(int argc, char **argv) {
+  BenchmarkConfig config;
+  for (int i = 1; i < argc; ++i) {
+    std::string value;
+    if (!std::strcmp(argv[i], "--csv")) {
+      config.csv = true;
+    } else if (parse_arg(argv[i], "--rows", value)) {
+      config.rows = std::stoull(value);
+    } else if (parse_arg(argv[i], "--chunks", value)) {
+      config.chunks = std::max<size_t>(1, std::stoull(value));
+    } else if (parse_arg(argv[i], "--elem-size", value)) {
+      config.elem_size = std::stoull(value);
+    } else if (parse_arg(argv[i], "--column-type", value)) {
+      config.column_type = parse_column_type(value);
+    } else if (parse_arg(argv[i], "--null-fraction", value)) {
+      config.null_fraction = std::stod(value);
+    } else if (parse_arg(argv[i], "--key-range", value)) {
+      config.key_range = std::max<int64_t>(1, std::stoll(value));
+    } else if (parse_arg(argv[i], "--zipf", value)) {
+      config.zipf = std::stod(value);
+    } else if (parse_arg(argv[i], "--key-columns", value)) {
+      config.key_columns = std::min<size_t>(2, std::max<size_t>(1, std::stoull(value)));
+    } else if (parse_arg(argv[i], "--reps", value)) {
+      config.reps = std::max<size_t>(1, std::stoull(value));
+    } else if (parse_arg(argv[i], "--seed", value)) {
+      config.seed = std::stoull(value);
+    } else if (parse_arg(argv[i], "--backend", value)) {
+      config.backend = value;
+    } else if (parse_arg(argv[i], "--threads", value)) {
+      config.threads = std::stoull(value);
+    } else if (parse_arg(argv[i], "--stages", value)) {
+      config.stages = value;
+    } else if (parse_arg(argv[i], "--trace", value)) {
+      config.trace = value;
+    } else {
+      std::fprintf(stderr, "unknown argument %s\n", argv[i]);
+      std::exit(1);
+    }
+  }
+  if (config.column_type == ColumnType::Double) {
+    config.elem_size = sizeof(double);
+  } else if (config.column_type == ColumnType::SmallDate &&
+             config.elem_size != 2 && config.elem_size != 4) {
+    config.elem_size = 4;
+  }
+  if (config.rows > static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+    std::fprintf(stderr, "row ids are 32 bits, --rows must be < 2^31\n");
+    std::exit(1);
+  }
+  return config;
+}
+
+// Zipf distribution over the ranks 1..n by rejection-inversion (W. Hormann,
+// G. Derflinger, "Rejection-inversion to generate variates from monotone
+// discrete distributions"): O(1) per sample without a table of n weights.
+class ZipfDistribution {
+public:
+  ZipfDistribution(const int64_t n, const double s)
+      : n_(n), s_(s), h_integral_x1_(h_integral(1.5) - 1),
+        h_integral_n_(h_integral(n + 0.5)),
+        threshold_(2 - h_integral_inverse(h_integral(2.5) - h(2))) {}
+
+  template <typename RNG> int64_t operator()(RNG &rng) {
+    std::uniform_real_distribution<double> uniform(0, 1);
+    while (true) {
+      const double u =
+          h_integral_n_ + uniform(rng) * (h_integral_x1_ - h_integral_n_);
+      const double x = h_integral_inverse(u);
+      const int64_t k = std::min<int64_t>(
+          n_, std::max<int64_t>(1, static_cast<int64_t>(x + 0.5)));
+      if (k - x <= threshold_ || u >= h_integral(k + 0.5) - h(k)) {
+        return k;
+      }
+    }
+  }
+
+private:
+  static double expm1_over_x(const double x) {
+    return std::abs(x) > 1e-8 ? std::expm1(x) / x : 1 + x / 2;
+  }
+  static double log1p_over_x(const double x) {
+    return std::abs(x) > 1e-8 ? std::log1p(x) / x : 1 - x / 2;
+  }
+  double h(const double x) const { return std::exp(-s_ * std::log(x)); }
+  double h_integral(const double x) const {
+    const double log_x = std::log(x);
+    return expm1_over_x((1 - s_) * log_x) * log_x;
+  }
+  double h_integral_inverse(const double x) const {
+    double t = x * (1 - s_);
+    t = std::max(t, -1.0);
+    return std::exp(log1p_over_x(t) * x);
+  }
+
+  const int64_t n_;
+  const double s_;
+  const double h_integral_x1_;
+  const double h_integral_n_;
+  const double threshold_;
+};
+
+// USM shared allocations of the context (host memory for the host backend),
+// released at the end of the benchmark.
+class BenchmarkMemory {
+public:
+  explicit BenchmarkMemory(ExecutionContext &ctx) : ctx_(ctx) {}
+  ~BenchmarkMemory() {
+    for (auto ptr : ptrs_) {
+      if (ctx_.is_host()) {
+        std::free(ptr);
+      } else {
+        sycl::free(ptr, ctx_.get_queue());
+      }
+    }
+  }
+
+  template <typename T> T *alloc(const size_t count) {
+    const size_t bytes = std::max<size_t>(1, count * sizeof(T));
+    void *ptr = ctx_.is_host() ? std::aligned_alloc(64, (bytes + 63) / 64 * 64)
+                               : sycl::malloc_shared(bytes, ctx_.get_queue());
+    if (!ptr) {
+      std::fprintf(stderr, "out of memory allocating %zu bytes\n", bytes);
+      std::exit(1);
+    }
+    ptrs_.push_back(ptr);
+    return static_cast<T *>(ptr);
+  }
+
+private:
+  ExecutionContext &ctx_;
+  std::vector<void *> ptrs_;
+};
+
+int64_t get_null_val(const ColumnType column_type, const size_t elem_size) {
+  switch (column_type) {
+  case ColumnType::Unsigned:
+    return elem_size == 8 ? std::numeric_limits<int64_t>::max()
+                          : (int64_t{1} << (8 * elem_size)) - 1;
+  case ColumnType::Double:
+    return NULL_BIGINT;
+  default:
+    return elem_size == 1   ? NULL_TINYINT
+           : elem_size == 2 ? NULL_SMALLINT
+           : elem_size == 4 ? NULL_INT
+                            : NULL_BIGINT;
+  }
+}
+
+// Stores the (decoded) value as the column type encodes it
+void encode_value(int8_t *chunk, const size_t pos, const int64_t value,
+                  const ColumnType column_type, const size_t elem_size) {
+  if (column_type == ColumnType::Double) {
+    reinterpret_cast<double *>(chunk)[pos] = static_cast<double>(value);
+    return;
+  }
+  switch (elem_size) {
+  case 1:
+    reinterpret_cast<int8_t *>(chunk)[pos] = static_cast<int8_t>(value);
+    break;
+  case 2:
+    reinterpret_cast<int16_t *>(chunk)[pos] = static_cast<int16_t>(value);
+    break;
+  case 4:
+    reinterpret_cast<int32_t *>(chunk)[pos] = static_cast<int32_t>(value);
+    break;
+  default:
+    reinterpret_cast<int64_t *>(chunk)[pos] = value;
+  }
+}
+
+// A synthetic key column and its type info: values in [0, key_range) (days
+// for small dates) drawn from the Zipf distribution, rank 1 being key 0, and
+// nulls with probability null_fraction. The rows are dealt to the chunks in
+// slightly uneven sizes.
+struct SyntheticColumn {
+  JoinColumn *join_column;
+  JoinColumnTypeInfo *type_info;
+  int64_t bucket_normalization;
+};
+
+SyntheticColumn make_column(BenchmarkMemory &memory,
+                            const BenchmarkConfig &config,
+                            const std::vector<int64_t> &keys) {
+  const int64_t null_val = get_null_val(config.column_type, config.elem_size);
+  const int64_t scale = config.column_type == ColumnType::SmallDate ? 86400 : 1;
+  auto chunks = memory.alloc<JoinChunk>(config.chunks);
+  size_t row = 0;
+  for (size_t c = 0; c < config.chunks; ++c) {
+    const size_t end =
+        c + 1 == config.chunks
+            ? keys.size()
+            : std::min(keys.size(), (c + 1) * keys.size() / config.chunks +
+                                        (c % 2 ? 0 : keys.size() / config.chunks / 8));
+    const size_t chunk_rows = end > row ? end - row : 0;
+    auto data = memory.alloc<int8_t>(chunk_rows * config.elem_size);
+    for (size_t i = 0; i < chunk_rows; ++i) {
+      const int64_t key = keys[row + i];
+      encode_value(data, i, key < 0 ? null_val : key, config.column_type,
+                   config.elem_size);
+    }
+    chunks[c] = {data, chunk_rows};
+    row += chunk_rows;
+  }
+  auto join_column = memory.alloc<JoinColumn>(1);
+  *join_column = {reinterpret_cast<const int8_t *>(chunks),
+                  config.chunks * sizeof(JoinChunk), config.chunks,
+                  keys.size(), config.elem_size};
+  auto type_info = memory.alloc<JoinColumnTypeInfo>(1);
+  new (type_info) JoinColumnTypeInfo{config.elem_size,
+                                     0,
+                                     (config.key_range - 1) * scale,
+                                     null_val,
+                                     false,
+                                     0,
+                                     config.column_type};
+  return {join_column, type_info, scale};
+}
+
+bool key_range_fits(const BenchmarkConfig &config) {
+  if (config.column_type == ColumnType::Double || config.elem_size == 8) {
+    return true;
+  }
+  // The null value stays out of the key range
+  const int64_t max_key = config.column_type == ColumnType::Unsigned
+                              ? (int64_t{1} << (8 * config.elem_size)) - 2
+                              : (int64_t{1} << (8 * config.elem_size - 1)) - 1;
+  return config.key_range - 1 <= max_key;
+}
+
+std::vector<int64_t> generate_keys(const BenchmarkConfig &config) {
+  std::mt19937_64 rng(config.seed);
+  std::bernoulli_distribution is_null(config.null_fraction);
+  std::vector<int64_t> keys(config.rows);
+  if (config.zipf > 0) {
+    ZipfDistribution zipf(config.key_range, config.zipf);
+    for (auto &key : keys) {
+      key = is_null(rng) ? -1 : zipf(rng) - 1;
+    }
+  } else {
+    std::uniform_int_distribution<int64_t> uniform(0, config.key_range - 1);
+    for (auto &key : keys) {
+      key = is_null(rng) ? -1 : uniform(rng);
+    }
+  }
+  return keys;
+}
+
+struct Stage {
+  std::string name;
+  // Runs on a host context (see ExecutionContext)
+  bool host_supported;
+  // Key column bytes read plus table bytes written by one run
+  size_t bytes;
+  // Untimed, before every run
+  std::function<void()> setup;
+  // Timed, returns the error code of the build (0 if it has none)
+  std::function<int()> run;
+};
+
+void run_stage(const Stage &stage, const BenchmarkConfig &config) {
+  std::vector<double> times_ms;
+  int err = 0;
+  for (size_t rep = 0; rep <= config.reps; ++rep) {
+    stage.setup();
+    const auto start = std::chrono::steady_clock::now();
+    err = stage.run();
+    const auto end = std::chrono::steady_clock::now();
+    // The first run is the warm-up
+    if (rep) {
+      times_ms.push_back(
+          std::chrono::duration<double, std::milli>(end - start).count());
+    }
+  }
+  std::sort(times_ms.begin(), times_ms.end());
+  const double min_ms = times_ms.front();
+  const double median_ms = times_ms[times_ms.size() / 2];
+  const double rows_per_s = config.rows / (median_ms / 1e3);
+  const double gb_per_s = stage.bytes / (median_ms / 1e3) / 1e9;
+  if (config.csv) {
+    std::printf("%s,%.4f,%.4f,%.0f,%.3f,%d\n", stage.name.c_str(), min_ms,
+                median_ms, rows_per_s, gb_per_s, err);
+  } else {
+    std::printf("%-44s %10.3f %10.3f %14.0f %8.3f %5d\n", stage.name.c_str(),
+                min_ms, median_ms, rows_per_s, gb_per_s, err);
+  }
+  std::fflush(stdout);
+}
+
+std::unique_ptr<ExecutionContext> make_context(const BenchmarkConfig &config) {
+  if (config.backend == "host") {
+    return std::make_unique<ExecutionContext>(HostBackend{config.threads});
+  }
+  if (config.backend == "cpu") {
+    return std::make_unique<ExecutionContext>(sycl::device(sycl::cpu_selector_v));
+  }
+  if (config.backend == "gpu") {
+    return std::make_unique<ExecutionContext>(sycl::device(sycl::gpu_selector_v));
+  }
+  return std::make_unique<ExecutionContext>();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const BenchmarkConfig config = parse_config(argc, argv);
+  if (!key_range_fits(config)) {
+    std::fprintf(stderr, "--key-range does not fit the element size\n");
+    return 1;
+  }
+  auto ctx_ptr = make_context(config);
+  ExecutionContext &ctx = *ctx_ptr;
+  KernelProfiler profiler(size_t{1} << 16);
+  if (!config.trace.empty()) {
+    ctx.set_profiler(&profiler);
+  }
+  BenchmarkMemory memory(ctx);
+
+  const auto keys = generate_keys(config);
+  const SyntheticColumn key_column = make_column(memory, config, keys);
+  // The second key component depends on the first, so that both key shapes
+  // have the distinct count of the first column.
+  std::vector<int64_t> second_keys(keys.size());
+  std::transform(keys.begin(), keys.end(), second_keys.begin(),
+                 [](const int64_t key) { return key < 0 ? key : key % 16; });
+  const SyntheticColumn second_column = make_column(memory, config, second_keys);
+
+  const size_t rows = config.rows;
+  const size_t kcc = config.key_columns;
+  const size_t column_bytes = rows * config.elem_size;
+  const int32_t invalid_slot_val = -1;
+  const JoinColumn join_column = *key_column.join_column;
+  const JoinColumnTypeInfo &type_info = *key_column.type_info;
+
+  if (ctx.is_host()) {
+    std::printf("backend: host, %zu threads\n",
+                ctx.get_host_pool().get_thread_count());
+  } else {
+    std::printf("backend: %s\n",
+                ctx.get_device().get_info<sycl::info::device::name>().c_str());
+  }
+  std::printf("rows %zu, chunks %zu, elem size %zu, key range %lld, zipf %g, "
+              "nulls %g, key columns %zu\n",
+              rows, config.chunks, config.elem_size,
+              static_cast<long long>(config.key_range), config.zipf,
+              config.null_fraction, kcc);
+  if (config.csv) {
+    std::printf("stage,min_ms,median_ms,rows_per_s,gb_per_s,err\n");
+  } else {
+    std::printf("%-44s %10s %10s %14s %8s %5s\n", "stage", "min ms",
+                "median ms", "rows/s", "GB/s", "err");
+  }
+
+  // Key handler over the key columns, with their chunk offsets
+  auto join_columns = memory.alloc<JoinColumn>(2);
+  join_columns[0] = join_column;
+  join_columns[1] = *second_column.join_column;
+  auto type_infos = memory.alloc<JoinColumnTypeInfo>(2);
+  new (&type_infos[0]) JoinColumnTypeInfo(type_info);
+  new (&type_infos[1]) JoinColumnTypeInfo(*second_column.type_info);
+  auto chunk_offsets = memory.alloc<size_t>(2 * (config.chunks + 1));
+  auto chunk_offsets_per_key = memory.alloc<const size_t *>(2);
+  for (size_t i = 0; i < 2; ++i) {
+    build_chunk_offsets_on_l0(ctx, join_columns[i],
+                              chunk_offsets + i * (config.chunks + 1));
+    chunk_offsets_per_key[i] = chunk_offsets + i * (config.chunks + 1);
+  }
+  auto key_handler = memory.alloc<GenericKeyHandler>(1);
+  new (key_handler) GenericKeyHandler(kcc, true, join_columns, type_infos,
+                                      nullptr, nullptr, chunk_offsets_per_key);
+
+  auto err_buff = memory.alloc<int>(1);
+  auto read_err = [err_buff] { return *err_buff; };
+  auto no_setup = [] {};
+
+  // Perfect hash tables over the key range
+  const int64_t norm = key_column.bucket_normalization;
+  const HashEntryInfo hash_entry_info{
+      static_cast<size_t>(type_info.max_val - type_info.min_val + 1), norm};
+  const int64_t entry_count = hash_entry_info.getNormalizedHashEntryCount();
+  const HashEntryInfo bucketized_entry_info{hash_entry_info.hash_entry_count,
+                                            4 * norm};
+  const int64_t bucketized_entry_count =
+      bucketized_entry_info.getNormalizedHashEntryCount();
+  auto perfect_buff = memory.alloc<int32_t>(2 * entry_count + rows);
+  const size_t one_to_one_bytes = column_bytes + entry_count * sizeof(int32_t);
+  const size_t one_to_many_bytes =
+      column_bytes + (2 * entry_count + rows) * sizeof(int32_t);
+
+  // Baseline tables at a load factor of 1/2 of the distinct keys
+  const int64_t distinct_estimate =
+      std::min<int64_t>(rows, config.key_range);
+  const int64_t baseline_entry_count = std::max<int64_t>(2, 2 * distinct_estimate);
+  const size_t key_bytes = kcc * sizeof(int64_t);
+  auto baseline_buff =
+      memory.alloc<int8_t>(baseline_entry_count * (key_bytes + sizeof(int64_t)));
+  auto baseline_one_to_many = memory.alloc<int32_t>(2 * baseline_entry_count + rows);
+  const size_t key_column_bytes = kcc * column_bytes;
+  const size_t baseline_bytes =
+      key_column_bytes + baseline_entry_count * (key_bytes + sizeof(int64_t));
+  const size_t baseline_keys_bytes =
+      key_column_bytes + baseline_entry_count * key_bytes;
+  const size_t baseline_one_to_many_bytes =
+      key_column_bytes + (2 * baseline_entry_count + rows) * sizeof(int32_t);
+
+  const size_t bucket_count =
+      get_bucketized_baseline_bucket_count(baseline_entry_count);
+  const size_t bucketized_size =
+      get_bucketized_baseline_hash_buff_size(bucket_count, key_bytes, true);
+  auto bucketized_buff = memory.alloc<int8_t>(bucketized_size);
+  const int64_t bucketized_slot_count = bucket_count * g_baseline_bucket_slots;
+  auto bucketized_one_to_many =
+      memory.alloc<int32_t>(2 * bucketized_slot_count + rows);
+
+  const uint32_t partition_bits =
+      ctx.is_host() ? 0
+                    : get_baseline_partition_bits(ctx, baseline_entry_count,
+                                                  key_bytes + sizeof(int64_t));
+  const size_t partitioned_size = get_partitioned_baseline_hash_buff_size(
+      partition_bits, baseline_entry_count, key_bytes + sizeof(int64_t));
+  auto partitioned_buff = memory.alloc<int8_t>(partitioned_size);
+
+  const uint32_t hll_bits = 16;
+  auto hll_buff = memory.alloc<uint8_t>(size_t{1} << hll_bits);
+  const size_t bloom_block_count = get_bloom_filter_block_count(distinct_estimate);
+  const BloomFilter bloom_filter{
+      memory.alloc<uint64_t>(get_bloom_filter_size(bloom_block_count) /
+                             sizeof(uint64_t)),
+      bloom_block_count};
+
+  auto init_perfect = [&] {
+    init_hash_join_buff_on_l0(ctx, perfect_buff, entry_count, invalid_slot_val);
+  };
+  auto init_baseline = [&](const bool with_val_slot) {
+    return [&, with_val_slot] {
+      init_baseline_hash_join_buff_on_l0<int64_t>(
+          ctx, baseline_buff, baseline_entry_count, kcc, with_val_slot,
+          invalid_slot_val);
+    };
+  };
+  auto fill_baseline = [&](const bool for_semi_join, const bool with_val_slot) {
+    return [&, for_semi_join, with_val_slot] {
+      fill_baseline_hash_join_buff_on_l0<int64_t>(
+          ctx, baseline_buff, baseline_entry_count, invalid_slot_val,
+          for_semi_join, kcc, with_val_slot, err_buff, key_handler, rows);
+      return read_err();
+    };
+  };
+  auto init_bucketized = [&] {
+    init_bucketized_baseline_hash_buff_on_l0<int64_t>(
+        ctx, bucketized_buff, bucket_count, kcc, true, invalid_slot_val);
+  };
+
+  std::vector<Stage> stages;
+  stages.push_back({"shared/build_chunk_offsets", true,
+                    (config.chunks + 1) * sizeof(size_t), no_setup, [&] {
+                      build_chunk_offsets_on_l0(ctx, join_column, chunk_offsets);
+                      return 0;
+                    }});
+  stages.push_back({"shared/compute_column_stats", false, column_bytes, no_setup,
+                    [&] {
+                      compute_column_stats_on_l0(ctx, join_column, type_info,
+                                                 entry_count);
+                      return 0;
+                    }});
+  stages.push_back({"perfect/init_hash_join_buff", true,
+                    entry_count * sizeof(int32_t), no_setup, [&] {
+                      init_perfect();
+                      return 0;
+                    }});
+  stages.push_back({"perfect/fill_hash_join_buff_bucketized", true,
+                    one_to_one_bytes, init_perfect, [&] {
+                      fill_hash_join_buff_bucketized_on_l0(
+                          ctx, perfect_buff, invalid_slot_val, false,
+                          join_column, type_info, nullptr, 0, norm, err_buff);
+                      return read_err();
+                    }});
+  for (const bool for_semi_join : {false, true}) {
+    stages.push_back(
+        {for_semi_join ? "perfect/build_hash_join_buff_bucketized(semi)"
+                       : "perfect/build_hash_join_buff_bucketized",
+         true, one_to_one_bytes, no_setup, [&, for_semi_join] {
+           build_hash_join_buff_bucketized_on_l0(
+               ctx, perfect_buff, hash_entry_info, invalid_slot_val,
+               for_semi_join, join_column, type_info, nullptr, 0, false,
+               err_buff);
+           return read_err();
+         }});
+  }
+  stages.push_back({"perfect/fill_one_to_many_hash_table_bucketized", true,
+                    column_bytes + (2 * bucketized_entry_count + rows) *
+                                       sizeof(int32_t),
+                    no_setup, [&] {
+                      fill_one_to_many_hash_table_on_l0_bucketized(
+                          ctx, perfect_buff, bucketized_entry_info,
+                          invalid_slot_val, join_column, type_info);
+                      return 0;
+                    }});
+  // The one-to-many layout of the non-bucketized build is over the
+  // unnormalized entry count (seconds for small dates)
+  if (norm == 1) {
+    stages.push_back({"perfect/fill_one_to_many_hash_table", true,
+                      one_to_many_bytes, no_setup, [&] {
+                        fill_one_to_many_hash_table_on_l0(
+                            ctx, perfect_buff, hash_entry_info, invalid_slot_val,
+                            join_column, type_info);
+                        return 0;
+                      }});
+    stages.push_back({"perfect/fill_one_to_many_hash_table(bloom)", false,
+                      one_to_many_bytes + get_bloom_filter_size(bloom_block_count),
+                      [&] { init_bloom_filter_on_l0(ctx, bloom_filter); }, [&] {
+                        fill_one_to_many_hash_table_on_l0_async(
+                            ctx, perfect_buff, hash_entry_info, invalid_slot_val,
+                            join_column, type_info, bloom_filter, {})
+                            .wait();
+                        return 0;
+                      }});
+  }
+
+  stages.push_back({"baseline/init_baseline_hash_join_buff", true,
+                    baseline_entry_count * (key_bytes + sizeof(int64_t)),
+                    no_setup, [&] {
+                      init_baseline(true)();
+                      return 0;
+                    }});
+  stages.push_back({"baseline/fill_baseline_hash_join_buff", true,
+                    baseline_bytes, init_baseline(true),
+                    fill_baseline(false, true)});
+  stages.push_back({"baseline/fill_baseline_hash_join_buff(semi)", true,
+                    baseline_bytes, init_baseline(true),
+                    fill_baseline(true, true)});
+  stages.push_back({"baseline/fill_baseline_hash_join_buff(keys)", true,
+                    baseline_keys_bytes, init_baseline(false),
+                    fill_baseline(false, false)});
+  stages.push_back(
+      {"baseline/fill_one_to_many_baseline_hash_table", true,
+       baseline_one_to_many_bytes,
+       [&] {
+         init_baseline(false)();
+         fill_baseline(false, false)();
+       },
+       [&] {
+         fill_one_to_many_baseline_hash_table_on_l0<int64_t>(
+             ctx, baseline_one_to_many,
+             reinterpret_cast<const int64_t *>(baseline_buff),
+             baseline_entry_count, invalid_slot_val, key_handler, rows);
+         return 0;
+       }});
+
+  stages.push_back({"bucketized_baseline/init", false, bucketized_size, no_setup,
+                    [&] {
+                      init_bucketized();
+                      return 0;
+                    }});
+  stages.push_back({"bucketized_baseline/fill", false,
+                    key_column_bytes + bucketized_size, init_bucketized, [&] {
+                      fill_bucketized_baseline_hash_buff_on_l0<int64_t>(
+                          ctx, bucketized_buff, bucket_count, invalid_slot_val,
+                          true, kcc, true, err_buff, key_handler, rows);
+                      return read_err();
+                    }});
+  stages.push_back(
+      {"bucketized_baseline/fill_one_to_many", false,
+       key_column_bytes + (2 * bucketized_slot_count + rows) * sizeof(int32_t),
+       [&] {
+         init_bucketized_baseline_hash_buff_on_l0<int64_t>(
+             ctx, bucketized_buff, bucket_count, kcc, false, invalid_slot_val);
+         fill_bucketized_baseline_hash_buff_on_l0<int64_t>(
+             ctx, bucketized_buff, bucket_count, invalid_slot_val, false, kcc,
+             false, err_buff, key_handler, rows);
+       },
+       [&] {
+         fill_one_to_many_bucketized_baseline_hash_table_on_l0<int64_t>(
+             ctx, bucketized_one_to_many, bucketized_buff, bucket_count, kcc,
+             key_handler, rows);
+         return 0;
+       }});
+
+  stages.push_back({"partitioned_baseline/fill", false,
+                    2 * key_column_bytes + partitioned_size, no_setup, [&] {
+                      fill_partitioned_baseline_hash_buff_on_l0<int64_t>(
+                          ctx, partitioned_buff, partition_bits,
+                          baseline_entry_count, invalid_slot_val, true, kcc,
+                          true, err_buff, key_handler, rows);
+                      return read_err();
+                    }});
+  stages.push_back(
+      {"partitioned_baseline/fill_one_to_many", false,
+       baseline_one_to_many_bytes,
+       [&] {
+         fill_partitioned_baseline_hash_buff_on_l0<int64_t>(
+             ctx, partitioned_buff, partition_bits, baseline_entry_count,
+             invalid_slot_val, false, kcc, false, err_buff, key_handler, rows);
+       },
+       [&] {
+         fill_one_to_many_partitioned_baseline_hash_table_on_l0<int64_t>(
+             ctx, baseline_one_to_many, partitioned_buff, partition_bits,
+             baseline_entry_count, kcc, key_handler, rows);
+         return 0;
+       }});
+
+  stages.push_back({"hll/approximate_distinct_tuples", true,
+                    key_column_bytes + (size_t{1} << hll_bits),
+                    [&] { std::memset(hll_buff, 0, size_t{1} << hll_bits); },
+                    [&] {
+                      approximate_distinct_tuples_on_l0(ctx, hll_buff, nullptr,
+                                                        hll_bits, rows,
+                                                        key_handler);
+                      return 0;
+                    }});
+  stages.push_back({"hll/estimate_hll_cardinality", false,
+                    size_t{1} << hll_bits, no_setup, [&] {
+                      estimate_hll_cardinality_on_l0(ctx, hll_buff, hll_bits);
+                      return 0;
+                    }});
+
+  // Sharded builds over the sub-devices of the device
+  std::unique_ptr<MultiDeviceContext> mctx;
+  std::vector<int32_t *> shard_buffs;
+  if (!ctx.is_host()) {
+    mctx = std::make_unique<MultiDeviceContext>(get_sub_devices(ctx.get_device()));
+    if (!config.trace.empty()) {
+      mctx->set_profiler(&profiler);
+    }
+  }
+  BenchmarkMemory shard_memory(mctx ? mctx->get_device_context(0) : ctx);
+  if (mctx) {
+    for (size_t s = 0; s < mctx->get_device_count(); ++s) {
+      shard_buffs.push_back(shard_memory.alloc<int32_t>(
+          2 * get_perfect_hash_shard(entry_count, s, mctx->get_device_count())
+                  .get_slot_count() +
+          rows));
+    }
+    auto sharded_one_to_one = shard_memory.alloc<int32_t>(entry_count);
+    auto sharded_err = shard_memory.alloc<int>(1);
+    const std::string devices = std::to_string(mctx->get_device_count());
+    stages.push_back({"sharded/build_hash_join_buff_bucketized(" + devices + ")",
+                      false, one_to_one_bytes, no_setup, [&, sharded_one_to_one,
+                                                          sharded_err] {
+                        build_hash_join_buff_bucketized_sharded_on_l0(
+                            *mctx, sharded_one_to_one, hash_entry_info,
+                            invalid_slot_val, false, join_column, type_info,
+                            sharded_err);
+                        return *sharded_err;
+                      }});
+    stages.push_back({"sharded/fill_one_to_many_hash_table(" + devices + ")",
+                      false, one_to_many_bytes, no_setup, [&] {
+                        fill_one_to_many_hash_table_sharded_on_l0(
+                            *mctx, shard_buffs.data(), hash_entry_info,
+                            invalid_slot_val, join_column, type_info);
+                        return 0;
+                      }});
+  }
+
+  for (const auto &stage : stages) {
+    if (ctx.is_host() && !stage.host_supported) {
+      continue;
+    }
+    if (!config.stages.empty() &&
+        stage.name.find(config.stages) == std::string::npos) {
+      continue;
+    }
+    run_stage(stage, config);
+  }
+  if (!config.trace.empty()) {
+    std::ofstream trace(config.trace);
+    profiler.write_chrome_trace(trace);
+    if (profiler.get_dropped_count()) {
+      std::fprintf(stderr, "trace: %zu oldest kernels dropped\n",
+                   profiler.get_dropped_count());
+    }
+  }
+  return 0;
+}
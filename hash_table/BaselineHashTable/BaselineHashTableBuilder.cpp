@@ -5,88 +5,81 @@
 
 #include "../GenericKeyHandler.h"
 #include "../MurMurHash.h"
+#include "../Shared/BloomFilter.h"
+#include "../Shared/ExecutionContext.h"
+#include "../Shared/HashTableStats.h"
+#include "../Shared/JoinColumnLaunch.h"
+#include "../Shared/MultiDeviceContext.h"
+#include "../Shared/Profiling.h"
+#include "../Shared/Scan.h"
+#include "../Shared/ShardExchange.h"
 #include "../Shared/Shared.h"
+#include "../Shared/Sharding.h"
+#include "../Shared/SlotCounting.h"
 #include "BaselineHashTableBuilder.h"
 #include "BaselineHashTableHelpers.h"
-
-template <typename T>
-inline bool keys_are_equal(const T *key1, const T *key2,
-                           const size_t key_component_count) {
-  for (size_t idx = 0; idx < key_component_count; idx++) {
-    if (key1[idx] != key2[idx]) {
-      return false;
-    }
-  }
-  return true;
-}
+#include "BucketizedBaselineHashTableHelpers.h"
+#include "PartitionedBaselineHashTableHelpers.h"
 
 uint8_t get_rank(const uint64_t x, const uint32_t b) {
   return std::min(b, static_cast<uint32_t>(x ? sycl::clz(x) : 64)) + 1;
 }
 
 // This executes on the device (no need to create queues)
+// Returns the value slot of entry h if it holds key (claiming it if it was
+// empty), nullptr otherwise.
 template <typename T>
 T *get_matching_baseline_hash_slot_at(int8_t *hash_buff, const uint32_t h,
                                       const T *key,
                                       const size_t key_component_count,
-                                      const int64_t hash_entry_size) {
+                                      const int64_t hash_entry_size,
+                                      uint32_t *cas_failures) {
   const uint32_t off =
       h * hash_entry_size; // Get row's offset in the hash table
   T *row_ptr = reinterpret_cast<T *>(hash_buff + off); // Get row itself
-  const T empty_key_const = get_invalid_key<T>();      // empty_key constant
-  T empty_key = empty_key_const;
-  sycl::atomic_ref<T, sycl::memory_order::acq_rel, sycl::memory_scope::device>
-      atomic_row_ptr(*row_ptr);
-  const bool success = atomic_row_ptr.compare_exchange_strong(
-      empty_key, *key,
-      sycl::memory_order::acq_rel); // Expect empty key, put write pending flag
-  if (success) {
-    for (int64_t i = 1; i < key_component_count; ++i) {
-      sycl::atomic_ref<T, sycl::memory_order::acq_rel,
-                       sycl::memory_scope::device>
-          atomic_row_ptr_i(*(row_ptr + i));
-      atomic_row_ptr_i.store(key[i], sycl::memory_order::release);
-    }
-  }
-  if (key_component_count > 1) {
-    sycl::atomic_ref<T, sycl::memory_order::acq_rel, sycl::memory_scope::device>
-        atomic_row_ptr_last(*(row_ptr + key_component_count - 1));
-    while (atomic_row_ptr_last.load(sycl::memory_order::acquire) ==
-           empty_key_const) {
-      // spin until the winning thread has finished writing the entire key and
-      // the init value
-    }
-  }
-  bool match = true;
-  for (uint32_t i = 0; i < key_component_count; ++i) {
-    if (row_ptr[i] != key[i]) {
-      return nullptr;
-    }
+  if (!match_or_claim_baseline_key(row_ptr, key, key_component_count,
+                                   cas_failures)) {
+    return nullptr;
   }
   return reinterpret_cast<T *>(row_ptr + key_component_count);
 }
 
+// Adds the CASes an inserter lost to cas_retries unless it is nullptr
+inline void add_cas_retries(int64_t *cas_retries,
+                            const uint32_t cas_failures) {
+  if (cas_retries && cas_failures) {
+    sycl::atomic_ref<int64_t, sycl::memory_order::relaxed,
+                     sycl::memory_scope::device>
+        atomic_cas_retries(*cas_retries);
+    atomic_cas_retries.fetch_add(cas_failures);
+  }
+}
+
 // This executes on the device (no need to create queues)
 template <typename T>
 int write_baseline_hash_slot_for_semi_join(
-    const int32_t val, int8_t *hash_buff, const int64_t entry_count,
+    const int64_t val, int8_t *hash_buff, const int64_t entry_count,
     const T *key, const size_t key_component_count, const bool with_val_slot,
     const int32_t invalid_slot_val, const size_t key_size_in_bytes,
-    const size_t hash_entry_size) {
+    const size_t hash_entry_size, int64_t *cas_retries = nullptr) {
+  uint32_t cas_failures = 0;
   const uint32_t h = MurmurHash1Impl(key, key_size_in_bytes, 0) % entry_count;
   T *matching_group = get_matching_baseline_hash_slot_at(
-      hash_buff, h, key, key_component_count, hash_entry_size);
+      hash_buff, h, key, key_component_count, hash_entry_size,
+      &cas_failures);
   if (!matching_group) {
     uint32_t h_probe = (h + 1) % entry_count;
     while (h_probe != h) {
       matching_group = get_matching_baseline_hash_slot_at(
-          hash_buff, h_probe, key, key_component_count, hash_entry_size);
+          hash_buff, h_probe, key, key_component_count, hash_entry_size,
+          &cas_failures);
       if (matching_group) {
         break;
       }
       h_probe = (h_probe + 1) % entry_count;
     }
   }
+  add_cas_retries(cas_retries, cas_failures);
   if (!matching_group) {
     return -2;
   }
@@ -103,30 +96,34 @@ int write_baseline_hash_slot_for_semi_join(
 
 // This executes on the device (no need to create queues)
 template <typename T>
-int write_baseline_hash_slot(const int32_t val, int8_t *hash_buff,
+int write_baseline_hash_slot(const int64_t val, int8_t *hash_buff,
                              const int64_t entry_count, const T *key,
                              const size_t key_component_count,
                              const bool with_val_slot,
                              const int32_t invalid_slot_val,
                              const size_t key_size_in_bytes,
-                             const size_t hash_entry_size) {
+                             const size_t hash_entry_size,
+                             int64_t *cas_retries = nullptr) {
+  uint32_t cas_failures = 0;
   const uint32_t h = MurmurHash1Impl(key, key_size_in_bytes, 0) %
                      entry_count; // get row's position in the hash table
   T *matching_group = get_matching_baseline_hash_slot_at(
       hash_buff, h, key, key_component_count,
-      hash_entry_size);  // Try to write the slot
+      hash_entry_size, &cas_failures); // Try to write the slot
   if (!matching_group) { // If couldn't write the slot for some reason (e.g.,
                          // someone else wrote to that slot another key)
     uint32_t h_probe = (h + 1) % entry_count; // we start linear probing
     while (h_probe != h) { // we go until we make the full circle
       matching_group = get_matching_baseline_hash_slot_at(
-          hash_buff, h_probe, key, key_component_count, hash_entry_size);
+          hash_buff, h_probe, key, key_component_count, hash_entry_size,
+          &cas_failures);
       if (matching_group) {
         break;
       }
       h_probe = (h_probe + 1) % entry_count;
     }
   }
+  add_cas_retries(cas_retries, cas_failures);
   if (!matching_group) { // If we went the full ht circle and couldn't find a
                          // slot
     return -2;
@@ -147,232 +144,546 @@ int write_baseline_hash_slot(const int32_t val, int8_t *hash_buff,
   return 0;
 }
 
-template <typename T, typename KEY_HANDLER>
-void fill_row_ids_baseline(int32_t *buff, const T *composite_key_dict,
-                           const int64_t hash_entry_count,
-                           const int32_t invalid_slot_val, const KEY_HANDLER *f,
-                           const int64_t num_elems) {
+// Bytes of the one-to-many passes over the keys of num_elems rows: the key
+// (one component, the rest is up to the key handler) and the entry looked up,
+// a count, and for the filling pass also a position and a row id.
+template <typename T, typename ROW_ID = int32_t>
+int64_t get_one_to_many_count_bytes(const int64_t num_elems) {
+  return num_elems * static_cast<int64_t>(2 * sizeof(T) + sizeof(ROW_ID));
+}
+
+template <typename T, typename ROW_ID = int32_t>
+int64_t get_one_to_many_fill_bytes(const int64_t num_elems) {
+  return num_elems * static_cast<int64_t>(2 * sizeof(T) + 3 * sizeof(ROW_ID));
+}
+
+// Atomic count of a slot of a one-to-many count_buff: add_slot_count(slot,
+// count) adds count rows to the slot and returns the rows before them.
+template <typename ROW_ID>
+struct SlotCountAdder {
+  ROW_ID *count_buff;
+
+  int64_t operator()(const int64_t slot, const int64_t count) const {
+    sycl::atomic_ref<ROW_ID, sycl::memory_order::relaxed,
+                     sycl::memory_scope::device>
+        atomic_count(count_buff[slot]);
+    return static_cast<int64_t>(
+        atomic_count.fetch_add(static_cast<ROW_ID>(count)));
+  }
+};
+
+template <typename T, typename ROW_ID, typename KEY_HANDLER>
+sycl::event fill_row_ids_baseline(ExecutionContext &ctx, ROW_ID *buff,
+                                  const T *composite_key_dict,
+                                  const int64_t hash_entry_count,
+                                  const KEY_HANDLER *f, const int64_t num_elems,
+                                  const std::vector<sycl::event> &deps) {
   assert(composite_key_dict);
-  sycl::queue q;
-  q.submit([&](sycl::handler &h) {
-     h.parallel_for(
-         sycl::range{static_cast<size_t>(hash_entry_count)},
-         [=](sycl::id<1> tuple_idx) {
-           int32_t *pos_buff = buff;
-           int32_t *count_buff = buff + hash_entry_count;
-           int32_t *id_buff = count_buff + hash_entry_count;
-           const size_t key_size_in_bytes =
-               f->get_key_component_count() * sizeof(T);
-           auto key_buff_handler = [composite_key_dict, hash_entry_count,
-                                    pos_buff, count_buff, id_buff,
-                                    key_size_in_bytes](
-                                       const int64_t row_index,
-                                       const T *key_scratch_buff,
-                                       const size_t key_component_count) {
-             const T *matching_group = get_matching_baseline_hash_slot_readonly(
-                 key_scratch_buff, key_component_count, composite_key_dict,
-                 hash_entry_count, key_size_in_bytes);
-             const auto entry_idx =
-                 (matching_group - composite_key_dict) / key_component_count;
-             int32_t *pos_ptr = pos_buff + entry_idx;
-             const auto bin_idx = pos_ptr - pos_buff;
-             sycl::atomic_ref<int32_t, sycl::memory_order::acq_rel,
-                              sycl::memory_scope::device>
-                 atomic_count_buff(*(count_buff + bin_idx));
-             const auto id_buff_idx = atomic_count_buff.fetch_add(1) + *pos_ptr;
-             id_buff[id_buff_idx] = static_cast<int32_t>(row_index);
-             return 0;
-           };
-
-           JoinColumnTuple cols(f->get_number_of_columns(),
-                                f->get_join_columns(),
-                                f->get_join_column_type_infos());
-           auto join_tuple_iter =
-               JoinColumnTupleIterator(cols.num_cols, cols.join_column_per_key,
-                                       cols.type_info_per_key, tuple_idx, 1);
-           T key_scratch_buff[g_maximum_conditions_to_coalesce]; // The key
-           if (join_tuple_iter != cols.end()) {
-             (*f)(join_tuple_iter.join_column_iterators, key_scratch_buff,
-                  key_buff_handler);
-           }
-         });
-   }).wait();
-}
-
-template <typename T, typename KEY_HANDLER>
-void count_matches_baseline(int32_t *count_buff, const T *composite_key_dict,
-                            const int64_t entry_count,
-                            const KEY_HANDLER *f, // On GPU
-                            const int64_t num_elems) {
-  sycl::queue q;
+  ROW_ID *pos_buff = buff;
+  ROW_ID *count_buff = buff + hash_entry_count;
+  ROW_ID *id_buff = count_buff + hash_entry_count;
+  auto get_slot = [composite_key_dict, hash_entry_count](
+                      const T *key_scratch_buff,
+                      const size_t key_component_count) -> int64_t {
+    const T *matching_group = get_matching_baseline_hash_slot_readonly(
+        key_scratch_buff, key_component_count, composite_key_dict,
+        hash_entry_count, key_component_count * sizeof(T));
+    return (matching_group - composite_key_dict) / key_component_count;
+  };
+  auto write_row_id = [pos_buff, id_buff](const int64_t row_index,
+                                          const int64_t slot,
+                                          const int64_t position) {
+    id_buff[pos_buff[slot] + position] = static_cast<ROW_ID>(row_index);
+  };
+  const KernelInfo info{"baseline_fill_row_ids", num_elems, hash_entry_count,
+                        get_one_to_many_fill_bytes<T, ROW_ID>(num_elems)};
+  const KeySlots<T, KEY_HANDLER, decltype(get_slot)> slots{f, num_elems,
+                                                           get_slot};
+  return submit_slot_reservations(ctx, info, slots,
+                                  SlotCountAdder<ROW_ID>{count_buff},
+                                  write_row_id, deps);
+}
+
+template <typename T, typename ROW_ID, typename KEY_HANDLER>
+sycl::event count_matches_baseline(ExecutionContext &ctx, ROW_ID *count_buff,
+                                   const T *composite_key_dict,
+                                   const int64_t entry_count,
+                                   const KEY_HANDLER *f, // On GPU
+                                   const int64_t num_elems,
+                                   const std::vector<sycl::event> &deps) {
   assert(composite_key_dict);
-  q.submit([&](sycl::handler &h) {
-     // std::cout << q.get_device().get_info<sycl::info::device::name>() <<
-     // "\n";
-     h.parallel_for(
-         sycl::range{static_cast<size_t>(entry_count)},
-         [=](sycl::id<1> tuple_idx) {
-           const size_t key_size_in_bytes =
-               f->get_key_component_count() * sizeof(T);
-           auto key_buff_handler =
-               [composite_key_dict, entry_count, count_buff, key_size_in_bytes](
-                   const int64_t row_entry_idx, const T *key_scratch_buff,
-                   const size_t key_component_count) {
-                 const auto matching_group =
-                     get_matching_baseline_hash_slot_readonly(
-                         key_scratch_buff, key_component_count,
-                         composite_key_dict, entry_count, key_size_in_bytes);
-                 const auto entry_idx = (matching_group - composite_key_dict) /
-                                        key_component_count;
-                 sycl::atomic_ref<int32_t, sycl::memory_order::relaxed,
-                                  sycl::memory_scope::device>
-                     atomic_count_buf_at_idx(count_buff[entry_idx]);
-                 atomic_count_buf_at_idx.fetch_add(1);
-                 return 0;
-               };
-           JoinColumnTuple cols(f->get_number_of_columns(),
-                                f->get_join_columns(),
-                                f->get_join_column_type_infos());
-           T key_scratch_buff[g_maximum_conditions_to_coalesce]; // The key
-           auto join_tuple_iter =
-               JoinColumnTupleIterator(cols.num_cols, cols.join_column_per_key,
-                                       cols.type_info_per_key, tuple_idx, 1);
-           if (join_tuple_iter != cols.end()) {
-             (*f)(join_tuple_iter.join_column_iterators, key_scratch_buff,
-                  key_buff_handler);
-           }
-         });
-   }).wait();
+  auto get_slot = [composite_key_dict, entry_count](
+                      const T *key_scratch_buff,
+                      const size_t key_component_count) -> int64_t {
+    const auto matching_group = get_matching_baseline_hash_slot_readonly(
+        key_scratch_buff, key_component_count, composite_key_dict, entry_count,
+        key_component_count * sizeof(T));
+    return (matching_group - composite_key_dict) / key_component_count;
+  };
+  const KernelInfo info{"baseline_count_matches", num_elems, entry_count,
+                        get_one_to_many_count_bytes<T, ROW_ID>(num_elems)};
+  const KeySlots<T, KEY_HANDLER, decltype(get_slot)> slots{f, num_elems,
+                                                           get_slot};
+  return submit_slot_counts(ctx, info, slots, entry_count,
+                            SlotCountAdder<ROW_ID>{count_buff}, deps);
 }
 
 template <typename T>
-const T *get_matching_baseline_hash_slot_readonly(
-    const T *key, const size_t key_component_count, const T *composite_key_dict,
-    const int64_t entry_count, const size_t key_size_in_bytes) {
-  const uint32_t h = MurmurHash1Impl(key, key_size_in_bytes, 0) % entry_count;
-  uint32_t off = h * key_component_count;
-  if (keys_are_equal(&composite_key_dict[off], key, key_component_count)) {
-    return &composite_key_dict[off];
-  }
-  uint32_t h_probe = (h + 1) % entry_count;
-  while (h_probe != h) {
-    off = h_probe * key_component_count;
-    if (keys_are_equal(&composite_key_dict[off], key, key_component_count)) {
-      return &composite_key_dict[off];
+sycl::event init_baseline_hash_join_buff_on_l0_async(
+    ExecutionContext &ctx, int8_t *hash_join_buff, const int64_t entry_count,
+    const size_t key_component_count, const bool with_val_slot,
+    const int32_t invalid_slot_val, const std::vector<sycl::event> &deps) {
+  const size_t hash_entry_size =
+      (key_component_count + (with_val_slot ? 1 : 0)) * sizeof(T);
+  const T empty_key = get_invalid_key<T>();
+  auto init_entry = [=](const size_t idx) {
+    const int64_t off = idx * hash_entry_size;
+    auto row_ptr = reinterpret_cast<T *>(hash_join_buff + off);
+    // std::fill(row_ptr, row_ptr+key_component_count, empty_key);
+    // memset(row_ptr, empty_key, key_component_count*sizeof(int32_t));
+    for (size_t k_component = 0; k_component < key_component_count;
+         ++k_component) {
+      row_ptr[k_component] = empty_key;
+    }
+    if (with_val_slot) {
+      row_ptr[key_component_count] = invalid_slot_val;
     }
-    h_probe = (h_probe + 1) % entry_count;
+  };
+  const KernelInfo info{"baseline_init", 0, entry_count,
+                        entry_count * static_cast<int64_t>(hash_entry_size)};
+  if (ctx.is_host()) {
+    return submit_profiled(ctx, info, [&] {
+      return run_on_host(deps, [&] {
+        host_parallel_for_rows(
+            ctx, entry_count, [&](const size_t begin, const size_t end) {
+              for (size_t idx = begin; idx < end; ++idx) {
+                init_entry(idx);
+              }
+            });
+      });
+    });
   }
-  assert(false);
-  return nullptr;
+  auto &q = ctx.get_queue();
+  const auto launch_config = ctx.get_launch_config();
+  return submit_profiled(ctx, info, [&] {
+    return q.submit([&](sycl::handler &h) {
+       h.depends_on(deps);
+       h.parallel_for(
+           get_grid_stride_nd_range(launch_config, entry_count),
+           [=](sycl::nd_item<1> item) {
+             for (size_t idx = item.get_global_id(0);
+                  idx < static_cast<size_t>(entry_count);
+                  idx += item.get_global_range(0)) {
+               init_entry(idx);
+             }
+           });
+     });
+  });
 }
 
 template <typename T>
-void init_baseline_hash_join_buff_on_l0(int8_t *hash_join_buff,
+void init_baseline_hash_join_buff_on_l0(ExecutionContext &ctx,
+                                        int8_t *hash_join_buff,
                                         const int64_t entry_count,
                                         const size_t key_component_count,
                                         const bool with_val_slot,
                                         const int32_t invalid_slot_val) {
-  sycl::queue q;
-  const size_t hash_entry_size =
-      (key_component_count + (with_val_slot ? 1 : 0)) * sizeof(T);
-  const T empty_key = get_invalid_key<T>();
-  q.submit([&](sycl::handler &h) {
-     h.parallel_for(
-         sycl::range{static_cast<size_t>(entry_count)}, [=](sycl::id<1> idx) {
-           const int64_t off = idx * hash_entry_size;
-           auto row_ptr = reinterpret_cast<T *>(hash_join_buff + off);
-           // std::fill(row_ptr, row_ptr+key_component_count, empty_key);
-           // memset(row_ptr, empty_key, key_component_count*sizeof(int32_t));
-           for (size_t k_component = 0; k_component < key_component_count;
-                ++k_component) {
-             row_ptr[k_component] = empty_key;
-           }
-           if (with_val_slot) {
-             row_ptr[key_component_count] = invalid_slot_val;
-           }
-         });
-   }).wait();
+  init_baseline_hash_join_buff_on_l0_async<T>(ctx, hash_join_buff, entry_count,
+                                              key_component_count,
+                                              with_val_slot, invalid_slot_val,
+                                              {})
+      .wait();
 }
 
 template <typename T>
-void fill_baseline_hash_join_buff_on_l0(
-    int8_t *hash_buff, const int64_t entry_count,
+void init_baseline_hash_join_buff_on_l0(int8_t *hash_join_buff,
+                                        const int64_t entry_count,
+                                        const size_t key_component_count,
+                                        const bool with_val_slot,
+                                        const int32_t invalid_slot_val) {
+  init_baseline_hash_join_buff_on_l0<T>(
+      ExecutionContext::get_default(), hash_join_buff, entry_count,
+      key_component_count, with_val_slot, invalid_slot_val);
+}
+
+// Inserts the keys for which key_filter(key, key_component_count) holds
+template <typename T, typename KEY_FILTER>
+sycl::event fill_baseline_hash_join_buff_impl(
+    ExecutionContext &ctx, int8_t *hash_buff, const int64_t entry_count,
     const int32_t invalid_slot_val, const bool for_semi_join,
     const size_t key_component_count, const bool with_val_slot,
     int *dev_err_buff, const GenericKeyHandler *key_handler,
-    const int64_t num_elems) {
-  sycl::queue q(sycl::property::queue::enable_profiling{});
+    const int64_t num_elems, const BloomFilter bloom_filter,
+    int64_t *cas_retries, KEY_FILTER key_filter,
+    const std::vector<sycl::event> &deps) {
   const size_t key_size_in_bytes = key_component_count * sizeof(T);
   const size_t hash_entry_size =
       key_size_in_bytes + (with_val_slot * sizeof(T));
   auto key_buff_handler = [hash_buff, entry_count, with_val_slot,
                            invalid_slot_val, key_size_in_bytes, hash_entry_size,
-                           for_semi_join](const int64_t entry_idx,
-                                          const T *key_scratch_buffer,
-                                          const size_t key_component_count) {
+                           for_semi_join, bloom_filter, cas_retries,
+                           key_filter](const int64_t entry_idx,
+                                       const T *key_scratch_buffer,
+                                       const size_t key_component_count) {
+    if (!key_filter(key_scratch_buffer, key_component_count)) {
+      return 0;
+    }
+    if (bloom_filter.blocks) {
+      bloom_filter_insert(bloom_filter,
+                          get_bloom_filter_hash(key_scratch_buffer,
+                                                key_component_count));
+    }
     if (for_semi_join) {
       return write_baseline_hash_slot_for_semi_join<T>(
           entry_idx, hash_buff, entry_count, key_scratch_buffer,
           key_component_count, with_val_slot, invalid_slot_val,
-          key_size_in_bytes, hash_entry_size);
+          key_size_in_bytes, hash_entry_size, cas_retries);
     } else {
       return write_baseline_hash_slot<T>(
           entry_idx, hash_buff, entry_count, key_scratch_buffer,
           key_component_count, with_val_slot, invalid_slot_val,
-          key_size_in_bytes, hash_entry_size);
+          key_size_in_bytes, hash_entry_size, cas_retries);
     }
   };
 
-  sycl::event kernelEvent = q.submit([&](sycl::handler &h) {
-    // std::cout << q.get_device().get_info<sycl::info::device::name>() << "\n";
-    h.parallel_for(
-        sycl::range{static_cast<size_t>(entry_count)},
-        [=](sycl::id<1> tuple_idx) {
-          JoinColumnTuple cols(key_handler->get_number_of_columns(),
-                               key_handler->get_join_columns(),
-                               key_handler->get_join_column_type_infos());
-          T key_scratch_buff[g_maximum_conditions_to_coalesce]; // The key
-          sycl::atomic_ref<int32_t, sycl::memory_order::relaxed,
-                           sycl::memory_scope::device>
-              atomic_dev_err_buff(*(dev_err_buff));
-          auto join_tuple_iter =
-              JoinColumnTupleIterator(cols.num_cols, cols.join_column_per_key,
-                                      cols.type_info_per_key, tuple_idx, 1);
-          if (join_tuple_iter != cols.end()) {
-            const auto err =
-                (*key_handler)(join_tuple_iter.join_column_iterators,
-                               key_scratch_buff, key_buff_handler);
-            if (err) {
-              atomic_dev_err_buff.store(err);
+  // The key and the entry it is inserted into
+  const KernelInfo info{
+      for_semi_join ? "baseline_fill_semi_join" : "baseline_fill_one_to_one",
+      num_elems, entry_count,
+      num_elems * static_cast<int64_t>(key_size_in_bytes + hash_entry_size)};
+  return submit_for_each_key<T>(ctx, info, key_handler, num_elems,
+                                dev_err_buff, key_buff_handler, deps);
+}
+
+template <typename T>
+sycl::event fill_baseline_hash_join_buff_on_l0_async(
+    ExecutionContext &ctx, int8_t *hash_buff, const int64_t entry_count,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const size_t key_component_count, const bool with_val_slot,
+    int *dev_err_buff, const GenericKeyHandler *key_handler,
+    const int64_t num_elems, const BloomFilter bloom_filter,
+    HashTableStats *stats, const std::vector<sycl::event> &deps) {
+  if (!stats) {
+    return fill_baseline_hash_join_buff_impl<T>(
+        ctx, hash_buff, entry_count, invalid_slot_val, for_semi_join,
+        key_component_count, with_val_slot, dev_err_buff, key_handler,
+        num_elems, bloom_filter, nullptr,
+        [](const T *, const size_t) { return true; }, deps);
+  }
+  auto stats_reset = init_hash_table_stats_on_l0_async(ctx, stats, deps);
+  auto filled = fill_baseline_hash_join_buff_impl<T>(
+      ctx, hash_buff, entry_count, invalid_slot_val, for_semi_join,
+      key_component_count, with_val_slot, dev_err_buff, key_handler, num_elems,
+      bloom_filter, &stats->cas_retries,
+      [](const T *, const size_t) { return true; }, {stats_reset});
+  return compute_baseline_hash_table_stats_on_l0_async<T>(
+      ctx, hash_buff, entry_count, key_component_count, with_val_slot, stats,
+      {filled});
+}
+
+template <typename T>
+sycl::event fill_baseline_hash_join_buff_on_l0_async(
+    ExecutionContext &ctx, int8_t *hash_buff, const int64_t entry_count,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const size_t key_component_count, const bool with_val_slot,
+    int *dev_err_buff, const GenericKeyHandler *key_handler,
+    const int64_t num_elems, const BloomFilter bloom_filter,
+    const std::vector<sycl::event> &deps) {
+  return fill_baseline_hash_join_buff_on_l0_async<T>(
+      ctx, hash_buff, entry_count, invalid_slot_val, for_semi_join,
+      key_component_count, with_val_slot, dev_err_buff, key_handler, num_elems,
+      bloom_filter, nullptr, deps);
+}
+
+template <typename T>
+sycl::event fill_baseline_hash_join_buff_on_l0_async(
+    ExecutionContext &ctx, int8_t *hash_buff, const int64_t entry_count,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const size_t key_component_count, const bool with_val_slot,
+    int *dev_err_buff, const GenericKeyHandler *key_handler,
+    const int64_t num_elems, const std::vector<sycl::event> &deps) {
+  return fill_baseline_hash_join_buff_on_l0_async<T>(
+      ctx, hash_buff, entry_count, invalid_slot_val, for_semi_join,
+      key_component_count, with_val_slot, dev_err_buff, key_handler, num_elems,
+      BloomFilter{}, deps);
+}
+
+template <typename T>
+void fill_baseline_hash_join_buff_on_l0(
+    ExecutionContext &ctx, int8_t *hash_buff, const int64_t entry_count,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const size_t key_component_count, const bool with_val_slot,
+    int *dev_err_buff, const GenericKeyHandler *key_handler,
+    const int64_t num_elems) {
+  fill_baseline_hash_join_buff_on_l0_async<T>(
+      ctx, hash_buff, entry_count, invalid_slot_val, for_semi_join,
+      key_component_count, with_val_slot, dev_err_buff, key_handler, num_elems,
+      {})
+      .wait();
+}
+
+template <typename T>
+void fill_baseline_hash_join_buff_on_l0(
+    int8_t *hash_buff, const int64_t entry_count,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const size_t key_component_count, const bool with_val_slot,
+    int *dev_err_buff, const GenericKeyHandler *key_handler,
+    const int64_t num_elems) {
+  fill_baseline_hash_join_buff_on_l0<T>(
+      ExecutionContext::get_default(), hash_buff, entry_count,
+      invalid_slot_val, for_semi_join, key_component_count, with_val_slot,
+      dev_err_buff, key_handler, num_elems);
+}
+
+// Raises register index of hll_buffer to rank. The registers are bytes, so
+// this CASes the aligned 32-bit word holding it (hll_buffer must be 4-byte
+// aligned, as USM allocations are).
+inline void atomic_max_hll_register(uint8_t *hll_buffer, const size_t index,
+                                    const uint8_t rank) {
+  const auto addr = reinterpret_cast<uintptr_t>(hll_buffer + index);
+  const uint32_t shift = (addr & 3) * 8;
+  sycl::atomic_ref<uint32_t, sycl::memory_order::relaxed,
+                   sycl::memory_scope::device>
+      atomic_word(*reinterpret_cast<uint32_t *>(addr & ~uintptr_t{3}));
+  uint32_t word = atomic_word.load();
+  while (((word >> shift) & 0xFF) < rank) {
+    const uint32_t raised =
+        (word & ~(uint32_t{0xFF} << shift)) | (uint32_t{rank} << shift);
+    if (atomic_word.compare_exchange_weak(word, raised)) {
+      break;
+    }
+  }
+}
+
+sycl::event approximate_distinct_tuples_on_l0_async(
+    ExecutionContext &ctx, uint8_t *hll_buffer, int32_t *row_count_buffer,
+    const uint32_t b, const int64_t num_elems, const GenericKeyHandler *f,
+    const std::vector<sycl::event> &deps) {
+  const size_t hll_size = size_t{1} << b;
+  auto count_row = [row_count_buffer](const int64_t entry_idx) {
+    if (row_count_buffer) {
+      sycl::atomic_ref<int32_t, sycl::memory_order::relaxed,
+                       sycl::memory_scope::device>
+          atomic_row_count(row_count_buffer[entry_idx]);
+      atomic_row_count.fetch_add(1);
+    }
+  };
+  auto get_register = [b](const int64_t *key_scratch_buff,
+                          const size_t key_component_count) {
+    const uint64_t hash = MurmurHash64AImpl(
+        key_scratch_buff, key_component_count * sizeof(int64_t), 0);
+    return std::make_pair(static_cast<uint32_t>(hash >> (64 - b)),
+                          get_rank(hash << b, 64 - b));
+  };
+  // The keys (one component, the rest is up to the key handler), the row
+  // counts and the registers
+  const KernelInfo hll_info{
+      "hll_approximate_distinct", num_elems, static_cast<int64_t>(hll_size),
+      num_elems * static_cast<int64_t>(sizeof(int64_t) +
+                                       (row_count_buffer ? sizeof(int32_t)
+                                                         : 0)) +
+          static_cast<int64_t>(hll_size)};
+
+  if (ctx.is_host()) {
+    // Every task builds a private sketch and merges it, as the work-groups do
+    return submit_profiled(ctx, hll_info, [&] {
+      return run_on_host(deps, [&] {
+        host_parallel_for_rows(ctx, num_elems, [&](const size_t begin,
+                                                   const size_t end) {
+          std::vector<uint8_t> task_hll(hll_size);
+          f->for_each_key_in_range<int64_t>(
+              begin, end,
+              [&](const int64_t entry_idx, const int64_t *key_scratch_buff,
+                  const size_t key_component_count) {
+                count_row(entry_idx);
+                const auto [index, rank] =
+                    get_register(key_scratch_buff, key_component_count);
+                task_hll[index] = std::max(task_hll[index], rank);
+                return 0;
+              });
+          for (size_t i = 0; i < hll_size; ++i) {
+            if (task_hll[i]) {
+              atomic_max_hll_register(hll_buffer, i, task_hll[i]);
             }
           }
         });
+      });
+    });
+  }
+
+  auto &q = ctx.get_queue();
+  const auto launch_config = ctx.get_launch_config();
+  const auto nd_range = get_grid_stride_nd_range(launch_config, num_elems);
+
+  const size_t local_mem_size =
+      ctx.get_device().get_info<sycl::info::device::local_mem_size>();
+  if (hll_size * sizeof(uint32_t) > local_mem_size / 2) {
+    // The sketch doesn't fit in local memory: update the registers in place
+    return submit_profiled(ctx, hll_info, [&] {
+      return q.submit([&](sycl::handler &h) {
+        h.depends_on(deps);
+        h.parallel_for(nd_range, [=](sycl::nd_item<1> item) {
+          f->for_each_key<int64_t>(
+              item.get_global_id(0), item.get_global_range(0),
+              [&](const int64_t entry_idx, const int64_t *key_scratch_buff,
+                  const size_t key_component_count) {
+                count_row(entry_idx);
+                const auto [index, rank] =
+                    get_register(key_scratch_buff, key_component_count);
+                atomic_max_hll_register(hll_buffer, index, rank);
+                return 0;
+              });
+        });
+      });
+    });
+  }
+
+  // Every work-group builds its sketch in local memory and merges it into
+  // hll_buffer at the end, one atomic per non-zero register.
+  return submit_profiled(ctx, hll_info, [&] {
+    return q.submit([&](sycl::handler &h) {
+      h.depends_on(deps);
+      sycl::local_accessor<uint32_t, 1> local_hll(sycl::range<1>{hll_size}, h);
+      h.parallel_for(nd_range, [=](sycl::nd_item<1> item) {
+        const auto group = item.get_group();
+        const size_t local_id = item.get_local_id(0);
+        const size_t local_range = item.get_local_range(0);
+        for (size_t i = local_id; i < hll_size; i += local_range) {
+          local_hll[i] = 0;
+        }
+        sycl::group_barrier(group);
+        f->for_each_key<int64_t>(
+            item.get_global_id(0), item.get_global_range(0),
+            [&](const int64_t entry_idx, const int64_t *key_scratch_buff,
+                const size_t key_component_count) {
+              count_row(entry_idx);
+              const auto [index, rank] =
+                  get_register(key_scratch_buff, key_component_count);
+              sycl::atomic_ref<uint32_t, sycl::memory_order::relaxed,
+                               sycl::memory_scope::work_group,
+                               sycl::access::address_space::local_space>
+                  atomic_register(local_hll[index]);
+              atomic_register.fetch_max(rank);
+              return 0;
+            });
+        sycl::group_barrier(group);
+        for (size_t i = local_id; i < hll_size; i += local_range) {
+          if (local_hll[i]) {
+            atomic_max_hll_register(hll_buffer, i,
+                                    static_cast<uint8_t>(local_hll[i]));
+          }
+        }
+      });
+    });
   });
+}
 
-  // sycl::event kernelEvent = q.single_task([=](){
-  //   sycl::atomic_ref<int32_t, sycl::memory_order::relaxed,
-  //   sycl::memory_scope::device> atomic_dev_err_buff(*(dev_err_buff));
-  //   JoinColumnTuple cols(key_handler->get_number_of_columns(),
-  //   key_handler->get_join_columns(),
-  //   key_handler->get_join_column_type_infos()); T
-  //   key_scratch_buff[g_maximum_conditions_to_coalesce]; // The key for (auto&
-  //   it : cols.slice(0, 1)) {
-  //     const auto err = (*key_handler)(it.join_column_iterators,
-  //     key_scratch_buff, key_buff_handler); if (err) {
-  //       atomic_dev_err_buff.store(err);
-  //     }
-  //   }
-  // });
-
-  kernelEvent.wait();
-  //   auto start_time =
-  //       kernelEvent
-  //           .get_profiling_info<sycl::info::event_profiling::command_start>();
-  //   auto end_time =
-  //       kernelEvent
-  //           .get_profiling_info<sycl::info::event_profiling::command_end>();
-  //   std::cout << "fill_baseline_hash_join_buff_on_l0 time: "
-  //             << (end_time - start_time) / 1e6 << " ms" << std::endl;
+sycl::event merge_hll_sketches_on_l0_async(ExecutionContext &ctx,
+                                           uint8_t *hll_buffer,
+                                           const uint8_t *other_hll_buffer,
+                                           const uint32_t b,
+                                           const std::vector<sycl::event> &deps) {
+  const int64_t hll_size = int64_t{1} << b;
+  const KernelInfo info{"hll_merge", 0, hll_size, 3 * hll_size};
+  return submit_profiled(ctx, info, [&] {
+    if (ctx.is_host()) {
+      return run_on_host(deps, [&] {
+        host_parallel_for_rows(
+            ctx, hll_size, [&](const size_t begin, const size_t end) {
+              for (size_t idx = begin; idx < end; ++idx) {
+                hll_buffer[idx] =
+                    std::max(hll_buffer[idx], other_hll_buffer[idx]);
+              }
+            });
+      });
+    }
+    return ctx.get_queue().submit([&](sycl::handler &h) {
+      h.depends_on(deps);
+      h.parallel_for(sycl::range<1>{size_t{1} << b}, [=](sycl::id<1> idx) {
+        hll_buffer[idx] = std::max(hll_buffer[idx], other_hll_buffer[idx]);
+      });
+    });
+  });
+}
+
+// Cardinality estimate of a sketch of hll_size registers from the sum of
+// 2^-register and the number of zero registers
+inline int64_t get_hll_estimate(const float sum, const uint32_t zero_count,
+                                const size_t hll_size) {
+  const float m = hll_size;
+  float alpha = 0.7213f / (1 + 1.079f / m);
+  if (hll_size == 16) {
+    alpha = 0.673f;
+  } else if (hll_size == 32) {
+    alpha = 0.697f;
+  } else if (hll_size == 64) {
+    alpha = 0.709f;
+  }
+  float estimate = alpha * m * m / sum;
+  if (estimate <= 2.5f * m && zero_count) {
+    // small range correction (linear counting)
+    estimate = m * sycl::log(m / zero_count);
+  }
+  return static_cast<int64_t>(sycl::round(estimate));
+}
+
+sycl::event estimate_hll_cardinality_on_l0_async(
+    ExecutionContext &ctx, const uint8_t *hll_buffer, const uint32_t b,
+    int64_t *cardinality, const std::vector<sycl::event> &deps) {
+  const size_t hll_size = size_t{1} << b;
+  const KernelInfo info{"hll_estimate", 0, static_cast<int64_t>(hll_size),
+                        static_cast<int64_t>(hll_size)};
+  if (ctx.is_host()) {
+    // A single pass over the registers, as the single work-group does
+    return submit_profiled(ctx, info, [&] {
+      return run_on_host(deps, [&] {
+        float sum = 0;
+        uint32_t zero_count = 0;
+        for (size_t i = 0; i < hll_size; ++i) {
+          sum += sycl::ldexp(1.f, -static_cast<int>(hll_buffer[i]));
+          zero_count += hll_buffer[i] == 0;
+        }
+        *cardinality = get_hll_estimate(sum, zero_count, hll_size);
+      });
+    });
+  }
+  auto &q = ctx.get_queue();
+  const size_t work_group_size = ctx.get_launch_config().work_group_size;
+  return submit_profiled(ctx, info, [&] {
+    return q.submit([&](sycl::handler &h) {
+      h.depends_on(deps);
+      h.parallel_for(
+          sycl::nd_range<1>{work_group_size, work_group_size},
+          [=](sycl::nd_item<1> item) {
+            float sum = 0;
+            uint32_t zero_count = 0;
+            for (size_t i = item.get_local_id(0); i < hll_size;
+                 i += work_group_size) {
+              sum += sycl::ldexp(1.f, -static_cast<int>(hll_buffer[i]));
+              zero_count += hll_buffer[i] == 0;
+            }
+            sum = sycl::reduce_over_group(item.get_group(), sum,
+                                          sycl::plus<float>());
+            zero_count = sycl::reduce_over_group(item.get_group(), zero_count,
+                                                 sycl::plus<uint32_t>());
+            if (item.get_local_id(0)) {
+              return;
+            }
+            *cardinality = get_hll_estimate(sum, zero_count, hll_size);
+          });
+    });
+  });
+}
+
+void approximate_distinct_tuples_on_l0(ExecutionContext &ctx,
+                                       uint8_t *hll_buffer,
+                                       int32_t *row_count_buffer,
+                                       const uint32_t b,
+                                       const int64_t num_elems,
+                                       const GenericKeyHandler *f) {
+  approximate_distinct_tuples_on_l0_async(ctx, hll_buffer, row_count_buffer, b,
+                                          num_elems, f, {})
+      .wait();
 }
 
 void approximate_distinct_tuples_on_l0(uint8_t *hll_buffer,
@@ -380,50 +691,84 @@ void approximate_distinct_tuples_on_l0(uint8_t *hll_buffer,
                                        const uint32_t b,
                                        const int64_t num_elems,
                                        const GenericKeyHandler *f) {
-  sycl::queue q;
-  auto writer_to_hll_buff =
-      [b, hll_buffer, row_count_buffer](const int64_t entry_idx,
-                                        const int64_t *key_scratch_buff,
-                                        const size_t key_component_count) {
-        if (row_count_buffer) {
-          row_count_buffer[entry_idx] += 1;
-        }
-        const uint64_t hash = MurmurHash64AImpl(
-            key_scratch_buff, key_component_count * sizeof(int64_t), 0);
-        const uint32_t index = hash >> (64 - b);
-        const auto rank = get_rank(hash << b, 64 - b);
-        hll_buffer[index] = std::max(hll_buffer[index], rank);
-        return 0;
-      };
-
-  q.submit([&](sycl::handler &h) {
-     h.parallel_for(
-         sycl::range{static_cast<size_t>(num_elems)},
-         [=](sycl::id<1> tuple_idx) {
-           JoinColumnTuple cols(f->get_number_of_columns(),
-                                f->get_join_columns(),
-                                f->get_join_column_type_infos());
-           int64_t
-               key_scratch_buff[g_maximum_conditions_to_coalesce]; // The key
-           auto join_cols_tuple_it =
-               JoinColumnTupleIterator(cols.num_cols, cols.join_column_per_key,
-                                       cols.type_info_per_key, tuple_idx, 1);
-           if (join_cols_tuple_it != cols.end()) {
-             (*f)(join_cols_tuple_it.join_column_iterators, key_scratch_buff,
-                  writer_to_hll_buff);
-           }
-         });
-   }).wait();
-
-  // q.single_task([=](){
-  //   JoinColumnTuple cols(
-  //       f->get_number_of_columns(), f->get_join_columns(),
-  //       f->get_join_column_type_infos());
-  //   int64_t key_scratch_buff[g_maximum_conditions_to_coalesce]; // The key
-  //   for (auto& it : cols.slice(0, 1)) {
-  //     (*f)(it.join_column_iterators, key_scratch_buff, writer_to_hll_buff);
-  //   }
-  // }).wait();
+  approximate_distinct_tuples_on_l0(ExecutionContext::get_default(),
+                                    hll_buffer, row_count_buffer, b, num_elems,
+                                    f);
+}
+
+void merge_hll_sketches_on_l0(ExecutionContext &ctx, uint8_t *hll_buffer,
+                              const uint8_t *other_hll_buffer,
+                              const uint32_t b) {
+  merge_hll_sketches_on_l0_async(ctx, hll_buffer, other_hll_buffer, b, {})
+      .wait();
+}
+
+int64_t estimate_hll_cardinality_on_l0(ExecutionContext &ctx,
+                                       const uint8_t *hll_buffer,
+                                       const uint32_t b) {
+  auto cardinality = reinterpret_cast<int64_t *>(
+      ctx.get_scratch(ScratchSlot::Result, sizeof(int64_t)));
+  auto estimated =
+      estimate_hll_cardinality_on_l0_async(ctx, hll_buffer, b, cardinality, {});
+  if (ctx.is_host()) {
+    return *cardinality;
+  }
+  int64_t result;
+  ctx.get_queue().memcpy(&result, cardinality, sizeof(int64_t), estimated).wait();
+  return result;
+}
+
+template <typename T, typename ROW_ID>
+sycl::event fill_one_to_many_baseline_hash_table_on_l0_async(
+    ExecutionContext &ctx, ROW_ID *buff, const T *composite_key_dict,
+    const int64_t hash_entry_count, const int32_t /*invalid_slot_val*/,
+    const GenericKeyHandler *key_handler, const size_t num_elems,
+    const std::vector<sycl::event> &deps) {
+  auto pos_buff = buff;
+  auto count_buff = buff + hash_entry_count;
+  auto count_buff_reset =
+      fill_buff_async(ctx, "baseline_reset_counts", count_buff, ROW_ID{0},
+                      static_cast<size_t>(hash_entry_count), deps);
+  auto counted = count_matches_baseline<T, ROW_ID, GenericKeyHandler>(
+      ctx, count_buff, composite_key_dict, hash_entry_count, key_handler,
+      num_elems, {count_buff_reset});
+  auto pos_set = set_valid_pos_from_counts(ctx, pos_buff, count_buff,
+                                           hash_entry_count, {counted});
+  return fill_row_ids_baseline<T, ROW_ID, GenericKeyHandler>(
+      ctx, buff, composite_key_dict, hash_entry_count, key_handler, num_elems,
+      {pos_set});
+}
+
+template <typename T, typename ROW_ID>
+sycl::event fill_one_to_many_baseline_hash_table_on_l0_async(
+    ExecutionContext &ctx, ROW_ID *buff, const T *composite_key_dict,
+    const int64_t hash_entry_count, const int32_t invalid_slot_val,
+    const GenericKeyHandler *key_handler, const size_t num_elems,
+    HashTableStats *stats, const std::vector<sycl::event> &deps) {
+  auto filled = fill_one_to_many_baseline_hash_table_on_l0_async<T>(
+      ctx, buff, composite_key_dict, hash_entry_count, invalid_slot_val,
+      key_handler, num_elems, deps);
+  if (!stats) {
+    return filled;
+  }
+  // Keeps the stats of composite_key_dict, only the bucket sizes are new
+  auto bucket_sizes_reset = fill_buff_async(
+      ctx, "one_to_many_stats_reset",
+      reinterpret_cast<int64_t *>(&stats->bucket_sizes), int64_t{0},
+      sizeof(HashTableDistribution) / sizeof(int64_t), {filled});
+  return compute_one_to_many_stats_on_l0_async(ctx, buff, hash_entry_count,
+                                               stats, {bucket_sizes_reset});
+}
+
+template <typename T, typename ROW_ID>
+void fill_one_to_many_baseline_hash_table_on_l0(
+    ExecutionContext &ctx, ROW_ID *buff, const T *composite_key_dict,
+    const int64_t hash_entry_count, const int32_t invalid_slot_val,
+    const GenericKeyHandler *key_handler, const size_t num_elems) {
+  fill_one_to_many_baseline_hash_table_on_l0_async<T>(
+      ctx, buff, composite_key_dict, hash_entry_count, invalid_slot_val,
+      key_handler, num_elems, {})
+      .wait();
 }
 
 template <typename T>
@@ -431,31 +776,854 @@ void fill_one_to_many_baseline_hash_table_on_l0(
     int32_t *buff, const T *composite_key_dict, const int64_t hash_entry_count,
     const int32_t invalid_slot_val, const GenericKeyHandler *key_handler,
     const size_t num_elems) {
-  sycl::queue q;
+  fill_one_to_many_baseline_hash_table_on_l0<T>(
+      ExecutionContext::get_default(), buff, composite_key_dict,
+      hash_entry_count, invalid_slot_val, key_handler, num_elems);
+}
+
+// This executes on the device (no need to create queues)
+template <typename T>
+int write_bucketized_baseline_hash_slot(const int32_t val,
+                                        const BucketizedBaselineTable<T> &table,
+                                        const T *key, const bool with_val_slot,
+                                        const int32_t invalid_slot_val,
+                                        const bool for_semi_join) {
+  const auto slot_idx = get_matching_bucketized_baseline_slot(table, key);
+  if (slot_idx < 0) {
+    return -2;
+  }
+  if (!with_val_slot) {
+    return 0;
+  }
+  int32_t invalid_slot_val_copy = invalid_slot_val;
+  sycl::atomic_ref<int32_t, sycl::memory_order::relaxed,
+                   sycl::memory_scope::device>
+      atomic_val(table.vals()[slot_idx]);
+  if (!atomic_val.compare_exchange_strong(invalid_slot_val_copy, val) &&
+      !for_semi_join) {
+    return -1;
+  }
+  return 0;
+}
+
+// One-to-many passes over the rows of slots (see SlotCounting.h) for the
+// tables whose lookups are not the flat ones: the slot of a row is the index
+// of the entry of its key, which is in the table, or -1 to skip the row.
+template <typename T, typename SLOTS>
+sycl::event count_matches_baseline_impl(ExecutionContext &ctx,
+                                        int32_t *count_buff,
+                                        const int64_t hash_entry_count,
+                                        const SLOTS &slots,
+                                        const std::vector<sycl::event> &deps) {
+  const int64_t num_rows = slots.get_launch_row_count();
+  const KernelInfo info{"baseline_count_matches", num_rows, 0,
+                        get_one_to_many_count_bytes<T>(num_rows)};
+  return submit_slot_counts(ctx, info, slots, hash_entry_count,
+                            SlotCountAdder<int32_t>{count_buff}, deps);
+}
+
+template <typename T, typename SLOTS>
+sycl::event fill_row_ids_baseline_impl(ExecutionContext &ctx, int32_t *buff,
+                                       const SLOTS &slots,
+                                       const int64_t hash_entry_count,
+                                       const std::vector<sycl::event> &deps) {
+  const int32_t *pos_buff = buff;
+  int32_t *count_buff = buff + hash_entry_count;
+  int32_t *id_buff = count_buff + hash_entry_count;
+  auto write_row_id = [pos_buff, id_buff](const int64_t row_index,
+                                          const int64_t slot,
+                                          const int64_t position) {
+    id_buff[pos_buff[slot] + position] = static_cast<int32_t>(row_index);
+  };
+  const int64_t num_rows = slots.get_launch_row_count();
+  const KernelInfo info{"baseline_fill_row_ids", num_rows, hash_entry_count,
+                        get_one_to_many_fill_bytes<T>(num_rows)};
+  return submit_slot_reservations(ctx, info, slots,
+                                  SlotCountAdder<int32_t>{count_buff},
+                                  write_row_id, deps);
+}
+
+template <typename T, typename SLOTS>
+sycl::event fill_one_to_many_baseline_impl(ExecutionContext &ctx, int32_t *buff,
+                                           const SLOTS &slots,
+                                           const int64_t hash_entry_count,
+                                           const std::vector<sycl::event> &deps) {
   auto pos_buff = buff;
   auto count_buff = buff + hash_entry_count;
-  q.memset(count_buff, 0, hash_entry_count * sizeof(int32_t)).wait();
-  count_matches_baseline<T, GenericKeyHandler>(
-      count_buff, composite_key_dict, hash_entry_count, key_handler, num_elems);
-  set_valid_pos_flag(pos_buff, count_buff, hash_entry_count);
-  q.single_task([=]() { // Inclusive scan
-     for (size_t i = 1; i < hash_entry_count; i++) {
-       count_buff[i] = count_buff[i - 1] + count_buff[i];
-     }
-   })
+  auto count_buff_reset =
+      fill_buff_async(ctx, "baseline_reset_counts", count_buff, 0,
+                      static_cast<size_t>(hash_entry_count), deps);
+  auto counted = count_matches_baseline_impl<T>(ctx, count_buff,
+                                                hash_entry_count, slots,
+                                                {count_buff_reset});
+  auto pos_set = set_valid_pos_from_counts(ctx, pos_buff, count_buff,
+                                           hash_entry_count, {counted});
+  return fill_row_ids_baseline_impl<T>(ctx, buff, slots, hash_entry_count,
+                                       {pos_set});
+}
+
+// Slots of the build keys of the num_elems rows of f: get_slot(key)
+template <typename T, typename SLOT_FUNC>
+auto get_baseline_key_slots(const GenericKeyHandler *f,
+                            const int64_t num_elems, SLOT_FUNC get_slot) {
+  auto get_key_slot = [get_slot](const T *key, const size_t) -> int64_t {
+    return get_slot(key);
+  };
+  return KeySlots<T, GenericKeyHandler, decltype(get_key_slot)>{
+      f, num_elems, get_key_slot};
+}
+
+template <typename T>
+sycl::event init_bucketized_baseline_hash_buff_on_l0_async(
+    ExecutionContext &ctx, int8_t *hash_buff, const size_t bucket_count,
+    const size_t key_component_count, const bool with_val_slot,
+    const int32_t invalid_slot_val, const std::vector<sycl::event> &deps) {
+  auto &q = ctx.get_queue();
+  // Empty fingerprints and a zero max probe length
+  const size_t header_size = get_bucketized_baseline_keys_offset(bucket_count);
+  const KernelInfo header_info{"bucketized_baseline_init_header", 0,
+                               static_cast<int64_t>(bucket_count),
+                               static_cast<int64_t>(header_size)};
+  auto header_reset = submit_profiled(ctx, header_info, [&] {
+    return q.memset(hash_buff, 0, header_size, deps);
+  });
+  const BucketizedBaselineTable<T> table{hash_buff, bucket_count,
+                                         key_component_count};
+  const size_t slot_count = bucket_count * g_baseline_bucket_slots;
+  auto keys_reset = fill_buff_async(
+      ctx, "bucketized_baseline_init_keys", table.keys(), get_invalid_key<T>(),
+      slot_count * key_component_count, {header_reset});
+  if (!with_val_slot) {
+    return keys_reset;
+  }
+  return fill_buff_async(ctx, "bucketized_baseline_init_vals", table.vals(),
+                         invalid_slot_val, slot_count, {keys_reset});
+}
+
+template <typename T>
+void init_bucketized_baseline_hash_buff_on_l0(
+    ExecutionContext &ctx, int8_t *hash_buff, const size_t bucket_count,
+    const size_t key_component_count, const bool with_val_slot,
+    const int32_t invalid_slot_val) {
+  init_bucketized_baseline_hash_buff_on_l0_async<T>(
+      ctx, hash_buff, bucket_count, key_component_count, with_val_slot,
+      invalid_slot_val, {})
       .wait();
-  set_valid_pos(pos_buff, count_buff, hash_entry_count);
-  q.memset(count_buff, 0, hash_entry_count * sizeof(int32_t)).wait();
-  fill_row_ids_baseline<T, GenericKeyHandler>(
-      buff, composite_key_dict, hash_entry_count, invalid_slot_val, key_handler,
-      num_elems);
 }
 
+template <typename T>
+sycl::event fill_bucketized_baseline_hash_buff_on_l0_async(
+    ExecutionContext &ctx, int8_t *hash_buff, const size_t bucket_count,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const size_t key_component_count, const bool with_val_slot,
+    int *dev_err_buff, const GenericKeyHandler *key_handler,
+    const int64_t num_elems, const BloomFilter bloom_filter,
+    const std::vector<sycl::event> &deps) {
+  auto &q = ctx.get_queue();
+  const BucketizedBaselineTable<T> table{hash_buff, bucket_count,
+                                         key_component_count};
+  auto key_buff_handler = [table, with_val_slot, invalid_slot_val,
+                           for_semi_join,
+                           bloom_filter](const int64_t entry_idx,
+                                         const T *key_scratch_buffer,
+                                         const size_t key_component_count) {
+    if (bloom_filter.blocks) {
+      bloom_filter_insert(bloom_filter,
+                          get_bloom_filter_hash(key_scratch_buffer,
+                                                key_component_count));
+    }
+    return write_bucketized_baseline_hash_slot<T>(
+        entry_idx, table, key_scratch_buffer, with_val_slot, invalid_slot_val,
+        for_semi_join);
+  };
+  const auto launch_config = ctx.get_launch_config();
+  // The key, its bucket word and the slot it is inserted into
+  const size_t key_size_in_bytes = key_component_count * sizeof(T);
+  const KernelInfo info{
+      for_semi_join ? "bucketized_baseline_fill_semi_join"
+                    : "bucketized_baseline_fill_one_to_one",
+      num_elems, static_cast<int64_t>(bucket_count * g_baseline_bucket_slots),
+      num_elems * static_cast<int64_t>(2 * key_size_in_bytes +
+                                       sizeof(uint64_t) + sizeof(int32_t))};
+  return submit_profiled(ctx, info, [&] {
+    return q.submit([&](sycl::handler &h) {
+      h.depends_on(deps);
+      h.parallel_for(
+          get_grid_stride_nd_range(launch_config, num_elems),
+          [=](sycl::nd_item<1> item) {
+            sycl::atomic_ref<int32_t, sycl::memory_order::relaxed,
+                             sycl::memory_scope::device>
+                atomic_dev_err_buff(*(dev_err_buff));
+            const auto err = key_handler->template for_each_key<T>(
+                item.get_global_id(0), item.get_global_range(0),
+                key_buff_handler);
+            if (err) {
+              atomic_dev_err_buff.store(err);
+            }
+          });
+    });
+  });
+}
+
+template <typename T>
+sycl::event fill_bucketized_baseline_hash_buff_on_l0_async(
+    ExecutionContext &ctx, int8_t *hash_buff, const size_t bucket_count,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const size_t key_component_count, const bool with_val_slot,
+    int *dev_err_buff, const GenericKeyHandler *key_handler,
+    const int64_t num_elems, const std::vector<sycl::event> &deps) {
+  return fill_bucketized_baseline_hash_buff_on_l0_async<T>(
+      ctx, hash_buff, bucket_count, invalid_slot_val, for_semi_join,
+      key_component_count, with_val_slot, dev_err_buff, key_handler, num_elems,
+      BloomFilter{}, deps);
+}
+
+template <typename T>
+void fill_bucketized_baseline_hash_buff_on_l0(
+    ExecutionContext &ctx, int8_t *hash_buff, const size_t bucket_count,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const size_t key_component_count, const bool with_val_slot,
+    int *dev_err_buff, const GenericKeyHandler *key_handler,
+    const int64_t num_elems) {
+  fill_bucketized_baseline_hash_buff_on_l0_async<T>(
+      ctx, hash_buff, bucket_count, invalid_slot_val, for_semi_join,
+      key_component_count, with_val_slot, dev_err_buff, key_handler, num_elems,
+      {})
+      .wait();
+}
+
+template <typename T>
+sycl::event fill_one_to_many_bucketized_baseline_hash_table_on_l0_async(
+    ExecutionContext &ctx, int32_t *buff, const int8_t *hash_buff,
+    const size_t bucket_count, const size_t key_component_count,
+    const GenericKeyHandler *key_handler, const size_t num_elems,
+    const std::vector<sycl::event> &deps) {
+  // The lookups only read the table
+  const BucketizedBaselineTable<T> table{const_cast<int8_t *>(hash_buff),
+                                         bucket_count, key_component_count};
+  const auto slots = get_baseline_key_slots<T>(
+      key_handler, num_elems, [table](const T *key) {
+        return get_matching_bucketized_baseline_slot_readonly(table, key);
+      });
+  return fill_one_to_many_baseline_impl<T>(
+      ctx, buff, slots, bucket_count * g_baseline_bucket_slots, deps);
+}
+
+template <typename T>
+void fill_one_to_many_bucketized_baseline_hash_table_on_l0(
+    ExecutionContext &ctx, int32_t *buff, const int8_t *hash_buff,
+    const size_t bucket_count, const size_t key_component_count,
+    const GenericKeyHandler *key_handler, const size_t num_elems) {
+  fill_one_to_many_bucketized_baseline_hash_table_on_l0_async<T>(
+      ctx, buff, hash_buff, bucket_count, key_component_count, key_handler,
+      num_elems, {})
+      .wait();
+}
+
+// Work-groups of the partitioning pass: their row counts per partition are
+// scanned, so there must not be one per few rows as in the other kernels.
+constexpr size_t g_max_partitioning_work_groups{1024};
+
+// Registers of the HyperLogLog sketch estimating the distinct keys of a
+// partition too big to count them in local memory (a standard error of
+// about 3%).
+constexpr uint32_t g_partition_hll_bits{10};
+
+// Local memory a partition build may use for its table.
+size_t get_partition_local_mem_size(ExecutionContext &ctx) {
+  return ctx.get_device().get_info<sycl::info::device::local_mem_size>() / 2;
+}
+
+uint32_t get_baseline_partition_bits(ExecutionContext &ctx,
+                                     const int64_t entry_count,
+                                     const size_t hash_entry_size) {
+  // Half the budget on average, so that most of the bigger partitions fit too
+  return get_baseline_partition_bits(entry_count, hash_entry_size,
+                                     get_partition_local_mem_size(ctx) / 2);
+}
+
+template <typename T>
+sycl::event fill_partitioned_baseline_hash_buff_on_l0_async(
+    ExecutionContext &ctx, int8_t *hash_buff, const uint32_t partition_bits,
+    const int64_t entry_count, const int32_t invalid_slot_val,
+    const bool for_semi_join, const size_t key_component_count,
+    const bool with_val_slot, int *dev_err_buff,
+    const GenericKeyHandler *key_handler, const int64_t num_elems,
+    const std::vector<sycl::event> &deps) {
+  if (needs_64bit_row_ids(num_elems)) {
+    return fill_buff_async(ctx, "partitioned_baseline_row_count_err",
+                           dev_err_buff, g_partitioned_baseline_row_count_err,
+                           1, deps);
+  }
+  auto &q = ctx.get_queue();
+  const size_t partition_count = size_t{1} << partition_bits;
+  const size_t key_size_in_bytes = key_component_count * sizeof(T);
+  const size_t hash_entry_size = key_component_count + (with_val_slot ? 1 : 0);
+  const PartitionedBaselineTable<T> table{hash_buff, partition_bits,
+                                          entry_count, key_component_count,
+                                          hash_entry_size};
+  auto get_partition = [table, key_size_in_bytes](const T *key) {
+    return table.get_partition(MurmurHash1Impl(key, key_size_in_bytes, 0));
+  };
+
+  const auto launch_config = ctx.get_launch_config();
+  const size_t work_group_size = launch_config.work_group_size;
+  const size_t group_count = std::min(
+      get_grid_stride_nd_range(launch_config, num_elems).get_group_range()[0],
+      g_max_partitioning_work_groups);
+  const sycl::nd_range<1> nd_range{group_count * work_group_size,
+                                   work_group_size};
+
+  // Scratch: the row count (then offset) of every work-group in every
+  // partition, partition-major, and the first row of every partition, then
+  // the keys and row ids scattered by partition.
+  const size_t group_offsets_count = partition_count * group_count;
+  const size_t keys_offset = align_to_cache_line(
+      (group_offsets_count + partition_count + 1) * sizeof(int32_t));
+  const size_t row_ids_offset =
+      keys_offset + align_to_cache_line(num_elems * key_size_in_bytes);
+  auto scratch = reinterpret_cast<int8_t *>(
+      ctx.get_scratch(ScratchSlot::Partition,
+                      row_ids_offset + num_elems * sizeof(int32_t)));
+  auto group_offsets = reinterpret_cast<int32_t *>(scratch);
+  auto partition_rows = group_offsets + group_offsets_count;
+  auto partitioned_keys = reinterpret_cast<T *>(scratch + keys_offset);
+  auto partitioned_row_ids = reinterpret_cast<int32_t *>(scratch + row_ids_offset);
+
+  // The keys are read by the histogram and the scatter (one component each,
+  // the rest is up to the key handler), the scatter and the build move the
+  // keys and row ids through the scratch memory.
+  const int64_t partitioned_row_bytes =
+      num_elems * static_cast<int64_t>(key_size_in_bytes + sizeof(int32_t));
+  const KernelInfo histogram_info{
+      "partitioned_baseline_histogram", num_elems,
+      static_cast<int64_t>(partition_count),
+      num_elems * static_cast<int64_t>(sizeof(T)) +
+          static_cast<int64_t>(group_offsets_count * sizeof(int32_t))};
+  const KernelInfo scatter_info{
+      "partitioned_baseline_scatter", num_elems,
+      static_cast<int64_t>(partition_count),
+      num_elems * static_cast<int64_t>(sizeof(T)) + partitioned_row_bytes};
+  const KernelInfo count_info{
+      "partitioned_baseline_count_keys", num_elems,
+      static_cast<int64_t>(partition_count),
+      num_elems * static_cast<int64_t>(key_size_in_bytes)};
+  const KernelInfo build_info{
+      "partitioned_baseline_build", num_elems, entry_count,
+      partitioned_row_bytes +
+          entry_count * static_cast<int64_t>(hash_entry_size * sizeof(T))};
+
+  // Histogram: every work-group counts its rows per partition in local memory
+  auto counted = submit_profiled(ctx, histogram_info, [&] {
+    return q.submit([&](sycl::handler &h) {
+      h.depends_on(deps);
+      sycl::local_accessor<uint32_t, 1> local_counts(
+          sycl::range<1>{partition_count}, h);
+      h.parallel_for(nd_range, [=](sycl::nd_item<1> item) {
+        const size_t local_id = item.get_local_id(0);
+        const size_t local_range = item.get_local_range(0);
+        for (size_t i = local_id; i < partition_count; i += local_range) {
+          local_counts[i] = 0;
+        }
+        sycl::group_barrier(item.get_group());
+        // Key handler errors (unpackable keys) are reported here, the
+        // scatter skips the same rows
+        const int err = key_handler->template for_each_key<T>(
+            item.get_global_id(0), item.get_global_range(0),
+            [&](const int64_t, const T *key, const size_t) {
+              sycl::atomic_ref<uint32_t, sycl::memory_order::relaxed,
+                               sycl::memory_scope::work_group,
+                               sycl::access::address_space::local_space>
+                  atomic_count(local_counts[get_partition(key)]);
+              atomic_count.fetch_add(1);
+              return 0;
+            });
+        if (err) {
+          sycl::atomic_ref<int32_t, sycl::memory_order::relaxed,
+                           sycl::memory_scope::device>
+              atomic_dev_err_buff(*dev_err_buff);
+          atomic_dev_err_buff.store(err);
+        }
+        sycl::group_barrier(item.get_group());
+        for (size_t i = local_id; i < partition_count; i += local_range) {
+          group_offsets[i * group_count + item.get_group(0)] = local_counts[i];
+        }
+      });
+    });
+  });
+
+  // The partition-major scan gives the first position of every work-group in
+  // every partition, and the first row of every partition.
+  auto scanned = exclusive_scan_on_device(
+      ctx, group_offsets, group_offsets_count,
+      [group_offsets, partition_rows, group_count,
+       group_offsets_count](const size_t idx, const int32_t prefix,
+                            const int32_t count) {
+        group_offsets[idx] = prefix;
+        if (idx % group_count == 0) {
+          partition_rows[idx / group_count] = prefix;
+        }
+        if (idx == group_offsets_count - 1) {
+          partition_rows[idx / group_count + 1] = prefix + count;
+        }
+      },
+      {counted});
+
+  // Scatter: every work-group walks the same rows again and writes them from
+  // its positions on
+  auto scattered = submit_profiled(ctx, scatter_info, [&] {
+    return q.submit([&](sycl::handler &h) {
+      h.depends_on(scanned);
+      sycl::local_accessor<uint32_t, 1> local_offsets(
+          sycl::range<1>{partition_count}, h);
+      h.parallel_for(nd_range, [=](sycl::nd_item<1> item) {
+        for (size_t i = item.get_local_id(0); i < partition_count;
+             i += item.get_local_range(0)) {
+          local_offsets[i] = group_offsets[i * group_count + item.get_group(0)];
+        }
+        sycl::group_barrier(item.get_group());
+        key_handler->template for_each_key<T>(
+            item.get_global_id(0), item.get_global_range(0),
+            [&](const int64_t row_index, const T *key,
+                const size_t key_component_count) {
+              sycl::atomic_ref<uint32_t, sycl::memory_order::relaxed,
+                               sycl::memory_scope::work_group,
+                               sycl::access::address_space::local_space>
+                  atomic_offset(local_offsets[get_partition(key)]);
+              const uint32_t pos = atomic_offset.fetch_add(1);
+              for (size_t i = 0; i < key_component_count; ++i) {
+                partitioned_keys[pos * key_component_count + i] = key[i];
+              }
+              partitioned_row_ids[pos] = static_cast<int32_t>(row_index);
+              return 0;
+            });
+      });
+    });
+  });
+
+  // Distinct keys: one work-group per partition inserts its rows into a
+  // table of twice as many entries in local memory, and counts the keys whose
+  // value slot it set first. A partition whose table doesn't fit adds its
+  // keys to a HyperLogLog sketch in local memory instead and takes the
+  // estimate plus an eighth (about four standard errors), at most its rows.
+  // Duplicate and skewed keys would overflow partitions sized by their rows.
+  int32_t *key_offsets = table.key_offsets();
+  const size_t local_table_size =
+      get_partition_local_mem_size(ctx) / sizeof(T);
+  const size_t count_entry_size = key_component_count + 1;
+  constexpr size_t partition_hll_size = size_t{1} << g_partition_hll_bits;
+  auto keys_counted = submit_profiled(ctx, count_info, [&] {
+    return q.submit([&](sycl::handler &h) {
+      h.depends_on(scattered);
+      sycl::local_accessor<T, 1> local_table(sycl::range<1>{local_table_size},
+                                             h);
+      sycl::local_accessor<uint32_t, 1> local_hll(
+          sycl::range<1>{partition_hll_size}, h);
+      h.parallel_for(
+          sycl::nd_range<1>{partition_count * work_group_size, work_group_size},
+          [=](sycl::nd_item<1> item) {
+            const auto group = item.get_group();
+            const size_t partition = item.get_group(0);
+            const size_t local_id = item.get_local_id(0);
+            const size_t local_range = item.get_local_range(0);
+            const int32_t rows_begin = partition_rows[partition];
+            const int32_t rows_end = partition_rows[partition + 1];
+            const int64_t count_entry_count =
+                2 * static_cast<int64_t>(rows_end - rows_begin);
+            const size_t count_table_size =
+                count_entry_count * count_entry_size;
+            int32_t key_count = 0;
+            if (count_table_size <= local_table_size) {
+              T *entries = &local_table[0];
+              const T empty_key = get_invalid_key<T>();
+              for (size_t i = local_id; i < count_table_size;
+                   i += local_range) {
+                entries[i] = i % count_entry_size < key_component_count
+                                 ? empty_key
+                                 : static_cast<T>(invalid_slot_val);
+              }
+              sycl::group_barrier(group);
+              for (int32_t row = rows_begin + local_id; row < rows_end;
+                   row += local_range) {
+                if (!write_baseline_hash_slot<T>(
+                        row, reinterpret_cast<int8_t *>(entries),
+                        count_entry_count,
+                        partitioned_keys + row * key_component_count,
+                        key_component_count, true, invalid_slot_val,
+                        key_size_in_bytes, count_entry_size * sizeof(T))) {
+                  ++key_count;
+                }
+              }
+              key_count = sycl::reduce_over_group(group, key_count,
+                                                  sycl::plus<int32_t>());
+            } else {
+              for (size_t i = local_id; i < partition_hll_size;
+                   i += local_range) {
+                local_hll[i] = 0;
+              }
+              sycl::group_barrier(group);
+              for (int32_t row = rows_begin + local_id; row < rows_end;
+                   row += local_range) {
+                const uint64_t hash = MurmurHash64AImpl(
+                    partitioned_keys + row * key_component_count,
+                    key_size_in_bytes, 0);
+                sycl::atomic_ref<uint32_t, sycl::memory_order::relaxed,
+                                 sycl::memory_scope::work_group,
+                                 sycl::access::address_space::local_space>
+                    atomic_register(
+                        local_hll[hash >> (64 - g_partition_hll_bits)]);
+                atomic_register.fetch_max(
+                    get_rank(hash << g_partition_hll_bits,
+                             64 - g_partition_hll_bits));
+              }
+              sycl::group_barrier(group);
+              float sum = 0;
+              uint32_t zero_count = 0;
+              for (size_t i = local_id; i < partition_hll_size;
+                   i += local_range) {
+                sum += sycl::ldexp(1.f, -static_cast<int>(local_hll[i]));
+                zero_count += local_hll[i] == 0;
+              }
+              sum = sycl::reduce_over_group(group, sum, sycl::plus<float>());
+              zero_count = sycl::reduce_over_group(group, zero_count,
+                                                   sycl::plus<uint32_t>());
+              const int64_t estimate =
+                  get_hll_estimate(sum, zero_count, partition_hll_size);
+              key_count = static_cast<int32_t>(std::min<int64_t>(
+                  estimate + (estimate + 7) / 8, rows_end - rows_begin));
+            }
+            if (!local_id) {
+              key_offsets[partition] = key_count;
+              if (!partition) {
+                key_offsets[partition_count] = 0;
+              }
+            }
+          });
+    });
+  });
+
+  // The partition directory: the first distinct key of every partition
+  auto keys_scanned = exclusive_scan_on_device(
+      ctx, key_offsets, partition_count + 1,
+      ExclusiveScanWriter<int32_t>{key_offsets}, {keys_counted});
+
+  // Build: one work-group per partition inserts its rows into the table of
+  // the partition, in local memory if it fits (then copied out) or else in
+  // place, where it is small enough to stay in cache.
+  return submit_profiled(ctx, build_info, [&] {
+    return q.submit([&](sycl::handler &h) {
+      h.depends_on(keys_scanned);
+      sycl::local_accessor<T, 1> local_table(sycl::range<1>{local_table_size},
+                                             h);
+      h.parallel_for(
+          sycl::nd_range<1>{partition_count * work_group_size, work_group_size},
+          [=](sycl::nd_item<1> item) {
+            const auto group = item.get_group();
+            const size_t partition = item.get_group(0);
+            const size_t local_id = item.get_local_id(0);
+            const size_t local_range = item.get_local_range(0);
+            const int32_t rows_begin = partition_rows[partition];
+            const int32_t rows_end = partition_rows[partition + 1];
+            if (rows_begin == rows_end) {
+              return;
+            }
+            const int64_t entries_begin = table.get_partition_begin(partition);
+            const int64_t partition_entry_count =
+                table.get_partition_begin(partition + 1) - entries_begin;
+            if (!partition_entry_count) {
+              if (!local_id) {
+                sycl::atomic_ref<int32_t, sycl::memory_order::relaxed,
+                                 sycl::memory_scope::device>
+                    atomic_dev_err_buff(*dev_err_buff);
+                atomic_dev_err_buff.store(-2);
+              }
+              return;
+            }
+            const size_t partition_size =
+                partition_entry_count * hash_entry_size;
+            T *global_entries =
+                table.entries() + entries_begin * hash_entry_size;
+            const bool in_local_mem = partition_size <= local_table_size;
+            T *entries = in_local_mem ? &local_table[0] : global_entries;
+            const T empty_key = get_invalid_key<T>();
+            for (size_t i = local_id; i < partition_size; i += local_range) {
+              entries[i] = i % hash_entry_size < key_component_count
+                               ? empty_key
+                               : static_cast<T>(invalid_slot_val);
+            }
+            sycl::group_barrier(group);
+            int err = 0;
+            for (int32_t row = rows_begin + local_id; row < rows_end;
+                 row += local_range) {
+              const T *key = partitioned_keys + row * key_component_count;
+              const int ret =
+                  for_semi_join
+                      ? write_baseline_hash_slot_for_semi_join<T>(
+                            partitioned_row_ids[row],
+                            reinterpret_cast<int8_t *>(entries),
+                            partition_entry_count, key, key_component_count,
+                            with_val_slot, invalid_slot_val, key_size_in_bytes,
+                            hash_entry_size * sizeof(T))
+                      : write_baseline_hash_slot<T>(
+                            partitioned_row_ids[row],
+                            reinterpret_cast<int8_t *>(entries),
+                            partition_entry_count, key, key_component_count,
+                            with_val_slot, invalid_slot_val, key_size_in_bytes,
+                            hash_entry_size * sizeof(T));
+              if (ret) {
+                err = ret;
+              }
+            }
+            if (err) {
+              sycl::atomic_ref<int32_t, sycl::memory_order::relaxed,
+                               sycl::memory_scope::device>
+                  atomic_dev_err_buff(*dev_err_buff);
+              atomic_dev_err_buff.store(err);
+            }
+            if (!in_local_mem) {
+              return;
+            }
+            sycl::group_barrier(group);
+            for (size_t i = local_id; i < partition_size; i += local_range) {
+              global_entries[i] = entries[i];
+            }
+          });
+    });
+  });
+}
+
+template <typename T>
+void fill_partitioned_baseline_hash_buff_on_l0(
+    ExecutionContext &ctx, int8_t *hash_buff, const uint32_t partition_bits,
+    const int64_t entry_count, const int32_t invalid_slot_val,
+    const bool for_semi_join, const size_t key_component_count,
+    const bool with_val_slot, int *dev_err_buff,
+    const GenericKeyHandler *key_handler, const int64_t num_elems) {
+  fill_partitioned_baseline_hash_buff_on_l0_async<T>(
+      ctx, hash_buff, partition_bits, entry_count, invalid_slot_val,
+      for_semi_join, key_component_count, with_val_slot, dev_err_buff,
+      key_handler, num_elems, {})
+      .wait();
+}
+
+template <typename T>
+sycl::event fill_one_to_many_partitioned_baseline_hash_table_on_l0_async(
+    ExecutionContext &ctx, int32_t *buff, const int8_t *hash_buff,
+    const uint32_t partition_bits, const int64_t entry_count,
+    const size_t key_component_count, const GenericKeyHandler *key_handler,
+    const size_t num_elems, const std::vector<sycl::event> &deps) {
+  // The lookups only read the table
+  const PartitionedBaselineTable<T> table{const_cast<int8_t *>(hash_buff),
+                                          partition_bits, entry_count,
+                                          key_component_count,
+                                          key_component_count};
+  const auto slots = get_baseline_key_slots<T>(
+      key_handler, num_elems, [table](const T *key) {
+        return (get_matching_partitioned_baseline_slot_readonly(table, key) -
+                table.entries()) /
+               table.key_component_count;
+      });
+  return fill_one_to_many_baseline_impl<T>(ctx, buff, slots, entry_count,
+                                           deps);
+}
+
+template <typename T>
+void fill_one_to_many_partitioned_baseline_hash_table_on_l0(
+    ExecutionContext &ctx, int32_t *buff, const int8_t *hash_buff,
+    const uint32_t partition_bits, const int64_t entry_count,
+    const size_t key_component_count, const GenericKeyHandler *key_handler,
+    const size_t num_elems) {
+  fill_one_to_many_partitioned_baseline_hash_table_on_l0_async<T>(
+      ctx, buff, hash_buff, partition_bits, entry_count, key_component_count,
+      key_handler, num_elems, {})
+      .wait();
+}
+
+// Every device reads the keys of its rows once and hands them over to the
+// devices of their shards. Unpackable keys are stored to err_buff unless it is
+// nullptr.
+template <typename T>
+ShardExchange<T> exchange_baseline_shard_rows(
+    MultiDeviceContext &mctx, const size_t key_component_count,
+    int *err_buff, const GenericKeyHandler *key_handler,
+    const int64_t num_elems, std::vector<sycl::event> &deps) {
+  const uint32_t shard_count = mctx.get_device_count();
+  return exchange_shard_rows<T>(
+      mctx,
+      [key_handler](ExecutionContext &, std::vector<sycl::event> &) {
+        return KeyHandlerShardKeys<T>{key_handler};
+      },
+      key_component_count, num_elems,
+      [key_component_count, shard_count](const T *key) -> int64_t {
+        return get_baseline_shard_for_key(key, key_component_count,
+                                          shard_count);
+      },
+      err_buff, deps);
+}
+
+template <typename T>
+sycl::event fill_baseline_hash_join_buff_sharded_on_l0_async(
+    MultiDeviceContext &mctx, int8_t *const *shard_hash_buffs,
+    const int64_t shard_entry_count, const int32_t invalid_slot_val,
+    const bool for_semi_join, const size_t key_component_count,
+    const bool with_val_slot, int *dev_err_buff,
+    const GenericKeyHandler *key_handler, const int64_t num_elems,
+    const std::vector<sycl::event> &deps) {
+  const uint32_t shard_count = mctx.get_device_count();
+  auto err_reset = fill_buff_async(mctx.get_device_context(0),
+                                   "reset_err_buff", dev_err_buff, 0, 1, deps);
+  std::vector<sycl::event> exchanged{err_reset};
+  const auto exchange = exchange_baseline_shard_rows<T>(
+      mctx, key_component_count, dev_err_buff, key_handler, num_elems,
+      exchanged);
+  const int64_t launch_row_count =
+      get_shard_launch_row_count(num_elems, shard_count);
+  const size_t key_size_in_bytes = key_component_count * sizeof(T);
+  const size_t hash_entry_size =
+      key_size_in_bytes + (with_val_slot * sizeof(T));
+  // The key and the entry it is inserted into
+  const KernelInfo info{
+      for_semi_join ? "baseline_fill_semi_join" : "baseline_fill_one_to_one",
+      launch_row_count, shard_entry_count,
+      launch_row_count *
+          static_cast<int64_t>(key_size_in_bytes + hash_entry_size)};
+  std::vector<sycl::event> built;
+  for (uint32_t shard = 0; shard < shard_count; ++shard) {
+    auto &ctx = mctx.get_device_context(shard);
+    int8_t *hash_buff = shard_hash_buffs[shard];
+    std::vector<sycl::event> fill_deps = exchanged;
+    fill_deps.push_back(init_baseline_hash_join_buff_on_l0_async<T>(
+        ctx, hash_buff, shard_entry_count, key_component_count, with_val_slot,
+        invalid_slot_val, {err_reset}));
+    built.push_back(submit_shard_exchange_rows(
+        ctx, info, exchange, shard, launch_row_count, fill_deps,
+        [=](const int32_t row_id, const T *key) {
+          const int err =
+              for_semi_join
+                  ? write_baseline_hash_slot_for_semi_join<T>(
+                        row_id, hash_buff, shard_entry_count, key,
+                        key_component_count, with_val_slot, invalid_slot_val,
+                        key_size_in_bytes, hash_entry_size)
+                  : write_baseline_hash_slot<T>(
+                        row_id, hash_buff, shard_entry_count, key,
+                        key_component_count, with_val_slot, invalid_slot_val,
+                        key_size_in_bytes, hash_entry_size);
+          if (err) {
+            sycl::atomic_ref<int, sycl::memory_order::relaxed,
+                             sycl::memory_scope::device>
+                atomic_dev_err(*dev_err_buff);
+            atomic_dev_err.store(err);
+          }
+        }));
+  }
+  return mctx.join(built);
+}
+
+template <typename T>
+void fill_baseline_hash_join_buff_sharded_on_l0(
+    MultiDeviceContext &mctx, int8_t *const *shard_hash_buffs,
+    const int64_t shard_entry_count, const int32_t invalid_slot_val,
+    const bool for_semi_join, const size_t key_component_count,
+    const bool with_val_slot, int *dev_err_buff,
+    const GenericKeyHandler *key_handler, const int64_t num_elems) {
+  fill_baseline_hash_join_buff_sharded_on_l0_async<T>(
+      mctx, shard_hash_buffs, shard_entry_count, invalid_slot_val,
+      for_semi_join, key_component_count, with_val_slot, dev_err_buff,
+      key_handler, num_elems, {})
+      .wait();
+}
+
+template <typename T>
+sycl::event fill_one_to_many_baseline_hash_table_sharded_on_l0_async(
+    MultiDeviceContext &mctx, int32_t *const *shard_buffs,
+    const T *const *shard_composite_key_dicts, const int64_t shard_entry_count,
+    const size_t key_component_count, const GenericKeyHandler *key_handler,
+    const int64_t num_elems, const std::vector<sycl::event> &deps) {
+  const uint32_t shard_count = mctx.get_device_count();
+  const size_t key_size_in_bytes = key_component_count * sizeof(T);
+  std::vector<sycl::event> exchanged = deps;
+  const auto exchange = exchange_baseline_shard_rows<T>(
+      mctx, key_component_count, nullptr, key_handler, num_elems, exchanged);
+  const int64_t launch_row_count =
+      get_shard_launch_row_count(num_elems, shard_count);
+  std::vector<sycl::event> built;
+  for (uint32_t shard = 0; shard < shard_count; ++shard) {
+    auto get_slot = [composite_key_dict = shard_composite_key_dicts[shard],
+                     shard_entry_count, key_component_count,
+                     key_size_in_bytes](const T *key) -> int64_t {
+      const T *matching_group = get_matching_baseline_hash_slot_readonly(
+          key, key_component_count, composite_key_dict, shard_entry_count,
+          key_size_in_bytes);
+      return (matching_group - composite_key_dict) / key_component_count;
+    };
+    const ShardExchangeSlots<T, decltype(get_slot)> slots{
+        exchange, shard, launch_row_count, get_slot};
+    built.push_back(fill_one_to_many_baseline_impl<T>(
+        mctx.get_device_context(shard), shard_buffs[shard], slots,
+        shard_entry_count, exchanged));
+  }
+  return mctx.join(built);
+}
+
+template <typename T>
+void fill_one_to_many_baseline_hash_table_sharded_on_l0(
+    MultiDeviceContext &mctx, int32_t *const *shard_buffs,
+    const T *const *shard_composite_key_dicts, const int64_t shard_entry_count,
+    const size_t key_component_count, const GenericKeyHandler *key_handler,
+    const int64_t num_elems) {
+  fill_one_to_many_baseline_hash_table_sharded_on_l0_async<T>(
+      mctx, shard_buffs, shard_composite_key_dicts, shard_entry_count,
+      key_component_count, key_handler, num_elems, {})
+      .wait();
+}
+
+template sycl::event init_baseline_hash_join_buff_on_l0_async<int32_t>(
+    ExecutionContext &, int8_t *, const int64_t, const size_t, const bool,
+    const int32_t, const std::vector<sycl::event> &);
+template sycl::event init_baseline_hash_join_buff_on_l0_async<int64_t>(
+    ExecutionContext &, int8_t *, const int64_t, const size_t, const bool,
+    const int32_t, const std::vector<sycl::event> &);
+template void init_baseline_hash_join_buff_on_l0<int32_t>(
+    ExecutionContext &, int8_t *, const int64_t, const size_t, const bool,
+    const int32_t);
+template void init_baseline_hash_join_buff_on_l0<int64_t>(
+    ExecutionContext &, int8_t *, const int64_t, const size_t, const bool,
+    const int32_t);
 template void init_baseline_hash_join_buff_on_l0<int32_t>(
     int8_t *, const int64_t, const size_t, const bool, const int32_t);
 template void init_baseline_hash_join_buff_on_l0<int64_t>(
     int8_t *, const int64_t, const size_t, const bool, const int32_t);
 
+template sycl::event fill_baseline_hash_join_buff_on_l0_async<int32_t>(
+    ExecutionContext &, int8_t *, const int64_t, const int32_t, const bool,
+    const size_t, const bool, int *, const GenericKeyHandler *, const int64_t,
+    const BloomFilter, const std::vector<sycl::event> &);
+template sycl::event fill_baseline_hash_join_buff_on_l0_async<int32_t>(
+    ExecutionContext &, int8_t *, const int64_t, const int32_t, const bool,
+    const size_t, const bool, int *, const GenericKeyHandler *, const int64_t,
+    const BloomFilter, HashTableStats *, const std::vector<sycl::event> &);
+template sycl::event fill_baseline_hash_join_buff_on_l0_async<int64_t>(
+    ExecutionContext &, int8_t *, const int64_t, const int32_t, const bool,
+    const size_t, const bool, int *, const GenericKeyHandler *, const int64_t,
+    const BloomFilter, const std::vector<sycl::event> &);
+template sycl::event fill_baseline_hash_join_buff_on_l0_async<int64_t>(
+    ExecutionContext &, int8_t *, const int64_t, const int32_t, const bool,
+    const size_t, const bool, int *, const GenericKeyHandler *, const int64_t,
+    const BloomFilter, HashTableStats *, const std::vector<sycl::event> &);
+template sycl::event fill_baseline_hash_join_buff_on_l0_async<int32_t>(
+    ExecutionContext &, int8_t *, const int64_t, const int32_t, const bool,
+    const size_t, const bool, int *, const GenericKeyHandler *, const int64_t,
+    const std::vector<sycl::event> &);
+template sycl::event fill_baseline_hash_join_buff_on_l0_async<int64_t>(
+    ExecutionContext &, int8_t *, const int64_t, const int32_t, const bool,
+    const size_t, const bool, int *, const GenericKeyHandler *, const int64_t,
+    const std::vector<sycl::event> &);
+template void fill_baseline_hash_join_buff_on_l0<int32_t>(
+    ExecutionContext &, int8_t *, const int64_t, const int32_t, const bool,
+    const size_t, const bool, int *, const GenericKeyHandler *, const int64_t);
+template void fill_baseline_hash_join_buff_on_l0<int64_t>(
+    ExecutionContext &, int8_t *, const int64_t, const int32_t, const bool,
+    const size_t, const bool, int *, const GenericKeyHandler *, const int64_t);
 template void fill_baseline_hash_join_buff_on_l0<int32_t>(
     int8_t *, const int64_t, const int32_t, const bool, const size_t,
     const bool, int *, const GenericKeyHandler *, const int64_t);
@@ -463,9 +1631,174 @@ template void fill_baseline_hash_join_buff_on_l0<int64_t>(
     int8_t *, const int64_t, const int32_t, const bool, const size_t,
     const bool, int *, const GenericKeyHandler *, const int64_t);
 
+template sycl::event fill_one_to_many_baseline_hash_table_on_l0_async<int32_t>(
+    ExecutionContext &, int32_t *, const int32_t *, const int64_t,
+    const int32_t, const GenericKeyHandler *, const size_t,
+    const std::vector<sycl::event> &);
+template sycl::event fill_one_to_many_baseline_hash_table_on_l0_async<int32_t>(
+    ExecutionContext &, int32_t *, const int32_t *, const int64_t,
+    const int32_t, const GenericKeyHandler *, const size_t, HashTableStats *,
+    const std::vector<sycl::event> &);
+template sycl::event fill_one_to_many_baseline_hash_table_on_l0_async<int64_t>(
+    ExecutionContext &, int32_t *, const int64_t *, const int64_t,
+    const int32_t, const GenericKeyHandler *, const size_t,
+    const std::vector<sycl::event> &);
+template sycl::event fill_one_to_many_baseline_hash_table_on_l0_async<int64_t>(
+    ExecutionContext &, int32_t *, const int64_t *, const int64_t,
+    const int32_t, const GenericKeyHandler *, const size_t, HashTableStats *,
+    const std::vector<sycl::event> &);
+template void fill_one_to_many_baseline_hash_table_on_l0<int32_t>(
+    ExecutionContext &, int32_t *, const int32_t *, const int64_t,
+    const int32_t, const GenericKeyHandler *, const size_t);
+template void fill_one_to_many_baseline_hash_table_on_l0<int64_t>(
+    ExecutionContext &, int32_t *, const int64_t *, const int64_t,
+    const int32_t, const GenericKeyHandler *, const size_t);
+template sycl::event
+fill_one_to_many_baseline_hash_table_on_l0_async<int32_t, int64_t>(
+    ExecutionContext &, int64_t *, const int32_t *, const int64_t,
+    const int32_t, const GenericKeyHandler *, const size_t,
+    const std::vector<sycl::event> &);
+template sycl::event
+fill_one_to_many_baseline_hash_table_on_l0_async<int32_t, int64_t>(
+    ExecutionContext &, int64_t *, const int32_t *, const int64_t,
+    const int32_t, const GenericKeyHandler *, const size_t, HashTableStats *,
+    const std::vector<sycl::event> &);
+template void fill_one_to_many_baseline_hash_table_on_l0<int32_t, int64_t>(
+    ExecutionContext &, int64_t *, const int32_t *, const int64_t,
+    const int32_t, const GenericKeyHandler *, const size_t);
+template sycl::event
+fill_one_to_many_baseline_hash_table_on_l0_async<int64_t, int64_t>(
+    ExecutionContext &, int64_t *, const int64_t *, const int64_t,
+    const int32_t, const GenericKeyHandler *, const size_t,
+    const std::vector<sycl::event> &);
+template sycl::event
+fill_one_to_many_baseline_hash_table_on_l0_async<int64_t, int64_t>(
+    ExecutionContext &, int64_t *, const int64_t *, const int64_t,
+    const int32_t, const GenericKeyHandler *, const size_t, HashTableStats *,
+    const std::vector<sycl::event> &);
+template void fill_one_to_many_baseline_hash_table_on_l0<int64_t, int64_t>(
+    ExecutionContext &, int64_t *, const int64_t *, const int64_t,
+    const int32_t, const GenericKeyHandler *, const size_t);
 template void fill_one_to_many_baseline_hash_table_on_l0<int32_t>(
     int32_t *, const int32_t *, const int64_t, const int32_t,
     const GenericKeyHandler *, const size_t);
 template void fill_one_to_many_baseline_hash_table_on_l0<int64_t>(
     int32_t *, const int64_t *, const int64_t, const int32_t,
     const GenericKeyHandler *, const size_t);
+
+template sycl::event init_bucketized_baseline_hash_buff_on_l0_async<int32_t>(
+    ExecutionContext &, int8_t *, const size_t, const size_t, const bool,
+    const int32_t, const std::vector<sycl::event> &);
+template sycl::event init_bucketized_baseline_hash_buff_on_l0_async<int64_t>(
+    ExecutionContext &, int8_t *, const size_t, const size_t, const bool,
+    const int32_t, const std::vector<sycl::event> &);
+template void init_bucketized_baseline_hash_buff_on_l0<int32_t>(
+    ExecutionContext &, int8_t *, const size_t, const size_t, const bool,
+    const int32_t);
+template void init_bucketized_baseline_hash_buff_on_l0<int64_t>(
+    ExecutionContext &, int8_t *, const size_t, const size_t, const bool,
+    const int32_t);
+
+template sycl::event fill_bucketized_baseline_hash_buff_on_l0_async<int32_t>(
+    ExecutionContext &, int8_t *, const size_t, const int32_t, const bool,
+    const size_t, const bool, int *, const GenericKeyHandler *, const int64_t,
+    const BloomFilter, const std::vector<sycl::event> &);
+template sycl::event fill_bucketized_baseline_hash_buff_on_l0_async<int64_t>(
+    ExecutionContext &, int8_t *, const size_t, const int32_t, const bool,
+    const size_t, const bool, int *, const GenericKeyHandler *, const int64_t,
+    const BloomFilter, const std::vector<sycl::event> &);
+template sycl::event fill_bucketized_baseline_hash_buff_on_l0_async<int32_t>(
+    ExecutionContext &, int8_t *, const size_t, const int32_t, const bool,
+    const size_t, const bool, int *, const GenericKeyHandler *, const int64_t,
+    const std::vector<sycl::event> &);
+template sycl::event fill_bucketized_baseline_hash_buff_on_l0_async<int64_t>(
+    ExecutionContext &, int8_t *, const size_t, const int32_t, const bool,
+    const size_t, const bool, int *, const GenericKeyHandler *, const int64_t,
+    const std::vector<sycl::event> &);
+template void fill_bucketized_baseline_hash_buff_on_l0<int32_t>(
+    ExecutionContext &, int8_t *, const size_t, const int32_t, const bool,
+    const size_t, const bool, int *, const GenericKeyHandler *, const int64_t);
+template void fill_bucketized_baseline_hash_buff_on_l0<int64_t>(
+    ExecutionContext &, int8_t *, const size_t, const int32_t, const bool,
+    const size_t, const bool, int *, const GenericKeyHandler *, const int64_t);
+
+template sycl::event
+fill_one_to_many_bucketized_baseline_hash_table_on_l0_async<int32_t>(
+    ExecutionContext &, int32_t *, const int8_t *, const size_t, const size_t,
+    const GenericKeyHandler *, const size_t, const std::vector<sycl::event> &);
+template sycl::event
+fill_one_to_many_bucketized_baseline_hash_table_on_l0_async<int64_t>(
+    ExecutionContext &, int32_t *, const int8_t *, const size_t, const size_t,
+    const GenericKeyHandler *, const size_t, const std::vector<sycl::event> &);
+template void fill_one_to_many_bucketized_baseline_hash_table_on_l0<int32_t>(
+    ExecutionContext &, int32_t *, const int8_t *, const size_t, const size_t,
+    const GenericKeyHandler *, const size_t);
+template void fill_one_to_many_bucketized_baseline_hash_table_on_l0<int64_t>(
+    ExecutionContext &, int32_t *, const int8_t *, const size_t, const size_t,
+    const GenericKeyHandler *, const size_t);
+
+template sycl::event fill_partitioned_baseline_hash_buff_on_l0_async<int32_t>(
+    ExecutionContext &, int8_t *, const uint32_t, const int64_t, const int32_t,
+    const bool, const size_t, const bool, int *, const GenericKeyHandler *,
+    const int64_t, const std::vector<sycl::event> &);
+template sycl::event fill_partitioned_baseline_hash_buff_on_l0_async<int64_t>(
+    ExecutionContext &, int8_t *, const uint32_t, const int64_t, const int32_t,
+    const bool, const size_t, const bool, int *, const GenericKeyHandler *,
+    const int64_t, const std::vector<sycl::event> &);
+template void fill_partitioned_baseline_hash_buff_on_l0<int32_t>(
+    ExecutionContext &, int8_t *, const uint32_t, const int64_t, const int32_t,
+    const bool, const size_t, const bool, int *, const GenericKeyHandler *,
+    const int64_t);
+template void fill_partitioned_baseline_hash_buff_on_l0<int64_t>(
+    ExecutionContext &, int8_t *, const uint32_t, const int64_t, const int32_t,
+    const bool, const size_t, const bool, int *, const GenericKeyHandler *,
+    const int64_t);
+
+template sycl::event
+fill_one_to_many_partitioned_baseline_hash_table_on_l0_async<int32_t>(
+    ExecutionContext &, int32_t *, const int8_t *, const uint32_t,
+    const int64_t, const size_t, const GenericKeyHandler *, const size_t,
+    const std::vector<sycl::event> &);
+template sycl::event
+fill_one_to_many_partitioned_baseline_hash_table_on_l0_async<int64_t>(
+    ExecutionContext &, int32_t *, const int8_t *, const uint32_t,
+    const int64_t, const size_t, const GenericKeyHandler *, const size_t,
+    const std::vector<sycl::event> &);
+template void fill_one_to_many_partitioned_baseline_hash_table_on_l0<int32_t>(
+    ExecutionContext &, int32_t *, const int8_t *, const uint32_t,
+    const int64_t, const size_t, const GenericKeyHandler *, const size_t);
+template void fill_one_to_many_partitioned_baseline_hash_table_on_l0<int64_t>(
+    ExecutionContext &, int32_t *, const int8_t *, const uint32_t,
+    const int64_t, const size_t, const GenericKeyHandler *, const size_t);
+template sycl::event fill_baseline_hash_join_buff_sharded_on_l0_async<int32_t>(
+    MultiDeviceContext &, int8_t *const *, const int64_t, const int32_t,
+    const bool, const size_t, const bool, int *, const GenericKeyHandler *,
+    const int64_t, const std::vector<sycl::event> &);
+template sycl::event fill_baseline_hash_join_buff_sharded_on_l0_async<int64_t>(
+    MultiDeviceContext &, int8_t *const *, const int64_t, const int32_t,
+    const bool, const size_t, const bool, int *, const GenericKeyHandler *,
+    const int64_t, const std::vector<sycl::event> &);
+template void fill_baseline_hash_join_buff_sharded_on_l0<int32_t>(
+    MultiDeviceContext &, int8_t *const *, const int64_t, const int32_t,
+    const bool, const size_t, const bool, int *, const GenericKeyHandler *,
+    const int64_t);
+template void fill_baseline_hash_join_buff_sharded_on_l0<int64_t>(
+    MultiDeviceContext &, int8_t *const *, const int64_t, const int32_t,
+    const bool, const size_t, const bool, int *, const GenericKeyHandler *,
+    const int64_t);
+template sycl::event
+fill_one_to_many_baseline_hash_table_sharded_on_l0_async<int32_t>(
+    MultiDeviceContext &, int32_t *const *, const int32_t *const *, const int64_t,
+    const size_t, const GenericKeyHandler *, const int64_t,
+    const std::vector<sycl::event> &);
+template sycl::event
+fill_one_to_many_baseline_hash_table_sharded_on_l0_async<int64_t>(
+    MultiDeviceContext &, int32_t *const *, const int64_t *const *, const int64_t,
+    const size_t, const GenericKeyHandler *, const int64_t,
+    const std::vector<sycl::event> &);
+template void fill_one_to_many_baseline_hash_table_sharded_on_l0<int32_t>(
+    MultiDeviceContext &, int32_t *const *, const int32_t *const *, const int64_t,
+    const size_t, const GenericKeyHandler *, const int64_t);
+template void fill_one_to_many_baseline_hash_table_sharded_on_l0<int64_t>(
+    MultiDeviceContext &, int32_t *const *, const int64_t *const *, const int64_t,
+    const size_t, const GenericKeyHandler *, const int64_t);
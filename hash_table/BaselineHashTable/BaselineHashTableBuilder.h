@@ -1,41 +1,317 @@
 #ifndef BASELINE_HT_BUILDER_H__
 #define BASELINE_HT_BUILDER_H__
 
+#include <CL/sycl.hpp>
+#include <vector>
+
 #include "../CommonDecls.h"
+#include "../Shared/BloomFilter.h"
+#include "../Shared/HashTableStats.h"
+
+// Asynchronous variants: the commands are enqueued after deps and the
+// returned event completes when the table is built. The inputs (including
+// the key handler and its columns) must stay alive until then.
+template <typename T>
+sycl::event init_baseline_hash_join_buff_on_l0_async(
+    ExecutionContext &ctx, int8_t *hash_join_buff, const int64_t entry_count,
+    const size_t key_component_count, const bool with_val_slot,
+    const int32_t invalid_slot_val, const std::vector<sycl::event> &deps);
+
+template <typename ROW_ID>
+sycl::event
+init_hash_join_buff_on_l0_async(ExecutionContext &ctx, ROW_ID *groups_buffer,
+                                const int64_t hash_entry_count,
+                                const int32_t invalid_slot_val,
+                                const std::vector<sycl::event> &deps);
+
+template <typename T>
+sycl::event fill_baseline_hash_join_buff_on_l0_async(
+    ExecutionContext &ctx, int8_t *hash_buff, const int64_t entry_count,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const size_t key_component_count, const bool with_val_slot,
+    int *dev_err_buff, const GenericKeyHandler *key_handler,
+    const int64_t num_elems, const std::vector<sycl::event> &deps);
+
+// Same, also inserting the keys into bloom_filter (initialized with
+// init_bloom_filter_on_l0_async) for filter_keys_on_l0_async.
+template <typename T>
+sycl::event fill_baseline_hash_join_buff_on_l0_async(
+    ExecutionContext &ctx, int8_t *hash_buff, const int64_t entry_count,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const size_t key_component_count, const bool with_val_slot,
+    int *dev_err_buff, const GenericKeyHandler *key_handler,
+    const int64_t num_elems, const BloomFilter bloom_filter,
+    const std::vector<sycl::event> &deps);
+
+// Same, also filling stats (HashTableStats.h): it is reset, CAS retries are
+// counted during the fill and the probe distances measured after it.
+template <typename T>
+sycl::event fill_baseline_hash_join_buff_on_l0_async(
+    ExecutionContext &ctx, int8_t *hash_buff, const int64_t entry_count,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const size_t key_component_count, const bool with_val_slot,
+    int *dev_err_buff, const GenericKeyHandler *key_handler,
+    const int64_t num_elems, const BloomFilter bloom_filter,
+    HashTableStats *stats, const std::vector<sycl::event> &deps);
+
+// Adds the keys of f to the HyperLogLog sketch hll_buffer (2^b registers,
+// 4-byte aligned), which may already hold the keys of other fragments.
+sycl::event approximate_distinct_tuples_on_l0_async(
+    ExecutionContext &ctx, uint8_t *hll_buffer, int32_t *row_count_buffer,
+    const uint32_t b, const int64_t num_elems, const GenericKeyHandler *f,
+    const std::vector<sycl::event> &deps);
+
+// hll_buffer receives the union of both sketches
+sycl::event merge_hll_sketches_on_l0_async(ExecutionContext &ctx,
+                                           uint8_t *hll_buffer,
+                                           const uint8_t *other_hll_buffer,
+                                           const uint32_t b,
+                                           const std::vector<sycl::event> &deps);
+
+// Writes the distinct count estimate of hll_buffer to cardinality (device
+// accessible)
+sycl::event estimate_hll_cardinality_on_l0_async(
+    ExecutionContext &ctx, const uint8_t *hll_buffer, const uint32_t b,
+    int64_t *cardinality, const std::vector<sycl::event> &deps);
+
+// buff receives pos|count|row ids of ROW_ID (int32_t, or int64_t for builds
+// of more than INT32_MAX rows, see dispatch_row_id_type)
+template <typename T, typename ROW_ID>
+sycl::event fill_one_to_many_baseline_hash_table_on_l0_async(
+    ExecutionContext &ctx, ROW_ID *buff, const T *composite_key_dict,
+    const int64_t hash_entry_count, const int32_t invalid_slot_val,
+    const GenericKeyHandler *key_handler, const size_t num_elems,
+    const std::vector<sycl::event> &deps);
+
+// Same, also measuring the bucket sizes into stats. The rest of stats is
+// kept, so that it can hold the stats of the fill of composite_key_dict.
+template <typename T, typename ROW_ID>
+sycl::event fill_one_to_many_baseline_hash_table_on_l0_async(
+    ExecutionContext &ctx, ROW_ID *buff, const T *composite_key_dict,
+    const int64_t hash_entry_count, const int32_t invalid_slot_val,
+    const GenericKeyHandler *key_handler, const size_t num_elems,
+    HashTableStats *stats, const std::vector<sycl::event> &deps);
+
+// Bucketized layout (BucketizedBaselineHashTableLayout.h): hash_buff holds
+// bucket_count buckets, get_bucketized_baseline_hash_buff_size() bytes.
+template <typename T>
+sycl::event init_bucketized_baseline_hash_buff_on_l0_async(
+    ExecutionContext &ctx, int8_t *hash_buff, const size_t bucket_count,
+    const size_t key_component_count, const bool with_val_slot,
+    const int32_t invalid_slot_val, const std::vector<sycl::event> &deps);
+
+template <typename T>
+sycl::event fill_bucketized_baseline_hash_buff_on_l0_async(
+    ExecutionContext &ctx, int8_t *hash_buff, const size_t bucket_count,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const size_t key_component_count, const bool with_val_slot,
+    int *dev_err_buff, const GenericKeyHandler *key_handler,
+    const int64_t num_elems, const std::vector<sycl::event> &deps);
+
+template <typename T>
+sycl::event fill_bucketized_baseline_hash_buff_on_l0_async(
+    ExecutionContext &ctx, int8_t *hash_buff, const size_t bucket_count,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const size_t key_component_count, const bool with_val_slot,
+    int *dev_err_buff, const GenericKeyHandler *key_handler,
+    const int64_t num_elems, const BloomFilter bloom_filter,
+    const std::vector<sycl::event> &deps);
+
+// hash_buff is a key only bucketized table of the inner keys, buff receives
+// pos|count|row ids with one entry per slot
+// (get_bucketized_baseline_bucket_count() * g_baseline_bucket_slots).
+template <typename T>
+sycl::event fill_one_to_many_bucketized_baseline_hash_table_on_l0_async(
+    ExecutionContext &ctx, int32_t *buff, const int8_t *hash_buff,
+    const size_t bucket_count, const size_t key_component_count,
+    const GenericKeyHandler *key_handler, const size_t num_elems,
+    const std::vector<sycl::event> &deps);
+
+// Radix partitioned layout (PartitionedBaselineHashTableLayout.h): hash_buff
+// holds get_partitioned_baseline_hash_buff_size() bytes and needs no init.
+// The keys are partitioned on the hash, then every partition is built by one
+// work-group in local memory when it fits, so that the random inserts don't
+// go to a table much bigger than the caches. Partitions of
+// get_baseline_partition_bits() bits fit on average. Overwrites the
+// partitioning scratch memory of ctx. The partitioned rows are indexed with
+// int32_t: a build of more than INT32_MAX rows only stores
+// g_partitioned_baseline_row_count_err to dev_err_buff, build those with the
+// flat layout.
+constexpr int g_partitioned_baseline_row_count_err{-4};
+
+uint32_t get_baseline_partition_bits(ExecutionContext &ctx,
+                                     const int64_t entry_count,
+                                     const size_t hash_entry_size);
+
+template <typename T>
+sycl::event fill_partitioned_baseline_hash_buff_on_l0_async(
+    ExecutionContext &ctx, int8_t *hash_buff, const uint32_t partition_bits,
+    const int64_t entry_count, const int32_t invalid_slot_val,
+    const bool for_semi_join, const size_t key_component_count,
+    const bool with_val_slot, int *dev_err_buff,
+    const GenericKeyHandler *key_handler, const int64_t num_elems,
+    const std::vector<sycl::event> &deps);
+
+// hash_buff is a key only partitioned table of the inner keys, buff receives
+// pos|count|row ids with one entry per table entry.
+template <typename T>
+sycl::event fill_one_to_many_partitioned_baseline_hash_table_on_l0_async(
+    ExecutionContext &ctx, int32_t *buff, const int8_t *hash_buff,
+    const uint32_t partition_bits, const int64_t entry_count,
+    const size_t key_component_count, const GenericKeyHandler *key_handler,
+    const size_t num_elems, const std::vector<sycl::event> &deps);
+
+// Sharded builds over the devices of mctx (MultiDeviceContext.h), split by
+// hash (Sharding.h): every device reads the keys of its get_shard_row_range()
+// and hands them over to the devices of their shards (ShardExchange.h), then
+// builds the flat table shard_hash_buffs[s] of shard_entry_count entries from
+// the keys of its shard. The buffers and the key handler must be USM
+// allocations of the context of mctx. The returned event is on the queue of
+// the first device.
+template <typename T>
+sycl::event fill_baseline_hash_join_buff_sharded_on_l0_async(
+    MultiDeviceContext &mctx, int8_t *const *shard_hash_buffs,
+    const int64_t shard_entry_count, const int32_t invalid_slot_val,
+    const bool for_semi_join, const size_t key_component_count,
+    const bool with_val_slot, int *dev_err_buff,
+    const GenericKeyHandler *key_handler, const int64_t num_elems,
+    const std::vector<sycl::event> &deps);
+
+// shard_composite_key_dicts[s] is the key only table of shard s,
+// shard_buffs[s] receives its pos|count|row ids.
+template <typename T>
+sycl::event fill_one_to_many_baseline_hash_table_sharded_on_l0_async(
+    MultiDeviceContext &mctx, int32_t *const *shard_buffs,
+    const T *const *shard_composite_key_dicts, const int64_t shard_entry_count,
+    const size_t key_component_count, const GenericKeyHandler *key_handler,
+    const int64_t num_elems, const std::vector<sycl::event> &deps);
 
 // Called from HDK
 template <typename T>
-void init_baseline_hash_join_buff_on_l0(int8_t *hash_join_buff,
+void init_baseline_hash_join_buff_on_l0(ExecutionContext &ctx,
+                                        int8_t *hash_join_buff,
                                         const int64_t entry_count,
                                         const size_t key_component_count,
                                         const bool with_val_slot,
                                         const int32_t invalid_slot_val);
 
 // Called from HDK
-void init_hash_join_buff_on_l0(int32_t *groups_buffer,
+template <typename ROW_ID>
+void init_hash_join_buff_on_l0(ExecutionContext &ctx, ROW_ID *groups_buffer,
                                const int64_t hash_entry_count,
                                const int32_t invalid_slot_val);
 
 // Called from HDK
 template <typename T>
 void fill_baseline_hash_join_buff_on_l0(
-    int8_t *hash_buff, const int64_t entry_count,
+    ExecutionContext &ctx, int8_t *hash_buff, const int64_t entry_count,
     const int32_t invalid_slot_val, const bool for_semi_join,
     const size_t key_component_count, const bool with_val_slot,
     int *dev_err_buff, const GenericKeyHandler *key_handler,
     const int64_t num_elems);
 // Called from HDK
-void approximate_distinct_tuples_on_l0(uint8_t *hll_buffer,
+void approximate_distinct_tuples_on_l0(ExecutionContext &ctx,
+                                       uint8_t *hll_buffer,
                                        int32_t *row_count_buffer,
                                        const uint32_t b,
                                        const int64_t num_elems,
                                        const GenericKeyHandler *f);
 
+void merge_hll_sketches_on_l0(ExecutionContext &ctx, uint8_t *hll_buffer,
+                              const uint8_t *other_hll_buffer,
+                              const uint32_t b);
+
+int64_t estimate_hll_cardinality_on_l0(ExecutionContext &ctx,
+                                       const uint8_t *hll_buffer,
+                                       const uint32_t b);
+
 // Called from HDK
+template <typename T, typename ROW_ID>
+void fill_one_to_many_baseline_hash_table_on_l0(
+    ExecutionContext &ctx, ROW_ID *buff, const T *composite_key_dict,
+    const int64_t hash_entry_count, const int32_t invalid_slot_val,
+    const GenericKeyHandler *key_handler, const size_t num_elems);
+
+template <typename T>
+void init_bucketized_baseline_hash_buff_on_l0(
+    ExecutionContext &ctx, int8_t *hash_buff, const size_t bucket_count,
+    const size_t key_component_count, const bool with_val_slot,
+    const int32_t invalid_slot_val);
+
+template <typename T>
+void fill_bucketized_baseline_hash_buff_on_l0(
+    ExecutionContext &ctx, int8_t *hash_buff, const size_t bucket_count,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const size_t key_component_count, const bool with_val_slot,
+    int *dev_err_buff, const GenericKeyHandler *key_handler,
+    const int64_t num_elems);
+
+template <typename T>
+void fill_one_to_many_bucketized_baseline_hash_table_on_l0(
+    ExecutionContext &ctx, int32_t *buff, const int8_t *hash_buff,
+    const size_t bucket_count, const size_t key_component_count,
+    const GenericKeyHandler *key_handler, const size_t num_elems);
+
+template <typename T>
+void fill_partitioned_baseline_hash_buff_on_l0(
+    ExecutionContext &ctx, int8_t *hash_buff, const uint32_t partition_bits,
+    const int64_t entry_count, const int32_t invalid_slot_val,
+    const bool for_semi_join, const size_t key_component_count,
+    const bool with_val_slot, int *dev_err_buff,
+    const GenericKeyHandler *key_handler, const int64_t num_elems);
+
+template <typename T>
+void fill_one_to_many_partitioned_baseline_hash_table_on_l0(
+    ExecutionContext &ctx, int32_t *buff, const int8_t *hash_buff,
+    const uint32_t partition_bits, const int64_t entry_count,
+    const size_t key_component_count, const GenericKeyHandler *key_handler,
+    const size_t num_elems);
+
+template <typename T>
+void fill_baseline_hash_join_buff_sharded_on_l0(
+    MultiDeviceContext &mctx, int8_t *const *shard_hash_buffs,
+    const int64_t shard_entry_count, const int32_t invalid_slot_val,
+    const bool for_semi_join, const size_t key_component_count,
+    const bool with_val_slot, int *dev_err_buff,
+    const GenericKeyHandler *key_handler, const int64_t num_elems);
+
+template <typename T>
+void fill_one_to_many_baseline_hash_table_sharded_on_l0(
+    MultiDeviceContext &mctx, int32_t *const *shard_buffs,
+    const T *const *shard_composite_key_dicts, const int64_t shard_entry_count,
+    const size_t key_component_count, const GenericKeyHandler *key_handler,
+    const int64_t num_elems);
+
+// Same as above, on ExecutionContext::get_default()
+template <typename T>
+void init_baseline_hash_join_buff_on_l0(int8_t *hash_join_buff,
+                                        const int64_t entry_count,
+                                        const size_t key_component_count,
+                                        const bool with_val_slot,
+                                        const int32_t invalid_slot_val);
+
+void init_hash_join_buff_on_l0(int32_t *groups_buffer,
+                               const int64_t hash_entry_count,
+                               const int32_t invalid_slot_val);
+
+template <typename T>
+void fill_baseline_hash_join_buff_on_l0(
+    int8_t *hash_buff, const int64_t entry_count,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const size_t key_component_count, const bool with_val_slot,
+    int *dev_err_buff, const GenericKeyHandler *key_handler,
+    const int64_t num_elems);
+
+void approximate_distinct_tuples_on_l0(uint8_t *hll_buffer,
+                                       int32_t *row_count_buffer,
+                                       const uint32_t b,
+                                       const int64_t num_elems,
+                                       const GenericKeyHandler *f);
+
 template <typename T>
 void fill_one_to_many_baseline_hash_table_on_l0(
     int32_t *buff, const T *composite_key_dict, const int64_t hash_entry_count,
     const int32_t invalid_slot_val, const GenericKeyHandler *key_handler,
     const size_t num_elems);
 
-#endif // BASELINE_HT_BUILDER_H__
\ No newline at end of file
+#endif // BASELINE_HT_BUILDER_H__
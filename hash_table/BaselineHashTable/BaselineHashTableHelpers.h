@@ -1,21 +1,103 @@
 #ifndef BASELINE_HT_HELPER_H__
 #define BASELINE_HT_HELPER_H__
+#include <CL/sycl.hpp>
+#include <vector>
+
 #include "../CommonDecls.h"
+#include "../MurMurHash.h"
+#include "../Shared/Shared.h"
+
+template <typename T, typename ROW_ID, typename KEY_HANDLER>
+sycl::event count_matches_baseline(ExecutionContext &ctx, ROW_ID *count_buff,
+                                   const T *composite_key_dict,
+                                   const int64_t entry_count,
+                                   const KEY_HANDLER *f,
+                                   const int64_t num_elems,
+                                   const std::vector<sycl::event> &deps);
 
-template <typename T, typename KEY_HANDLER>
-void count_matches_baseline(int32_t *count_buff, const T *composite_key_dict,
-                            const int64_t entry_count, const KEY_HANDLER *f,
-                            const int64_t num_elems);
+template <typename T, typename ROW_ID, typename KEY_HANDLER>
+sycl::event fill_row_ids_baseline(ExecutionContext &ctx, ROW_ID *buff,
+                                  const T *composite_key_dict,
+                                  const int64_t hash_entry_count,
+                                  const KEY_HANDLER *f, const int64_t num_elems,
+                                  const std::vector<sycl::event> &deps);
 
-template <typename T, typename KEY_HANDLER>
-void fill_row_ids_baseline(int32_t *buff, const T *composite_key_dict,
-                           const int64_t hash_entry_count,
-                           const int32_t invalid_slot_val, const KEY_HANDLER *f,
-                           const int64_t num_elems);
+template <typename T>
+inline bool keys_are_equal(const T *key1, const T *key2,
+                           const size_t key_component_count) {
+  for (size_t idx = 0; idx < key_component_count; idx++) {
+    if (key1[idx] != key2[idx]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Makes the key at slot_key equal to key if its components are still empty,
+// returns whether slot_key holds key. Components are claimed in order by CAS
+// from the empty key, so concurrent inserters of keys sharing a prefix write
+// it together and the first differing component decides which key the slot
+// gets: every inserter is done after at most key_component_count atomics and
+// never waits for another one to finish writing a key. The CASes lost to
+// another inserter are added to *cas_failures unless it is nullptr.
+template <typename T>
+inline bool match_or_claim_baseline_key(T *slot_key, const T *key,
+                                        const size_t key_component_count,
+                                        uint32_t *cas_failures = nullptr) {
+  const T empty_key = get_invalid_key<T>();
+  for (size_t i = 0; i < key_component_count; ++i) {
+    sycl::atomic_ref<T, sycl::memory_order::acq_rel, sycl::memory_scope::device>
+        atomic_component(slot_key[i]);
+    T component = atomic_component.load(sycl::memory_order::acquire);
+    if (component == empty_key) {
+      atomic_component.compare_exchange_strong(component, key[i],
+                                               sycl::memory_order::acq_rel);
+      if (component == empty_key) {
+        continue; // claimed
+      }
+      if (cas_failures) {
+        ++*cas_failures;
+      }
+    }
+    if (component != key[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Linear probing lookup of key, entries are hash_entry_size elements of T
+// apart (key_component_count, plus one for the value slot if any). Keys are
+// never removed, so the first empty slot ends the probe sequence: returns
+// nullptr if the key is not in the table.
+template <typename T>
+const T *get_matching_baseline_hash_slot_readonly(
+    const T *key, const size_t key_component_count, const T *composite_key_dict,
+    const int64_t entry_count, const size_t key_size_in_bytes,
+    const size_t hash_entry_size) {
+  const T empty_key = get_invalid_key<T>();
+  const uint32_t h = MurmurHash1Impl(key, key_size_in_bytes, 0) % entry_count;
+  uint32_t h_probe = h;
+  do {
+    const T *entry = &composite_key_dict[h_probe * hash_entry_size];
+    if (keys_are_equal(entry, key, key_component_count)) {
+      return entry;
+    }
+    if (*entry == empty_key) {
+      return nullptr;
+    }
+    h_probe = (h_probe + 1) % entry_count;
+  } while (h_probe != h);
+  return nullptr;
+}
 
 template <typename T>
 const T *get_matching_baseline_hash_slot_readonly(
     const T *key, const size_t key_component_count, const T *composite_key_dict,
-    const int64_t entry_count, const size_t key_size_in_bytes);
+    const int64_t entry_count, const size_t key_size_in_bytes) {
+  return get_matching_baseline_hash_slot_readonly(
+      key, key_component_count, composite_key_dict, entry_count,
+      key_size_in_bytes, key_component_count);
+}
 
 #endif // BASELINE_HT_HELPER_H__
\ No newline at end of file
@@ -0,0 +1,473 @@
+#include <CL/sycl.hpp>
+
+#include "../GenericKeyHandler.h"
+#include "../Shared/ExecutionContext.h"
+#include "../Shared/Probe.h"
+#include "BaselineHashTableHelpers.h"
+#include "BaselineHashTableProbe.h"
+#include "BucketizedBaselineHashTableHelpers.h"
+#include "PartitionedBaselineHashTableHelpers.h"
+
+// Calls on_key(key, key_component_count) with the composite key of the outer
+// row, unless one of its components is null.
+template <typename T, typename KEY_FUNC>
+inline void for_outer_row_key(const GenericKeyHandler *outer_key_handler,
+                              const size_t outer_idx, KEY_FUNC on_key) {
+  JoinColumnTuple cols(outer_key_handler->get_number_of_columns(),
+                       outer_key_handler->get_join_columns(),
+                       outer_key_handler->get_join_column_type_infos());
+  T key_scratch_buff[g_maximum_conditions_to_coalesce]; // The key
+  auto join_tuple_iter =
+      JoinColumnTupleIterator(cols.num_cols, cols.join_column_per_key,
+                              cols.type_info_per_key,
+                              outer_key_handler->get_chunk_offsets_per_key(),
+                              outer_idx, 1);
+  if (join_tuple_iter != cols.end()) {
+    (*outer_key_handler)(join_tuple_iter.join_column_iterators,
+                         key_scratch_buff,
+                         [&](const int64_t, const T *key,
+                             const size_t key_component_count) {
+                           on_key(key, key_component_count);
+                           return 0;
+                         });
+  }
+}
+
+template <typename T>
+sycl::event probe_baseline_hash_join_buff_on_l0_async(
+    ExecutionContext &ctx, const int8_t *hash_buff, const int64_t entry_count,
+    const int32_t invalid_slot_val, const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches, const std::vector<sycl::event> &deps) {
+  const T *composite_key_dict = reinterpret_cast<const T *>(hash_buff);
+  const size_t key_size_in_bytes = key_component_count * sizeof(T);
+  auto matcher = [=](const size_t outer_idx, auto emit) {
+    for_outer_row_key<T>(
+        outer_key_handler, outer_idx,
+        [&](const T *key, const size_t key_component_count) {
+          const T *matching_group = get_matching_baseline_hash_slot_readonly(
+              key, key_component_count, composite_key_dict, entry_count,
+              key_size_in_bytes, key_component_count + 1);
+          if (matching_group &&
+              matching_group[key_component_count] != invalid_slot_val) {
+            emit(static_cast<int32_t>(matching_group[key_component_count]));
+          }
+        });
+  };
+  return probe_hash_table_impl(ctx, num_elems, matcher, outer_row_ids,
+                               inner_row_ids, max_matches, num_matches, deps);
+}
+
+template <typename T>
+sycl::event probe_one_to_many_baseline_hash_table_on_l0_async(
+    ExecutionContext &ctx, const int32_t *buff, const T *composite_key_dict,
+    const int64_t hash_entry_count, const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches, const std::vector<sycl::event> &deps) {
+  const size_t key_size_in_bytes = key_component_count * sizeof(T);
+  const int32_t *pos_buff = buff;
+  const int32_t *count_buff = buff + hash_entry_count;
+  const int32_t *id_buff = count_buff + hash_entry_count;
+  auto matcher = [=](const size_t outer_idx, auto emit) {
+    for_outer_row_key<T>(
+        outer_key_handler, outer_idx,
+        [&](const T *key, const size_t key_component_count) {
+          const T *matching_group = get_matching_baseline_hash_slot_readonly(
+              key, key_component_count, composite_key_dict, hash_entry_count,
+              key_size_in_bytes);
+          if (!matching_group) {
+            return;
+          }
+          const auto entry_idx =
+              (matching_group - composite_key_dict) / key_component_count;
+          const int32_t *row_ids = id_buff + pos_buff[entry_idx];
+          for (int32_t i = 0; i < count_buff[entry_idx]; ++i) {
+            emit(row_ids[i]);
+          }
+        });
+  };
+  return probe_hash_table_impl(ctx, num_elems, matcher, outer_row_ids,
+                               inner_row_ids, max_matches, num_matches, deps);
+}
+
+template <typename T>
+sycl::event probe_compact_one_to_many_baseline_hash_table_on_l0_async(
+    ExecutionContext &ctx, const CompactOneToManyTable table,
+    const T *composite_key_dict, const int64_t hash_entry_count,
+    const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches, const std::vector<sycl::event> &deps) {
+  const size_t key_size_in_bytes = key_component_count * sizeof(T);
+  auto matcher = [=](const size_t outer_idx, auto emit) {
+    for_outer_row_key<T>(
+        outer_key_handler, outer_idx,
+        [&](const T *key, const size_t key_component_count) {
+          const T *matching_group = get_matching_baseline_hash_slot_readonly(
+              key, key_component_count, composite_key_dict, hash_entry_count,
+              key_size_in_bytes);
+          if (!matching_group) {
+            return;
+          }
+          const auto entry_idx =
+              (matching_group - composite_key_dict) / key_component_count;
+          table.for_each_row_id(entry_idx, [&](const int64_t row_id) {
+            emit(static_cast<int32_t>(row_id));
+          });
+        });
+  };
+  return probe_hash_table_impl(ctx, num_elems, matcher, outer_row_ids,
+                               inner_row_ids, max_matches, num_matches, deps);
+}
+
+template <typename T>
+void probe_baseline_hash_join_buff_on_l0(
+    ExecutionContext &ctx, const int8_t *hash_buff, const int64_t entry_count,
+    const int32_t invalid_slot_val, const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches) {
+  probe_baseline_hash_join_buff_on_l0_async<T>(
+      ctx, hash_buff, entry_count, invalid_slot_val, key_component_count,
+      outer_key_handler, num_elems, outer_row_ids, inner_row_ids, max_matches,
+      num_matches, {})
+      .wait();
+}
+
+template <typename T>
+void probe_one_to_many_baseline_hash_table_on_l0(
+    ExecutionContext &ctx, const int32_t *buff, const T *composite_key_dict,
+    const int64_t hash_entry_count, const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches) {
+  probe_one_to_many_baseline_hash_table_on_l0_async<T>(
+      ctx, buff, composite_key_dict, hash_entry_count, key_component_count,
+      outer_key_handler, num_elems, outer_row_ids, inner_row_ids, max_matches,
+      num_matches, {})
+      .wait();
+}
+
+template <typename T>
+void probe_compact_one_to_many_baseline_hash_table_on_l0(
+    ExecutionContext &ctx, const CompactOneToManyTable table,
+    const T *composite_key_dict, const int64_t hash_entry_count,
+    const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches) {
+  probe_compact_one_to_many_baseline_hash_table_on_l0_async<T>(
+      ctx, table, composite_key_dict, hash_entry_count, key_component_count,
+      outer_key_handler, num_elems, outer_row_ids, inner_row_ids, max_matches,
+      num_matches, {})
+      .wait();
+}
+
+template <typename T>
+sycl::event probe_bucketized_baseline_hash_buff_on_l0_async(
+    ExecutionContext &ctx, const int8_t *hash_buff, const size_t bucket_count,
+    const int32_t invalid_slot_val, const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches, const std::vector<sycl::event> &deps) {
+  const BucketizedBaselineTable<T> table{const_cast<int8_t *>(hash_buff),
+                                         bucket_count, key_component_count};
+  auto matcher = [=](const size_t outer_idx, auto emit) {
+    for_outer_row_key<T>(
+        outer_key_handler, outer_idx, [&](const T *key, const size_t) {
+          const auto slot_idx =
+              get_matching_bucketized_baseline_slot_readonly(table, key);
+          if (slot_idx >= 0 && table.vals()[slot_idx] != invalid_slot_val) {
+            emit(table.vals()[slot_idx]);
+          }
+        });
+  };
+  return probe_hash_table_impl(ctx, num_elems, matcher, outer_row_ids,
+                               inner_row_ids, max_matches, num_matches, deps);
+}
+
+template <typename T>
+sycl::event probe_one_to_many_bucketized_baseline_hash_table_on_l0_async(
+    ExecutionContext &ctx, const int32_t *buff, const int8_t *hash_buff,
+    const size_t bucket_count, const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches, const std::vector<sycl::event> &deps) {
+  const BucketizedBaselineTable<T> table{const_cast<int8_t *>(hash_buff),
+                                         bucket_count, key_component_count};
+  const int64_t hash_entry_count = bucket_count * g_baseline_bucket_slots;
+  const int32_t *pos_buff = buff;
+  const int32_t *count_buff = buff + hash_entry_count;
+  const int32_t *id_buff = count_buff + hash_entry_count;
+  auto matcher = [=](const size_t outer_idx, auto emit) {
+    for_outer_row_key<T>(
+        outer_key_handler, outer_idx, [&](const T *key, const size_t) {
+          const auto slot_idx =
+              get_matching_bucketized_baseline_slot_readonly(table, key);
+          if (slot_idx < 0) {
+            return;
+          }
+          const int32_t *row_ids = id_buff + pos_buff[slot_idx];
+          for (int32_t i = 0; i < count_buff[slot_idx]; ++i) {
+            emit(row_ids[i]);
+          }
+        });
+  };
+  return probe_hash_table_impl(ctx, num_elems, matcher, outer_row_ids,
+                               inner_row_ids, max_matches, num_matches, deps);
+}
+
+template <typename T>
+void probe_bucketized_baseline_hash_buff_on_l0(
+    ExecutionContext &ctx, const int8_t *hash_buff, const size_t bucket_count,
+    const int32_t invalid_slot_val, const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches) {
+  probe_bucketized_baseline_hash_buff_on_l0_async<T>(
+      ctx, hash_buff, bucket_count, invalid_slot_val, key_component_count,
+      outer_key_handler, num_elems, outer_row_ids, inner_row_ids, max_matches,
+      num_matches, {})
+      .wait();
+}
+
+template <typename T>
+void probe_one_to_many_bucketized_baseline_hash_table_on_l0(
+    ExecutionContext &ctx, const int32_t *buff, const int8_t *hash_buff,
+    const size_t bucket_count, const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches) {
+  probe_one_to_many_bucketized_baseline_hash_table_on_l0_async<T>(
+      ctx, buff, hash_buff, bucket_count, key_component_count,
+      outer_key_handler, num_elems, outer_row_ids, inner_row_ids, max_matches,
+      num_matches, {})
+      .wait();
+}
+
+template <typename T>
+sycl::event probe_partitioned_baseline_hash_buff_on_l0_async(
+    ExecutionContext &ctx, const int8_t *hash_buff,
+    const uint32_t partition_bits, const int64_t entry_count,
+    const int32_t invalid_slot_val, const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches, const std::vector<sycl::event> &deps) {
+  const PartitionedBaselineTable<T> table{const_cast<int8_t *>(hash_buff),
+                                          partition_bits, entry_count,
+                                          key_component_count,
+                                          key_component_count + 1};
+  auto matcher = [=](const size_t outer_idx, auto emit) {
+    for_outer_row_key<T>(
+        outer_key_handler, outer_idx, [&](const T *key, const size_t) {
+          const T *matching_group =
+              get_matching_partitioned_baseline_slot_readonly(table, key);
+          if (matching_group &&
+              matching_group[key_component_count] != invalid_slot_val) {
+            emit(static_cast<int32_t>(matching_group[key_component_count]));
+          }
+        });
+  };
+  return probe_hash_table_impl(ctx, num_elems, matcher, outer_row_ids,
+                               inner_row_ids, max_matches, num_matches, deps);
+}
+
+template <typename T>
+sycl::event probe_one_to_many_partitioned_baseline_hash_table_on_l0_async(
+    ExecutionContext &ctx, const int32_t *buff, const int8_t *hash_buff,
+    const uint32_t partition_bits, const int64_t entry_count,
+    const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches, const std::vector<sycl::event> &deps) {
+  const PartitionedBaselineTable<T> table{const_cast<int8_t *>(hash_buff),
+                                          partition_bits, entry_count,
+                                          key_component_count,
+                                          key_component_count};
+  const int32_t *pos_buff = buff;
+  const int32_t *count_buff = buff + entry_count;
+  const int32_t *id_buff = count_buff + entry_count;
+  auto matcher = [=](const size_t outer_idx, auto emit) {
+    for_outer_row_key<T>(
+        outer_key_handler, outer_idx, [&](const T *key, const size_t) {
+          const T *matching_group =
+              get_matching_partitioned_baseline_slot_readonly(table, key);
+          if (!matching_group) {
+            return;
+          }
+          const auto entry_idx =
+              (matching_group - table.entries()) / key_component_count;
+          const int32_t *row_ids = id_buff + pos_buff[entry_idx];
+          for (int32_t i = 0; i < count_buff[entry_idx]; ++i) {
+            emit(row_ids[i]);
+          }
+        });
+  };
+  return probe_hash_table_impl(ctx, num_elems, matcher, outer_row_ids,
+                               inner_row_ids, max_matches, num_matches, deps);
+}
+
+template <typename T>
+void probe_partitioned_baseline_hash_buff_on_l0(
+    ExecutionContext &ctx, const int8_t *hash_buff,
+    const uint32_t partition_bits, const int64_t entry_count,
+    const int32_t invalid_slot_val, const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches) {
+  probe_partitioned_baseline_hash_buff_on_l0_async<T>(
+      ctx, hash_buff, partition_bits, entry_count, invalid_slot_val,
+      key_component_count, outer_key_handler, num_elems, outer_row_ids,
+      inner_row_ids, max_matches, num_matches, {})
+      .wait();
+}
+
+template <typename T>
+void probe_one_to_many_partitioned_baseline_hash_table_on_l0(
+    ExecutionContext &ctx, const int32_t *buff, const int8_t *hash_buff,
+    const uint32_t partition_bits, const int64_t entry_count,
+    const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches) {
+  probe_one_to_many_partitioned_baseline_hash_table_on_l0_async<T>(
+      ctx, buff, hash_buff, partition_bits, entry_count, key_component_count,
+      outer_key_handler, num_elems, outer_row_ids, inner_row_ids, max_matches,
+      num_matches, {})
+      .wait();
+}
+
+template sycl::event probe_baseline_hash_join_buff_on_l0_async<int32_t>(
+    ExecutionContext &, const int8_t *, const int64_t, const int32_t,
+    const size_t, const GenericKeyHandler *, const int64_t, int32_t *,
+    int32_t *, const int64_t, int64_t *, const std::vector<sycl::event> &);
+template sycl::event probe_baseline_hash_join_buff_on_l0_async<int64_t>(
+    ExecutionContext &, const int8_t *, const int64_t, const int32_t,
+    const size_t, const GenericKeyHandler *, const int64_t, int32_t *,
+    int32_t *, const int64_t, int64_t *, const std::vector<sycl::event> &);
+
+template sycl::event probe_one_to_many_baseline_hash_table_on_l0_async<int32_t>(
+    ExecutionContext &, const int32_t *, const int32_t *, const int64_t,
+    const size_t, const GenericKeyHandler *, const int64_t, int32_t *,
+    int32_t *, const int64_t, int64_t *, const std::vector<sycl::event> &);
+template sycl::event probe_one_to_many_baseline_hash_table_on_l0_async<int64_t>(
+    ExecutionContext &, const int32_t *, const int64_t *, const int64_t,
+    const size_t, const GenericKeyHandler *, const int64_t, int32_t *,
+    int32_t *, const int64_t, int64_t *, const std::vector<sycl::event> &);
+
+template void probe_baseline_hash_join_buff_on_l0<int32_t>(
+    ExecutionContext &, const int8_t *, const int64_t, const int32_t,
+    const size_t, const GenericKeyHandler *, const int64_t, int32_t *,
+    int32_t *, const int64_t, int64_t *);
+template void probe_baseline_hash_join_buff_on_l0<int64_t>(
+    ExecutionContext &, const int8_t *, const int64_t, const int32_t,
+    const size_t, const GenericKeyHandler *, const int64_t, int32_t *,
+    int32_t *, const int64_t, int64_t *);
+
+template void probe_one_to_many_baseline_hash_table_on_l0<int32_t>(
+    ExecutionContext &, const int32_t *, const int32_t *, const int64_t,
+    const size_t, const GenericKeyHandler *, const int64_t, int32_t *,
+    int32_t *, const int64_t, int64_t *);
+template void probe_one_to_many_baseline_hash_table_on_l0<int64_t>(
+    ExecutionContext &, const int32_t *, const int64_t *, const int64_t,
+    const size_t, const GenericKeyHandler *, const int64_t, int32_t *,
+    int32_t *, const int64_t, int64_t *);
+
+template sycl::event
+probe_compact_one_to_many_baseline_hash_table_on_l0_async<int32_t>(
+    ExecutionContext &, const CompactOneToManyTable, const int32_t *,
+    const int64_t, const size_t, const GenericKeyHandler *, const int64_t,
+    int32_t *, int32_t *, const int64_t, int64_t *,
+    const std::vector<sycl::event> &);
+template sycl::event
+probe_compact_one_to_many_baseline_hash_table_on_l0_async<int64_t>(
+    ExecutionContext &, const CompactOneToManyTable, const int64_t *,
+    const int64_t, const size_t, const GenericKeyHandler *, const int64_t,
+    int32_t *, int32_t *, const int64_t, int64_t *,
+    const std::vector<sycl::event> &);
+template void probe_compact_one_to_many_baseline_hash_table_on_l0<int32_t>(
+    ExecutionContext &, const CompactOneToManyTable, const int32_t *,
+    const int64_t, const size_t, const GenericKeyHandler *, const int64_t,
+    int32_t *, int32_t *, const int64_t, int64_t *);
+template void probe_compact_one_to_many_baseline_hash_table_on_l0<int64_t>(
+    ExecutionContext &, const CompactOneToManyTable, const int64_t *,
+    const int64_t, const size_t, const GenericKeyHandler *, const int64_t,
+    int32_t *, int32_t *, const int64_t, int64_t *);
+
+template sycl::event probe_bucketized_baseline_hash_buff_on_l0_async<int32_t>(
+    ExecutionContext &, const int8_t *, const size_t, const int32_t,
+    const size_t, const GenericKeyHandler *, const int64_t, int32_t *,
+    int32_t *, const int64_t, int64_t *, const std::vector<sycl::event> &);
+template sycl::event probe_bucketized_baseline_hash_buff_on_l0_async<int64_t>(
+    ExecutionContext &, const int8_t *, const size_t, const int32_t,
+    const size_t, const GenericKeyHandler *, const int64_t, int32_t *,
+    int32_t *, const int64_t, int64_t *, const std::vector<sycl::event> &);
+
+template sycl::event probe_one_to_many_bucketized_baseline_hash_table_on_l0_async<int32_t>(
+    ExecutionContext &, const int32_t *, const int8_t *, const size_t,
+    const size_t, const GenericKeyHandler *, const int64_t, int32_t *,
+    int32_t *, const int64_t, int64_t *, const std::vector<sycl::event> &);
+template sycl::event probe_one_to_many_bucketized_baseline_hash_table_on_l0_async<int64_t>(
+    ExecutionContext &, const int32_t *, const int8_t *, const size_t,
+    const size_t, const GenericKeyHandler *, const int64_t, int32_t *,
+    int32_t *, const int64_t, int64_t *, const std::vector<sycl::event> &);
+
+template void probe_bucketized_baseline_hash_buff_on_l0<int32_t>(
+    ExecutionContext &, const int8_t *, const size_t, const int32_t,
+    const size_t, const GenericKeyHandler *, const int64_t, int32_t *,
+    int32_t *, const int64_t, int64_t *);
+template void probe_bucketized_baseline_hash_buff_on_l0<int64_t>(
+    ExecutionContext &, const int8_t *, const size_t, const int32_t,
+    const size_t, const GenericKeyHandler *, const int64_t, int32_t *,
+    int32_t *, const int64_t, int64_t *);
+
+template void probe_one_to_many_bucketized_baseline_hash_table_on_l0<int32_t>(
+    ExecutionContext &, const int32_t *, const int8_t *, const size_t,
+    const size_t, const GenericKeyHandler *, const int64_t, int32_t *,
+    int32_t *, const int64_t, int64_t *);
+template void probe_one_to_many_bucketized_baseline_hash_table_on_l0<int64_t>(
+    ExecutionContext &, const int32_t *, const int8_t *, const size_t,
+    const size_t, const GenericKeyHandler *, const int64_t, int32_t *,
+    int32_t *, const int64_t, int64_t *);
+
+template sycl::event probe_partitioned_baseline_hash_buff_on_l0_async<int32_t>(
+    ExecutionContext &, const int8_t *, const uint32_t, const int64_t,
+    const int32_t, const size_t, const GenericKeyHandler *, const int64_t,
+    int32_t *, int32_t *, const int64_t, int64_t *,
+    const std::vector<sycl::event> &);
+template sycl::event probe_partitioned_baseline_hash_buff_on_l0_async<int64_t>(
+    ExecutionContext &, const int8_t *, const uint32_t, const int64_t,
+    const int32_t, const size_t, const GenericKeyHandler *, const int64_t,
+    int32_t *, int32_t *, const int64_t, int64_t *,
+    const std::vector<sycl::event> &);
+
+template sycl::event probe_one_to_many_partitioned_baseline_hash_table_on_l0_async<int32_t>(
+    ExecutionContext &, const int32_t *, const int8_t *, const uint32_t,
+    const int64_t, const size_t, const GenericKeyHandler *, const int64_t,
+    int32_t *, int32_t *, const int64_t, int64_t *,
+    const std::vector<sycl::event> &);
+template sycl::event probe_one_to_many_partitioned_baseline_hash_table_on_l0_async<int64_t>(
+    ExecutionContext &, const int32_t *, const int8_t *, const uint32_t,
+    const int64_t, const size_t, const GenericKeyHandler *, const int64_t,
+    int32_t *, int32_t *, const int64_t, int64_t *,
+    const std::vector<sycl::event> &);
+
+template void probe_partitioned_baseline_hash_buff_on_l0<int32_t>(
+    ExecutionContext &, const int8_t *, const uint32_t, const int64_t,
+    const int32_t, const size_t, const GenericKeyHandler *, const int64_t,
+    int32_t *, int32_t *, const int64_t, int64_t *);
+template void probe_partitioned_baseline_hash_buff_on_l0<int64_t>(
+    ExecutionContext &, const int8_t *, const uint32_t, const int64_t,
+    const int32_t, const size_t, const GenericKeyHandler *, const int64_t,
+    int32_t *, int32_t *, const int64_t, int64_t *);
+
+template void probe_one_to_many_partitioned_baseline_hash_table_on_l0<int32_t>(
+    ExecutionContext &, const int32_t *, const int8_t *, const uint32_t,
+    const int64_t, const size_t, const GenericKeyHandler *, const int64_t,
+    int32_t *, int32_t *, const int64_t, int64_t *);
+template void probe_one_to_many_partitioned_baseline_hash_table_on_l0<int64_t>(
+    ExecutionContext &, const int32_t *, const int8_t *, const uint32_t,
+    const int64_t, const size_t, const GenericKeyHandler *, const int64_t,
+    int32_t *, int32_t *, const int64_t, int64_t *);
@@ -0,0 +1,150 @@
+#ifndef BASELINE_HT_PROBE_H__
+#define BASELINE_HT_PROBE_H__
+
+#include <CL/sycl.hpp>
+#include <vector>
+
+#include "../CommonDecls.h"
+#include "../Shared/CompactOneToManyLayout.h"
+
+// Probe operators for the tables built by BaselineHashTableBuilder.h. The
+// composite keys of the num_elems outer rows are read through
+// outer_key_handler (on the device, like the build side key handler) and the
+// (outer_row, inner_row) pairs of the join are written into
+// outer_row_ids/inner_row_ids, ordered by outer row. At most max_matches pairs
+// are written, num_matches (device accessible) receives the total number of
+// matches so that the caller can retry with a bigger output.
+
+// hash_buff is a one-to-one table filled with with_val_slot set
+// (fill_baseline_hash_join_buff_on_l0)
+template <typename T>
+sycl::event probe_baseline_hash_join_buff_on_l0_async(
+    ExecutionContext &ctx, const int8_t *hash_buff, const int64_t entry_count,
+    const int32_t invalid_slot_val, const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches, const std::vector<sycl::event> &deps);
+
+// composite_key_dict/buff are a one-to-many table
+// (fill_one_to_many_baseline_hash_table_on_l0)
+template <typename T>
+sycl::event probe_one_to_many_baseline_hash_table_on_l0_async(
+    ExecutionContext &ctx, const int32_t *buff, const T *composite_key_dict,
+    const int64_t hash_entry_count, const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches, const std::vector<sycl::event> &deps);
+
+// composite_key_dict is the key only table of the one-to-many table whose
+// compact layout is table (compress_one_to_many_on_l0)
+template <typename T>
+sycl::event probe_compact_one_to_many_baseline_hash_table_on_l0_async(
+    ExecutionContext &ctx, const CompactOneToManyTable table,
+    const T *composite_key_dict, const int64_t hash_entry_count,
+    const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches, const std::vector<sycl::event> &deps);
+
+// hash_buff is a bucketized one-to-one table filled with with_val_slot set
+// (fill_bucketized_baseline_hash_buff_on_l0)
+template <typename T>
+sycl::event probe_bucketized_baseline_hash_buff_on_l0_async(
+    ExecutionContext &ctx, const int8_t *hash_buff, const size_t bucket_count,
+    const int32_t invalid_slot_val, const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches, const std::vector<sycl::event> &deps);
+
+// hash_buff/buff are a bucketized one-to-many table
+// (fill_one_to_many_bucketized_baseline_hash_table_on_l0)
+template <typename T>
+sycl::event probe_one_to_many_bucketized_baseline_hash_table_on_l0_async(
+    ExecutionContext &ctx, const int32_t *buff, const int8_t *hash_buff,
+    const size_t bucket_count, const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches, const std::vector<sycl::event> &deps);
+
+// hash_buff is a partitioned one-to-one table filled with with_val_slot set
+// (fill_partitioned_baseline_hash_buff_on_l0)
+template <typename T>
+sycl::event probe_partitioned_baseline_hash_buff_on_l0_async(
+    ExecutionContext &ctx, const int8_t *hash_buff,
+    const uint32_t partition_bits, const int64_t entry_count,
+    const int32_t invalid_slot_val, const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches, const std::vector<sycl::event> &deps);
+
+// hash_buff/buff are a partitioned one-to-many table
+// (fill_one_to_many_partitioned_baseline_hash_table_on_l0)
+template <typename T>
+sycl::event probe_one_to_many_partitioned_baseline_hash_table_on_l0_async(
+    ExecutionContext &ctx, const int32_t *buff, const int8_t *hash_buff,
+    const uint32_t partition_bits, const int64_t entry_count,
+    const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches, const std::vector<sycl::event> &deps);
+
+template <typename T>
+void probe_baseline_hash_join_buff_on_l0(
+    ExecutionContext &ctx, const int8_t *hash_buff, const int64_t entry_count,
+    const int32_t invalid_slot_val, const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches);
+
+template <typename T>
+void probe_one_to_many_baseline_hash_table_on_l0(
+    ExecutionContext &ctx, const int32_t *buff, const T *composite_key_dict,
+    const int64_t hash_entry_count, const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches);
+
+template <typename T>
+void probe_compact_one_to_many_baseline_hash_table_on_l0(
+    ExecutionContext &ctx, const CompactOneToManyTable table,
+    const T *composite_key_dict, const int64_t hash_entry_count,
+    const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches);
+
+template <typename T>
+void probe_bucketized_baseline_hash_buff_on_l0(
+    ExecutionContext &ctx, const int8_t *hash_buff, const size_t bucket_count,
+    const int32_t invalid_slot_val, const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches);
+
+template <typename T>
+void probe_one_to_many_bucketized_baseline_hash_table_on_l0(
+    ExecutionContext &ctx, const int32_t *buff, const int8_t *hash_buff,
+    const size_t bucket_count, const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches);
+
+template <typename T>
+void probe_partitioned_baseline_hash_buff_on_l0(
+    ExecutionContext &ctx, const int8_t *hash_buff,
+    const uint32_t partition_bits, const int64_t entry_count,
+    const int32_t invalid_slot_val, const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches);
+
+template <typename T>
+void probe_one_to_many_partitioned_baseline_hash_table_on_l0(
+    ExecutionContext &ctx, const int32_t *buff, const int8_t *hash_buff,
+    const uint32_t partition_bits, const int64_t entry_count,
+    const size_t key_component_count,
+    const GenericKeyHandler *outer_key_handler, const int64_t num_elems,
+    int32_t *outer_row_ids, int32_t *inner_row_ids, const int64_t max_matches,
+    int64_t *num_matches);
+
+#endif // BASELINE_HT_PROBE_H__
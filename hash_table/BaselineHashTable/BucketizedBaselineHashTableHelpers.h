@@ -0,0 +1,160 @@
+#ifndef BUCKETIZED_BASELINE_HT_HELPER_H__
+#define BUCKETIZED_BASELINE_HT_HELPER_H__
+#include <CL/sycl.hpp>
+
+#include "../MurMurHash.h"
+#include "BaselineHashTableHelpers.h"
+#include "BucketizedBaselineHashTableLayout.h"
+
+constexpr uint64_t g_fingerprint_lsbs{0x0101010101010101ULL};
+constexpr uint64_t g_fingerprint_low7{0x7F7F7F7F7F7F7F7FULL};
+constexpr uint8_t g_empty_fingerprint{0};
+
+// Device view of a bucketized baseline table (see
+// BucketizedBaselineHashTableLayout.h for the layout of hash_buff).
+template <typename T> struct BucketizedBaselineTable {
+  int8_t *hash_buff;
+  size_t bucket_count;
+  size_t key_component_count;
+
+  uint32_t *max_probe_length() const {
+    return reinterpret_cast<uint32_t *>(hash_buff);
+  }
+  uint64_t *fingerprints() const {
+    return reinterpret_cast<uint64_t *>(
+        hash_buff + g_bucketized_baseline_header_size);
+  }
+  T *keys() const {
+    return reinterpret_cast<T *>(
+        hash_buff + get_bucketized_baseline_keys_offset(bucket_count));
+  }
+  T *key_at(const size_t slot_idx) const {
+    return keys() + slot_idx * key_component_count;
+  }
+  int32_t *vals() const {
+    return reinterpret_cast<int32_t *>(
+        hash_buff + get_bucketized_baseline_vals_offset(
+                        bucket_count, key_component_count * sizeof(T)));
+  }
+};
+
+struct BucketizedBaselineHash {
+  size_t bucket;
+  uint8_t fingerprint; // never empty
+};
+
+template <typename T>
+inline BucketizedBaselineHash
+get_bucketized_baseline_hash(const T *key, const size_t key_component_count,
+                             const size_t bucket_count) {
+  const uint32_t h =
+      MurmurHash1Impl(key, key_component_count * sizeof(T), 0);
+  return {h % bucket_count, static_cast<uint8_t>((h >> 24) % 255 + 1)};
+}
+
+// Has the high bit of every byte of word that equals fingerprint set, without
+// false positives.
+inline uint64_t match_fingerprints(const uint64_t word,
+                                   const uint8_t fingerprint) {
+  const uint64_t x = word ^ (g_fingerprint_lsbs * fingerprint);
+  return ~(((x & g_fingerprint_low7) + g_fingerprint_low7) | x |
+           g_fingerprint_low7);
+}
+
+inline size_t get_fingerprint_slot(const uint64_t byte_mask) {
+  return sycl::ctz(byte_mask) / 8;
+}
+
+// Index of the slot holding key, -1 if it is not in the table. Only reads
+// published slots, so it must run after the build. A probe loads one
+// fingerprint word per bucket, compares full keys on fingerprint hits only
+// and ends at the first bucket with a free slot or after the maximum probe
+// length recorded by the build.
+template <typename T>
+inline int64_t
+get_matching_bucketized_baseline_slot_readonly(const BucketizedBaselineTable<T> &table,
+                                               const T *key) {
+  const auto kcc = table.key_component_count;
+  const auto hash = get_bucketized_baseline_hash(key, kcc, table.bucket_count);
+  const uint32_t max_probe_length = *table.max_probe_length();
+  size_t bucket = hash.bucket;
+  for (uint32_t probe = 0; probe < max_probe_length; ++probe) {
+    const uint64_t word = table.fingerprints()[bucket];
+    for (uint64_t hits = match_fingerprints(word, hash.fingerprint); hits;
+         hits &= hits - 1) {
+      const size_t slot_idx =
+          bucket * g_baseline_bucket_slots + get_fingerprint_slot(hits);
+      if (keys_are_equal(table.key_at(slot_idx), key, kcc)) {
+        return slot_idx;
+      }
+    }
+    if (match_fingerprints(word, g_empty_fingerprint)) {
+      return -1;
+    }
+    bucket = bucket + 1 == table.bucket_count ? 0 : bucket + 1;
+  }
+  return -1;
+}
+
+// Index of the slot holding key, inserting it if needed, -1 if the table is
+// full. A slot is claimed by setting its fingerprint in the bucket word, its
+// key is then written with match_or_claim_baseline_key, which inserters of
+// other keys with the same fingerprint may win first: the claimer then just
+// goes on with the next free slot. No inserter ever waits for another one.
+template <typename T>
+inline int64_t
+get_matching_bucketized_baseline_slot(const BucketizedBaselineTable<T> &table,
+                                      const T *key) {
+  const auto kcc = table.key_component_count;
+  const auto hash = get_bucketized_baseline_hash(key, kcc, table.bucket_count);
+  size_t bucket = hash.bucket;
+  for (size_t probe = 0; probe < table.bucket_count; ++probe) {
+    sycl::atomic_ref<uint64_t, sycl::memory_order::acq_rel,
+                     sycl::memory_scope::device>
+        atomic_word(table.fingerprints()[bucket]);
+    uint64_t word = atomic_word.load(sycl::memory_order::acquire);
+    // Byte mask of the slots compared already: a slot that doesn't hold key
+    // never will.
+    uint64_t checked_hits = 0;
+    int64_t slot_idx = -1;
+    while (slot_idx < 0) {
+      const uint64_t hits =
+          match_fingerprints(word, hash.fingerprint) & ~checked_hits;
+      for (uint64_t hit = hits; hit; hit &= hit - 1) {
+        const size_t hit_idx =
+            bucket * g_baseline_bucket_slots + get_fingerprint_slot(hit);
+        if (match_or_claim_baseline_key(table.key_at(hit_idx), key, kcc)) {
+          slot_idx = hit_idx;
+          break;
+        }
+      }
+      if (slot_idx >= 0) {
+        break;
+      }
+      checked_hits |= hits;
+      const uint64_t empty = match_fingerprints(word, g_empty_fingerprint);
+      if (!empty) {
+        break; // bucket full, the key is not in it
+      }
+      const size_t slot = get_fingerprint_slot(empty);
+      const uint64_t claimed =
+          word | (static_cast<uint64_t>(hash.fingerprint) << (8 * slot));
+      if (atomic_word.compare_exchange_strong(word, claimed,
+                                              sycl::memory_order::acq_rel)) {
+        // Compared with the other hits on the next iteration
+        word = claimed;
+      } // else word holds the current value of the bucket
+    }
+    if (slot_idx >= 0) {
+      sycl::atomic_ref<uint32_t, sycl::memory_order::relaxed,
+                       sycl::memory_scope::device>
+          atomic_max_probe_length(*table.max_probe_length());
+      atomic_max_probe_length.fetch_max(probe + 1);
+      return slot_idx;
+    }
+    bucket = bucket + 1 == table.bucket_count ? 0 : bucket + 1;
+  }
+  return -1;
+}
+
+#endif // BUCKETIZED_BASELINE_HT_HELPER_H__
@@ -0,0 +1,51 @@
+#ifndef BUCKETIZED_BASELINE_HT_LAYOUT_H__
+#define BUCKETIZED_BASELINE_HT_LAYOUT_H__
+
+#include <cstddef>
+#include <cstdint>
+
+// Bucketized baseline hash table, an alternative to the flat layout of
+// BaselineHashTableBuilder.h. Slots are grouped into buckets of
+// g_baseline_bucket_slots, the one byte fingerprints of a bucket share one
+// 64-bit word so that a probe compares all of them at once and only compares
+// full keys on a fingerprint hit. The buffer holds, cache line aligned:
+//   header:       uint32_t max probe length (in buckets) seen by the build
+//   fingerprints: uint64_t per bucket
+//   keys:         key_component_count T's per slot, empty keys until claimed
+//   vals:         int32_t per slot (row id), only with a value slot
+constexpr size_t g_baseline_bucket_slots{8};
+constexpr size_t g_bucketized_baseline_alignment{64};
+constexpr size_t g_bucketized_baseline_header_size{g_bucketized_baseline_alignment};
+
+inline size_t align_to_cache_line(const size_t bytes) {
+  return (bytes + g_bucketized_baseline_alignment - 1) /
+         g_bucketized_baseline_alignment * g_bucketized_baseline_alignment;
+}
+
+inline size_t get_bucketized_baseline_keys_offset(const size_t bucket_count) {
+  return g_bucketized_baseline_header_size +
+         align_to_cache_line(bucket_count * sizeof(uint64_t));
+}
+
+inline size_t get_bucketized_baseline_vals_offset(const size_t bucket_count,
+                                                  const size_t key_size_in_bytes) {
+  return get_bucketized_baseline_keys_offset(bucket_count) +
+         align_to_cache_line(bucket_count * g_baseline_bucket_slots *
+                             key_size_in_bytes);
+}
+
+// Size in bytes of the buffer of a table with bucket_count buckets.
+inline size_t get_bucketized_baseline_hash_buff_size(const size_t bucket_count,
+                                                     const size_t key_size_in_bytes,
+                                                     const bool with_val_slot) {
+  return get_bucketized_baseline_vals_offset(bucket_count, key_size_in_bytes) +
+         (with_val_slot ? bucket_count * g_baseline_bucket_slots * sizeof(int32_t)
+                        : 0);
+}
+
+// Number of buckets to hold entry_count keys.
+inline size_t get_bucketized_baseline_bucket_count(const size_t entry_count) {
+  return (entry_count + g_baseline_bucket_slots - 1) / g_baseline_bucket_slots;
+}
+
+#endif // BUCKETIZED_BASELINE_HT_LAYOUT_H__
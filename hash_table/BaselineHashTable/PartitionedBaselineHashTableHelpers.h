@@ -0,0 +1,53 @@
+#ifndef PARTITIONED_BASELINE_HT_HELPER_H__
+#define PARTITIONED_BASELINE_HT_HELPER_H__
+#include <CL/sycl.hpp>
+
+#include "../MurMurHash.h"
+#include "BaselineHashTableHelpers.h"
+#include "PartitionedBaselineHashTableLayout.h"
+
+// Device view of a partitioned baseline table (see
+// PartitionedBaselineHashTableLayout.h for the layout of hash_buff).
+template <typename T> struct PartitionedBaselineTable {
+  int8_t *hash_buff;
+  uint32_t partition_bits;
+  int64_t entry_count;
+  size_t key_component_count;
+  size_t hash_entry_size; // in T's
+
+  int32_t *key_offsets() const {
+    return reinterpret_cast<int32_t *>(hash_buff);
+  }
+  T *entries() const {
+    return reinterpret_cast<T *>(
+        hash_buff + get_partitioned_baseline_entries_offset(partition_bits));
+  }
+  uint32_t get_partition(const uint32_t h) const {
+    return partition_bits ? h >> (32 - partition_bits) : 0;
+  }
+  // First entry of partition p, entry_count for p == partition count
+  int64_t get_partition_begin(const size_t p) const {
+    const int64_t num_keys = key_offsets()[size_t{1} << partition_bits];
+    return num_keys ? key_offsets()[p] * entry_count / num_keys : 0;
+  }
+};
+
+// Entry holding key, nullptr if it is not in the table. Only valid after the
+// build.
+template <typename T>
+inline const T *
+get_matching_partitioned_baseline_slot_readonly(const PartitionedBaselineTable<T> &table,
+                                                const T *key) {
+  const auto kcc = table.key_component_count;
+  const size_t p = table.get_partition(MurmurHash1Impl(key, kcc * sizeof(T), 0));
+  const int64_t begin = table.get_partition_begin(p);
+  const int64_t end = table.get_partition_begin(p + 1);
+  if (begin == end) {
+    return nullptr;
+  }
+  return get_matching_baseline_hash_slot_readonly(
+      key, kcc, table.entries() + begin * table.hash_entry_size, end - begin,
+      kcc * sizeof(T), table.hash_entry_size);
+}
+
+#endif // PARTITIONED_BASELINE_HT_HELPER_H__
@@ -0,0 +1,56 @@
+#ifndef PARTITIONED_BASELINE_HT_LAYOUT_H__
+#define PARTITIONED_BASELINE_HT_LAYOUT_H__
+
+#include <cstddef>
+#include <cstdint>
+
+// Radix partitioned baseline hash table, built partition by partition so that
+// the inserts of a partition stay in local memory (or cache). Partition p
+// holds the keys whose MurmurHash1Impl hash has p in its partition_bits most
+// significant bits. The buffer holds, cache line aligned:
+//   directory: int32_t per partition plus one, exclusive prefix sum of the
+//              number of distinct build keys per partition (estimated for
+//              the partitions too big to count them in local memory)
+//   entries:   entry_count entries in the flat baseline layout (key
+//              components, then the value slot if any, all of type T)
+// Partition p owns entries [dir[p] * entry_count / dir[P],
+// dir[p + 1] * entry_count / dir[P]), a flat linear probing table indexed by
+// hash % its entry count. Every partition gets at least entry_count / dir[P]
+// entries per distinct key (rounded down), so a table with at least as many
+// entries as distinct keys never overflows a partition whose keys are
+// counted. The estimates are padded, leave some slack for them.
+constexpr uint32_t g_max_baseline_partition_bits{12};
+constexpr size_t g_partitioned_baseline_alignment{64};
+
+inline size_t get_partitioned_baseline_entries_offset(const uint32_t partition_bits) {
+  const size_t directory_size =
+      ((size_t{1} << partition_bits) + 1) * sizeof(int32_t);
+  return (directory_size + g_partitioned_baseline_alignment - 1) /
+         g_partitioned_baseline_alignment * g_partitioned_baseline_alignment;
+}
+
+// Size in bytes of the buffer of a table with entry_count entries of
+// hash_entry_size bytes.
+inline size_t get_partitioned_baseline_hash_buff_size(const uint32_t partition_bits,
+                                                      const int64_t entry_count,
+                                                      const size_t hash_entry_size) {
+  return get_partitioned_baseline_entries_offset(partition_bits) +
+         entry_count * hash_entry_size;
+}
+
+// Fewest partition bits for which the partitions of a table of entry_count
+// entries of hash_entry_size bytes take at most partition_size bytes on
+// average.
+inline uint32_t get_baseline_partition_bits(const int64_t entry_count,
+                                            const size_t hash_entry_size,
+                                            const size_t partition_size) {
+  const size_t table_size = entry_count * hash_entry_size;
+  uint32_t partition_bits = 0;
+  while (partition_bits < g_max_baseline_partition_bits &&
+         table_size > (partition_size << partition_bits)) {
+    ++partition_bits;
+  }
+  return partition_bits;
+}
+
+#endif // PARTITIONED_BASELINE_HT_LAYOUT_H__
@@ -13,5 +13,7 @@ enum class HashType;
 class BaselineHashTable;
 class GenericKeyHandler;
 struct HashEntryInfo;
+class ExecutionContext;
+class MultiDeviceContext;
 
 #endif // HT_COMMON_DECLS_H__
\ No newline at end of file
@@ -0,0 +1,101 @@
+#ifndef COMPOSITE_KEY_PACKING_H__
+#define COMPOSITE_KEY_PACKING_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "Types.h"
+
+// Packs a composite key into a single key component when the value ranges of
+// its components fit in one word together: component i is stored as
+// (value - min_val) in bits [shift, shift + bit width) of the packed key.
+// Nulls of uses_bw_eq components get the code max_val - min_val + 1.
+// Baseline tables built from packed keys have one key component, so inserts
+// are a single CAS and key comparisons a single compare.
+// Result of the key handler for a row whose key is outside of the ranges of
+// its packing. The baseline builders store it to dev_err_buff, as the table
+// would miss the row; the probes skip such rows, they can't match.
+constexpr int g_unpackable_key_err{-3};
+
+struct CompositeKeyPacking {
+  size_t key_component_count;
+  int64_t min_val[g_maximum_conditions_to_coalesce];
+  int64_t max_val[g_maximum_conditions_to_coalesce];
+  int64_t null_val[g_maximum_conditions_to_coalesce];
+  bool null_is_key[g_maximum_conditions_to_coalesce];
+  uint32_t shift[g_maximum_conditions_to_coalesce];
+
+  // Returns false if a component is out of its range: no key of the table
+  // can equal key then.
+  template <typename T> bool pack(const T *key, T &packed) const {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < key_component_count; ++i) {
+      uint64_t code;
+      if (null_is_key[i] && key[i] == null_val[i]) {
+        code = static_cast<uint64_t>(max_val[i] - min_val[i]) + 1;
+      } else if (key[i] >= min_val[i] && key[i] <= max_val[i]) {
+        code = static_cast<uint64_t>(key[i] - min_val[i]);
+      } else {
+        return false;
+      }
+      bits |= code << shift[i];
+    }
+    packed = static_cast<T>(bits);
+    return true;
+  }
+};
+
+inline uint32_t get_bit_width(const uint64_t max_code) {
+  uint32_t bit_width = 0;
+  while (bit_width < 64 && (max_code >> bit_width)) {
+    ++bit_width;
+  }
+  return bit_width;
+}
+
+// Sets up packing for keys of key_component_count components described by
+// type_info_per_key (host memory), returns false if the packed keys would not
+// fit in a T, minus its empty key. With translation maps, the ranges must be
+// the ones of the translated (outer) ids. The nulls of the components without
+// uses_bw_eq are out of range: a build side key handler must skip them
+// (should_skip_entries), or the build fails with g_unpackable_key_err.
+template <typename T>
+bool init_composite_key_packing(CompositeKeyPacking &packing,
+                                const JoinColumnTypeInfo *type_info_per_key,
+                                const size_t key_component_count) {
+  if (key_component_count > g_maximum_conditions_to_coalesce) {
+    return false;
+  }
+  constexpr uint32_t key_bits = sizeof(T) * 8 - 1; // non-negative keys only
+  packing.key_component_count = key_component_count;
+  uint32_t shift = 0;
+  uint64_t max_packed = 0;
+  for (size_t i = 0; i < key_component_count; ++i) {
+    const auto &type_info = type_info_per_key[i];
+    if (type_info.column_type == ColumnType::Double ||
+        type_info.max_val < type_info.min_val) {
+      return false;
+    }
+    const uint64_t range =
+        static_cast<uint64_t>(type_info.max_val - type_info.min_val);
+    const uint64_t max_code = range + (type_info.uses_bw_eq ? 1 : 0);
+    if (max_code < range) {
+      return false;
+    }
+    const uint32_t bit_width = get_bit_width(max_code);
+    if (shift + bit_width > key_bits) {
+      return false;
+    }
+    packing.min_val[i] = type_info.min_val;
+    packing.max_val[i] = type_info.max_val;
+    packing.null_val[i] = type_info.null_val;
+    packing.null_is_key[i] = type_info.uses_bw_eq;
+    packing.shift[i] = shift;
+    max_packed |= max_code << shift;
+    shift += bit_width;
+  }
+  return max_packed < static_cast<uint64_t>(std::numeric_limits<T>::max());
+}
+
+#endif // COMPOSITE_KEY_PACKING_H__
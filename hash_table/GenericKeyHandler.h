@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <cstddef>
 #include <cassert>
+#include "CompositeKeyPacking.h"
 #include "JoinColumnIterator.h"
 #include "Types.h"
 
@@ -13,11 +14,15 @@ struct GenericKeyHandler {
                     const JoinColumn *join_column_per_key,
                     const JoinColumnTypeInfo *type_info_per_key,
                     const int32_t *const *sd_inner_to_outer_translation_maps,
-                    const int32_t *sd_min_inner_elems)
+                    const int32_t *sd_min_inner_elems,
+                    const size_t *const *chunk_offsets_per_key = nullptr,
+                    const CompositeKeyPacking *key_packing = nullptr)
       : key_component_count_(key_component_count),
         should_skip_entries_(should_skip_entries),
         join_column_per_key_(join_column_per_key),
-        type_info_per_key_(type_info_per_key) {
+        type_info_per_key_(type_info_per_key),
+        chunk_offsets_per_key_(chunk_offsets_per_key),
+        key_packing_(key_packing) {
     if (sd_inner_to_outer_translation_maps) {
       sd_inner_to_outer_translation_maps_ = sd_inner_to_outer_translation_maps;
       sd_min_inner_elems_ = sd_min_inner_elems;
@@ -28,12 +33,12 @@ struct GenericKeyHandler {
     }
   }
 
-  template <typename T, typename KEY_BUFF_HANDLER>
-  int SYCL_EXTERNAL operator()(JoinColumnIterator* join_column_iterators, T* key_scratch_buff, KEY_BUFF_HANDLER f) const {
+  template <typename T, typename KEY_BUFF_HANDLER, typename DECODER = GenericColumnDecoder>
+  int SYCL_EXTERNAL operator()(JoinColumnIterator* join_column_iterators, T* key_scratch_buff, KEY_BUFF_HANDLER f, DECODER decoder = {}) const {
     bool skip_entry = false;
     for (size_t key_component_index = 0; key_component_index < key_component_count_; ++key_component_index) { // All key components (cols, e.g., Group By 3 cols -> 3 components)
       const auto& join_column_iterator = join_column_iterators[key_component_index]; // Get iterator on the current column of the "key"
-      int64_t elem = (*join_column_iterator).element; // Get its element
+      int64_t elem = decoder(join_column_iterator).element; // Get its element
       if (should_skip_entries_ && elem == join_column_iterator.type_info->null_val && !join_column_iterator.type_info->uses_bw_eq) {
         skip_entry = true;
         break;
@@ -58,18 +63,123 @@ struct GenericKeyHandler {
     }
 
     if (!skip_entry) { // If entry shouldn't be skipped (all components are non null), we call a callback that writes key to the hash slot
+      if (key_packing_) {
+        T packed_key;
+        if (!key_packing_->pack(key_scratch_buff, packed_key)) {
+          return g_unpackable_key_err;
+        }
+        return f(join_column_iterators[0].index, &packed_key, 1);
+      }
       return f(join_column_iterators[0].index, key_scratch_buff, key_component_count_);
     }
 
     return 0;
   }
 
+  // Calls func with the ColumnDecoder of the key columns if they all share
+  // one ColumnType and element width, with the GenericColumnDecoder otherwise.
+  // The type infos live on the device, so kernels call this once per work
+  // item instead of decoding every row through the type switch.
+  template <typename FUNC>
+  auto dispatch_key_decoder(FUNC func) const {
+    for (size_t i = 1; i < key_component_count_; ++i) {
+      if (type_info_per_key_[i].column_type != type_info_per_key_[0].column_type ||
+          type_info_per_key_[i].elem_sz != type_info_per_key_[0].elem_sz) {
+        return func(GenericColumnDecoder{});
+      }
+    }
+    return dispatch_column_decoder(type_info_per_key_[0].column_type,
+                                   type_info_per_key_[0].elem_sz, func);
+  }
+
+  // Calls f on the key of every row from start on, stepping by step rows (a
+  // grid-stride loop when start and step are the global id and range of the
+  // work item). Returns the last non-zero result of f (or
+  // g_unpackable_key_err), 0 otherwise.
+  template <typename T, typename KEY_BUFF_HANDLER>
+  int for_each_key(const size_t start, const size_t step, KEY_BUFF_HANDLER f) const {
+    T key_scratch_buff[g_maximum_conditions_to_coalesce]; // The key
+    return dispatch_key_decoder([&](auto decoder) {
+      int err = 0;
+      for (JoinColumnTupleIterator it(key_component_count_, join_column_per_key_,
+                                      type_info_per_key_, chunk_offsets_per_key_,
+                                      start, step);
+           it; ++it) {
+        if (const int ret = (*this)(it.join_column_iterators, key_scratch_buff, f, decoder)) {
+          err = ret;
+        }
+      }
+      return err;
+    });
+  }
+
+  // Same as for_each_key for the rows before end only (e.g. the rows of one
+  // device of a sharded build).
+  template <typename T, typename KEY_BUFF_HANDLER>
+  int for_each_key_before(const size_t start, const size_t step, const size_t end,
+                          KEY_BUFF_HANDLER f) const {
+    T key_scratch_buff[g_maximum_conditions_to_coalesce]; // The key
+    return dispatch_key_decoder([&](auto decoder) {
+      int err = 0;
+      for (JoinColumnTupleIterator it(key_component_count_, join_column_per_key_,
+                                      type_info_per_key_, chunk_offsets_per_key_,
+                                      start, step);
+           it && it.join_column_iterators[0].index < end; ++it) {
+        if (const int ret = (*this)(it.join_column_iterators, key_scratch_buff, f, decoder)) {
+          err = ret;
+        }
+      }
+      return err;
+    });
+  }
+
+  // Same over the rows [begin, end) in order (a host backend task).
+  template <typename T, typename KEY_BUFF_HANDLER>
+  int for_each_key_in_range(const size_t begin, const size_t end, KEY_BUFF_HANDLER f) const {
+    T key_scratch_buff[g_maximum_conditions_to_coalesce]; // The key
+    return dispatch_key_decoder([&](auto decoder) {
+      int err = 0;
+      JoinColumnTupleIterator it(key_component_count_, join_column_per_key_,
+                                 type_info_per_key_, chunk_offsets_per_key_,
+                                 begin, 1);
+      for (size_t row = begin; row < end && it; ++row, ++it) {
+        if (const int ret = (*this)(it.join_column_iterators, key_scratch_buff, f, decoder)) {
+          err = ret;
+        }
+      }
+      return err;
+    });
+  }
+
+  // Same as for_each_key for rounds steps, past the end of the rows if need
+  // be, calling step_f() after every step whether f was called or not. With
+  // the same rounds for all the work items of a work-group, their calls to
+  // step_f stay converged and may use group collectives.
+  template <typename T, typename KEY_BUFF_HANDLER, typename STEP_FUNC>
+  void for_each_key_converged(const size_t start, const size_t step, const size_t rounds,
+                              KEY_BUFF_HANDLER f, STEP_FUNC step_f) const {
+    T key_scratch_buff[g_maximum_conditions_to_coalesce]; // The key
+    dispatch_key_decoder([&](auto decoder) {
+      JoinColumnTupleIterator it(key_component_count_, join_column_per_key_,
+                                 type_info_per_key_, chunk_offsets_per_key_,
+                                 start, step);
+      for (size_t round = 0; round < rounds; ++round, ++it) {
+        if (it) {
+          (*this)(it.join_column_iterators, key_scratch_buff, f, decoder);
+        }
+        step_f();
+      }
+      return 0;
+    });
+  }
+
   size_t get_number_of_columns() const {
     return key_component_count_;
   }
 
+  // Components of the keys passed to the callbacks: 1 with key packing.
   size_t get_key_component_count() const {
-    return key_component_count_;
+    return key_packing_ ? 1 : key_component_count_;
   }
 
   const JoinColumn* get_join_columns() const {
@@ -80,11 +190,20 @@ struct GenericKeyHandler {
     return type_info_per_key_;
   }
 
+  // Per key column prefix sums of the chunk sizes (see
+  // build_chunk_offsets_on_l0_async), nullptr if not provided.
+  const size_t* const* get_chunk_offsets_per_key() const {
+    return chunk_offsets_per_key_;
+  }
+
   const size_t key_component_count_;
   const bool should_skip_entries_;
   const JoinColumn* join_column_per_key_;
   const JoinColumnTypeInfo* type_info_per_key_;
   const int32_t* const* sd_inner_to_outer_translation_maps_;
   const int32_t* sd_min_inner_elems_;
+  const size_t* const* chunk_offsets_per_key_;
+  // Packs the keys into one component if set (see CompositeKeyPacking.h)
+  const CompositeKeyPacking* key_packing_;
 };
 #endif // GENERIC_KEY_HANDLER_H__
\ No newline at end of file
@@ -17,6 +17,8 @@
 #ifndef JOIN_COL_ITER_H__
 #define JOIN_COL_ITER_H__
 
+#include <type_traits>
+
 #include "Types.h"
 
 inline int64_t fixed_width_int_decode(const int8_t *byte_stream,
@@ -80,6 +82,7 @@ struct JoinColumnIterator {
   const JoinColumnTypeInfo* type_info;  // WARNING: pointer might be on GPU
   const struct JoinChunk* join_chunk_array;
   const int8_t* chunk_data;  // bool(chunk_data) tells if this iterator is valid
+  const size_t* chunk_offsets;  // WARNING: pointer might be on GPU, or nullptr
   size_t index_of_chunk;
   size_t index_inside_chunk;
   size_t index;
@@ -126,29 +129,64 @@ struct JoinColumnIterator {
   JoinColumnIterator& operator++() {
     index += step;              // make step in the global index
     index_inside_chunk += step; // make step in the local index
-    // So if we make too big step, we just go from current chunk, to the last
-    // one
-    while (chunk_data &&
+    if (chunk_data) {
+      if (chunk_offsets) {
+        seekChunk();
+      } else {
+        skipExhaustedChunks();
+      }
+    }
+    return *this;
+  }
+
+  // Same as skipExhaustedChunks through chunk_offsets: a step past the current
+  // chunk binary searches the chunks after it, so that a grid-stride step
+  // costs O(log(num_chunks)) instead of one iteration per chunk it crosses.
+  void seekChunk() {
+    if (index_inside_chunk < join_chunk_array[index_of_chunk].num_elems) {
+      return;
+    }
+    if (index >= join_column->num_elems) {
+      chunk_data = nullptr;
+      return;
+    }
+    // Last chunk starting at or before index, skips empty chunks.
+    size_t lo = index_of_chunk + 1;
+    size_t hi = join_column->num_chunks;
+    while (hi - lo > 1) {
+      const size_t mid = lo + (hi - lo) / 2;
+      if (chunk_offsets[mid] <= index) {
+        lo = mid;
+      } else {
+        hi = mid;
+      }
+    }
+    index_of_chunk = lo;
+    index_inside_chunk = index - chunk_offsets[lo];
+    chunk_data = join_chunk_array[lo].col_buff;
+  }
+
+  // So if we make too big step, we just go from current chunk, to the last
+  // one. Empty chunks are skipped by their num_elems, their col_buff may be
+  // nullptr.
+  void skipExhaustedChunks() {
+    while (index_of_chunk < join_column->num_chunks &&
            index_inside_chunk >=
                join_chunk_array[index_of_chunk]
-                   .num_elems) { // while valid and local index is overflown
+                   .num_elems) { // while local index is overflown
       index_inside_chunk -=
           join_chunk_array[index_of_chunk]
               .num_elems; // reduce local index by current chunk's num_elems
       ++index_of_chunk;   // go to next chunk
-      if (index_of_chunk <
-          join_column
-              ->num_chunks) { // if we are still in the range of col's chunks
-        chunk_data =
-            join_chunk_array[index_of_chunk].col_buff; // update chunk ptr
-      } else {
-        chunk_data = nullptr; // set to invalid
-      }
     }
-    return *this;
+    // if we are still in the range of col's chunks update chunk ptr,
+    // otherwise set to invalid
+    chunk_data = index_of_chunk < join_column->num_chunks
+                     ? join_chunk_array[index_of_chunk].col_buff
+                     : nullptr;
   }
 
-  JoinColumnIterator() : chunk_data(nullptr) {}
+  JoinColumnIterator() : chunk_data(nullptr), chunk_offsets(nullptr) {}
 
   JoinColumnIterator(
       const JoinColumn* join_column,        // WARNING: pointer might be on GPU
@@ -158,20 +196,168 @@ struct JoinColumnIterator {
       : join_column(join_column)
       , type_info(type_info)
       , join_chunk_array(reinterpret_cast<const struct JoinChunk*>(join_column->col_chunks_buff))
-      , chunk_data(join_column->num_elems > 0 ? join_chunk_array->col_buff : nullptr)
+      , chunk_data(nullptr)
+      , chunk_offsets(nullptr)
       , index_of_chunk(0)
-      , index_inside_chunk(0)
-      , index(0)
+      , index_inside_chunk(start)
+      , index(start)
       , start(start)
       , step(step) {
     // Stagger the index differently for each thread iterating over the column.
-    auto temp = this->step;
-    this->step = this->start;
-    operator++();
-    this->step = temp;
+    if (join_column->num_elems > 0) {
+      skipExhaustedChunks();
+    }
   }
+
+  // Random access through chunk_offsets, the prefix sum of the chunk sizes
+  // (num_chunks + 1 entries, see build_chunk_offsets_on_l0_async): the chunk
+  // of start is found by binary search instead of walking all chunks before
+  // it, and so are the chunks of the steps from it. Falls back to the walk
+  // when chunk_offsets is nullptr.
+  JoinColumnIterator(
+      const JoinColumn* join_column,        // WARNING: pointer might be on GPU
+      const JoinColumnTypeInfo* type_info,  // WARNING: pointer might be on GPU
+      const size_t* chunk_offsets,          // WARNING: pointer might be on GPU
+      size_t start,
+      size_t step)
+      : JoinColumnIterator(join_column, type_info, chunk_offsets ? 0 : start, step) {
+    if (!chunk_offsets) {
+      return;
+    }
+    this->chunk_offsets = chunk_offsets;
+    this->start = start;
+    if (start >= join_column->num_elems) {
+      chunk_data = nullptr;
+      return;
+    }
+    // Last chunk starting at or before start, skips empty chunks.
+    size_t lo = 0;
+    size_t hi = join_column->num_chunks;
+    while (hi - lo > 1) {
+      const size_t mid = lo + (hi - lo) / 2;
+      if (chunk_offsets[mid] <= start) {
+        lo = mid;
+      } else {
+        hi = mid;
+      }
+    }
+    index_of_chunk = lo;
+    index_inside_chunk = start - chunk_offsets[lo];
+    index = start;
+    chunk_data = join_chunk_array[lo].col_buff;
+  }
+
+  // Positions the iterator directly on a row of a known chunk, used by the
+  // chunk-major launches where every work-group owns whole chunks.
+  JoinColumnIterator(
+      const JoinColumn* join_column,        // WARNING: pointer might be on GPU
+      const JoinColumnTypeInfo* type_info,  // WARNING: pointer might be on GPU
+      size_t index_of_chunk,
+      size_t index_inside_chunk,
+      size_t index,
+      size_t step)
+      : join_column(join_column)
+      , type_info(type_info)
+      , join_chunk_array(reinterpret_cast<const struct JoinChunk*>(join_column->col_chunks_buff))
+      , chunk_data(join_chunk_array[index_of_chunk].col_buff)
+      , chunk_offsets(nullptr)
+      , index_of_chunk(index_of_chunk)
+      , index_inside_chunk(index_inside_chunk)
+      , index(index)
+      , start(index)
+      , step(step) {}
 };  // struct JoinColumnIterator
 
+//! Decodes the rows of columns of one ColumnType and element width, so that
+//! kernels instantiated with it load the elements without switching on the
+//! type info of the column for every row.
+template <ColumnType COLUMN_TYPE, size_t ELEM_SZ>
+struct ColumnDecoder {
+  static int64_t decode(const int8_t* chunk_data, const size_t pos) {
+    if constexpr (COLUMN_TYPE == ColumnType::SmallDate) {
+      using SmallDateT = std::conditional_t<ELEM_SZ == 4, int32_t, int16_t>;
+      constexpr int64_t null_val = ELEM_SZ == 4 ? NULL_INT : NULL_SMALLINT;
+      const int64_t val = reinterpret_cast<const SmallDateT*>(chunk_data)[pos];
+      return val == null_val ? null_val : val * 86400;
+    } else if constexpr (COLUMN_TYPE == ColumnType::Signed) {
+      using SignedT = std::conditional_t<
+          ELEM_SZ == 1, int8_t,
+          std::conditional_t<ELEM_SZ == 2, int16_t,
+                             std::conditional_t<ELEM_SZ == 4, int32_t, int64_t>>>;
+      return reinterpret_cast<const SignedT*>(chunk_data)[pos];
+    } else if constexpr (COLUMN_TYPE == ColumnType::Unsigned) {
+      using UnsignedT = std::conditional_t<
+          ELEM_SZ == 1, uint8_t,
+          std::conditional_t<ELEM_SZ == 2, uint16_t,
+                             std::conditional_t<ELEM_SZ == 4, uint32_t, uint64_t>>>;
+      return reinterpret_cast<const UnsignedT*>(chunk_data)[pos];
+    } else {
+      static_assert(COLUMN_TYPE == ColumnType::Double && ELEM_SZ == sizeof(double));
+      return fixed_width_double_decode(chunk_data, pos);
+    }
+  }
+
+  JoinColumnIterator::IndexedElement operator()(const JoinColumnIterator& it) const {
+    return {it.index, decode(it.chunk_data, it.index_inside_chunk)};
+  }
+};  // struct ColumnDecoder
+
+//! Decodes the rows of any column, switching on its type info for every row.
+struct GenericColumnDecoder {
+  JoinColumnIterator::IndexedElement operator()(const JoinColumnIterator& it) const {
+    return *it;
+  }
+};  // struct GenericColumnDecoder
+
+//! Calls func with the ColumnDecoder matching column_type and elem_sz, or with
+//! the GenericColumnDecoder for unexpected combinations. Dispatch once per
+//! kernel launch, not per row.
+template <typename FUNC>
+auto dispatch_column_decoder(const ColumnType column_type,
+                             const size_t elem_sz,
+                             FUNC func) {
+  switch (column_type) {
+    case ColumnType::SmallDate:
+      switch (elem_sz) {
+        case 2:
+          return func(ColumnDecoder<ColumnType::SmallDate, 2>{});
+        case 4:
+          return func(ColumnDecoder<ColumnType::SmallDate, 4>{});
+      }
+      break;
+    case ColumnType::Signed:
+      switch (elem_sz) {
+        case 1:
+          return func(ColumnDecoder<ColumnType::Signed, 1>{});
+        case 2:
+          return func(ColumnDecoder<ColumnType::Signed, 2>{});
+        case 4:
+          return func(ColumnDecoder<ColumnType::Signed, 4>{});
+        case 8:
+          return func(ColumnDecoder<ColumnType::Signed, 8>{});
+      }
+      break;
+    case ColumnType::Unsigned:
+      switch (elem_sz) {
+        case 1:
+          return func(ColumnDecoder<ColumnType::Unsigned, 1>{});
+        case 2:
+          return func(ColumnDecoder<ColumnType::Unsigned, 2>{});
+        case 4:
+          return func(ColumnDecoder<ColumnType::Unsigned, 4>{});
+        case 8:
+          return func(ColumnDecoder<ColumnType::Unsigned, 8>{});
+      }
+      break;
+    case ColumnType::Double:
+      if (elem_sz == sizeof(double)) {
+        return func(ColumnDecoder<ColumnType::Double, sizeof(double)>{});
+      }
+      break;
+  }
+  return func(GenericColumnDecoder{});
+}
+
 //! Helper class for viewing a JoinColumn and it's matching JoinColumnTypeInfo as a single
 //! object.
 struct JoinColumnTyped {
@@ -237,6 +423,26 @@ struct JoinColumnTupleIterator {
     }
   }
 
+  // Same as above, with the chunk offsets of every key column (entries may be
+  // nullptr) for O(log(num_chunks)) positioning.
+  JoinColumnTupleIterator(size_t num_cols,
+                                 const JoinColumn* join_column_per_key,
+                                 const JoinColumnTypeInfo* type_info_per_key,
+                                 const size_t* const* chunk_offsets_per_key,
+                                 size_t start,
+                                 size_t step)
+      : num_cols(num_cols) {
+    assert(num_cols <= g_maximum_conditions_to_coalesce);
+    for (size_t i = 0; i < num_cols; ++i) {
+      join_column_iterators[i] =
+          JoinColumnIterator(&join_column_per_key[i],
+                             type_info_per_key ? &type_info_per_key[i] : nullptr,
+                             chunk_offsets_per_key ? chunk_offsets_per_key[i] : nullptr,
+                             start,
+                             step);
+    }
+  }
+
   operator bool() const {
     for (size_t i = 0; i < num_cols; ++i) {
       if (join_column_iterators[i]) {
@@ -5,9 +5,9 @@
 #include <cstddef>
 
 
-uint32_t MurmurHash1Impl(const void* key,
-                        int len,
-                        const uint32_t seed) {
+inline uint32_t MurmurHash1Impl(const void* key,
+                               int len,
+                               const uint32_t seed) {
   const unsigned int m = 0xc6a4a793;
 
   const int r = 16;
@@ -52,9 +52,9 @@ uint32_t MurmurHash1Impl(const void* key,
   return h;
 }
 
-uint64_t MurmurHash64AImpl(const void* key,
-                            int len,
-                            uint64_t seed) {
+inline uint64_t MurmurHash64AImpl(const void* key,
+                                  int len,
+                                  uint64_t seed) {
   const uint64_t m = 0xc6a4a7935bd1e995LLU;
   const int r = 47;
 
@@ -4,32 +4,28 @@
 #include <type_traits>
 
 #include "../JoinColumnIterator.h"
+#include "../Shared/ExecutionContext.h"
+#include "../Shared/HashTableStats.h"
+#include "../Shared/JoinColumnLaunch.h"
+#include "../Shared/MultiDeviceContext.h"
+#include "../Shared/ShardExchange.h"
 #include "../Shared/Shared.h"
+#include "../Shared/Sharding.h"
+#include "../Shared/SlotCounting.h"
 #include "PerfectHashTableBuilder.h"
 #include "PerfectHashTableHelpers.h"
 
-int32_t *get_hash_slot(int32_t *buff, const int64_t key,
-                       const int64_t min_key) {
-  return buff + (key - min_key);
-}
-
-int32_t *get_bucketized_hash_slot(int32_t *buff, const int64_t key,
-                                  const int64_t min_key,
-                                  const int64_t bucket_normalization) {
-  return buff + (key - min_key) / bucket_normalization;
-}
-
-int fill_one_to_one_hashtable(const size_t idx, int32_t *entry_ptr,
+template <typename ROW_ID, sycl::memory_scope SCOPE>
+int fill_one_to_one_hashtable(const size_t idx, ROW_ID *entry_ptr,
                               const int32_t invalid_slot_val) {
   // the atomic takes the address of invalid_slot_val to write the value of
   // entry_ptr if not equal to invalid_slot_val. make a copy to avoid
   // dereferencing a const value.
-  int32_t invalid_slot_val_copy = invalid_slot_val;
-  sycl::atomic_ref<int32_t, sycl::memory_order::acq_rel,
-                   sycl::memory_scope::device>
+  ROW_ID invalid_slot_val_copy = invalid_slot_val;
+  sycl::atomic_ref<ROW_ID, sycl::memory_order::acq_rel, SCOPE>
       atomic_entry_ptr(*entry_ptr);
   if (!atomic_entry_ptr.compare_exchange_strong(invalid_slot_val_copy,
-                                                static_cast<int32_t>(idx),
+                                                static_cast<ROW_ID>(idx),
                                                 sycl::memory_order::acq_rel)) {
     // slot is full
     return -1;
@@ -37,200 +33,398 @@ int fill_one_to_one_hashtable(const size_t idx, int32_t *entry_ptr,
   return 0;
 }
 
-int fill_hashtable_for_semi_join(const size_t idx, int32_t *entry_ptr,
+template <typename ROW_ID, sycl::memory_scope SCOPE>
+int fill_hashtable_for_semi_join(const size_t idx, ROW_ID *entry_ptr,
                                  const int32_t invalid_slot_val) {
   // just mark the existence of value to the corresponding hash slot
   // regardless of hashtable collision
-  auto invalid_slot_val_copy = invalid_slot_val;
-  sycl::atomic_ref<int32_t, sycl::memory_order::relaxed,
-                   sycl::memory_scope::device>
+  ROW_ID invalid_slot_val_copy = invalid_slot_val;
+  sycl::atomic_ref<ROW_ID, sycl::memory_order::relaxed, SCOPE>
       atomic_entry_ptr(*entry_ptr);
   atomic_entry_ptr.compare_exchange_strong(invalid_slot_val_copy,
-                                           static_cast<int32_t>(idx),
+                                           static_cast<ROW_ID>(idx),
                                            sycl::memory_order::relaxed);
   return 0;
 }
 
-template <typename HASHTABLE_FILLING_FUNC>
-void fill_hash_join_buff_impl(int32_t *buff, const int32_t invalid_slot_val,
-                              const JoinColumn join_column,
-                              const JoinColumnTypeInfo type_info,
-                              const int32_t *sd_inner_to_outer_translation_map,
-                              const int32_t min_inner_elem,
-                              HASHTABLE_FILLING_FUNC filling_func,
-                              int *dev_err_buff) {
-  sycl::queue q;
-  q.submit([&](sycl::handler &h) {
-     h.parallel_for(sycl::range{static_cast<size_t>(join_column.num_elems)},
-                    [=](sycl::id<1> elem_idx) {
-                      sycl::atomic_ref<int, sycl::memory_order::relaxed,
-                                       sycl::memory_scope::device>
-                          atomic_dev_err(*dev_err_buff);
-                      auto item = *(JoinColumnIterator(&join_column, &type_info,
-                                                       elem_idx, 1));
-                      const size_t index = item.index;
-                      int64_t elem = item.element;
-                      if (elem == type_info.null_val) {
-                        if (type_info.uses_bw_eq) {
-                          elem = type_info.translated_null_val;
-                        } else {
-                          return;
-                        }
-                      }
-                      if (filling_func(elem, index)) {
-                        atomic_dev_err.store(-1);
-                      }
-                    });
-   }).wait();
+template <typename ROW_ID, typename HASHTABLE_FILLING_FUNC>
+sycl::event fill_hash_join_buff_impl(
+    ExecutionContext &ctx, const char *kernel_name, ROW_ID *buff,
+    const int32_t invalid_slot_val,
+    const JoinColumn join_column, const JoinColumnTypeInfo type_info,
+    const int64_t row_begin, const int64_t row_end,
+    const int32_t *sd_inner_to_outer_translation_map,
+    const int32_t min_inner_elem, HASHTABLE_FILLING_FUNC filling_func,
+    const BloomFilter bloom_filter, int *dev_err_buff,
+    const std::vector<sycl::event> &deps) {
+  std::vector<sycl::event> offsets_deps = deps;
+  const size_t *chunk_offsets = get_chunk_offsets(ctx, join_column, offsets_deps);
+  const int64_t num_rows = row_end - row_begin;
+  const KernelInfo info{
+      kernel_name, num_rows, 0,
+      get_join_column_bytes(join_column) /
+              std::max<int64_t>(1, join_column.num_elems) * num_rows +
+          num_rows * static_cast<int64_t>(sizeof(ROW_ID))};
+  return dispatch_column_decoder(
+      type_info.column_type, type_info.elem_sz, [&](auto decoder) {
+        auto fill_row = [=](const JoinColumnIterator &it) {
+          sycl::atomic_ref<int, sycl::memory_order::relaxed,
+                           sycl::memory_scope::device>
+              atomic_dev_err(*dev_err_buff);
+          auto item = decoder(it);
+          const size_t index = item.index;
+          int64_t elem = item.element;
+          if (!get_one_to_one_fill_key(elem, type_info,
+                                       sd_inner_to_outer_translation_map,
+                                       min_inner_elem)) {
+            return;
+          }
+          if (bloom_filter.blocks) {
+            bloom_filter_insert(bloom_filter,
+                                get_bloom_filter_hash(&elem, 1));
+          }
+          if (filling_func(elem, index)) {
+            atomic_dev_err.store(-1);
+          }
+        };
+        if (num_rows == static_cast<int64_t>(join_column.num_elems)) {
+          return submit_join_column_rows(ctx, info, join_column, type_info,
+                                         chunk_offsets, offsets_deps,
+                                         fill_row);
+        }
+        return submit_join_column_row_range(ctx, info, join_column, type_info,
+                                            chunk_offsets, row_begin, row_end,
+                                            offsets_deps, fill_row);
+      });
 };
 
-template <typename SLOT_SELECTOR>
-void count_matches_impl(int32_t *count_buff, const int32_t invalid_slot_val,
-                        const JoinColumn join_column,
-                        const JoinColumnTypeInfo type_info,
-                        SLOT_SELECTOR slot_selector) {
-  sycl::queue q;
-  q.submit([&](sycl::handler &h) {
-     h.parallel_for(sycl::range{static_cast<size_t>(join_column.num_elems)},
-                    [=](sycl::id<1> elem_idx) {
-                      auto item = *(JoinColumnIterator(&join_column, &type_info,
-                                                       elem_idx, 1));
-                      int64_t elem = item.element;
-                      if (elem == type_info.null_val) {
-                        if (type_info.uses_bw_eq) {
-                          elem = type_info.translated_null_val;
-                        } else {
-                          return;
-                        }
-                      }
-                      int32_t *entry_ptr = slot_selector(count_buff, elem);
-                      sycl::atomic_ref<int32_t, sycl::memory_order::relaxed,
-                                       sycl::memory_scope::device>
-                          atomic_slot_entry(*entry_ptr);
-                      atomic_slot_entry.fetch_add(1);
-                    });
-   }).wait();
-}
-
-void count_matches(int32_t *count_buff, const int32_t invalid_slot_val,
-                   const JoinColumn join_column,
-                   const JoinColumnTypeInfo type_info) {
+// Slots of a bucketized table reached by the keys of type_info: the range
+// [min_val, max_val] and the translated null.
+inline int64_t get_bucketized_key_slot_count(
+    const JoinColumnTypeInfo &type_info, const int64_t bucket_normalization) {
+  const int64_t max_key =
+      type_info.uses_bw_eq
+          ? std::max(type_info.max_val, type_info.translated_null_val)
+          : type_info.max_val;
+  return std::max<int64_t>(
+      (max_key - type_info.min_val) / bucket_normalization + 1, 0);
+}
+
+// Same as fill_hash_join_buff_impl for the bucketized table buff whose slots
+// [0, slot_count) fit local memory: every work-group fills a copy of them in
+// local memory and merges it into buff at the end, with a CAS per occupied
+// slot instead of one per row. Like the global fill, a one-to-one table
+// flags a key in two rows (in the same or in different work-groups) as an
+// error, while a semi-join table keeps any row of the key. Keys past
+// slot_count go to buff directly.
+template <typename ROW_ID>
+sycl::event fill_hash_join_buff_staged(
+    ExecutionContext &ctx, ROW_ID *buff, const int64_t slot_count,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const JoinColumn join_column, const JoinColumnTypeInfo type_info,
+    const int32_t *sd_inner_to_outer_translation_map,
+    const int32_t min_inner_elem, const int64_t bucket_normalization,
+    const BloomFilter bloom_filter, int *dev_err_buff,
+    const std::vector<sycl::event> &deps) {
+  std::vector<sycl::event> offsets_deps = deps;
+  const size_t *chunk_offsets = get_chunk_offsets(ctx, join_column, offsets_deps);
+  const int64_t num_rows = join_column.num_elems;
+  const auto launch_config = ctx.get_launch_config();
+  const auto nd_range =
+      get_grid_stride_nd_range(launch_config, join_column.num_elems);
+  const int64_t group_count = nd_range.get_group_range()[0];
+  const KernelInfo info{
+      for_semi_join ? "perfect_fill_semi_join_staged"
+                    : "perfect_fill_one_to_one_staged",
+      num_rows, slot_count,
+      get_join_column_bytes(join_column) +
+          group_count * slot_count * static_cast<int64_t>(sizeof(ROW_ID))};
+  return submit_profiled(ctx, info, [&] {
+    return ctx.get_queue().submit([&](sycl::handler &h) {
+      h.depends_on(offsets_deps);
+      sycl::local_accessor<ROW_ID, 1> local_table(
+          sycl::range<1>{static_cast<size_t>(slot_count)}, h);
+      dispatch_column_decoder(
+          type_info.column_type, type_info.elem_sz, [&](auto decoder) {
+            h.parallel_for(nd_range, [=](sycl::nd_item<1> item) {
+              sycl::atomic_ref<int, sycl::memory_order::relaxed,
+                               sycl::memory_scope::device>
+                  atomic_dev_err(*dev_err_buff);
+              const auto group = item.get_group();
+              const size_t local_id = item.get_local_id(0);
+              const size_t local_range = item.get_local_range(0);
+              for (int64_t i = local_id; i < slot_count; i += local_range) {
+                local_table[i] = invalid_slot_val;
+              }
+              sycl::group_barrier(group);
+              for (JoinColumnIterator it(&join_column, &type_info,
+                                         chunk_offsets, item.get_global_id(0),
+                                         item.get_global_range(0));
+                   it; ++it) {
+                auto row = decoder(it);
+                int64_t elem = row.element;
+                if (!get_one_to_one_fill_key(elem, type_info,
+                                             sd_inner_to_outer_translation_map,
+                                             min_inner_elem)) {
+                  continue;
+                }
+                if (bloom_filter.blocks) {
+                  bloom_filter_insert(bloom_filter,
+                                      get_bloom_filter_hash(&elem, 1));
+                }
+                const int64_t slot =
+                    (elem - type_info.min_val) / bucket_normalization;
+                int err = 0;
+                if (slot < slot_count) {
+                  ROW_ID invalid_slot_val_copy = invalid_slot_val;
+                  sycl::atomic_ref<ROW_ID, sycl::memory_order::relaxed,
+                                   sycl::memory_scope::work_group,
+                                   sycl::access::address_space::local_space>
+                      atomic_local_entry(local_table[slot]);
+                  err = !atomic_local_entry.compare_exchange_strong(
+                            invalid_slot_val_copy,
+                            static_cast<ROW_ID>(row.index)) &&
+                        !for_semi_join;
+                } else {
+                  err = for_semi_join
+                            ? fill_hashtable_for_semi_join(
+                                  row.index, buff + slot, invalid_slot_val)
+                            : fill_one_to_one_hashtable(
+                                  row.index, buff + slot, invalid_slot_val);
+                }
+                if (err) {
+                  atomic_dev_err.store(-1);
+                }
+              }
+              sycl::group_barrier(group);
+              for (int64_t i = local_id; i < slot_count; i += local_range) {
+                if (local_table[i] == invalid_slot_val) {
+                  continue;
+                }
+                const int err =
+                    for_semi_join
+                        ? fill_hashtable_for_semi_join(local_table[i], buff + i,
+                                                       invalid_slot_val)
+                        : fill_one_to_one_hashtable(local_table[i], buff + i,
+                                                    invalid_slot_val);
+                if (err) {
+                  atomic_dev_err.store(-1);
+                }
+              }
+            });
+          });
+    });
+  });
+}
+
+template <typename ROW_ID, typename SLOT_SELECTOR>
+sycl::event count_matches_impl(ExecutionContext &ctx, ROW_ID *count_buff,
+                               const int64_t hash_entry_count,
+                               const int32_t invalid_slot_val,
+                               const JoinColumn join_column,
+                               const JoinColumnTypeInfo type_info,
+                               const size_t *chunk_offsets,
+                               const BloomFilter bloom_filter,
+                               SLOT_SELECTOR slot_selector,
+                               const std::vector<sycl::event> &deps) {
+  // One count per row
+  const int64_t num_rows = join_column.num_elems;
+  const KernelInfo info{"perfect_count_matches", num_rows, 0,
+                        get_join_column_bytes(join_column) +
+                            num_rows * static_cast<int64_t>(sizeof(ROW_ID))};
+  auto add_count = [count_buff](const int64_t slot, const int64_t count) {
+    sycl::atomic_ref<ROW_ID, sycl::memory_order::relaxed,
+                     sycl::memory_scope::device>
+        atomic_slot_entry(count_buff[slot]);
+    return static_cast<int64_t>(
+        atomic_slot_entry.fetch_add(static_cast<ROW_ID>(count)));
+  };
+  return dispatch_column_decoder(
+      type_info.column_type, type_info.elem_sz, [&](auto decoder) {
+        auto get_slot = [=](const JoinColumnIterator &it) -> int64_t {
+          int64_t elem = decoder(it).element;
+          if (elem == type_info.null_val) {
+            if (type_info.uses_bw_eq) {
+              elem = type_info.translated_null_val;
+            } else {
+              return -1;
+            }
+          }
+          if (bloom_filter.blocks) {
+            bloom_filter_insert(bloom_filter, get_bloom_filter_hash(&elem, 1));
+          }
+          ROW_ID *entry_ptr = slot_selector(count_buff, elem);
+          return entry_ptr ? entry_ptr - count_buff
+                           : -1; // key of another shard
+        };
+        const JoinColumnSlots<decltype(get_slot)> slots{
+            join_column, type_info, chunk_offsets, get_slot};
+        return submit_slot_counts(ctx, info, slots, hash_entry_count,
+                                  add_count, deps);
+      });
+}
+
+template <typename ROW_ID>
+sycl::event count_matches(ExecutionContext &ctx, ROW_ID *count_buff,
+                          const int64_t hash_entry_count,
+                          const int32_t invalid_slot_val,
+                          const JoinColumn join_column,
+                          const JoinColumnTypeInfo type_info,
+                          const size_t *chunk_offsets,
+                          const BloomFilter bloom_filter,
+                          const std::vector<sycl::event> &deps) {
   auto slot_sel = [type_info](auto count_buff, auto elem) {
     return get_hash_slot(count_buff, elem, type_info.min_val);
   };
-  count_matches_impl(count_buff, invalid_slot_val, join_column, type_info,
-                     slot_sel);
-}
-
-template <typename SLOT_SELECTOR>
-void fill_row_ids_impl(int32_t *buff, const int64_t hash_entry_count,
-                       const int32_t invalid_slot_val,
-                       const JoinColumn join_column,
-                       const JoinColumnTypeInfo type_info,
-                       SLOT_SELECTOR slot_selector) {
-  sycl::queue q;
-  q.submit([&](sycl::handler &h) {
-     int32_t *pos_buff = buff;
-     int32_t *count_buff = buff + hash_entry_count;
-     int32_t *id_buff = count_buff + hash_entry_count;
-     h.parallel_for(
-         sycl::range{static_cast<size_t>(join_column.num_elems)},
-         [=](sycl::id<1> elem_idx) {
-           auto item =
-               *(JoinColumnIterator(&join_column, &type_info, elem_idx, 1));
-           const size_t index = item.index;
-           int64_t elem = item.element;
-           if (elem == type_info.null_val) {
-             if (type_info.uses_bw_eq) {
-               elem = type_info.translated_null_val;
-             } else {
-               return;
-             }
-           }
-           auto pos_ptr = slot_selector(pos_buff, elem);
-           const auto bin_idx = pos_ptr - pos_buff;
-           sycl::atomic_ref<int32_t, sycl::memory_order::acq_rel,
-                            sycl::memory_scope::device>
-               atomic_count_buff(*(count_buff + bin_idx));
-           const auto id_buff_idx = atomic_count_buff.fetch_add(1) + *pos_ptr;
-           id_buff[id_buff_idx] = static_cast<int32_t>(index);
-         });
-   }).wait();
-}
-
-void fill_row_ids(int32_t *buff, const int64_t hash_entry_count,
-                  const int32_t invalid_slot_val, const JoinColumn join_column,
-                  const JoinColumnTypeInfo type_info) {
+  return count_matches_impl(ctx, count_buff, hash_entry_count,
+                            invalid_slot_val, join_column, type_info,
+                            chunk_offsets, bloom_filter, slot_sel, deps);
+}
+
+template <typename ROW_ID, typename SLOT_SELECTOR>
+sycl::event fill_row_ids_impl(ExecutionContext &ctx, ROW_ID *buff,
+                              const int64_t hash_entry_count,
+                              const int32_t invalid_slot_val,
+                              const JoinColumn join_column,
+                              const JoinColumnTypeInfo type_info,
+                              const size_t *chunk_offsets,
+                              SLOT_SELECTOR slot_selector,
+                              const std::vector<sycl::event> &deps) {
+  ROW_ID *pos_buff = buff;
+  ROW_ID *count_buff = buff + hash_entry_count;
+  ROW_ID *id_buff = count_buff + hash_entry_count;
+  // A position, a count and a row id per row
+  const int64_t num_rows = join_column.num_elems;
+  const KernelInfo info{
+      "perfect_fill_row_ids", num_rows, hash_entry_count,
+      get_join_column_bytes(join_column) +
+          3 * num_rows * static_cast<int64_t>(sizeof(ROW_ID))};
+  auto reserve = [count_buff](const int64_t slot, const int64_t count) {
+    sycl::atomic_ref<ROW_ID, sycl::memory_order::relaxed,
+                     sycl::memory_scope::device>
+        atomic_count_buff(count_buff[slot]);
+    return static_cast<int64_t>(
+        atomic_count_buff.fetch_add(static_cast<ROW_ID>(count)));
+  };
+  auto write_row_id = [pos_buff, id_buff](const int64_t row_index,
+                                          const int64_t slot,
+                                          const int64_t position) {
+    id_buff[pos_buff[slot] + position] = static_cast<ROW_ID>(row_index);
+  };
+  return dispatch_column_decoder(
+      type_info.column_type, type_info.elem_sz, [&](auto decoder) {
+        auto get_slot = [=](const JoinColumnIterator &it) -> int64_t {
+          int64_t elem = decoder(it).element;
+          if (elem == type_info.null_val) {
+            if (type_info.uses_bw_eq) {
+              elem = type_info.translated_null_val;
+            } else {
+              return -1;
+            }
+          }
+          auto pos_ptr = slot_selector(pos_buff, elem);
+          return pos_ptr ? pos_ptr - pos_buff : -1;
+        };
+        const JoinColumnSlots<decltype(get_slot)> slots{
+            join_column, type_info, chunk_offsets, get_slot};
+        return submit_slot_reservations(ctx, info, slots, reserve,
+                                        write_row_id, deps);
+      });
+}
+
+template <typename ROW_ID>
+sycl::event fill_row_ids(ExecutionContext &ctx, ROW_ID *buff,
+                         const int64_t hash_entry_count,
+                         const int32_t invalid_slot_val,
+                         const JoinColumn join_column,
+                         const JoinColumnTypeInfo type_info,
+                         const size_t *chunk_offsets,
+                         const std::vector<sycl::event> &deps) {
   auto slot_sel = [type_info](auto pos_buff, auto elem) {
     return get_hash_slot(pos_buff, elem, type_info.min_val);
   };
 
-  fill_row_ids_impl(buff, hash_entry_count, invalid_slot_val, join_column,
-                    type_info, slot_sel);
+  return fill_row_ids_impl(ctx, buff, hash_entry_count, invalid_slot_val,
+                           join_column, type_info, chunk_offsets, slot_sel,
+                           deps);
 }
 
-template <typename COUNT_MATCHES_FUNCTOR, typename FILL_ROW_IDS_FUNCTOR>
-void fill_one_to_many_hash_table_on_device_impl(
-    int32_t *buff, const int64_t hash_entry_count,
+template <typename ROW_ID, typename COUNT_MATCHES_FUNCTOR,
+          typename FILL_ROW_IDS_FUNCTOR>
+sycl::event fill_one_to_many_hash_table_on_device_impl(
+    ExecutionContext &ctx, ROW_ID *buff, const int64_t hash_entry_count,
     const int32_t invalid_slot_val, const JoinColumn &join_column,
     const JoinColumnTypeInfo &type_info,
     COUNT_MATCHES_FUNCTOR count_matches_func,
-    FILL_ROW_IDS_FUNCTOR fill_row_ids_func) {
-  sycl::queue q;
-  int32_t *pos_buff = buff;
-  int32_t *count_buff = buff + hash_entry_count;
-  q.memset(count_buff, 0, hash_entry_count * sizeof(int32_t)).wait();
-  count_matches_func();
-
-  set_valid_pos_flag(pos_buff, count_buff, hash_entry_count);
-
-  q.single_task([=]() { // Inclusive scan
-     for (size_t i = 1; i < hash_entry_count; i++) {
-       count_buff[i] = count_buff[i - 1] + count_buff[i];
-     }
-   })
-      .wait();
-
-  set_valid_pos(pos_buff, count_buff, hash_entry_count);
-  q.memset(count_buff, 0, hash_entry_count * sizeof(int32_t)).wait();
-  fill_row_ids_func();
+    FILL_ROW_IDS_FUNCTOR fill_row_ids_func,
+    const std::vector<sycl::event> &deps) {
+  ROW_ID *pos_buff = buff;
+  ROW_ID *count_buff = buff + hash_entry_count;
+  auto count_buff_reset =
+      fill_buff_async(ctx, "perfect_reset_counts", count_buff, ROW_ID{0},
+                      static_cast<size_t>(hash_entry_count), deps);
+  auto counted = count_matches_func({count_buff_reset});
+  auto pos_set = set_valid_pos_from_counts(ctx, pos_buff, count_buff,
+                                           hash_entry_count, {counted});
+  return fill_row_ids_func({pos_set});
 }
 
-void count_matches_bucketized(int32_t *count_buff,
-                              const int32_t invalid_slot_val,
-                              const JoinColumn join_column,
-                              const JoinColumnTypeInfo type_info,
-                              const int64_t bucket_normalization) {
+template <typename ROW_ID>
+sycl::event count_matches_bucketized(ExecutionContext &ctx,
+                                     ROW_ID *count_buff,
+                                     const int64_t hash_entry_count,
+                                     const int32_t invalid_slot_val,
+                                     const JoinColumn join_column,
+                                     const JoinColumnTypeInfo type_info,
+                                     const int64_t bucket_normalization,
+                                     const size_t *chunk_offsets,
+                                     const BloomFilter bloom_filter,
+                                     const std::vector<sycl::event> &deps) {
   auto slot_sel = [bucket_normalization, type_info](auto count_buff,
                                                     auto elem) {
     return get_bucketized_hash_slot(count_buff, elem, type_info.min_val,
                                     bucket_normalization);
   };
-  count_matches_impl(count_buff, invalid_slot_val, join_column, type_info,
-                     slot_sel);
+  return count_matches_impl(ctx, count_buff, hash_entry_count,
+                            invalid_slot_val, join_column, type_info,
+                            chunk_offsets, bloom_filter, slot_sel, deps);
 }
 
-void fill_row_ids_bucketized(int32_t *buff, const int64_t hash_entry_count,
-                             const int32_t invalid_slot_val,
-                             const JoinColumn join_column,
-                             const JoinColumnTypeInfo type_info,
-                             const int64_t bucket_normalization) {
+template <typename ROW_ID>
+sycl::event fill_row_ids_bucketized(ExecutionContext &ctx, ROW_ID *buff,
+                                    const int64_t hash_entry_count,
+                                    const int32_t invalid_slot_val,
+                                    const JoinColumn join_column,
+                                    const JoinColumnTypeInfo type_info,
+                                    const int64_t bucket_normalization,
+                                    const size_t *chunk_offsets,
+                                    const std::vector<sycl::event> &deps) {
   auto slot_sel = [type_info, bucket_normalization](auto pos_buff, auto elem) {
     return get_bucketized_hash_slot(pos_buff, elem, type_info.min_val,
                                     bucket_normalization);
   };
-  fill_row_ids_impl(buff, hash_entry_count, invalid_slot_val, join_column,
-                    type_info, slot_sel);
+  return fill_row_ids_impl(ctx, buff, hash_entry_count, invalid_slot_val,
+                           join_column, type_info, chunk_offsets, slot_sel,
+                           deps);
 }
 
-void fill_hash_join_buff_bucketized_on_l0(
-    int32_t *buff, const int32_t invalid_slot_val, const bool for_semi_join,
-    const JoinColumn join_column, const JoinColumnTypeInfo type_info,
+template <typename ROW_ID>
+sycl::event fill_hash_join_buff_bucketized_on_l0_async(
+    ExecutionContext &ctx, ROW_ID *buff, const int32_t invalid_slot_val,
+    const bool for_semi_join, const JoinColumn join_column,
+    const JoinColumnTypeInfo type_info,
     const int32_t *sd_inner_to_outer_translation_map,
     const int32_t min_inner_elem, const int64_t bucket_normalization,
-    int *dev_err_buff) {
-  auto filling_func =
-      for_semi_join ? fill_hashtable_for_semi_join : fill_one_to_one_hashtable;
+    int *dev_err_buff, const BloomFilter bloom_filter,
+    const std::vector<sycl::event> &deps) {
+  const int64_t slot_count =
+      get_bucketized_key_slot_count(type_info, bucket_normalization);
+  if (!ctx.is_host() && use_local_slots(ctx, slot_count, sizeof(ROW_ID))) {
+    return fill_hash_join_buff_staged(
+        ctx, buff, slot_count, invalid_slot_val, for_semi_join, join_column,
+        type_info, sd_inner_to_outer_translation_map, min_inner_elem,
+        bucket_normalization, bloom_filter, dev_err_buff, deps);
+  }
   auto hashtable_filling_func = [=](auto elem, size_t index) {
     auto entry_ptr = get_bucketized_hash_slot(buff, elem, type_info.min_val,
                                               bucket_normalization);
@@ -240,55 +434,649 @@ void fill_hash_join_buff_bucketized_on_l0(
                : fill_one_to_one_hashtable(index, entry_ptr, invalid_slot_val);
   };
 
-  fill_hash_join_buff_impl(buff, invalid_slot_val, join_column, type_info,
-                           sd_inner_to_outer_translation_map, min_inner_elem,
-                           hashtable_filling_func, dev_err_buff);
+  return fill_hash_join_buff_impl(
+      ctx, for_semi_join ? "perfect_fill_semi_join" : "perfect_fill_one_to_one",
+      buff, invalid_slot_val, join_column, type_info, 0, join_column.num_elems,
+      sd_inner_to_outer_translation_map, min_inner_elem, hashtable_filling_func,
+      bloom_filter, dev_err_buff, deps);
 }
 
-void fill_one_to_many_hash_table_on_l0(int32_t *buff,
+template <typename ROW_ID>
+sycl::event fill_hash_join_buff_bucketized_on_l0_async(
+    ExecutionContext &ctx, ROW_ID *buff, const int32_t invalid_slot_val,
+    const bool for_semi_join, const JoinColumn join_column,
+    const JoinColumnTypeInfo type_info,
+    const int32_t *sd_inner_to_outer_translation_map,
+    const int32_t min_inner_elem, const int64_t bucket_normalization,
+    int *dev_err_buff, const std::vector<sycl::event> &deps) {
+  return fill_hash_join_buff_bucketized_on_l0_async(
+      ctx, buff, invalid_slot_val, for_semi_join, join_column, type_info,
+      sd_inner_to_outer_translation_map, min_inner_elem, bucket_normalization,
+      dev_err_buff, BloomFilter{}, deps);
+}
+
+template <typename ROW_ID>
+void fill_hash_join_buff_bucketized_on_l0(
+    ExecutionContext &ctx, ROW_ID *buff, const int32_t invalid_slot_val,
+    const bool for_semi_join, const JoinColumn join_column,
+    const JoinColumnTypeInfo type_info,
+    const int32_t *sd_inner_to_outer_translation_map,
+    const int32_t min_inner_elem, const int64_t bucket_normalization,
+    int *dev_err_buff) {
+  fill_hash_join_buff_bucketized_on_l0_async(
+      ctx, buff, invalid_slot_val, for_semi_join, join_column, type_info,
+      sd_inner_to_outer_translation_map, min_inner_elem, bucket_normalization,
+      dev_err_buff, {})
+      .wait();
+}
+
+void fill_hash_join_buff_bucketized_on_l0(
+    int32_t *buff, const int32_t invalid_slot_val, const bool for_semi_join,
+    const JoinColumn join_column, const JoinColumnTypeInfo type_info,
+    const int32_t *sd_inner_to_outer_translation_map,
+    const int32_t min_inner_elem, const int64_t bucket_normalization,
+    int *dev_err_buff) {
+  fill_hash_join_buff_bucketized_on_l0(
+      ExecutionContext::get_default(), buff, invalid_slot_val, for_semi_join,
+      join_column, type_info, sd_inner_to_outer_translation_map,
+      min_inner_elem, bucket_normalization, dev_err_buff);
+}
+
+template <typename ROW_ID>
+sycl::event build_hash_join_buff_bucketized_on_l0_async(
+    ExecutionContext &ctx, ROW_ID *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const JoinColumn join_column, const JoinColumnTypeInfo type_info,
+    const int32_t *sd_inner_to_outer_translation_map,
+    const int32_t min_inner_elem, const bool buff_is_initialized,
+    int *dev_err_buff, const BloomFilter bloom_filter, HashTableStats *stats,
+    const std::vector<sycl::event> &deps) {
+  const int64_t entry_count = hash_entry_info.getNormalizedHashEntryCount();
+  // The in-order queue chains the commands, only the first one waits on deps.
+  auto err_reset =
+      fill_buff_async(ctx, "reset_err_buff", dev_err_buff, 0, 1, deps);
+  auto initialized =
+      buff_is_initialized
+          ? err_reset
+          : init_hash_join_buff_on_l0_async(ctx, buff, entry_count,
+                                            invalid_slot_val, {err_reset});
+  auto filled = fill_hash_join_buff_bucketized_on_l0_async(
+      ctx, buff, invalid_slot_val, for_semi_join, join_column, type_info,
+      sd_inner_to_outer_translation_map, min_inner_elem,
+      hash_entry_info.bucket_normalization, dev_err_buff, bloom_filter,
+      {initialized});
+  if (!stats) {
+    return filled;
+  }
+  auto stats_reset = init_hash_table_stats_on_l0_async(ctx, stats, {filled});
+  return compute_perfect_hash_table_stats_on_l0_async(
+      ctx, buff, entry_count, invalid_slot_val, stats, {stats_reset});
+}
+
+template <typename ROW_ID>
+sycl::event build_hash_join_buff_bucketized_on_l0_async(
+    ExecutionContext &ctx, ROW_ID *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const JoinColumn join_column, const JoinColumnTypeInfo type_info,
+    const int32_t *sd_inner_to_outer_translation_map,
+    const int32_t min_inner_elem, const bool buff_is_initialized,
+    int *dev_err_buff, const BloomFilter bloom_filter,
+    const std::vector<sycl::event> &deps) {
+  return build_hash_join_buff_bucketized_on_l0_async(
+      ctx, buff, hash_entry_info, invalid_slot_val, for_semi_join, join_column,
+      type_info, sd_inner_to_outer_translation_map, min_inner_elem,
+      buff_is_initialized, dev_err_buff, bloom_filter, nullptr, deps);
+}
+
+template <typename ROW_ID>
+sycl::event build_hash_join_buff_bucketized_on_l0_async(
+    ExecutionContext &ctx, ROW_ID *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const JoinColumn join_column, const JoinColumnTypeInfo type_info,
+    const int32_t *sd_inner_to_outer_translation_map,
+    const int32_t min_inner_elem, const bool buff_is_initialized,
+    int *dev_err_buff, const std::vector<sycl::event> &deps) {
+  return build_hash_join_buff_bucketized_on_l0_async(
+      ctx, buff, hash_entry_info, invalid_slot_val, for_semi_join, join_column,
+      type_info, sd_inner_to_outer_translation_map, min_inner_elem,
+      buff_is_initialized, dev_err_buff, BloomFilter{}, deps);
+}
+
+template <typename ROW_ID>
+void build_hash_join_buff_bucketized_on_l0(
+    ExecutionContext &ctx, ROW_ID *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const JoinColumn join_column, const JoinColumnTypeInfo type_info,
+    const int32_t *sd_inner_to_outer_translation_map,
+    const int32_t min_inner_elem, const bool buff_is_initialized,
+    int *dev_err_buff) {
+  build_hash_join_buff_bucketized_on_l0_async(
+      ctx, buff, hash_entry_info, invalid_slot_val, for_semi_join, join_column,
+      type_info, sd_inner_to_outer_translation_map, min_inner_elem,
+      buff_is_initialized, dev_err_buff, {})
+      .wait();
+}
+
+void build_hash_join_buff_bucketized_on_l0(
+    int32_t *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const JoinColumn join_column, const JoinColumnTypeInfo type_info,
+    const int32_t *sd_inner_to_outer_translation_map,
+    const int32_t min_inner_elem, const bool buff_is_initialized,
+    int *dev_err_buff) {
+  build_hash_join_buff_bucketized_on_l0(
+      ExecutionContext::get_default(), buff, hash_entry_info,
+      invalid_slot_val, for_semi_join, join_column, type_info,
+      sd_inner_to_outer_translation_map, min_inner_elem, buff_is_initialized,
+      dev_err_buff);
+}
+
+template <typename ROW_ID>
+sycl::event fill_one_to_many_hash_table_on_l0_async(
+    ExecutionContext &ctx, ROW_ID *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const JoinColumn &join_column,
+    const JoinColumnTypeInfo &type_info,
+    const BloomFilter bloom_filter,
+    const std::vector<sycl::event> &deps) {
+  auto hash_entry_count = hash_entry_info.hash_entry_count;
+  // Shared by the counting and the filling pass.
+  std::vector<sycl::event> offsets_deps = deps;
+  const size_t *chunk_offsets = get_chunk_offsets(ctx, join_column, offsets_deps);
+  auto count_matches_func =
+      [&ctx, hash_entry_count, count_buff = buff + hash_entry_count,
+       invalid_slot_val, join_column, type_info, chunk_offsets,
+       bloom_filter](const std::vector<sycl::event> &deps) {
+        return count_matches(ctx, count_buff, hash_entry_count,
+                             invalid_slot_val, join_column, type_info,
+                             chunk_offsets, bloom_filter, deps);
+      };
+
+  auto fill_row_ids_func = [&ctx, buff, hash_entry_count, invalid_slot_val,
+                            join_column, type_info,
+                            chunk_offsets](const std::vector<sycl::event> &deps) {
+    return fill_row_ids(ctx, buff, hash_entry_count, invalid_slot_val,
+                        join_column, type_info, chunk_offsets, deps);
+  };
+
+  return fill_one_to_many_hash_table_on_device_impl(
+      ctx, buff, hash_entry_count, invalid_slot_val, join_column, type_info,
+      count_matches_func, fill_row_ids_func, offsets_deps);
+}
+
+template <typename ROW_ID>
+sycl::event fill_one_to_many_hash_table_on_l0_async(
+    ExecutionContext &ctx, ROW_ID *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const JoinColumn &join_column,
+    const JoinColumnTypeInfo &type_info, const BloomFilter bloom_filter,
+    HashTableStats *stats, const std::vector<sycl::event> &deps) {
+  auto filled = fill_one_to_many_hash_table_on_l0_async(
+      ctx, buff, hash_entry_info, invalid_slot_val, join_column, type_info,
+      bloom_filter, deps);
+  if (!stats) {
+    return filled;
+  }
+  auto stats_reset = init_hash_table_stats_on_l0_async(ctx, stats, {filled});
+  return compute_one_to_many_stats_on_l0_async(
+      ctx, buff, hash_entry_info.hash_entry_count, stats, {stats_reset});
+}
+
+template <typename ROW_ID>
+sycl::event fill_one_to_many_hash_table_on_l0_async(
+    ExecutionContext &ctx, ROW_ID *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const JoinColumn &join_column,
+    const JoinColumnTypeInfo &type_info,
+    const std::vector<sycl::event> &deps) {
+  return fill_one_to_many_hash_table_on_l0_async(ctx, buff, hash_entry_info,
+                                                 invalid_slot_val, join_column,
+                                                 type_info, BloomFilter{}, deps);
+}
+
+template <typename ROW_ID>
+void fill_one_to_many_hash_table_on_l0(ExecutionContext &ctx, ROW_ID *buff,
                                        const HashEntryInfo hash_entry_info,
                                        const int32_t invalid_slot_val,
                                        const JoinColumn &join_column,
                                        const JoinColumnTypeInfo &type_info) {
-  auto hash_entry_count = hash_entry_info.hash_entry_count;
-  auto count_matches_func = [hash_entry_count,
-                             count_buff = buff + hash_entry_count,
-                             invalid_slot_val, join_column, type_info] {
-    count_matches(count_buff, invalid_slot_val, join_column, type_info);
-  };
-
-  auto fill_row_ids_func = [buff, hash_entry_count, invalid_slot_val,
-                            join_column, type_info] {
-    fill_row_ids(buff, hash_entry_count, invalid_slot_val, join_column,
-                 type_info);
-  };
+  fill_one_to_many_hash_table_on_l0_async(ctx, buff, hash_entry_info,
+                                          invalid_slot_val, join_column,
+                                          type_info, {})
+      .wait();
+}
 
-  fill_one_to_many_hash_table_on_device_impl(
-      buff, hash_entry_count, invalid_slot_val, join_column, type_info,
-      count_matches_func, fill_row_ids_func);
+void fill_one_to_many_hash_table_on_l0(int32_t *buff,
+                                       const HashEntryInfo hash_entry_info,
+                                       const int32_t invalid_slot_val,
+                                       const JoinColumn &join_column,
+                                       const JoinColumnTypeInfo &type_info) {
+  fill_one_to_many_hash_table_on_l0(ExecutionContext::get_default(), buff,
+                                    hash_entry_info, invalid_slot_val,
+                                    join_column, type_info);
 }
 
-void fill_one_to_many_hash_table_on_l0_bucketized(
-    int32_t *buff, const HashEntryInfo hash_entry_info,
+template <typename ROW_ID>
+sycl::event fill_one_to_many_hash_table_on_l0_bucketized_async(
+    ExecutionContext &ctx, ROW_ID *buff, const HashEntryInfo hash_entry_info,
     const int32_t invalid_slot_val, const JoinColumn &join_column,
-    const JoinColumnTypeInfo &type_info) {
+    const JoinColumnTypeInfo &type_info,
+    const BloomFilter bloom_filter,
+    const std::vector<sycl::event> &deps) {
   auto hash_entry_count = hash_entry_info.getNormalizedHashEntryCount();
+  // Shared by the counting and the filling pass.
+  std::vector<sycl::event> offsets_deps = deps;
+  const size_t *chunk_offsets = get_chunk_offsets(ctx, join_column, offsets_deps);
   auto count_matches_func =
-      [count_buff = buff + hash_entry_count, invalid_slot_val, join_column,
-       type_info, bucket_normalization = hash_entry_info.bucket_normalization] {
-        count_matches_bucketized(count_buff, invalid_slot_val, join_column,
-                                 type_info, bucket_normalization);
+      [&ctx, hash_entry_count, count_buff = buff + hash_entry_count,
+       invalid_slot_val, join_column, type_info,
+       bucket_normalization = hash_entry_info.bucket_normalization,
+       chunk_offsets, bloom_filter](const std::vector<sycl::event> &deps) {
+        return count_matches_bucketized(ctx, count_buff, hash_entry_count,
+                                        invalid_slot_val, join_column,
+                                        type_info,
+                                        bucket_normalization, chunk_offsets,
+                                        bloom_filter, deps);
       };
 
   auto fill_row_ids_func =
-      [buff, hash_entry_count = hash_entry_info.getNormalizedHashEntryCount(),
+      [&ctx, buff,
+       hash_entry_count = hash_entry_info.getNormalizedHashEntryCount(),
        invalid_slot_val, join_column, type_info,
-       bucket_normalization = hash_entry_info.bucket_normalization] {
-        fill_row_ids_bucketized(buff, hash_entry_count, invalid_slot_val,
-                                join_column, type_info, bucket_normalization);
+       bucket_normalization = hash_entry_info.bucket_normalization,
+       chunk_offsets](const std::vector<sycl::event> &deps) {
+        return fill_row_ids_bucketized(ctx, buff, hash_entry_count,
+                                       invalid_slot_val, join_column,
+                                       type_info, bucket_normalization,
+                                       chunk_offsets, deps);
       };
 
-  fill_one_to_many_hash_table_on_device_impl(
-      buff, hash_entry_count, invalid_slot_val, join_column, type_info,
-      count_matches_func, fill_row_ids_func);
+  return fill_one_to_many_hash_table_on_device_impl(
+      ctx, buff, hash_entry_count, invalid_slot_val, join_column, type_info,
+      count_matches_func, fill_row_ids_func, offsets_deps);
+}
+
+template <typename ROW_ID>
+sycl::event fill_one_to_many_hash_table_on_l0_bucketized_async(
+    ExecutionContext &ctx, ROW_ID *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const JoinColumn &join_column,
+    const JoinColumnTypeInfo &type_info, const BloomFilter bloom_filter,
+    HashTableStats *stats, const std::vector<sycl::event> &deps) {
+  auto filled = fill_one_to_many_hash_table_on_l0_bucketized_async(
+      ctx, buff, hash_entry_info, invalid_slot_val, join_column, type_info,
+      bloom_filter, deps);
+  if (!stats) {
+    return filled;
+  }
+  auto stats_reset = init_hash_table_stats_on_l0_async(ctx, stats, {filled});
+  return compute_one_to_many_stats_on_l0_async(
+      ctx, buff, hash_entry_info.getNormalizedHashEntryCount(), stats,
+      {stats_reset});
+}
+
+template <typename ROW_ID>
+sycl::event fill_one_to_many_hash_table_on_l0_bucketized_async(
+    ExecutionContext &ctx, ROW_ID *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const JoinColumn &join_column,
+    const JoinColumnTypeInfo &type_info,
+    const std::vector<sycl::event> &deps) {
+  return fill_one_to_many_hash_table_on_l0_bucketized_async(
+      ctx, buff, hash_entry_info, invalid_slot_val, join_column, type_info,
+      BloomFilter{}, deps);
+}
+
+template <typename ROW_ID>
+void fill_one_to_many_hash_table_on_l0_bucketized(
+    ExecutionContext &ctx, ROW_ID *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const JoinColumn &join_column,
+    const JoinColumnTypeInfo &type_info) {
+  fill_one_to_many_hash_table_on_l0_bucketized_async(
+      ctx, buff, hash_entry_info, invalid_slot_val, join_column, type_info, {})
+      .wait();
+}
+
+void fill_one_to_many_hash_table_on_l0_bucketized(
+    int32_t *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const JoinColumn &join_column,
+    const JoinColumnTypeInfo &type_info) {
+  fill_one_to_many_hash_table_on_l0_bucketized(
+      ExecutionContext::get_default(), buff, hash_entry_info,
+      invalid_slot_val, join_column, type_info);
 }
+
+sycl::event build_hash_join_buff_bucketized_sharded_on_l0_async(
+    MultiDeviceContext &mctx, int32_t *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const JoinColumn join_column, const JoinColumnTypeInfo type_info,
+    int *dev_err_buff, const std::vector<sycl::event> &deps) {
+  const size_t shard_count = mctx.get_device_count();
+  const int64_t slot_count = hash_entry_info.getNormalizedHashEntryCount();
+  const int64_t bucket_normalization = hash_entry_info.bucket_normalization;
+  auto err_reset = fill_buff_async(mctx.get_device_context(0),
+                                   "reset_err_buff", dev_err_buff, 0, 1, deps);
+  // The shards are disjoint slices of buff, initialized by their devices
+  std::vector<sycl::event> initialized{err_reset};
+  for (size_t shard = 0; shard < shard_count; ++shard) {
+    const auto shard_slots = get_perfect_hash_shard(slot_count, shard, shard_count);
+    if (shard_slots.get_slot_count()) {
+      initialized.push_back(init_hash_join_buff_on_l0_async(
+          mctx.get_device_context(shard), buff + shard_slots.slot_begin,
+          shard_slots.get_slot_count(), invalid_slot_val, {err_reset}));
+    }
+  }
+  if (!mctx.has_shared_atomics()) {
+    // The atomics of a device may not see those of the others on shared
+    // memory: the devices exchange their rows (ShardExchange.h), then every
+    // device fills the slice of its shard only, with device scope atomics
+    const int64_t min_val = type_info.min_val;
+    const int64_t shard_slot_count =
+        get_perfect_hash_shard_slot_count(slot_count, shard_count);
+    std::vector<sycl::event> exchanged = initialized;
+    const auto exchange = dispatch_column_decoder(
+        type_info.column_type, type_info.elem_sz, [&](auto decoder) {
+          auto get_shard_keys = [&](ExecutionContext &ctx,
+                                    std::vector<sycl::event> &deps) {
+            const size_t *chunk_offsets =
+                get_chunk_offsets(ctx, join_column, deps);
+            return JoinColumnShardKeys<decltype(decoder)>{
+                join_column, type_info, chunk_offsets, decoder};
+          };
+          auto get_shard = [=](const int64_t *key) -> int64_t {
+            const int64_t slot = (*key - min_val) / bucket_normalization;
+            return slot >= 0 && slot < slot_count ? slot / shard_slot_count
+                                                  : -1;
+          };
+          return exchange_shard_rows<int64_t>(mctx, get_shard_keys, 1,
+                                              join_column.num_elems,
+                                              get_shard, nullptr, exchanged);
+        });
+    const int64_t launch_row_count =
+        get_shard_launch_row_count(join_column.num_elems, shard_count);
+    const KernelInfo info{
+        for_semi_join ? "perfect_fill_semi_join" : "perfect_fill_one_to_one",
+        launch_row_count, 0,
+        launch_row_count *
+            static_cast<int64_t>(sizeof(int64_t) + 2 * sizeof(int32_t))};
+    std::vector<sycl::event> built;
+    for (size_t shard = 0; shard < shard_count; ++shard) {
+      built.push_back(submit_shard_exchange_rows(
+          mctx.get_device_context(shard), info, exchange, shard,
+          launch_row_count, exchanged,
+          [=](const int32_t row_id, const int64_t *key) {
+            int32_t *entry_ptr =
+                buff + (*key - min_val) / bucket_normalization;
+            const int err =
+                for_semi_join
+                    ? fill_hashtable_for_semi_join<int32_t>(row_id, entry_ptr,
+                                                            invalid_slot_val)
+                    : fill_one_to_one_hashtable<int32_t>(row_id, entry_ptr,
+                                                         invalid_slot_val);
+            if (err) {
+              sycl::atomic_ref<int, sycl::memory_order::relaxed,
+                               sycl::memory_scope::device>
+                  atomic_dev_err(*dev_err_buff);
+              atomic_dev_err.store(-1);
+            }
+          }));
+    }
+    return mctx.join(built);
+  }
+  // buff is shared memory: every device fills the slots of all the shards
+  // from its rows, with system scope atomics
+  auto hashtable_filling_func = [=](auto elem, size_t index) {
+    int32_t *entry_ptr =
+        buff + (elem - type_info.min_val) / bucket_normalization;
+    return for_semi_join
+               ? fill_hashtable_for_semi_join<int32_t,
+                                              sycl::memory_scope::system>(
+                     index, entry_ptr, invalid_slot_val)
+               : fill_one_to_one_hashtable<int32_t, sycl::memory_scope::system>(
+                     index, entry_ptr, invalid_slot_val);
+  };
+  std::vector<sycl::event> built = initialized;
+  for (size_t device = 0; device < shard_count; ++device) {
+    const auto rows =
+        get_shard_row_range(join_column.num_elems, device, shard_count);
+    if (!rows.size()) {
+      continue;
+    }
+    built.push_back(fill_hash_join_buff_impl(
+        mctx.get_device_context(device),
+        for_semi_join ? "perfect_fill_semi_join" : "perfect_fill_one_to_one",
+        buff, invalid_slot_val, join_column, type_info, rows.begin, rows.end,
+        nullptr, 0, hashtable_filling_func, BloomFilter{}, dev_err_buff,
+        initialized));
+  }
+  return mctx.join(built);
+}
+
+sycl::event fill_one_to_many_hash_table_sharded_on_l0_async(
+    MultiDeviceContext &mctx, int32_t *const *shard_buffs,
+    const HashEntryInfo hash_entry_info, const int32_t invalid_slot_val,
+    const JoinColumn &join_column, const JoinColumnTypeInfo &type_info,
+    const std::vector<sycl::event> &deps) {
+  const size_t shard_count = mctx.get_device_count();
+  const int64_t slot_count = hash_entry_info.getNormalizedHashEntryCount();
+  const int64_t bucket_normalization = hash_entry_info.bucket_normalization;
+  const int64_t min_val = type_info.min_val;
+  const int64_t shard_slot_count =
+      get_perfect_hash_shard_slot_count(slot_count, shard_count);
+  // Every device reads its rows once and hands them over to the devices of
+  // their shards
+  std::vector<sycl::event> exchanged = deps;
+  const auto exchange = dispatch_column_decoder(
+      type_info.column_type, type_info.elem_sz, [&](auto decoder) {
+        auto get_shard_keys = [&](ExecutionContext &ctx,
+                                  std::vector<sycl::event> &deps) {
+          const size_t *chunk_offsets =
+              get_chunk_offsets(ctx, join_column, deps);
+          return JoinColumnShardKeys<decltype(decoder)>{
+              join_column, type_info, chunk_offsets, decoder};
+        };
+        auto get_shard = [=](const int64_t *key) -> int64_t {
+          const int64_t slot = (*key - min_val) / bucket_normalization;
+          return slot >= 0 && slot < slot_count ? slot / shard_slot_count : -1;
+        };
+        return exchange_shard_rows<int64_t>(mctx, get_shard_keys, 1,
+                                            join_column.num_elems, get_shard,
+                                            nullptr, exchanged);
+      });
+  const int64_t launch_row_count =
+      get_shard_launch_row_count(join_column.num_elems, shard_count);
+  std::vector<sycl::event> built;
+  for (size_t shard = 0; shard < shard_count; ++shard) {
+    auto &ctx = mctx.get_device_context(shard);
+    const auto shard_slots = get_perfect_hash_shard(slot_count, shard, shard_count);
+    const int64_t shard_entry_count = shard_slots.get_slot_count();
+    int32_t *buff = shard_buffs[shard];
+    int32_t *pos_buff = buff;
+    int32_t *count_buff = buff + shard_entry_count;
+    int32_t *id_buff = count_buff + shard_entry_count;
+    auto get_slot = [min_val, bucket_normalization,
+                     slot_begin = shard_slots.slot_begin](const int64_t *key) {
+      return (*key - min_val) / bucket_normalization - slot_begin;
+    };
+    const ShardExchangeSlots<int64_t, decltype(get_slot)> slots{
+        exchange, shard, launch_row_count, get_slot};
+    auto add_count = [count_buff](const int64_t slot, const int64_t count) {
+      sycl::atomic_ref<int32_t, sycl::memory_order::relaxed,
+                       sycl::memory_scope::device>
+          atomic_slot_entry(count_buff[slot]);
+      return static_cast<int64_t>(
+          atomic_slot_entry.fetch_add(static_cast<int32_t>(count)));
+    };
+    auto write_row_id = [pos_buff, id_buff](const int64_t row_index,
+                                            const int64_t slot,
+                                            const int64_t position) {
+      id_buff[pos_buff[slot] + position] = static_cast<int32_t>(row_index);
+    };
+    auto count_matches_func = [&ctx, &slots, shard_entry_count, add_count](
+                                  const std::vector<sycl::event> &deps) {
+      const KernelInfo info{"perfect_count_matches", slots.launch_row_count, 0,
+                            slots.launch_row_count *
+                                static_cast<int64_t>(sizeof(int64_t) +
+                                                     2 * sizeof(int32_t))};
+      return submit_slot_counts(ctx, info, slots, shard_entry_count,
+                                add_count, deps);
+    };
+    auto fill_row_ids_func = [&ctx, &slots, shard_entry_count, add_count,
+                              write_row_id](
+                                 const std::vector<sycl::event> &deps) {
+      const KernelInfo info{
+          "perfect_fill_row_ids", slots.launch_row_count, shard_entry_count,
+          slots.launch_row_count *
+              static_cast<int64_t>(sizeof(int64_t) + 4 * sizeof(int32_t))};
+      return submit_slot_reservations(ctx, info, slots, add_count,
+                                      write_row_id, deps);
+    };
+    built.push_back(fill_one_to_many_hash_table_on_device_impl(
+        ctx, buff, shard_entry_count, invalid_slot_val, join_column, type_info,
+        count_matches_func, fill_row_ids_func, exchanged));
+  }
+  return mctx.join(built);
+}
+
+void build_hash_join_buff_bucketized_sharded_on_l0(
+    MultiDeviceContext &mctx, int32_t *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const JoinColumn join_column, const JoinColumnTypeInfo type_info,
+    int *dev_err_buff) {
+  build_hash_join_buff_bucketized_sharded_on_l0_async(
+      mctx, buff, hash_entry_info, invalid_slot_val, for_semi_join,
+      join_column, type_info, dev_err_buff, {})
+      .wait();
+}
+
+void fill_one_to_many_hash_table_sharded_on_l0(
+    MultiDeviceContext &mctx, int32_t *const *shard_buffs,
+    const HashEntryInfo hash_entry_info, const int32_t invalid_slot_val,
+    const JoinColumn &join_column, const JoinColumnTypeInfo &type_info) {
+  fill_one_to_many_hash_table_sharded_on_l0_async(
+      mctx, shard_buffs, hash_entry_info, invalid_slot_val, join_column,
+      type_info, {})
+      .wait();
+}
+
+template sycl::event fill_hash_join_buff_bucketized_on_l0_async<int32_t>(
+    ExecutionContext &, int32_t *, const int32_t, const bool, const JoinColumn,
+    const JoinColumnTypeInfo, const int32_t *, const int32_t, const int64_t,
+    int *, const std::vector<sycl::event> &);
+template sycl::event build_hash_join_buff_bucketized_on_l0_async<int32_t>(
+    ExecutionContext &, int32_t *, const HashEntryInfo, const int32_t,
+    const bool, const JoinColumn, const JoinColumnTypeInfo, const int32_t *,
+    const int32_t, const bool, int *, const std::vector<sycl::event> &);
+template sycl::event
+fill_one_to_many_hash_table_on_l0_bucketized_async<int32_t>(
+    ExecutionContext &, int32_t *, const HashEntryInfo, const int32_t,
+    const JoinColumn &, const JoinColumnTypeInfo &,
+    const std::vector<sycl::event> &);
+template sycl::event fill_one_to_many_hash_table_on_l0_async<int32_t>(
+    ExecutionContext &, int32_t *, const HashEntryInfo, const int32_t,
+    const JoinColumn &, const JoinColumnTypeInfo &,
+    const std::vector<sycl::event> &);
+template sycl::event fill_hash_join_buff_bucketized_on_l0_async<int32_t>(
+    ExecutionContext &, int32_t *, const int32_t, const bool, const JoinColumn,
+    const JoinColumnTypeInfo, const int32_t *, const int32_t, const int64_t,
+    int *, const BloomFilter, const std::vector<sycl::event> &);
+template sycl::event build_hash_join_buff_bucketized_on_l0_async<int32_t>(
+    ExecutionContext &, int32_t *, const HashEntryInfo, const int32_t,
+    const bool, const JoinColumn, const JoinColumnTypeInfo, const int32_t *,
+    const int32_t, const bool, int *, const BloomFilter,
+    const std::vector<sycl::event> &);
+template sycl::event
+fill_one_to_many_hash_table_on_l0_bucketized_async<int32_t>(
+    ExecutionContext &, int32_t *, const HashEntryInfo, const int32_t,
+    const JoinColumn &, const JoinColumnTypeInfo &, const BloomFilter,
+    const std::vector<sycl::event> &);
+template sycl::event fill_one_to_many_hash_table_on_l0_async<int32_t>(
+    ExecutionContext &, int32_t *, const HashEntryInfo, const int32_t,
+    const JoinColumn &, const JoinColumnTypeInfo &, const BloomFilter,
+    const std::vector<sycl::event> &);
+template sycl::event build_hash_join_buff_bucketized_on_l0_async<int32_t>(
+    ExecutionContext &, int32_t *, const HashEntryInfo, const int32_t,
+    const bool, const JoinColumn, const JoinColumnTypeInfo, const int32_t *,
+    const int32_t, const bool, int *, const BloomFilter, HashTableStats *,
+    const std::vector<sycl::event> &);
+template sycl::event
+fill_one_to_many_hash_table_on_l0_bucketized_async<int32_t>(
+    ExecutionContext &, int32_t *, const HashEntryInfo, const int32_t,
+    const JoinColumn &, const JoinColumnTypeInfo &, const BloomFilter,
+    HashTableStats *, const std::vector<sycl::event> &);
+template sycl::event fill_one_to_many_hash_table_on_l0_async<int32_t>(
+    ExecutionContext &, int32_t *, const HashEntryInfo, const int32_t,
+    const JoinColumn &, const JoinColumnTypeInfo &, const BloomFilter,
+    HashTableStats *, const std::vector<sycl::event> &);
+template void fill_hash_join_buff_bucketized_on_l0<int32_t>(
+    ExecutionContext &, int32_t *, const int32_t, const bool, const JoinColumn,
+    const JoinColumnTypeInfo, const int32_t *, const int32_t, const int64_t,
+    int *);
+template void build_hash_join_buff_bucketized_on_l0<int32_t>(
+    ExecutionContext &, int32_t *, const HashEntryInfo, const int32_t,
+    const bool, const JoinColumn, const JoinColumnTypeInfo, const int32_t *,
+    const int32_t, const bool, int *);
+template void fill_one_to_many_hash_table_on_l0_bucketized<int32_t>(
+    ExecutionContext &, int32_t *, const HashEntryInfo, const int32_t,
+    const JoinColumn &, const JoinColumnTypeInfo &);
+template void fill_one_to_many_hash_table_on_l0<int32_t>(
+    ExecutionContext &, int32_t *, const HashEntryInfo, const int32_t,
+    const JoinColumn &, const JoinColumnTypeInfo &);
+template sycl::event fill_hash_join_buff_bucketized_on_l0_async<int64_t>(
+    ExecutionContext &, int64_t *, const int32_t, const bool, const JoinColumn,
+    const JoinColumnTypeInfo, const int32_t *, const int32_t, const int64_t,
+    int *, const std::vector<sycl::event> &);
+template sycl::event build_hash_join_buff_bucketized_on_l0_async<int64_t>(
+    ExecutionContext &, int64_t *, const HashEntryInfo, const int32_t,
+    const bool, const JoinColumn, const JoinColumnTypeInfo, const int32_t *,
+    const int32_t, const bool, int *, const std::vector<sycl::event> &);
+template sycl::event
+fill_one_to_many_hash_table_on_l0_bucketized_async<int64_t>(
+    ExecutionContext &, int64_t *, const HashEntryInfo, const int32_t,
+    const JoinColumn &, const JoinColumnTypeInfo &,
+    const std::vector<sycl::event> &);
+template sycl::event fill_one_to_many_hash_table_on_l0_async<int64_t>(
+    ExecutionContext &, int64_t *, const HashEntryInfo, const int32_t,
+    const JoinColumn &, const JoinColumnTypeInfo &,
+    const std::vector<sycl::event> &);
+template sycl::event fill_hash_join_buff_bucketized_on_l0_async<int64_t>(
+    ExecutionContext &, int64_t *, const int32_t, const bool, const JoinColumn,
+    const JoinColumnTypeInfo, const int32_t *, const int32_t, const int64_t,
+    int *, const BloomFilter, const std::vector<sycl::event> &);
+template sycl::event build_hash_join_buff_bucketized_on_l0_async<int64_t>(
+    ExecutionContext &, int64_t *, const HashEntryInfo, const int32_t,
+    const bool, const JoinColumn, const JoinColumnTypeInfo, const int32_t *,
+    const int32_t, const bool, int *, const BloomFilter,
+    const std::vector<sycl::event> &);
+template sycl::event
+fill_one_to_many_hash_table_on_l0_bucketized_async<int64_t>(
+    ExecutionContext &, int64_t *, const HashEntryInfo, const int32_t,
+    const JoinColumn &, const JoinColumnTypeInfo &, const BloomFilter,
+    const std::vector<sycl::event> &);
+template sycl::event fill_one_to_many_hash_table_on_l0_async<int64_t>(
+    ExecutionContext &, int64_t *, const HashEntryInfo, const int32_t,
+    const JoinColumn &, const JoinColumnTypeInfo &, const BloomFilter,
+    const std::vector<sycl::event> &);
+template sycl::event build_hash_join_buff_bucketized_on_l0_async<int64_t>(
+    ExecutionContext &, int64_t *, const HashEntryInfo, const int32_t,
+    const bool, const JoinColumn, const JoinColumnTypeInfo, const int32_t *,
+    const int32_t, const bool, int *, const BloomFilter, HashTableStats *,
+    const std::vector<sycl::event> &);
+template sycl::event
+fill_one_to_many_hash_table_on_l0_bucketized_async<int64_t>(
+    ExecutionContext &, int64_t *, const HashEntryInfo, const int32_t,
+    const JoinColumn &, const JoinColumnTypeInfo &, const BloomFilter,
+    HashTableStats *, const std::vector<sycl::event> &);
+template sycl::event fill_one_to_many_hash_table_on_l0_async<int64_t>(
+    ExecutionContext &, int64_t *, const HashEntryInfo, const int32_t,
+    const JoinColumn &, const JoinColumnTypeInfo &, const BloomFilter,
+    HashTableStats *, const std::vector<sycl::event> &);
+template void fill_hash_join_buff_bucketized_on_l0<int64_t>(
+    ExecutionContext &, int64_t *, const int32_t, const bool, const JoinColumn,
+    const JoinColumnTypeInfo, const int32_t *, const int32_t, const int64_t,
+    int *);
+template void build_hash_join_buff_bucketized_on_l0<int64_t>(
+    ExecutionContext &, int64_t *, const HashEntryInfo, const int32_t,
+    const bool, const JoinColumn, const JoinColumnTypeInfo, const int32_t *,
+    const int32_t, const bool, int *);
+template void fill_one_to_many_hash_table_on_l0_bucketized<int64_t>(
+    ExecutionContext &, int64_t *, const HashEntryInfo, const int32_t,
+    const JoinColumn &, const JoinColumnTypeInfo &);
+template void fill_one_to_many_hash_table_on_l0<int64_t>(
+    ExecutionContext &, int64_t *, const HashEntryInfo, const int32_t,
+    const JoinColumn &, const JoinColumnTypeInfo &);
@@ -1,8 +1,200 @@
 #ifndef PERFECT_HT_BUILDER_H__
 #define PERFECT_HT_BUILDER_H__
 
+#include <CL/sycl.hpp>
+#include <vector>
+
 #include "../CommonDecls.h"
+#include "../Shared/BloomFilter.h"
+#include "../Shared/HashTableStats.h"
+
+// Asynchronous variants: the commands are enqueued after deps and the
+// returned event completes when the table is built. The inputs (including
+// the chunk arrays of the join columns) must stay alive until then.
+// ROW_ID is the element type of the table, int32_t or int64_t when the build
+// side has more than INT32_MAX rows (dispatch_row_id_type in Shared.h).
+template <typename ROW_ID>
+sycl::event
+init_hash_join_buff_on_l0_async(ExecutionContext &ctx, ROW_ID *groups_buffer,
+                                const int64_t hash_entry_count,
+                                const int32_t invalid_slot_val,
+                                const std::vector<sycl::event> &deps);
+
+template <typename ROW_ID>
+sycl::event fill_hash_join_buff_bucketized_on_l0_async(
+    ExecutionContext &ctx, ROW_ID *buff, const int32_t invalid_slot_val,
+    const bool for_semi_join, const JoinColumn join_column,
+    const JoinColumnTypeInfo type_info,
+    const int32_t *sd_inner_to_outer_translation_map,
+    const int32_t min_inner_elem, const int64_t bucket_normalization,
+    int *dev_err_buff, const std::vector<sycl::event> &deps);
+
+// Builds a one-to-one table in one call: resets dev_err_buff, initializes
+// the normalized entries of buff to invalid_slot_val and fills it, without
+// host synchronization in between. Pass buff_is_initialized if buff already
+// holds invalid_slot_val everywhere (e.g. recycled from an initialized pool)
+// to skip the initialization pass over the table.
+template <typename ROW_ID>
+sycl::event build_hash_join_buff_bucketized_on_l0_async(
+    ExecutionContext &ctx, ROW_ID *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const JoinColumn join_column, const JoinColumnTypeInfo type_info,
+    const int32_t *sd_inner_to_outer_translation_map,
+    const int32_t min_inner_elem, const bool buff_is_initialized,
+    int *dev_err_buff, const std::vector<sycl::event> &deps);
+
+template <typename ROW_ID>
+sycl::event fill_one_to_many_hash_table_on_l0_bucketized_async(
+    ExecutionContext &ctx, ROW_ID *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const JoinColumn &join_column,
+    const JoinColumnTypeInfo &type_info,
+    const std::vector<sycl::event> &deps);
+
+template <typename ROW_ID>
+sycl::event fill_one_to_many_hash_table_on_l0_async(
+    ExecutionContext &ctx, ROW_ID *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const JoinColumn &join_column,
+    const JoinColumnTypeInfo &type_info,
+    const std::vector<sycl::event> &deps);
+
+// Same, also inserting the build keys into bloom_filter (initialized with
+// init_bloom_filter_on_l0_async) for filter_join_column_on_l0_async.
+template <typename ROW_ID>
+sycl::event fill_hash_join_buff_bucketized_on_l0_async(
+    ExecutionContext &ctx, ROW_ID *buff, const int32_t invalid_slot_val,
+    const bool for_semi_join, const JoinColumn join_column,
+    const JoinColumnTypeInfo type_info,
+    const int32_t *sd_inner_to_outer_translation_map,
+    const int32_t min_inner_elem, const int64_t bucket_normalization,
+    int *dev_err_buff, const BloomFilter bloom_filter,
+    const std::vector<sycl::event> &deps);
+
+template <typename ROW_ID>
+sycl::event build_hash_join_buff_bucketized_on_l0_async(
+    ExecutionContext &ctx, ROW_ID *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const JoinColumn join_column, const JoinColumnTypeInfo type_info,
+    const int32_t *sd_inner_to_outer_translation_map,
+    const int32_t min_inner_elem, const bool buff_is_initialized,
+    int *dev_err_buff, const BloomFilter bloom_filter,
+    const std::vector<sycl::event> &deps);
+
+template <typename ROW_ID>
+sycl::event fill_one_to_many_hash_table_on_l0_bucketized_async(
+    ExecutionContext &ctx, ROW_ID *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const JoinColumn &join_column,
+    const JoinColumnTypeInfo &type_info, const BloomFilter bloom_filter,
+    const std::vector<sycl::event> &deps);
+
+template <typename ROW_ID>
+sycl::event fill_one_to_many_hash_table_on_l0_async(
+    ExecutionContext &ctx, ROW_ID *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const JoinColumn &join_column,
+    const JoinColumnTypeInfo &type_info, const BloomFilter bloom_filter,
+    const std::vector<sycl::event> &deps);
+
+// Same, also filling stats (HashTableStats.h), which is reset first: the
+// occupied slots of the one-to-one table, or the bucket sizes of the
+// one-to-many table.
+template <typename ROW_ID>
+sycl::event build_hash_join_buff_bucketized_on_l0_async(
+    ExecutionContext &ctx, ROW_ID *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const JoinColumn join_column, const JoinColumnTypeInfo type_info,
+    const int32_t *sd_inner_to_outer_translation_map,
+    const int32_t min_inner_elem, const bool buff_is_initialized,
+    int *dev_err_buff, const BloomFilter bloom_filter, HashTableStats *stats,
+    const std::vector<sycl::event> &deps);
+
+template <typename ROW_ID>
+sycl::event fill_one_to_many_hash_table_on_l0_bucketized_async(
+    ExecutionContext &ctx, ROW_ID *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const JoinColumn &join_column,
+    const JoinColumnTypeInfo &type_info, const BloomFilter bloom_filter,
+    HashTableStats *stats, const std::vector<sycl::event> &deps);
+
+template <typename ROW_ID>
+sycl::event fill_one_to_many_hash_table_on_l0_async(
+    ExecutionContext &ctx, ROW_ID *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const JoinColumn &join_column,
+    const JoinColumnTypeInfo &type_info, const BloomFilter bloom_filter,
+    HashTableStats *stats, const std::vector<sycl::event> &deps);
+
+// Sharded builds over the devices of mctx (MultiDeviceContext.h), split by
+// key range (Sharding.h): every device reads the rows of its
+// get_shard_row_range() only. The buffers, the column chunks and dev_err_buff
+// must be USM allocations of the context of mctx. The returned event is on
+// the queue of the first device.
+
+// Builds the one-to-one table buff, which must be shared memory: every device
+// initializes its slice of it, then inserts its rows into any slice with
+// system scope atomics. That needs usm_atomic_shared_allocations on all the
+// devices (MultiDeviceContext::has_shared_atomics()); without it the devices
+// exchange their rows first and fill the slices of their shards only.
+sycl::event build_hash_join_buff_bucketized_sharded_on_l0_async(
+    MultiDeviceContext &mctx, int32_t *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const JoinColumn join_column, const JoinColumnTypeInfo type_info,
+    int *dev_err_buff, const std::vector<sycl::event> &deps);
 
+// Builds one one-to-many table per shard: the devices exchange their rows
+// (ShardExchange.h), then shard_buffs[s] receives the pos|count|row ids of
+// get_perfect_hash_shard(..., s, ...), sized for its slots and all the rows.
+sycl::event fill_one_to_many_hash_table_sharded_on_l0_async(
+    MultiDeviceContext &mctx, int32_t *const *shard_buffs,
+    const HashEntryInfo hash_entry_info, const int32_t invalid_slot_val,
+    const JoinColumn &join_column, const JoinColumnTypeInfo &type_info,
+    const std::vector<sycl::event> &deps);
+
+// Blocking variants
+template <typename ROW_ID>
+void init_hash_join_buff_on_l0(ExecutionContext &ctx, ROW_ID *groups_buffer,
+                               const int64_t hash_entry_count,
+                               const int32_t invalid_slot_val);
+
+template <typename ROW_ID>
+void fill_hash_join_buff_bucketized_on_l0(
+    ExecutionContext &ctx, ROW_ID *buff, const int32_t invalid_slot_val,
+    const bool for_semi_join, const JoinColumn join_column,
+    const JoinColumnTypeInfo type_info,
+    const int32_t *sd_inner_to_outer_translation_map,
+    const int32_t min_inner_elem, const int64_t bucket_normalization,
+    int *dev_err_buff);
+
+template <typename ROW_ID>
+void build_hash_join_buff_bucketized_on_l0(
+    ExecutionContext &ctx, ROW_ID *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const JoinColumn join_column, const JoinColumnTypeInfo type_info,
+    const int32_t *sd_inner_to_outer_translation_map,
+    const int32_t min_inner_elem, const bool buff_is_initialized,
+    int *dev_err_buff);
+
+template <typename ROW_ID>
+void fill_one_to_many_hash_table_on_l0_bucketized(
+    ExecutionContext &ctx, ROW_ID *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const JoinColumn &join_column,
+    const JoinColumnTypeInfo &type_info);
+
+template <typename ROW_ID>
+void fill_one_to_many_hash_table_on_l0(ExecutionContext &ctx, ROW_ID *buff,
+                                       const HashEntryInfo hash_entry_info,
+                                       const int32_t invalid_slot_val,
+                                       const JoinColumn &join_column,
+                                       const JoinColumnTypeInfo &type_info);
+
+void build_hash_join_buff_bucketized_sharded_on_l0(
+    MultiDeviceContext &mctx, int32_t *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const JoinColumn join_column, const JoinColumnTypeInfo type_info,
+    int *dev_err_buff);
+
+void fill_one_to_many_hash_table_sharded_on_l0(
+    MultiDeviceContext &mctx, int32_t *const *shard_buffs,
+    const HashEntryInfo hash_entry_info, const int32_t invalid_slot_val,
+    const JoinColumn &join_column, const JoinColumnTypeInfo &type_info);
+
+// Same as above, on ExecutionContext::get_default()
 void init_hash_join_buff_on_l0(int32_t *groups_buffer,
                                const int64_t hash_entry_count,
                                const int32_t invalid_slot_val);
@@ -14,6 +206,14 @@ void fill_hash_join_buff_bucketized_on_l0(
     const int32_t min_inner_elem, const int64_t bucket_normalization,
     int *dev_err_buff);
 
+void build_hash_join_buff_bucketized_on_l0(
+    int32_t *buff, const HashEntryInfo hash_entry_info,
+    const int32_t invalid_slot_val, const bool for_semi_join,
+    const JoinColumn join_column, const JoinColumnTypeInfo type_info,
+    const int32_t *sd_inner_to_outer_translation_map,
+    const int32_t min_inner_elem, const bool buff_is_initialized,
+    int *dev_err_buff);
+
 void fill_one_to_many_hash_table_on_l0_bucketized(
     int32_t *buff, const HashEntryInfo hash_entry_info,
     const int32_t invalid_slot_val, const JoinColumn &join_column,
@@ -24,4 +224,4 @@ void fill_one_to_many_hash_table_on_l0(int32_t *buff,
                                        const int32_t invalid_slot_val,
                                        const JoinColumn &join_column,
                                        const JoinColumnTypeInfo &type_info);
-#endif // BASELINE_HT_BUILDER_H__
\ No newline at end of file
+#endif // BASELINE_HT_BUILDER_H__
@@ -1,59 +1,155 @@
 #ifndef PERFECT_HT_HELPER_H__
 #define PERFECT_HT_HELPER_H__
+#include <CL/sycl.hpp>
+#include <vector>
+
 #include "../CommonDecls.h"
+#include "../Shared/BloomFilter.h"
+#include "../Types.h"
 
-template <typename HASHTABLE_FILLING_FUNC>
-void fill_hash_join_buff_impl(int32_t *buff, const int32_t invalid_slot_val,
-                              const JoinColumn join_column,
-                              const JoinColumnTypeInfo type_info,
-                              const int32_t *sd_inner_to_outer_translation_map,
-                              const int32_t min_inner_elem,
-                              HASHTABLE_FILLING_FUNC filling_func,
-                              int *dev_err_buff);
-
-template <typename SLOT_SELECTOR>
-void count_matches_impl(int32_t *count_buff, const int32_t invalid_slot_val,
-                        const JoinColumn join_column,
-                        const JoinColumnTypeInfo type_info,
-                        SLOT_SELECTOR slot_selector);
-
-int fill_one_to_one_hashtable(size_t idx, int32_t *entry_ptr,
+template <typename T>
+inline T *get_hash_slot(T *buff, const int64_t key, const int64_t min_key) {
+  return buff + (key - min_key);
+}
+
+template <typename T>
+inline T *get_bucketized_hash_slot(T *buff, const int64_t key,
+                                   const int64_t min_key,
+                                   const int64_t bucket_normalization) {
+  return buff + (key - min_key) / bucket_normalization;
+}
+
+// Outer dictionary id of the inner string id elem, INVALID_STR_ID if the
+// string is not in the outer dictionary or out of the table range.
+inline int64_t map_str_id_to_outer_dict(
+    const int64_t elem, const int32_t min_inner_elem, const int64_t min_elem,
+    const int64_t max_elem, const int32_t *sd_inner_to_outer_translation_map) {
+  const int64_t outer_id =
+      sd_inner_to_outer_translation_map[elem - min_inner_elem];
+  if (outer_id < min_elem || outer_id > max_elem) {
+    return StringDictionary_INVALID_STR_ID;
+  }
+  return outer_id;
+}
+
+// Translates the value elem of a build row to its key for the one-to-one
+// fill, false if the row is skipped (a null without bitwise equality, or a
+// string that is not in the outer dictionary).
+inline bool get_one_to_one_fill_key(
+    int64_t &elem, const JoinColumnTypeInfo &type_info,
+    const int32_t *sd_inner_to_outer_translation_map,
+    const int32_t min_inner_elem) {
+  if (elem == type_info.null_val) {
+    if (!type_info.uses_bw_eq) {
+      return false;
+    }
+    elem = type_info.translated_null_val;
+  } else if (sd_inner_to_outer_translation_map) {
+    elem = map_str_id_to_outer_dict(elem, min_inner_elem, type_info.min_val,
+                                    type_info.max_val,
+                                    sd_inner_to_outer_translation_map);
+    if (elem == StringDictionary_INVALID_STR_ID) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// The helpers are templated on the row id type ROW_ID of the table: int32_t,
+// or int64_t for builds of more than INT32_MAX rows (see
+// dispatch_row_id_type).
+// Fills the table from the rows [row_begin, row_end) of join_column.
+template <typename ROW_ID, typename HASHTABLE_FILLING_FUNC>
+sycl::event fill_hash_join_buff_impl(
+    ExecutionContext &ctx, const char *kernel_name, ROW_ID *buff,
+    const int32_t invalid_slot_val, const JoinColumn join_column,
+    const JoinColumnTypeInfo type_info, const int64_t row_begin,
+    const int64_t row_end, const int32_t *sd_inner_to_outer_translation_map,
+    const int32_t min_inner_elem, HASHTABLE_FILLING_FUNC filling_func,
+    const BloomFilter bloom_filter, int *dev_err_buff,
+    const std::vector<sycl::event> &deps);
+
+template <typename ROW_ID, typename SLOT_SELECTOR>
+sycl::event count_matches_impl(ExecutionContext &ctx, ROW_ID *count_buff,
+                               const int64_t hash_entry_count,
+                               const int32_t invalid_slot_val,
+                               const JoinColumn join_column,
+                               const JoinColumnTypeInfo type_info,
+                               const size_t *chunk_offsets,
+                               const BloomFilter bloom_filter,
+                               SLOT_SELECTOR slot_selector,
+                               const std::vector<sycl::event> &deps);
+
+// SCOPE is system for a table that the devices of a sharded build fill
+// together.
+template <typename ROW_ID,
+          sycl::memory_scope SCOPE = sycl::memory_scope::device>
+int fill_one_to_one_hashtable(const size_t idx, ROW_ID *entry_ptr,
                               const int32_t invalid_slot_val);
 
-int fill_hashtable_for_semi_join(size_t idx, int32_t *entry_ptr,
+template <typename ROW_ID,
+          sycl::memory_scope SCOPE = sycl::memory_scope::device>
+int fill_hashtable_for_semi_join(const size_t idx, ROW_ID *entry_ptr,
                                  const int32_t invalid_slot_val);
 
-void count_matches(int32_t *count_buff, const int32_t invalid_slot_val,
-                   const JoinColumn join_column,
-                   const JoinColumnTypeInfo type_info);
+template <typename ROW_ID>
+sycl::event count_matches(ExecutionContext &ctx, ROW_ID *count_buff,
+                          const int64_t hash_entry_count,
+                          const int32_t invalid_slot_val,
+                          const JoinColumn join_column,
+                          const JoinColumnTypeInfo type_info,
+                          const size_t *chunk_offsets,
+                          const BloomFilter bloom_filter,
+                          const std::vector<sycl::event> &deps);
 
-template <typename SLOT_SELECTOR>
-void fill_row_ids_impl(int32_t *buff, const int64_t hash_entry_count,
-                       const int32_t invalid_slot_val,
-                       const JoinColumn join_column,
-                       const JoinColumnTypeInfo type_info,
-                       SLOT_SELECTOR slot_selector);
+template <typename ROW_ID, typename SLOT_SELECTOR>
+sycl::event fill_row_ids_impl(ExecutionContext &ctx, ROW_ID *buff,
+                              const int64_t hash_entry_count,
+                              const int32_t invalid_slot_val,
+                              const JoinColumn join_column,
+                              const JoinColumnTypeInfo type_info,
+                              const size_t *chunk_offsets,
+                              SLOT_SELECTOR slot_selector,
+                              const std::vector<sycl::event> &deps);
 
-void fill_row_ids(int32_t *buff, const int64_t hash_entry_count,
-                  const int32_t invalid_slot_val, const JoinColumn join_column,
-                  const JoinColumnTypeInfo type_info);
+template <typename ROW_ID>
+sycl::event fill_row_ids(ExecutionContext &ctx, ROW_ID *buff,
+                         const int64_t hash_entry_count,
+                         const int32_t invalid_slot_val,
+                         const JoinColumn join_column,
+                         const JoinColumnTypeInfo type_info,
+                         const size_t *chunk_offsets,
+                         const std::vector<sycl::event> &deps);
 
-template <typename COUNT_MATCHES_FUNCTOR, typename FILL_ROW_IDS_FUNCTOR>
-void fill_one_to_many_hash_table_on_device_impl(
-    int32_t *buff, const int64_t hash_entry_count,
+template <typename ROW_ID, typename COUNT_MATCHES_FUNCTOR,
+          typename FILL_ROW_IDS_FUNCTOR>
+sycl::event fill_one_to_many_hash_table_on_device_impl(
+    ExecutionContext &ctx, ROW_ID *buff, const int64_t hash_entry_count,
     const int32_t invalid_slot_val, const JoinColumn &join_column,
     const JoinColumnTypeInfo &type_info,
     COUNT_MATCHES_FUNCTOR count_matches_func,
-    FILL_ROW_IDS_FUNCTOR fill_row_ids_func);
-void count_matches_bucketized(int32_t *count_buff,
-                              const int32_t invalid_slot_val,
-                              const JoinColumn join_column,
-                              const JoinColumnTypeInfo type_info,
-                              const int64_t bucket_normalization);
+    FILL_ROW_IDS_FUNCTOR fill_row_ids_func,
+    const std::vector<sycl::event> &deps);
+
+template <typename ROW_ID>
+sycl::event count_matches_bucketized(ExecutionContext &ctx,
+                                     ROW_ID *count_buff,
+                                     const int64_t hash_entry_count,
+                                     const int32_t invalid_slot_val,
+                                     const JoinColumn join_column,
+                                     const JoinColumnTypeInfo type_info,
+                                     const int64_t bucket_normalization,
+                                     const size_t *chunk_offsets,
+                                     const BloomFilter bloom_filter,
+                                     const std::vector<sycl::event> &deps);
 
-void fill_row_ids_bucketized(int32_t *buff, const int64_t hash_entry_count,
-                             const int32_t invalid_slot_val,
-                             const JoinColumn join_column,
-                             const JoinColumnTypeInfo type_info,
-                             const int64_t bucket_normalization);
+template <typename ROW_ID>
+sycl::event fill_row_ids_bucketized(ExecutionContext &ctx, ROW_ID *buff,
+                                    const int64_t hash_entry_count,
+                                    const int32_t invalid_slot_val,
+                                    const JoinColumn join_column,
+                                    const JoinColumnTypeInfo type_info,
+                                    const int64_t bucket_normalization,
+                                    const size_t *chunk_offsets,
+                                    const std::vector<sycl::event> &deps);
 #endif // PERFECT_HT_HELPER_H__
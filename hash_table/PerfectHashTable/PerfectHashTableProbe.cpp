@@ -0,0 +1,175 @@
+#include <CL/sycl.hpp>
+
+#include "../JoinColumnIterator.h"
+#include "../Shared/ExecutionContext.h"
+#include "../Shared/JoinColumnLaunch.h"
+#include "../Shared/Probe.h"
+#include "PerfectHashTableHelpers.h"
+#include "PerfectHashTableProbe.h"
+
+// Decodes the key of an outer row, returns false if the row is null (and
+// nulls don't compare equal) or if the key is below the range of the table.
+inline bool get_outer_row_key(const JoinColumn &outer_join_column,
+                              const JoinColumnTypeInfo &outer_type_info,
+                              const size_t *outer_chunk_offsets,
+                              const size_t outer_idx,
+                              const int64_t min_inner_key, int64_t &key) {
+  auto item = *(JoinColumnIterator(&outer_join_column, &outer_type_info,
+                                   outer_chunk_offsets, outer_idx, 1));
+  key = item.element;
+  if (key == outer_type_info.null_val) {
+    if (outer_type_info.uses_bw_eq) {
+      key = outer_type_info.translated_null_val;
+    } else {
+      return false;
+    }
+  }
+  return key >= min_inner_key;
+}
+
+sycl::event probe_hash_join_buff_bucketized_on_l0_async(
+    ExecutionContext &ctx, const int32_t *buff,
+    const HashEntryInfo hash_entry_info, const int32_t invalid_slot_val,
+    const int64_t min_inner_key, const JoinColumn outer_join_column,
+    const JoinColumnTypeInfo outer_type_info, int32_t *outer_row_ids,
+    int32_t *inner_row_ids, const int64_t max_matches, int64_t *num_matches,
+    const std::vector<sycl::event> &deps) {
+  const int64_t hash_entry_count =
+      hash_entry_info.getNormalizedHashEntryCount();
+  const int64_t bucket_normalization = hash_entry_info.bucket_normalization;
+  std::vector<sycl::event> offsets_deps = deps;
+  const size_t *outer_chunk_offsets =
+      get_chunk_offsets(ctx, outer_join_column, offsets_deps);
+  auto matcher = [=](const size_t outer_idx, auto emit) {
+    int64_t key;
+    if (!get_outer_row_key(outer_join_column, outer_type_info,
+                           outer_chunk_offsets, outer_idx, min_inner_key,
+                           key)) {
+      return;
+    }
+    const int32_t *entry_ptr = get_bucketized_hash_slot(
+        buff, key, min_inner_key, bucket_normalization);
+    if (entry_ptr - buff >= hash_entry_count) {
+      return;
+    }
+    const int32_t inner_row = *entry_ptr;
+    if (inner_row != invalid_slot_val) {
+      emit(inner_row);
+    }
+  };
+  return probe_hash_table_impl(ctx, outer_join_column.num_elems, matcher,
+                               outer_row_ids, inner_row_ids, max_matches,
+                               num_matches, offsets_deps);
+}
+
+sycl::event probe_one_to_many_hash_table_on_l0_async(
+    ExecutionContext &ctx, const int32_t *buff,
+    const HashEntryInfo hash_entry_info, const int64_t min_inner_key,
+    const JoinColumn outer_join_column,
+    const JoinColumnTypeInfo outer_type_info, int32_t *outer_row_ids,
+    int32_t *inner_row_ids, const int64_t max_matches, int64_t *num_matches,
+    const std::vector<sycl::event> &deps) {
+  const int64_t hash_entry_count =
+      hash_entry_info.getNormalizedHashEntryCount();
+  const int64_t bucket_normalization = hash_entry_info.bucket_normalization;
+  std::vector<sycl::event> offsets_deps = deps;
+  const size_t *outer_chunk_offsets =
+      get_chunk_offsets(ctx, outer_join_column, offsets_deps);
+  const int32_t *pos_buff = buff;
+  const int32_t *count_buff = buff + hash_entry_count;
+  const int32_t *id_buff = count_buff + hash_entry_count;
+  auto matcher = [=](const size_t outer_idx, auto emit) {
+    int64_t key;
+    if (!get_outer_row_key(outer_join_column, outer_type_info,
+                           outer_chunk_offsets, outer_idx, min_inner_key,
+                           key)) {
+      return;
+    }
+    const auto entry_idx = get_bucketized_hash_slot(pos_buff, key,
+                                                    min_inner_key,
+                                                    bucket_normalization) -
+                           pos_buff;
+    if (entry_idx >= hash_entry_count) {
+      return;
+    }
+    const int32_t *row_ids = id_buff + pos_buff[entry_idx];
+    for (int32_t i = 0; i < count_buff[entry_idx]; ++i) {
+      emit(row_ids[i]);
+    }
+  };
+  return probe_hash_table_impl(ctx, outer_join_column.num_elems, matcher,
+                               outer_row_ids, inner_row_ids, max_matches,
+                               num_matches, offsets_deps);
+}
+
+sycl::event probe_compact_one_to_many_hash_table_on_l0_async(
+    ExecutionContext &ctx, const CompactOneToManyTable table,
+    const HashEntryInfo hash_entry_info, const int64_t min_inner_key,
+    const JoinColumn outer_join_column,
+    const JoinColumnTypeInfo outer_type_info, int32_t *outer_row_ids,
+    int32_t *inner_row_ids, const int64_t max_matches, int64_t *num_matches,
+    const std::vector<sycl::event> &deps) {
+  const int64_t hash_entry_count =
+      hash_entry_info.getNormalizedHashEntryCount();
+  const int64_t bucket_normalization = hash_entry_info.bucket_normalization;
+  std::vector<sycl::event> offsets_deps = deps;
+  const size_t *outer_chunk_offsets =
+      get_chunk_offsets(ctx, outer_join_column, offsets_deps);
+  auto matcher = [=](const size_t outer_idx, auto emit) {
+    int64_t key;
+    if (!get_outer_row_key(outer_join_column, outer_type_info,
+                           outer_chunk_offsets, outer_idx, min_inner_key,
+                           key)) {
+      return;
+    }
+    const int64_t entry_idx = (key - min_inner_key) / bucket_normalization;
+    if (entry_idx >= hash_entry_count) {
+      return;
+    }
+    table.for_each_row_id(entry_idx, [&](const int64_t row_id) {
+      emit(static_cast<int32_t>(row_id));
+    });
+  };
+  return probe_hash_table_impl(ctx, outer_join_column.num_elems, matcher,
+                               outer_row_ids, inner_row_ids, max_matches,
+                               num_matches, offsets_deps);
+}
+
+void probe_hash_join_buff_bucketized_on_l0(
+    ExecutionContext &ctx, const int32_t *buff,
+    const HashEntryInfo hash_entry_info, const int32_t invalid_slot_val,
+    const int64_t min_inner_key, const JoinColumn outer_join_column,
+    const JoinColumnTypeInfo outer_type_info, int32_t *outer_row_ids,
+    int32_t *inner_row_ids, const int64_t max_matches, int64_t *num_matches) {
+  probe_hash_join_buff_bucketized_on_l0_async(
+      ctx, buff, hash_entry_info, invalid_slot_val, min_inner_key,
+      outer_join_column, outer_type_info, outer_row_ids, inner_row_ids,
+      max_matches, num_matches, {})
+      .wait();
+}
+
+void probe_one_to_many_hash_table_on_l0(
+    ExecutionContext &ctx, const int32_t *buff,
+    const HashEntryInfo hash_entry_info, const int64_t min_inner_key,
+    const JoinColumn outer_join_column,
+    const JoinColumnTypeInfo outer_type_info, int32_t *outer_row_ids,
+    int32_t *inner_row_ids, const int64_t max_matches, int64_t *num_matches) {
+  probe_one_to_many_hash_table_on_l0_async(
+      ctx, buff, hash_entry_info, min_inner_key, outer_join_column,
+      outer_type_info, outer_row_ids, inner_row_ids, max_matches, num_matches,
+      {})
+      .wait();
+}
+
+void probe_compact_one_to_many_hash_table_on_l0(
+    ExecutionContext &ctx, const CompactOneToManyTable table,
+    const HashEntryInfo hash_entry_info, const int64_t min_inner_key,
+    const JoinColumn outer_join_column,
+    const JoinColumnTypeInfo outer_type_info, int32_t *outer_row_ids,
+    int32_t *inner_row_ids, const int64_t max_matches, int64_t *num_matches) {
+  probe_compact_one_to_many_hash_table_on_l0_async(
+      ctx, table, hash_entry_info, min_inner_key, outer_join_column,
+      outer_type_info, outer_row_ids, inner_row_ids, max_matches, num_matches,
+      {})
+      .wait();
+}
@@ -0,0 +1,68 @@
+#ifndef PERFECT_HT_PROBE_H__
+#define PERFECT_HT_PROBE_H__
+
+#include <CL/sycl.hpp>
+#include <vector>
+
+#include "../CommonDecls.h"
+#include "../Shared/CompactOneToManyLayout.h"
+
+// Probe operators for the tables built by PerfectHashTableBuilder.h. For every
+// row of outer_join_column they emit the (outer_row, inner_row) pairs of the
+// join into outer_row_ids/inner_row_ids, ordered by outer row. At most
+// max_matches pairs are written, num_matches (device accessible) receives the
+// total number of matches so that the caller can retry with a bigger output.
+// hash_entry_info and min_inner_key are the ones used to build the table
+// (bucket_normalization is 1 for non-bucketized tables).
+
+// buff is a one-to-one table (fill_hash_join_buff_bucketized_on_l0)
+sycl::event probe_hash_join_buff_bucketized_on_l0_async(
+    ExecutionContext &ctx, const int32_t *buff,
+    const HashEntryInfo hash_entry_info, const int32_t invalid_slot_val,
+    const int64_t min_inner_key, const JoinColumn outer_join_column,
+    const JoinColumnTypeInfo outer_type_info, int32_t *outer_row_ids,
+    int32_t *inner_row_ids, const int64_t max_matches, int64_t *num_matches,
+    const std::vector<sycl::event> &deps);
+
+// buff is a one-to-many table (fill_one_to_many_hash_table_on_l0 or
+// fill_one_to_many_hash_table_on_l0_bucketized)
+sycl::event probe_one_to_many_hash_table_on_l0_async(
+    ExecutionContext &ctx, const int32_t *buff,
+    const HashEntryInfo hash_entry_info, const int64_t min_inner_key,
+    const JoinColumn outer_join_column,
+    const JoinColumnTypeInfo outer_type_info, int32_t *outer_row_ids,
+    int32_t *inner_row_ids, const int64_t max_matches, int64_t *num_matches,
+    const std::vector<sycl::event> &deps);
+
+// table is the compact layout of a one-to-many table
+// (compress_one_to_many_on_l0)
+sycl::event probe_compact_one_to_many_hash_table_on_l0_async(
+    ExecutionContext &ctx, const CompactOneToManyTable table,
+    const HashEntryInfo hash_entry_info, const int64_t min_inner_key,
+    const JoinColumn outer_join_column,
+    const JoinColumnTypeInfo outer_type_info, int32_t *outer_row_ids,
+    int32_t *inner_row_ids, const int64_t max_matches, int64_t *num_matches,
+    const std::vector<sycl::event> &deps);
+
+void probe_hash_join_buff_bucketized_on_l0(
+    ExecutionContext &ctx, const int32_t *buff,
+    const HashEntryInfo hash_entry_info, const int32_t invalid_slot_val,
+    const int64_t min_inner_key, const JoinColumn outer_join_column,
+    const JoinColumnTypeInfo outer_type_info, int32_t *outer_row_ids,
+    int32_t *inner_row_ids, const int64_t max_matches, int64_t *num_matches);
+
+void probe_one_to_many_hash_table_on_l0(
+    ExecutionContext &ctx, const int32_t *buff,
+    const HashEntryInfo hash_entry_info, const int64_t min_inner_key,
+    const JoinColumn outer_join_column,
+    const JoinColumnTypeInfo outer_type_info, int32_t *outer_row_ids,
+    int32_t *inner_row_ids, const int64_t max_matches, int64_t *num_matches);
+
+void probe_compact_one_to_many_hash_table_on_l0(
+    ExecutionContext &ctx, const CompactOneToManyTable table,
+    const HashEntryInfo hash_entry_info, const int64_t min_inner_key,
+    const JoinColumn outer_join_column,
+    const JoinColumnTypeInfo outer_type_info, int32_t *outer_row_ids,
+    int32_t *inner_row_ids, const int64_t max_matches, int64_t *num_matches);
+
+#endif // PERFECT_HT_PROBE_H__
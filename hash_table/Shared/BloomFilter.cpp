@@ -0,0 +1,190 @@
+#include "BloomFilter.h"
+
+#include "../GenericKeyHandler.h"
+#include "../JoinColumnIterator.h"
+#include "ExecutionContext.h"
+#include "JoinColumnLaunch.h"
+#include "Profiling.h"
+#include "Scan.h"
+
+// A probe reads one block of the filter and writes one flag per row
+constexpr int64_t g_bloom_filter_probe_bytes_per_row{
+    g_bloom_filter_block_words * sizeof(uint64_t) + sizeof(int32_t)};
+
+// Work-group size of the scan compacting the flags, 0 on the host backend
+// which compacts them in one pass.
+size_t get_filter_scan_work_group_size(ExecutionContext &ctx) {
+  return ctx.is_host() ? 0 : get_scan_work_group_size(ctx);
+}
+
+// Flags of num_rows rows in the probe scratch memory, followed by the scratch
+// of the scan compacting them.
+int32_t *get_row_flags(ExecutionContext &ctx, const size_t num_rows,
+                       const size_t wg_size) {
+  const size_t scan_scratch_elems =
+      wg_size ? get_scan_scratch_elems(num_rows,
+                                       wg_size * g_scan_items_per_work_item)
+              : 0;
+  return reinterpret_cast<int32_t *>(ctx.get_scratch(
+      ScratchSlot::Probe, (num_rows + scan_scratch_elems) * sizeof(int32_t)));
+}
+
+// Writes the indices of the flagged rows to selection, in order.
+sycl::event select_flagged_rows(ExecutionContext &ctx, const int32_t *flags,
+                                const size_t num_rows, const size_t wg_size,
+                                int32_t *selection, int64_t *num_selected,
+                                const std::vector<sycl::event> &deps) {
+  if (ctx.is_host()) {
+    const KernelInfo info{"bloom_filter_select_rows",
+                          static_cast<int64_t>(num_rows), 0,
+                          static_cast<int64_t>(2 * num_rows * sizeof(int32_t))};
+    return submit_profiled(ctx, info, [&] {
+      return run_on_host(deps, [=] {
+        int64_t count = 0;
+        for (size_t idx = 0; idx < num_rows; ++idx) {
+          if (flags[idx]) {
+            selection[count++] = static_cast<int32_t>(idx);
+          }
+        }
+        *num_selected = count;
+      });
+    });
+  }
+  return exclusive_scan_on_device_impl(
+      ctx, flags, num_rows,
+      [selection, num_selected, num_rows](const size_t idx,
+                                          const int32_t prefix,
+                                          const int32_t flag) {
+        if (flag) {
+          selection[prefix] = static_cast<int32_t>(idx);
+        }
+        if (idx == num_rows - 1) {
+          *num_selected = prefix + flag;
+        }
+      },
+      const_cast<int32_t *>(flags) + num_rows, wg_size, deps);
+}
+
+sycl::event init_bloom_filter_on_l0_async(ExecutionContext &ctx,
+                                          const BloomFilter bloom_filter,
+                                          const std::vector<sycl::event> &deps) {
+  return fill_buff_async(ctx, "init_bloom_filter", bloom_filter.blocks,
+                         uint64_t{0},
+                         bloom_filter.block_count * g_bloom_filter_block_words,
+                         deps);
+}
+
+void init_bloom_filter_on_l0(ExecutionContext &ctx,
+                             const BloomFilter bloom_filter) {
+  init_bloom_filter_on_l0_async(ctx, bloom_filter, {}).wait();
+}
+
+sycl::event filter_join_column_on_l0_async(
+    ExecutionContext &ctx, const BloomFilter bloom_filter,
+    const JoinColumn join_column, const JoinColumnTypeInfo type_info,
+    int32_t *selection, int64_t *num_selected,
+    const std::vector<sycl::event> &deps) {
+  const size_t num_rows = join_column.num_elems;
+  if (!num_rows) {
+    return fill_buff_async(ctx, "bloom_filter_select_rows", num_selected,
+                           int64_t{0}, 1, deps);
+  }
+  std::vector<sycl::event> offsets_deps = deps;
+  const size_t *chunk_offsets =
+      get_chunk_offsets(ctx, join_column, offsets_deps);
+  const size_t wg_size = get_filter_scan_work_group_size(ctx);
+  int32_t *flags = get_row_flags(ctx, num_rows, wg_size);
+  const KernelInfo info{"bloom_filter_flag_rows",
+                        static_cast<int64_t>(num_rows),
+                        static_cast<int64_t>(bloom_filter.block_count),
+                        get_join_column_bytes(join_column) +
+                            static_cast<int64_t>(num_rows) *
+                                g_bloom_filter_probe_bytes_per_row};
+  auto flagged = dispatch_column_decoder(
+      type_info.column_type, type_info.elem_sz, [&](auto decoder) {
+        return submit_join_column_rows(
+            ctx, info, join_column, type_info, chunk_offsets, offsets_deps,
+            [=](const JoinColumnIterator &it) {
+              const auto item = decoder(it);
+              int64_t elem = item.element;
+              bool may_match = true;
+              if (elem == type_info.null_val) {
+                may_match = type_info.uses_bw_eq;
+                elem = type_info.translated_null_val;
+              }
+              flags[item.index] =
+                  may_match && bloom_filter_contains(
+                                   bloom_filter,
+                                   get_bloom_filter_hash(&elem, 1));
+            });
+      });
+  return select_flagged_rows(ctx, flags, num_rows, wg_size, selection,
+                             num_selected, {flagged});
+}
+
+template <typename T>
+sycl::event filter_keys_on_l0_async(ExecutionContext &ctx,
+                                    const BloomFilter bloom_filter,
+                                    const GenericKeyHandler *key_handler,
+                                    const int64_t num_elems, int32_t *selection,
+                                    int64_t *num_selected,
+                                    const std::vector<sycl::event> &deps) {
+  if (num_elems <= 0) {
+    return fill_buff_async(ctx, "bloom_filter_select_rows", num_selected,
+                           int64_t{0}, 1, deps);
+  }
+  const size_t wg_size = get_filter_scan_work_group_size(ctx);
+  int32_t *flags = get_row_flags(ctx, num_elems, wg_size);
+  // Rows with null components are skipped by the key handler
+  auto flags_reset = fill_buff_async(ctx, "bloom_filter_clear_flags", flags,
+                                     int32_t{0}, num_elems, deps);
+  // The key bytes are up to the key handler
+  const KernelInfo flag_info{"bloom_filter_flag_keys", num_elems,
+                             static_cast<int64_t>(bloom_filter.block_count),
+                             num_elems * g_bloom_filter_probe_bytes_per_row};
+  auto flagged = submit_for_each_key<T>(
+      ctx, flag_info, key_handler, num_elems, nullptr,
+      [=](const int64_t row_index, const T *key,
+          const size_t key_component_count) {
+        flags[row_index] = bloom_filter_contains(
+            bloom_filter, get_bloom_filter_hash(key, key_component_count));
+        return 0;
+      },
+      {flags_reset});
+  return select_flagged_rows(ctx, flags, num_elems, wg_size, selection,
+                             num_selected, {flagged});
+}
+
+void filter_join_column_on_l0(ExecutionContext &ctx,
+                              const BloomFilter bloom_filter,
+                              const JoinColumn join_column,
+                              const JoinColumnTypeInfo type_info,
+                              int32_t *selection, int64_t *num_selected) {
+  filter_join_column_on_l0_async(ctx, bloom_filter, join_column, type_info,
+                                 selection, num_selected, {})
+      .wait();
+}
+
+template <typename T>
+void filter_keys_on_l0(ExecutionContext &ctx, const BloomFilter bloom_filter,
+                       const GenericKeyHandler *key_handler,
+                       const int64_t num_elems, int32_t *selection,
+                       int64_t *num_selected) {
+  filter_keys_on_l0_async<T>(ctx, bloom_filter, key_handler, num_elems,
+                             selection, num_selected, {})
+      .wait();
+}
+
+template sycl::event filter_keys_on_l0_async<int32_t>(
+    ExecutionContext &, const BloomFilter, const GenericKeyHandler *,
+    const int64_t, int32_t *, int64_t *, const std::vector<sycl::event> &);
+template sycl::event filter_keys_on_l0_async<int64_t>(
+    ExecutionContext &, const BloomFilter, const GenericKeyHandler *,
+    const int64_t, int32_t *, int64_t *, const std::vector<sycl::event> &);
+
+template void filter_keys_on_l0<int32_t>(ExecutionContext &, const BloomFilter,
+                                         const GenericKeyHandler *,
+                                         const int64_t, int32_t *, int64_t *);
+template void filter_keys_on_l0<int64_t>(ExecutionContext &, const BloomFilter,
+                                         const GenericKeyHandler *,
+                                         const int64_t, int32_t *, int64_t *);
@@ -0,0 +1,128 @@
+#ifndef SHARED_BLOOM_FILTER_H__
+#define SHARED_BLOOM_FILTER_H__
+
+#include <CL/sycl.hpp>
+#include <vector>
+
+#include "../CommonDecls.h"
+#include "../MurMurHash.h"
+#include "../Types.h"
+
+// Blocked Bloom filter of the build keys, filled by the table builders that
+// take one. Every key sets one bit in each of the g_bloom_filter_block_words
+// words of one cache line sized block, so a lookup touches a single cache
+// line. blocks == nullptr disables the filter.
+constexpr size_t g_bloom_filter_block_words{8};
+constexpr size_t g_bloom_filter_bits_per_key{16};
+
+struct BloomFilter {
+  uint64_t *blocks;
+  size_t block_count;
+};
+
+// Blocks for about cardinality distinct keys (e.g. the HLL estimate), at
+// g_bloom_filter_bits_per_key bits per key (~0.1% false positives).
+inline size_t get_bloom_filter_block_count(const int64_t cardinality) {
+  constexpr size_t block_bits = g_bloom_filter_block_words * 64;
+  const size_t bits =
+      static_cast<size_t>(cardinality > 0 ? cardinality : 1) *
+      g_bloom_filter_bits_per_key;
+  return (bits + block_bits - 1) / block_bits;
+}
+
+inline size_t get_bloom_filter_size(const size_t block_count) {
+  return block_count * g_bloom_filter_block_words * sizeof(uint64_t);
+}
+
+// The components are widened to 64 bits so that a filter built from keys of
+// any width matches the keys of the probe side.
+template <typename T>
+inline uint64_t get_bloom_filter_hash(const T *key,
+                                      const size_t key_component_count) {
+  int64_t wide_key[g_maximum_conditions_to_coalesce];
+  for (size_t i = 0; i < key_component_count; ++i) {
+    wide_key[i] = key[i];
+  }
+  return MurmurHash64AImpl(wide_key, key_component_count * sizeof(int64_t), 0);
+}
+
+inline uint64_t get_bloom_filter_bit(const uint64_t hash, const size_t word) {
+  constexpr uint32_t salts[g_bloom_filter_block_words] = {
+      0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+      0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+  return uint64_t{1} << ((static_cast<uint32_t>(hash) * salts[word]) >> 26);
+}
+
+inline uint64_t *get_bloom_filter_block(const BloomFilter &bloom_filter,
+                                        const uint64_t hash) {
+  const size_t block = ((hash >> 32) * bloom_filter.block_count) >> 32;
+  return bloom_filter.blocks + block * g_bloom_filter_block_words;
+}
+
+inline void bloom_filter_insert(const BloomFilter &bloom_filter,
+                                const uint64_t hash) {
+  uint64_t *block = get_bloom_filter_block(bloom_filter, hash);
+  for (size_t i = 0; i < g_bloom_filter_block_words; ++i) {
+    const uint64_t bit = get_bloom_filter_bit(hash, i);
+    // Most bits are set already once the filter fills up
+    if (!(block[i] & bit)) {
+      sycl::atomic_ref<uint64_t, sycl::memory_order::relaxed,
+                       sycl::memory_scope::device>
+          atomic_word(block[i]);
+      atomic_word.fetch_or(bit);
+    }
+  }
+}
+
+inline bool bloom_filter_contains(const BloomFilter &bloom_filter,
+                                  const uint64_t hash) {
+  const uint64_t *block = get_bloom_filter_block(bloom_filter, hash);
+  for (size_t i = 0; i < g_bloom_filter_block_words; ++i) {
+    const uint64_t bit = get_bloom_filter_bit(hash, i);
+    if (!(block[i] & bit)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+sycl::event init_bloom_filter_on_l0_async(ExecutionContext &ctx,
+                                          const BloomFilter bloom_filter,
+                                          const std::vector<sycl::event> &deps);
+
+// Writes the indices of the rows of join_column whose value may be in
+// bloom_filter (built by a perfect hash table builder) to selection, in
+// increasing order, and their number to num_selected (device accessible).
+// Nulls pass only with uses_bw_eq, like in the probes.
+sycl::event filter_join_column_on_l0_async(
+    ExecutionContext &ctx, const BloomFilter bloom_filter,
+    const JoinColumn join_column, const JoinColumnTypeInfo type_info,
+    int32_t *selection, int64_t *num_selected,
+    const std::vector<sycl::event> &deps);
+
+// Same for the composite keys of key_handler against a filter built by a
+// baseline hash table builder.
+template <typename T>
+sycl::event filter_keys_on_l0_async(ExecutionContext &ctx,
+                                    const BloomFilter bloom_filter,
+                                    const GenericKeyHandler *key_handler,
+                                    const int64_t num_elems, int32_t *selection,
+                                    int64_t *num_selected,
+                                    const std::vector<sycl::event> &deps);
+
+void init_bloom_filter_on_l0(ExecutionContext &ctx,
+                             const BloomFilter bloom_filter);
+
+void filter_join_column_on_l0(ExecutionContext &ctx,
+                              const BloomFilter bloom_filter,
+                              const JoinColumn join_column,
+                              const JoinColumnTypeInfo type_info,
+                              int32_t *selection, int64_t *num_selected);
+
+template <typename T>
+void filter_keys_on_l0(ExecutionContext &ctx, const BloomFilter bloom_filter,
+                       const GenericKeyHandler *key_handler,
+                       const int64_t num_elems, int32_t *selection,
+                       int64_t *num_selected);
+
+#endif // SHARED_BLOOM_FILTER_H__
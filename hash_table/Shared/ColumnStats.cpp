@@ -0,0 +1,168 @@
+#include "ColumnStats.h"
+
+#include <limits>
+
+#include "../JoinColumnIterator.h"
+#include "ExecutionContext.h"
+#include "JoinColumnLaunch.h"
+#include "Profiling.h"
+
+sycl::event compute_column_stats_on_l0_async(
+    ExecutionContext &ctx, const JoinColumn join_column,
+    const JoinColumnTypeInfo type_info, const int64_t max_distinct_range,
+    ColumnStats *stats, const std::vector<sycl::event> &deps) {
+  auto &q = ctx.get_queue();
+  std::vector<sycl::event> offsets_deps = deps;
+  const size_t *chunk_offsets =
+      get_chunk_offsets(ctx, join_column, offsets_deps);
+
+  const int64_t range_min = type_info.min_val;
+  const uint64_t range =
+      type_info.max_val >= type_info.min_val
+          ? static_cast<uint64_t>(type_info.max_val - type_info.min_val) + 1
+          : 0;
+  const bool count_distinct =
+      range && range <= static_cast<uint64_t>(max_distinct_range);
+  uint32_t *bitmap = nullptr;
+  const size_t bitmap_words = count_distinct ? (range + 31) / 32 : 0;
+  std::vector<sycl::event> init_deps = offsets_deps;
+  if (count_distinct) {
+    bitmap = reinterpret_cast<uint32_t *>(
+        ctx.get_scratch(ScratchSlot::Bitmap, bitmap_words * sizeof(uint32_t)));
+    const KernelInfo clear_info{
+        "column_stats_clear_bitmap", 0, static_cast<int64_t>(bitmap_words),
+        static_cast<int64_t>(bitmap_words * sizeof(uint32_t))};
+    init_deps.push_back(submit_profiled(ctx, clear_info, [&] {
+      return q.memset(bitmap, 0, bitmap_words * sizeof(uint32_t),
+                      offsets_deps);
+    }));
+  }
+  const KernelInfo init_info{"column_stats_init", 0, 0, sizeof(ColumnStats)};
+  auto stats_init = submit_profiled(ctx, init_info, [&] {
+    return q.submit([&](sycl::handler &h) {
+      h.depends_on(init_deps);
+      h.single_task([=]() {
+        *stats = {std::numeric_limits<int64_t>::max(),
+                  std::numeric_limits<int64_t>::min(), 0,
+                  count_distinct ? 0 : -1};
+      });
+    });
+  });
+
+  // Every work item reduces its rows in registers, every work-group its work
+  // items and then updates stats with one atomic per field.
+  const auto launch_config = ctx.get_launch_config();
+  const KernelInfo scan_info{"column_stats_scan",
+                             static_cast<int64_t>(join_column.num_elems),
+                             static_cast<int64_t>(bitmap_words),
+                             get_join_column_bytes(join_column)};
+  auto scanned = submit_profiled(ctx, scan_info, [&] {
+    return dispatch_column_decoder(
+        type_info.column_type, type_info.elem_sz, [&](auto decoder) {
+          return q.submit([&](sycl::handler &h) {
+            h.depends_on(stats_init);
+            h.parallel_for(
+                get_grid_stride_nd_range(launch_config, join_column.num_elems),
+                [=](sycl::nd_item<1> item) {
+                  int64_t min_val = std::numeric_limits<int64_t>::max();
+                  int64_t max_val = std::numeric_limits<int64_t>::min();
+                  int64_t null_count = 0;
+                  bool out_of_range = false;
+                  for (JoinColumnIterator it(&join_column, &type_info,
+                                             chunk_offsets,
+                                             item.get_global_id(0),
+                                             item.get_global_range(0));
+                       it; ++it) {
+                    const int64_t elem = decoder(it).element;
+                    if (elem == type_info.null_val) {
+                      ++null_count;
+                      continue;
+                    }
+                    min_val = sycl::min(min_val, elem);
+                    max_val = sycl::max(max_val, elem);
+                    if (bitmap) {
+                      const uint64_t bit =
+                          static_cast<uint64_t>(elem - range_min);
+                      if (elem < range_min || bit >= range) {
+                        out_of_range = true;
+                        continue;
+                      }
+                      sycl::atomic_ref<uint32_t, sycl::memory_order::relaxed,
+                                       sycl::memory_scope::device>
+                          atomic_word(bitmap[bit / 32]);
+                      atomic_word.fetch_or(uint32_t{1} << (bit % 32));
+                    }
+                  }
+                  const auto group = item.get_group();
+                  min_val = sycl::reduce_over_group(group, min_val,
+                                                    sycl::minimum<int64_t>());
+                  max_val = sycl::reduce_over_group(group, max_val,
+                                                    sycl::maximum<int64_t>());
+                  null_count = sycl::reduce_over_group(group, null_count,
+                                                       sycl::plus<int64_t>());
+                  out_of_range = sycl::any_of_group(group, out_of_range);
+                  if (item.get_local_id(0)) {
+                    return;
+                  }
+                  using atomic_stat =
+                      sycl::atomic_ref<int64_t, sycl::memory_order::relaxed,
+                                       sycl::memory_scope::device>;
+                  atomic_stat(stats->min_val).fetch_min(min_val);
+                  atomic_stat(stats->max_val).fetch_max(max_val);
+                  if (null_count) {
+                    atomic_stat(stats->null_count).fetch_add(null_count);
+                  }
+                  if (out_of_range) {
+                    // the bitmap misses values: no exact count
+                    atomic_stat(stats->distinct_count).store(-1);
+                  }
+                });
+          });
+        });
+  });
+  if (!count_distinct) {
+    return scanned;
+  }
+
+  const KernelInfo count_info{
+      "column_stats_count_distinct", 0, static_cast<int64_t>(bitmap_words),
+      static_cast<int64_t>(bitmap_words * sizeof(uint32_t))};
+  return submit_profiled(ctx, count_info, [&] {
+    return q.submit([&](sycl::handler &h) {
+      h.depends_on(scanned);
+      h.parallel_for(
+          get_grid_stride_nd_range(launch_config, bitmap_words),
+          [=](sycl::nd_item<1> item) {
+            int64_t distinct_count = 0;
+            for (size_t i = item.get_global_id(0); i < bitmap_words;
+                 i += item.get_global_range(0)) {
+              distinct_count += sycl::popcount(bitmap[i]);
+            }
+            distinct_count = sycl::reduce_over_group(
+                item.get_group(), distinct_count, sycl::plus<int64_t>());
+            if (item.get_local_id(0) || !distinct_count) {
+              return;
+            }
+            sycl::atomic_ref<int64_t, sycl::memory_order::relaxed,
+                             sycl::memory_scope::device>
+                atomic_distinct_count(stats->distinct_count);
+            if (atomic_distinct_count.load() >= 0) {
+              atomic_distinct_count.fetch_add(distinct_count);
+            }
+          });
+    });
+  });
+}
+
+ColumnStats compute_column_stats_on_l0(ExecutionContext &ctx,
+                                       const JoinColumn join_column,
+                                       const JoinColumnTypeInfo type_info,
+                                       const int64_t max_distinct_range) {
+  auto stats = reinterpret_cast<ColumnStats *>(
+      ctx.get_scratch(ScratchSlot::Result, sizeof(ColumnStats)));
+  auto computed = compute_column_stats_on_l0_async(
+      ctx, join_column, type_info, max_distinct_range, stats, {});
+  ColumnStats result;
+  ctx.get_queue().memcpy(&result, stats, sizeof(ColumnStats), computed).wait();
+  return result;
+}
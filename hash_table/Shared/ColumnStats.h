@@ -0,0 +1,34 @@
+#ifndef SHARED_COLUMN_STATS_H__
+#define SHARED_COLUMN_STATS_H__
+
+#include <CL/sycl.hpp>
+#include <vector>
+
+#include "../CommonDecls.h"
+#include "../Types.h"
+
+// Statistics of the decoded values of a join column, nulls excluded from
+// min/max. min_val > max_val if the column has no non-null value.
+struct ColumnStats {
+  int64_t min_val;
+  int64_t max_val;
+  int64_t null_count;
+  // Exact number of distinct non-null values, -1 if not computed (see below)
+  int64_t distinct_count;
+};
+
+// Computes the statistics of join_column in one pass and writes them to
+// stats (device accessible). If the range of type_info (min_val..max_val)
+// has at most max_distinct_range values, the distinct values are also marked
+// in a bitmap (range / 8 bytes of scratch memory) and counted exactly.
+sycl::event compute_column_stats_on_l0_async(
+    ExecutionContext &ctx, const JoinColumn join_column,
+    const JoinColumnTypeInfo type_info, const int64_t max_distinct_range,
+    ColumnStats *stats, const std::vector<sycl::event> &deps);
+
+ColumnStats compute_column_stats_on_l0(ExecutionContext &ctx,
+                                       const JoinColumn join_column,
+                                       const JoinColumnTypeInfo type_info,
+                                       const int64_t max_distinct_range);
+
+#endif // SHARED_COLUMN_STATS_H__
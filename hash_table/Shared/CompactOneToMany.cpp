@@ -0,0 +1,326 @@
+#include "CompactOneToMany.h"
+
+#include <algorithm>
+
+#include "ExecutionContext.h"
+#include "JoinColumnLaunch.h"
+#include "Profiling.h"
+#include "Scan.h"
+
+namespace {
+
+// Calls block_func(block) for every block < block_count, one work item (host
+// task row) per block.
+template <typename BLOCK_FUNC>
+sycl::event for_each_block_async(ExecutionContext &ctx, const KernelInfo &info,
+                                 const int64_t block_count,
+                                 BLOCK_FUNC block_func,
+                                 const std::vector<sycl::event> &deps) {
+  return submit_profiled(ctx, info, [&] {
+    if (ctx.is_host()) {
+      return run_on_host(deps, [&] {
+        host_parallel_for_rows(
+            ctx, block_count, [&](const size_t begin, const size_t end) {
+              for (size_t block = begin; block < end; ++block) {
+                block_func(block);
+              }
+            });
+      });
+    }
+    const auto launch_config = ctx.get_launch_config();
+    return ctx.get_queue().submit([&](sycl::handler &h) {
+      h.depends_on(deps);
+      h.parallel_for(get_grid_stride_nd_range(launch_config, block_count),
+                     [=](sycl::nd_item<1> item) {
+                       for (size_t block = item.get_global_id(0);
+                            block < static_cast<size_t>(block_count);
+                            block += item.get_global_range(0)) {
+                         block_func(block);
+                       }
+                     });
+    });
+  });
+}
+
+// Heap sort, in place and without recursion for the device
+template <typename ROW_ID>
+void sort_row_ids(ROW_ID *ids, const int64_t count) {
+  auto sift_down = [ids](int64_t root, const int64_t end) {
+    for (int64_t child = 2 * root + 1; child < end; child = 2 * root + 1) {
+      if (child + 1 < end && ids[child] < ids[child + 1]) {
+        ++child;
+      }
+      if (!(ids[root] < ids[child])) {
+        return;
+      }
+      const ROW_ID tmp = ids[root];
+      ids[root] = ids[child];
+      ids[child] = tmp;
+      root = child;
+    }
+  };
+  for (int64_t root = count / 2 - 1; root >= 0; --root) {
+    sift_down(root, count);
+  }
+  for (int64_t end = count - 1; end > 0; --end) {
+    const ROW_ID tmp = ids[0];
+    ids[0] = ids[end];
+    ids[end] = tmp;
+    sift_down(0, end);
+  }
+}
+
+// Width of the gaps minus one between the sorted row ids of an entry
+template <typename ROW_ID>
+uint32_t get_gap_width(const ROW_ID *ids, const int64_t count) {
+  uint64_t max_gap = 0;
+  for (int64_t i = 1; i < count; ++i) {
+    max_gap =
+        sycl::max(max_gap, static_cast<uint64_t>(ids[i] - ids[i - 1] - 1));
+  }
+  return get_bit_width(max_gap);
+}
+
+struct CompactBlockSize {
+  int64_t words;
+  int64_t overflows;
+};
+
+// Sorts the row ids of the entries of block of the table buff that aren't
+// sorted yet, for the delta encoding
+template <typename ROW_ID>
+void sort_block_row_ids(ROW_ID *buff, const CompactOneToManySpec &spec,
+                        const int64_t block) {
+  const ROW_ID *pos_buff = buff;
+  const ROW_ID *count_buff = buff + spec.entry_count;
+  ROW_ID *id_buff = buff + 2 * spec.entry_count;
+  const int64_t begin = block * g_compact_one_to_many_block_entries;
+  const int64_t end = sycl::min(
+      spec.entry_count,
+      static_cast<int64_t>(begin + g_compact_one_to_many_block_entries));
+  for (int64_t e = begin; e < end; ++e) {
+    ROW_ID *ids = id_buff + pos_buff[e];
+    const int64_t count = count_buff[e];
+    int64_t i = 1;
+    while (i < count && ids[i - 1] < ids[i]) {
+      ++i;
+    }
+    if (i < count) {
+      sort_row_ids(ids, count);
+    }
+  }
+}
+
+// Row id words and overflow counts of block in the compact table of buff
+template <typename ROW_ID>
+CompactBlockSize get_compact_block_size(const ROW_ID *buff,
+                                        const CompactOneToManySpec &spec,
+                                        const int64_t block) {
+  const ROW_ID *pos_buff = buff;
+  const ROW_ID *count_buff = buff + spec.entry_count;
+  const ROW_ID *id_buff = count_buff + spec.entry_count;
+  const int64_t begin = block * g_compact_one_to_many_block_entries;
+  const int64_t end = sycl::min(
+      spec.entry_count,
+      static_cast<int64_t>(begin + g_compact_one_to_many_block_entries));
+  int64_t bits = 0;
+  int64_t overflows = 0;
+  for (int64_t e = begin; e < end; ++e) {
+    const int64_t count = count_buff[e];
+    if (!count) {
+      continue;
+    }
+    const uint32_t w =
+        spec.delta_row_ids ? get_gap_width(id_buff + pos_buff[e], count) : 0;
+    bits += spec.get_row_ids_bits(count, w);
+    overflows += count >= spec.get_overflow_code();
+  }
+  return {(bits + 31) / 32, overflows};
+}
+
+// Exclusive scan of the count + 1 elements of buff in place, the last one
+// (zero) receives the total
+sycl::event scan_block_offsets(ExecutionContext &ctx, int64_t *buff,
+                               const int64_t count,
+                               const std::vector<sycl::event> &deps) {
+  if (ctx.is_host()) {
+    const KernelInfo info{"compact_one_to_many_block_offsets", 0, count + 1,
+                          (count + 1) * static_cast<int64_t>(sizeof(int64_t))};
+    return submit_profiled(ctx, info, [&] {
+      return run_on_host(deps, [=] {
+        int64_t prefix = 0;
+        for (int64_t block = 0; block <= count; ++block) {
+          const int64_t size = buff[block];
+          buff[block] = prefix;
+          prefix += size;
+        }
+      });
+    });
+  }
+  return exclusive_scan_on_device(ctx, buff, count + 1,
+                                  ExclusiveScanWriter<int64_t>{buff}, deps);
+}
+
+} // namespace
+
+template <typename ROW_ID>
+CompactOneToManySpec plan_compact_one_to_many_on_l0(
+    ExecutionContext &ctx, ROW_ID *buff, const int64_t hash_entry_count,
+    const int64_t num_rows, const CompactOneToManyOptions options) {
+  // Row ids up to num_rows - 1
+  const uint32_t row_id_bits = std::max<uint32_t>(
+      get_bit_width(std::max<int64_t>(num_rows - 1, 0)), 1);
+  CompactOneToManySpec spec{hash_entry_count, options.count_bits, row_id_bits,
+                            options.delta_row_ids, 0, 0};
+  auto totals = reinterpret_cast<int64_t *>(
+      ctx.get_scratch(ScratchSlot::Result, sizeof(CompactBlockSize)));
+  const KernelInfo info{
+      "compact_one_to_many_plan", num_rows, hash_entry_count,
+      (2 * hash_entry_count + (options.delta_row_ids ? 2 : 1) * num_rows) *
+          static_cast<int64_t>(sizeof(ROW_ID))};
+  auto planned = for_each_block_async(
+      ctx, info, spec.get_block_count(),
+      [=](const int64_t block) {
+        if (spec.delta_row_ids) {
+          sort_block_row_ids(buff, spec, block);
+        }
+        const CompactBlockSize size = get_compact_block_size(buff, spec, block);
+        using atomic_total =
+            sycl::atomic_ref<int64_t, sycl::memory_order::relaxed,
+                             sycl::memory_scope::device>;
+        atomic_total(totals[0]).fetch_add(size.words);
+        atomic_total(totals[1]).fetch_add(size.overflows);
+      },
+      {fill_buff_async(ctx, "compact_one_to_many_plan_init", totals,
+                       int64_t{0}, 2, {})});
+  CompactBlockSize result;
+  if (ctx.is_host()) {
+    result = {totals[0], totals[1]};
+  } else {
+    ctx.get_queue()
+        .memcpy(&result, totals, sizeof(CompactBlockSize), planned)
+        .wait();
+  }
+  spec.row_id_word_count = result.words;
+  spec.overflow_count = result.overflows;
+  return spec;
+}
+
+template <typename ROW_ID>
+sycl::event compress_one_to_many_on_l0_async(
+    ExecutionContext &ctx, ROW_ID *buff, const CompactOneToManySpec &spec,
+    int8_t *compact_buff, const std::vector<sycl::event> &deps) {
+  const CompactOneToManyTable table{compact_buff, spec};
+  const int64_t block_count = spec.get_block_count();
+  int64_t *block_word_offsets = table.block_word_offsets();
+  int64_t *block_overflow_offsets = table.block_overflow_offsets();
+
+  // Block sizes, turned into offsets by a scan. The delta encoding sorts the
+  // row ids of every entry here rather than relying on the plan, buff may
+  // have been rebuilt since.
+  const KernelInfo sizes_info{
+      "compact_one_to_many_block_sizes", 0, spec.entry_count,
+      2 * spec.entry_count * static_cast<int64_t>(sizeof(ROW_ID))};
+  auto sized = for_each_block_async(
+      ctx, sizes_info, block_count + 1,
+      [=](const int64_t block) {
+        if (spec.delta_row_ids && block < block_count) {
+          sort_block_row_ids(buff, spec, block);
+        }
+        const CompactBlockSize size =
+            block < block_count ? get_compact_block_size(buff, spec, block)
+                                : CompactBlockSize{0, 0};
+        block_word_offsets[block] = size.words;
+        block_overflow_offsets[block] = size.overflows;
+      },
+      deps);
+  auto words_scanned =
+      scan_block_offsets(ctx, block_word_offsets, block_count, {sized});
+  auto overflows_scanned = scan_block_offsets(ctx, block_overflow_offsets,
+                                              block_count, {words_scanned});
+
+  // Every block zeroes and writes its own words
+  const KernelInfo encode_info{
+      "compact_one_to_many_encode", 0, spec.entry_count,
+      static_cast<int64_t>(spec.get_buff_size()) +
+          2 * spec.entry_count * static_cast<int64_t>(sizeof(ROW_ID))};
+  return for_each_block_async(
+      ctx, encode_info, block_count,
+      [=](const int64_t block) {
+        const ROW_ID *pos_buff = buff;
+        const ROW_ID *count_buff = buff + spec.entry_count;
+        const ROW_ID *id_buff = count_buff + spec.entry_count;
+        uint32_t *words = table.row_id_words();
+        const uint32_t overflow_code = spec.get_overflow_code();
+        for (int64_t word = block_word_offsets[block];
+             word < block_word_offsets[block + 1]; ++word) {
+          words[word] = 0;
+        }
+        int64_t overflow_idx = block_overflow_offsets[block];
+        int64_t bit_offset = block_word_offsets[block] * 32;
+        const int64_t begin = block * g_compact_one_to_many_block_entries;
+        const int64_t end = sycl::min(
+            spec.entry_count,
+            static_cast<int64_t>(begin + g_compact_one_to_many_block_entries));
+        for (int64_t e = begin; e < end; ++e) {
+          const int64_t count = count_buff[e];
+          if (count >= overflow_code) {
+            table.set_count_code(e, overflow_code);
+            table.overflow_counts()[overflow_idx++] = count;
+          } else {
+            table.set_count_code(e, static_cast<uint32_t>(count));
+          }
+          if (!count) {
+            continue;
+          }
+          const ROW_ID *ids = id_buff + pos_buff[e];
+          if (!spec.delta_row_ids) {
+            for (int64_t i = 0; i < count; ++i) {
+              write_packed_bits(words, bit_offset, spec.row_id_bits, ids[i]);
+              bit_offset += spec.row_id_bits;
+            }
+            continue;
+          }
+          write_packed_bits(words, bit_offset, spec.row_id_bits, ids[0]);
+          bit_offset += spec.row_id_bits;
+          if (count == 1) {
+            continue;
+          }
+          const uint32_t w = get_gap_width(ids, count);
+          write_packed_bits(words, bit_offset, g_compact_delta_width_bits, w);
+          bit_offset += g_compact_delta_width_bits;
+          for (int64_t i = 1; i < count; ++i, bit_offset += w) {
+            write_packed_bits(words, bit_offset, w, ids[i] - ids[i - 1] - 1);
+          }
+        }
+      },
+      {overflows_scanned});
+}
+
+template <typename ROW_ID>
+void compress_one_to_many_on_l0(ExecutionContext &ctx, ROW_ID *buff,
+                                const CompactOneToManySpec &spec,
+                                int8_t *compact_buff) {
+  compress_one_to_many_on_l0_async(ctx, buff, spec, compact_buff, {}).wait();
+}
+
+template CompactOneToManySpec plan_compact_one_to_many_on_l0<int32_t>(
+    ExecutionContext &, int32_t *, const int64_t, const int64_t,
+    const CompactOneToManyOptions);
+template CompactOneToManySpec plan_compact_one_to_many_on_l0<int64_t>(
+    ExecutionContext &, int64_t *, const int64_t, const int64_t,
+    const CompactOneToManyOptions);
+template sycl::event compress_one_to_many_on_l0_async<int32_t>(
+    ExecutionContext &, int32_t *, const CompactOneToManySpec &, int8_t *,
+    const std::vector<sycl::event> &);
+template sycl::event compress_one_to_many_on_l0_async<int64_t>(
+    ExecutionContext &, int64_t *, const CompactOneToManySpec &, int8_t *,
+    const std::vector<sycl::event> &);
+template void compress_one_to_many_on_l0<int32_t>(ExecutionContext &,
+                                                  int32_t *,
+                                                  const CompactOneToManySpec &,
+                                                  int8_t *);
+template void compress_one_to_many_on_l0<int64_t>(ExecutionContext &,
+                                                  int64_t *,
+                                                  const CompactOneToManySpec &,
+                                                  int8_t *);
@@ -0,0 +1,38 @@
+#ifndef SHARED_COMPACT_ONE_TO_MANY_H__
+#define SHARED_COMPACT_ONE_TO_MANY_H__
+
+#include <CL/sycl.hpp>
+#include <vector>
+
+#include "../CommonDecls.h"
+#include "CompactOneToManyLayout.h"
+
+// Conversion of a built one-to-many table (pos|count|row ids of
+// hash_entry_count entries over num_rows rows, perfect or baseline) to the
+// compact layout of CompactOneToManyLayout.h, to free the dense table after.
+// Entries keep their index, so the table is probed like the dense one with
+// CompactOneToManyTable as the decoder.
+
+// Sizes the compact table of buff. With options.delta_row_ids, the row ids of
+// every entry of buff are sorted in place first (their order in an entry is
+// unspecified anyway), the gaps between them set the size.
+template <typename ROW_ID>
+CompactOneToManySpec plan_compact_one_to_many_on_l0(
+    ExecutionContext &ctx, ROW_ID *buff, const int64_t hash_entry_count,
+    const int64_t num_rows, const CompactOneToManyOptions options);
+
+// Writes the compact table of buff, planned as spec, into compact_buff of
+// spec.get_buff_size() bytes (device accessible). buff must hold the same row
+// ids per entry as the planned table, in any order: with spec.delta_row_ids,
+// the unsorted entries of buff are sorted in place again.
+template <typename ROW_ID>
+sycl::event compress_one_to_many_on_l0_async(
+    ExecutionContext &ctx, ROW_ID *buff, const CompactOneToManySpec &spec,
+    int8_t *compact_buff, const std::vector<sycl::event> &deps);
+
+template <typename ROW_ID>
+void compress_one_to_many_on_l0(ExecutionContext &ctx, ROW_ID *buff,
+                                const CompactOneToManySpec &spec,
+                                int8_t *compact_buff);
+
+#endif // SHARED_COMPACT_ONE_TO_MANY_H__
@@ -0,0 +1,216 @@
+#ifndef SHARED_COMPACT_ONE_TO_MANY_LAYOUT_H__
+#define SHARED_COMPACT_ONE_TO_MANY_LAYOUT_H__
+
+#include <CL/sycl.hpp>
+#include <cstddef>
+#include <cstdint>
+
+#include "../CompositeKeyPacking.h"
+
+// Compact layout of a one-to-many table, an alternative to the
+// pos|count|row ids arrays for tables that stay resident (see
+// CompactOneToMany.h). Entries are grouped into blocks of
+// g_compact_one_to_many_block_entries:
+//   block word offsets:     int64_t per block + 1, first row id word of the
+//                           block (blocks start on a word boundary)
+//   block overflow offsets: int64_t per block + 1, first overflow count of
+//                           the block
+//   overflow counts:        int64_t per entry whose count doesn't fit its
+//                           code, in entry order
+//   counts:                 count_bits code per entry, the all ones code
+//                           meaning that the count is in the overflow counts
+//   row ids:                bit stream of uint32_t words, the row ids of the
+//                           entries one after the other
+// Positions are not stored, a lookup sums the counts of the entries before
+// it in its block. Row ids are row_id_bits wide. With delta_row_ids, the row
+// ids of an entry are sorted and only the first one is stored whole, followed
+// (if there are more) by the g_compact_delta_width_bits width w of the gaps
+// and by the gaps minus one in w bits each, so that runs of consecutive rows
+// take no bits. Sections are cache line aligned.
+constexpr size_t g_compact_one_to_many_block_entries{64};
+constexpr size_t g_compact_one_to_many_alignment{64};
+constexpr uint32_t g_compact_delta_width_bits{6};
+
+inline size_t align_compact_section(const size_t bytes) {
+  return (bytes + g_compact_one_to_many_alignment - 1) /
+         g_compact_one_to_many_alignment * g_compact_one_to_many_alignment;
+}
+
+inline uint64_t read_packed_bits(const uint32_t *words,
+                                 const int64_t bit_offset,
+                                 const uint32_t width) {
+  uint64_t value = 0;
+  for (uint32_t done = 0; done < width;) {
+    const int64_t bit = bit_offset + done;
+    const uint32_t shift = bit % 32;
+    const uint32_t take = sycl::min(32 - shift, width - done);
+    const uint64_t chunk =
+        (words[bit / 32] >> shift) & ((uint64_t{1} << take) - 1);
+    value |= chunk << done;
+    done += take;
+  }
+  return value;
+}
+
+// ORs value into zeroed words
+inline void write_packed_bits(uint32_t *words, const int64_t bit_offset,
+                              const uint32_t width, const uint64_t value) {
+  for (uint32_t done = 0; done < width;) {
+    const int64_t bit = bit_offset + done;
+    const uint32_t shift = bit % 32;
+    const uint32_t take = sycl::min(32 - shift, width - done);
+    const uint64_t chunk = (value >> done) & ((uint64_t{1} << take) - 1);
+    words[bit / 32] |= static_cast<uint32_t>(chunk << shift);
+    done += take;
+  }
+}
+
+// Choices of the compact layout
+struct CompactOneToManyOptions {
+  uint32_t count_bits{8}; // 8 or 16
+  bool delta_row_ids{false};
+};
+
+// Shape of a compact table, from plan_compact_one_to_many_on_l0
+struct CompactOneToManySpec {
+  int64_t entry_count;
+  uint32_t count_bits;
+  uint32_t row_id_bits;
+  bool delta_row_ids;
+  int64_t overflow_count;
+  int64_t row_id_word_count;
+
+  int64_t get_block_count() const {
+    return (entry_count + g_compact_one_to_many_block_entries - 1) /
+           g_compact_one_to_many_block_entries;
+  }
+  uint32_t get_overflow_code() const {
+    return static_cast<uint32_t>((uint64_t{1} << count_bits) - 1);
+  }
+  size_t get_block_section_size() const {
+    return align_compact_section((get_block_count() + 1) * sizeof(int64_t));
+  }
+  size_t get_block_overflow_offsets_offset() const {
+    return get_block_section_size();
+  }
+  size_t get_overflow_counts_offset() const {
+    return 2 * get_block_section_size();
+  }
+  size_t get_counts_offset() const {
+    return get_overflow_counts_offset() +
+           align_compact_section(overflow_count * sizeof(int64_t));
+  }
+  size_t get_row_ids_offset() const {
+    return get_counts_offset() +
+           align_compact_section(entry_count * (count_bits / 8));
+  }
+  // Size in bytes of the buffer of the table
+  size_t get_buff_size() const {
+    return get_row_ids_offset() + row_id_word_count * sizeof(uint32_t);
+  }
+  // Bits of the row ids of an entry of count rows, w is the width of its gaps
+  int64_t get_row_ids_bits(const int64_t count, const uint32_t w) const {
+    if (!delta_row_ids) {
+      return count * row_id_bits;
+    }
+    return count > 1
+               ? row_id_bits + g_compact_delta_width_bits + (count - 1) * w
+               : count * row_id_bits;
+  }
+};
+
+// Device view of a compact table, also the decoder of the probes
+struct CompactOneToManyTable {
+  int8_t *buff;
+  CompactOneToManySpec spec;
+
+  int64_t *block_word_offsets() const {
+    return reinterpret_cast<int64_t *>(buff);
+  }
+  int64_t *block_overflow_offsets() const {
+    return reinterpret_cast<int64_t *>(
+        buff + spec.get_block_overflow_offsets_offset());
+  }
+  int64_t *overflow_counts() const {
+    return reinterpret_cast<int64_t *>(buff +
+                                       spec.get_overflow_counts_offset());
+  }
+  uint32_t *row_id_words() const {
+    return reinterpret_cast<uint32_t *>(buff + spec.get_row_ids_offset());
+  }
+  uint32_t get_count_code(const int64_t entry) const {
+    const int8_t *counts = buff + spec.get_counts_offset();
+    return spec.count_bits == 8
+               ? reinterpret_cast<const uint8_t *>(counts)[entry]
+               : reinterpret_cast<const uint16_t *>(counts)[entry];
+  }
+  void set_count_code(const int64_t entry, const uint32_t code) const {
+    int8_t *counts = buff + spec.get_counts_offset();
+    if (spec.count_bits == 8) {
+      reinterpret_cast<uint8_t *>(counts)[entry] = static_cast<uint8_t>(code);
+    } else {
+      reinterpret_cast<uint16_t *>(counts)[entry] = static_cast<uint16_t>(code);
+    }
+  }
+  // Width of the gaps of an entry of count rows whose bits start at bit_offset
+  uint32_t get_delta_width(const int64_t count,
+                           const int64_t bit_offset) const {
+    return spec.delta_row_ids && count > 1
+               ? read_packed_bits(row_id_words(), bit_offset + spec.row_id_bits,
+                                  g_compact_delta_width_bits)
+               : 0;
+  }
+
+  // Row count of entry, stores the bit offset of its row ids in bit_offset.
+  // Walks the entries before it in its block.
+  int64_t locate(const int64_t entry, int64_t &bit_offset) const {
+    const int64_t block = entry / g_compact_one_to_many_block_entries;
+    const uint32_t overflow_code = spec.get_overflow_code();
+    int64_t overflow_idx = block_overflow_offsets()[block];
+    bit_offset = block_word_offsets()[block] * 32;
+    for (int64_t e = block * g_compact_one_to_many_block_entries;; ++e) {
+      const uint32_t code = get_count_code(e);
+      const int64_t count =
+          code == overflow_code ? overflow_counts()[overflow_idx++] : code;
+      if (e == entry) {
+        return count;
+      }
+      bit_offset +=
+          spec.get_row_ids_bits(count, get_delta_width(count, bit_offset));
+    }
+  }
+
+  int64_t get_count(const int64_t entry) const {
+    int64_t bit_offset;
+    return locate(entry, bit_offset);
+  }
+
+  // Calls func(row_id) for the rows of entry
+  template <typename FUNC>
+  void for_each_row_id(const int64_t entry, FUNC func) const {
+    int64_t bit_offset;
+    const int64_t count = locate(entry, bit_offset);
+    if (!count) {
+      return;
+    }
+    const uint32_t *words = row_id_words();
+    if (!spec.delta_row_ids) {
+      for (int64_t i = 0; i < count; ++i) {
+        func(static_cast<int64_t>(read_packed_bits(
+            words, bit_offset + i * spec.row_id_bits, spec.row_id_bits)));
+      }
+      return;
+    }
+    int64_t row_id = read_packed_bits(words, bit_offset, spec.row_id_bits);
+    func(row_id);
+    const uint32_t w = get_delta_width(count, bit_offset);
+    bit_offset += spec.row_id_bits + g_compact_delta_width_bits;
+    for (int64_t i = 1; i < count; ++i, bit_offset += w) {
+      row_id +=
+          static_cast<int64_t>(read_packed_bits(words, bit_offset, w)) + 1;
+      func(row_id);
+    }
+  }
+};
+
+#endif // SHARED_COMPACT_ONE_TO_MANY_LAYOUT_H__
@@ -0,0 +1,135 @@
+#include "ExecutionContext.h"
+#include "Profiling.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+// GPUs want many resident work items with few rows each to hide the memory
+// latency, CPU work items map to SIMD lanes of few threads and want long
+// loops.
+constexpr LaunchConfig g_gpu_launch_config{256, 4};
+constexpr LaunchConfig g_cpu_launch_config{128, 32};
+
+ExecutionContext::ExecutionContext()
+    : queue_(std::in_place,
+             sycl::property_list{sycl::property::queue::in_order{}}) {
+  build_kernel_bundle();
+  init_launch_config();
+}
+
+ExecutionContext::ExecutionContext(const sycl::device &device)
+    : queue_(std::in_place, device,
+             sycl::property_list{sycl::property::queue::in_order{}}) {
+  build_kernel_bundle();
+  init_launch_config();
+}
+
+ExecutionContext::ExecutionContext(const sycl::queue &queue)
+    : queue_(queue.is_in_order()
+                 ? queue
+                 : sycl::queue(queue.get_context(), queue.get_device(),
+                               sycl::property_list{
+                                   sycl::property::queue::in_order{}})) {
+  build_kernel_bundle();
+  init_launch_config();
+}
+
+ExecutionContext::ExecutionContext(const HostBackend &host_backend)
+    : host_pool_(std::make_unique<HostThreadPool>(host_backend.thread_count)) {
+  init_launch_config();
+}
+
+ExecutionContext::~ExecutionContext() {
+  if (queue_) {
+    queue_->wait();
+  }
+  for (auto ptr : retired_scratch_) {
+    free_scratch(ptr);
+  }
+  for (auto ptr : scratch_) {
+    if (ptr) {
+      free_scratch(ptr);
+    }
+  }
+}
+
+void *ExecutionContext::get_scratch(const ScratchSlot slot, const size_t bytes) {
+  auto &scratch = scratch_[static_cast<int>(slot)];
+  auto &scratch_size = scratch_size_[static_cast<int>(slot)];
+  if (bytes > scratch_size) {
+    if (scratch) {
+      retired_scratch_.push_back(scratch);
+    }
+    scratch_size = std::max(bytes, 2 * scratch_size);
+    scratch = queue_ ? sycl::malloc_device(scratch_size, *queue_)
+                     : std::malloc(scratch_size);
+  }
+  return scratch;
+}
+
+void ExecutionContext::free_scratch(void *ptr) {
+  if (queue_) {
+    sycl::free(ptr, *queue_);
+  } else {
+    std::free(ptr);
+  }
+}
+
+void ExecutionContext::build_kernel_bundle() {
+  try {
+    kernel_bundle_ = sycl::get_kernel_bundle<sycl::bundle_state::executable>(
+        queue_->get_context(), {queue_->get_device()});
+  } catch (const sycl::exception &) {
+    // Some kernels may not be buildable for this device (e.g. no fp64
+    // support). Fall back to lazy per-kernel JIT, which the runtime still
+    // caches per context.
+    kernel_bundle_.reset();
+  }
+}
+
+void ExecutionContext::init_launch_config() {
+  set_launch_config(!queue_ || get_device().is_cpu() ? g_cpu_launch_config
+                                                     : g_gpu_launch_config);
+}
+
+void ExecutionContext::set_launch_config(const LaunchConfig &launch_config) {
+  // The host backend splits the rows by work-group size * rows per item too
+  const size_t max_work_group_size =
+      queue_ ? get_device().get_info<sycl::info::device::max_work_group_size>()
+             : launch_config.work_group_size;
+  launch_config_.work_group_size = std::max<size_t>(
+      1, std::min(launch_config.work_group_size, max_work_group_size));
+  launch_config_.items_per_work_item =
+      std::max<size_t>(1, launch_config.items_per_work_item);
+}
+
+void ExecutionContext::set_profiler(KernelProfiler *profiler,
+                                    const std::string &track_name) {
+  if (profiler && queue_ &&
+      !queue_->has_property<sycl::property::queue::enable_profiling>()) {
+    queue_->wait();
+    const auto context = queue_->get_context();
+    const auto device = queue_->get_device();
+    queue_.emplace(context, device,
+                   sycl::property_list{
+                       sycl::property::queue::in_order{},
+                       sycl::property::queue::enable_profiling{}});
+  }
+  if (profiler_ && profiler_ != profiler) {
+    profiler_->flush();
+  }
+  profiler_ = profiler;
+  if (profiler) {
+    profiler_track_ = profiler->add_track(
+        !track_name.empty() ? track_name
+        : queue_ ? get_device().get_info<sycl::info::device::name>()
+                 : std::string("host"));
+  }
+}
+
+ExecutionContext &ExecutionContext::get_default() {
+  // Intentionally leaked: destroying a queue during static destruction races
+  // with the SYCL runtime teardown.
+  static ExecutionContext *default_ctx = new ExecutionContext();
+  return *default_ctx;
+}
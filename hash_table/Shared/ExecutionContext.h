@@ -0,0 +1,129 @@
+#ifndef EXECUTION_CONTEXT_H__
+#define EXECUTION_CONTEXT_H__
+
+#include <CL/sycl.hpp>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "HostThreadPool.h"
+
+// Independent scratch buffers of an ExecutionContext (and of a
+// MultiDeviceContext), one per kind of temporary that has to outlive the
+// commands of another kind.
+enum class ScratchSlot : int {
+  Scan = 0,
+  Probe,
+  ChunkOffsets,
+  Result,
+  Bitmap,
+  Partition,
+  Exchange,
+  NumSlots
+};
+
+// Launch shape of the kernels iterating over the rows of the join columns:
+// every work item handles about items_per_work_item rows in a grid-stride
+// loop.
+struct LaunchConfig {
+  size_t work_group_size;
+  size_t items_per_work_item;
+};
+
+// Selects the host backend: the builders run as C++ threads of a
+// HostThreadPool of thread_count threads (0: one per hardware thread) on
+// host memory, with the same table layouts as the device builds.
+struct HostBackend {
+  size_t thread_count;
+};
+
+class KernelProfiler;
+
+//! Owns the device, context, in-order queue and prebuilt kernels used by the
+//! builders. Creating a sycl::queue selects a device and creates a context,
+//! so HDK is expected to create one ExecutionContext and pass it to every
+//! call. The entry points without a context argument use get_default().
+//!
+//! All the commands of a build are submitted to the same in-order queue, so
+//! the asynchronous entry points only attach the caller's dependencies to
+//! their first command. A context must not be used by several host threads
+//! at the same time.
+//!
+//! A host context (HostBackend) has no queue and starts no SYCL runtime. It
+//! supports the perfect and baseline init, fill and one-to-many builders, the
+//! HyperLogLog sketches (approximate_distinct_tuples_on_l0, the merge and the
+//! estimate) and the Bloom filter init and filters, which then run
+//! synchronously and return a complete event after waiting for their
+//! dependencies.
+class ExecutionContext {
+public:
+  ExecutionContext();
+  explicit ExecutionContext(const sycl::device &device);
+  // Adopts a queue created by the caller (e.g. to share HDK's context). An
+  // out-of-order queue is replaced by an in-order one on the same context.
+  explicit ExecutionContext(const sycl::queue &queue);
+  explicit ExecutionContext(const HostBackend &host_backend);
+  ~ExecutionContext();
+
+  ExecutionContext(const ExecutionContext &) = delete;
+  ExecutionContext &operator=(const ExecutionContext &) = delete;
+
+  sycl::queue &get_queue() {
+    assert(queue_ && "not supported by the host backend");
+    return *queue_;
+  }
+  sycl::device get_device() const { return queue_->get_device(); }
+  sycl::context get_context() const { return queue_->get_context(); }
+
+  bool is_host() const { return host_pool_ != nullptr; }
+  HostThreadPool &get_host_pool() { return *host_pool_; }
+
+  // Device memory (host memory for a host context) for temporaries of the
+  // builders (e.g. scan block sums).
+  // The buffer of a slot is reused by consecutive commands, which is safe
+  // because the queue is in-order. A grown buffer replaces the previous one,
+  // which is released when the context is destroyed since commands still in
+  // flight may use it.
+  void *get_scratch(const ScratchSlot slot, const size_t bytes);
+
+  // Defaults depend on the device type, the work-group size is clamped to the
+  // maximum of the device.
+  const LaunchConfig &get_launch_config() const { return launch_config_; }
+  void set_launch_config(const LaunchConfig &launch_config);
+
+  // Reports every kernel of the builders to profiler (nullptr: none). A
+  // device queue is recreated with enable_profiling on the same context if
+  // it lacks it, after the commands submitted so far have completed. The
+  // kernels of the context show up as track track_name (the device name if
+  // empty) of the profiler, which must stay alive until it is detached or
+  // the context is destroyed.
+  void set_profiler(KernelProfiler *profiler,
+                    const std::string &track_name = {});
+  KernelProfiler *get_profiler() const { return profiler_; }
+  uint32_t get_profiler_track() const { return profiler_track_; }
+
+  static ExecutionContext &get_default();
+
+private:
+  void build_kernel_bundle();
+  void init_launch_config();
+  void free_scratch(void *ptr);
+
+  std::optional<sycl::queue> queue_;
+  std::unique_ptr<HostThreadPool> host_pool_;
+  // Keeps the JIT-compiled program alive for the lifetime of the context, so
+  // that the first submission of every kernel does not pay for the build.
+  std::optional<sycl::kernel_bundle<sycl::bundle_state::executable>>
+      kernel_bundle_;
+  void *scratch_[static_cast<int>(ScratchSlot::NumSlots)]{};
+  size_t scratch_size_[static_cast<int>(ScratchSlot::NumSlots)]{};
+  std::vector<void *> retired_scratch_;
+  LaunchConfig launch_config_;
+  KernelProfiler *profiler_{nullptr};
+  uint32_t profiler_track_{0};
+};
+
+#endif // EXECUTION_CONTEXT_H__
@@ -0,0 +1,291 @@
+#include "HashTableStats.h"
+
+#include <algorithm>
+
+#include "../MurMurHash.h"
+#include "ExecutionContext.h"
+#include "JoinColumnLaunch.h"
+#include "Profiling.h"
+#include "Shared.h"
+
+namespace {
+
+void add_to_distribution(HashTableDistribution *distribution,
+                         const int64_t count, const int64_t sum,
+                         const int64_t max) {
+  if (!count) {
+    return;
+  }
+  using atomic_stat = sycl::atomic_ref<int64_t, sycl::memory_order::relaxed,
+                                       sycl::memory_scope::device>;
+  atomic_stat(distribution->count).fetch_add(count);
+  atomic_stat(distribution->sum).fetch_add(sum);
+  atomic_stat(distribution->max).fetch_max(max);
+}
+
+void add_to_histogram(HashTableDistribution *distribution, const size_t bin,
+                      const int64_t count) {
+  sycl::atomic_ref<int64_t, sycl::memory_order::relaxed,
+                   sycl::memory_scope::device>
+      atomic_bin(distribution->histogram[bin]);
+  atomic_bin.fetch_add(count);
+}
+
+// Adds get_value(idx) of the entries idx < entry_count for which it is not
+// negative to distribution (a member of stats). Every work-group (host task)
+// builds its histogram in local memory and reduces the count, sum and max of
+// its entries, then merges them with one atomic per field and non-zero bin.
+template <typename VALUE_FUNC>
+sycl::event add_distribution_async(ExecutionContext &ctx,
+                                   const KernelInfo &info,
+                                   const int64_t entry_count,
+                                   HashTableStats *stats,
+                                   HashTableDistribution *distribution,
+                                   VALUE_FUNC get_value,
+                                   const std::vector<sycl::event> &deps) {
+  return submit_profiled(ctx, info, [&] {
+    if (ctx.is_host()) {
+      return run_on_host(deps, [&] {
+        host_parallel_for_rows(
+            ctx, entry_count, [&](const size_t begin, const size_t end) {
+              int64_t histogram[g_hash_table_stats_bins]{};
+              int64_t count = 0;
+              int64_t sum = 0;
+              int64_t max = 0;
+              for (size_t idx = begin; idx < end; ++idx) {
+                const int64_t value = get_value(idx);
+                if (value < 0) {
+                  continue;
+                }
+                ++count;
+                sum += value;
+                max = std::max(max, value);
+                ++histogram[get_hash_table_stats_bin(value)];
+              }
+              add_to_distribution(distribution, count, sum, max);
+              for (size_t bin = 0; bin < g_hash_table_stats_bins; ++bin) {
+                if (histogram[bin]) {
+                  add_to_histogram(distribution, bin, histogram[bin]);
+                }
+              }
+            });
+        stats->entry_count = entry_count;
+      });
+    }
+    const auto launch_config = ctx.get_launch_config();
+    return ctx.get_queue().submit([&](sycl::handler &h) {
+      h.depends_on(deps);
+      sycl::local_accessor<uint32_t, 1> local_histogram(
+          sycl::range<1>{g_hash_table_stats_bins}, h);
+      h.parallel_for(
+          get_grid_stride_nd_range(launch_config, entry_count),
+          [=](sycl::nd_item<1> item) {
+            const auto group = item.get_group();
+            const size_t local_id = item.get_local_id(0);
+            const size_t local_range = item.get_local_range(0);
+            for (size_t bin = local_id; bin < g_hash_table_stats_bins;
+                 bin += local_range) {
+              local_histogram[bin] = 0;
+            }
+            sycl::group_barrier(group);
+            int64_t count = 0;
+            int64_t sum = 0;
+            int64_t max = 0;
+            for (size_t idx = item.get_global_id(0);
+                 idx < static_cast<size_t>(entry_count);
+                 idx += item.get_global_range(0)) {
+              const int64_t value = get_value(idx);
+              if (value < 0) {
+                continue;
+              }
+              ++count;
+              sum += value;
+              max = sycl::max(max, value);
+              sycl::atomic_ref<uint32_t, sycl::memory_order::relaxed,
+                               sycl::memory_scope::work_group,
+                               sycl::access::address_space::local_space>
+                  atomic_bin(local_histogram[get_hash_table_stats_bin(value)]);
+              atomic_bin.fetch_add(1);
+            }
+            count =
+                sycl::reduce_over_group(group, count, sycl::plus<int64_t>());
+            sum = sycl::reduce_over_group(group, sum, sycl::plus<int64_t>());
+            max = sycl::reduce_over_group(group, max, sycl::maximum<int64_t>());
+            sycl::group_barrier(group);
+            if (!local_id) {
+              add_to_distribution(distribution, count, sum, max);
+              if (!item.get_group(0)) {
+                stats->entry_count = entry_count;
+              }
+            }
+            for (size_t bin = local_id; bin < g_hash_table_stats_bins;
+                 bin += local_range) {
+              if (local_histogram[bin]) {
+                add_to_histogram(distribution, bin, local_histogram[bin]);
+              }
+            }
+          });
+    });
+  });
+}
+
+// Copies stats to the host once computed is complete
+HashTableStats read_hash_table_stats(ExecutionContext &ctx,
+                                     const HashTableStats *stats,
+                                     const sycl::event &computed) {
+  if (ctx.is_host()) {
+    return *stats;
+  }
+  HashTableStats result;
+  ctx.get_queue()
+      .memcpy(&result, stats, sizeof(HashTableStats), computed)
+      .wait();
+  return result;
+}
+
+} // namespace
+
+sycl::event init_hash_table_stats_on_l0_async(
+    ExecutionContext &ctx, HashTableStats *stats,
+    const std::vector<sycl::event> &deps) {
+  const KernelInfo info{"hash_table_stats_init", 0, 0, sizeof(HashTableStats)};
+  return submit_profiled(ctx, info, [&] {
+    if (ctx.is_host()) {
+      return run_on_host(deps, [&] { *stats = HashTableStats{}; });
+    }
+    return ctx.get_queue().memset(stats, 0, sizeof(HashTableStats), deps);
+  });
+}
+
+template <typename T>
+sycl::event compute_baseline_hash_table_stats_on_l0_async(
+    ExecutionContext &ctx, const int8_t *hash_buff, const int64_t entry_count,
+    const size_t key_component_count, const bool with_val_slot,
+    HashTableStats *stats, const std::vector<sycl::event> &deps) {
+  const T *entries = reinterpret_cast<const T *>(hash_buff);
+  const size_t key_size_in_bytes = key_component_count * sizeof(T);
+  const size_t hash_entry_size = key_component_count + with_val_slot;
+  // Linear probing from the home slot, wrapping around at the end
+  auto get_probe_distance = [=](const size_t idx) -> int64_t {
+    const T *key = entries + idx * hash_entry_size;
+    if (*key == get_invalid_key<T>()) {
+      return -1;
+    }
+    const int64_t home =
+        MurmurHash1Impl(key, key_size_in_bytes, 0) % entry_count;
+    return (static_cast<int64_t>(idx) - home + entry_count) % entry_count;
+  };
+  const KernelInfo info{
+      "baseline_hash_table_stats", 0, entry_count,
+      entry_count * static_cast<int64_t>(hash_entry_size * sizeof(T))};
+  return add_distribution_async(ctx, info, entry_count, stats,
+                                &stats->probe_distances, get_probe_distance,
+                                deps);
+}
+
+template <typename ROW_ID>
+sycl::event compute_perfect_hash_table_stats_on_l0_async(
+    ExecutionContext &ctx, const ROW_ID *buff, const int64_t entry_count,
+    const int32_t invalid_slot_val, HashTableStats *stats,
+    const std::vector<sycl::event> &deps) {
+  // Every key has its own slot
+  auto get_probe_distance = [=](const size_t idx) -> int64_t {
+    return buff[idx] != invalid_slot_val ? 0 : -1;
+  };
+  const KernelInfo info{"perfect_hash_table_stats", 0, entry_count,
+                        entry_count * static_cast<int64_t>(sizeof(ROW_ID))};
+  return add_distribution_async(ctx, info, entry_count, stats,
+                                &stats->probe_distances, get_probe_distance,
+                                deps);
+}
+
+template <typename ROW_ID>
+sycl::event compute_one_to_many_stats_on_l0_async(
+    ExecutionContext &ctx, const ROW_ID *buff, const int64_t hash_entry_count,
+    HashTableStats *stats, const std::vector<sycl::event> &deps) {
+  const ROW_ID *count_buff = buff + hash_entry_count;
+  auto get_bucket_size = [=](const size_t idx) -> int64_t {
+    return count_buff[idx] ? count_buff[idx] : -1;
+  };
+  const KernelInfo info{
+      "one_to_many_stats", 0, hash_entry_count,
+      hash_entry_count * static_cast<int64_t>(sizeof(ROW_ID))};
+  return add_distribution_async(ctx, info, hash_entry_count, stats,
+                                &stats->bucket_sizes, get_bucket_size, deps);
+}
+
+template <typename T>
+HashTableStats compute_baseline_hash_table_stats_on_l0(
+    ExecutionContext &ctx, const int8_t *hash_buff, const int64_t entry_count,
+    const size_t key_component_count, const bool with_val_slot) {
+  auto stats = reinterpret_cast<HashTableStats *>(
+      ctx.get_scratch(ScratchSlot::Result, sizeof(HashTableStats)));
+  auto initialized = init_hash_table_stats_on_l0_async(ctx, stats, {});
+  auto computed = compute_baseline_hash_table_stats_on_l0_async<T>(
+      ctx, hash_buff, entry_count, key_component_count, with_val_slot, stats,
+      {initialized});
+  return read_hash_table_stats(ctx, stats, computed);
+}
+
+template <typename ROW_ID>
+HashTableStats compute_perfect_hash_table_stats_on_l0(
+    ExecutionContext &ctx, const ROW_ID *buff, const int64_t entry_count,
+    const int32_t invalid_slot_val) {
+  auto stats = reinterpret_cast<HashTableStats *>(
+      ctx.get_scratch(ScratchSlot::Result, sizeof(HashTableStats)));
+  auto initialized = init_hash_table_stats_on_l0_async(ctx, stats, {});
+  auto computed = compute_perfect_hash_table_stats_on_l0_async(
+      ctx, buff, entry_count, invalid_slot_val, stats, {initialized});
+  return read_hash_table_stats(ctx, stats, computed);
+}
+
+template <typename ROW_ID>
+HashTableStats compute_one_to_many_stats_on_l0(ExecutionContext &ctx,
+                                               const ROW_ID *buff,
+                                               const int64_t hash_entry_count) {
+  auto stats = reinterpret_cast<HashTableStats *>(
+      ctx.get_scratch(ScratchSlot::Result, sizeof(HashTableStats)));
+  auto initialized = init_hash_table_stats_on_l0_async(ctx, stats, {});
+  auto computed = compute_one_to_many_stats_on_l0_async(
+      ctx, buff, hash_entry_count, stats, {initialized});
+  return read_hash_table_stats(ctx, stats, computed);
+}
+
+template sycl::event compute_baseline_hash_table_stats_on_l0_async<int32_t>(
+    ExecutionContext &ctx, const int8_t *hash_buff, const int64_t entry_count,
+    const size_t key_component_count, const bool with_val_slot,
+    HashTableStats *stats, const std::vector<sycl::event> &deps);
+template sycl::event compute_baseline_hash_table_stats_on_l0_async<int64_t>(
+    ExecutionContext &ctx, const int8_t *hash_buff, const int64_t entry_count,
+    const size_t key_component_count, const bool with_val_slot,
+    HashTableStats *stats, const std::vector<sycl::event> &deps);
+template HashTableStats compute_baseline_hash_table_stats_on_l0<int32_t>(
+    ExecutionContext &ctx, const int8_t *hash_buff, const int64_t entry_count,
+    const size_t key_component_count, const bool with_val_slot);
+template HashTableStats compute_baseline_hash_table_stats_on_l0<int64_t>(
+    ExecutionContext &ctx, const int8_t *hash_buff, const int64_t entry_count,
+    const size_t key_component_count, const bool with_val_slot);
+template sycl::event compute_perfect_hash_table_stats_on_l0_async<int32_t>(
+    ExecutionContext &ctx, const int32_t *buff, const int64_t entry_count,
+    const int32_t invalid_slot_val, HashTableStats *stats,
+    const std::vector<sycl::event> &deps);
+template sycl::event compute_perfect_hash_table_stats_on_l0_async<int64_t>(
+    ExecutionContext &ctx, const int64_t *buff, const int64_t entry_count,
+    const int32_t invalid_slot_val, HashTableStats *stats,
+    const std::vector<sycl::event> &deps);
+template sycl::event compute_one_to_many_stats_on_l0_async<int32_t>(
+    ExecutionContext &ctx, const int32_t *buff, const int64_t hash_entry_count,
+    HashTableStats *stats, const std::vector<sycl::event> &deps);
+template sycl::event compute_one_to_many_stats_on_l0_async<int64_t>(
+    ExecutionContext &ctx, const int64_t *buff, const int64_t hash_entry_count,
+    HashTableStats *stats, const std::vector<sycl::event> &deps);
+template HashTableStats compute_perfect_hash_table_stats_on_l0<int32_t>(
+    ExecutionContext &ctx, const int32_t *buff, const int64_t entry_count,
+    const int32_t invalid_slot_val);
+template HashTableStats compute_perfect_hash_table_stats_on_l0<int64_t>(
+    ExecutionContext &ctx, const int64_t *buff, const int64_t entry_count,
+    const int32_t invalid_slot_val);
+template HashTableStats compute_one_to_many_stats_on_l0<int32_t>(
+    ExecutionContext &ctx, const int32_t *buff, const int64_t hash_entry_count);
+template HashTableStats compute_one_to_many_stats_on_l0<int64_t>(
+    ExecutionContext &ctx, const int64_t *buff, const int64_t hash_entry_count);
@@ -0,0 +1,103 @@
+#ifndef SHARED_HASH_TABLE_STATS_H__
+#define SHARED_HASH_TABLE_STATS_H__
+
+#include <CL/sycl.hpp>
+#include <vector>
+
+#include "../CommonDecls.h"
+#include "../Types.h"
+
+// Histograms have power of two bins: bin 0 counts the value 0, bin i > 0 the
+// values in [2^(i-1), 2^i), the last bin everything above.
+constexpr size_t g_hash_table_stats_bins{32};
+
+inline size_t get_hash_table_stats_bin(const uint64_t value) {
+  const size_t bin = value ? 64 - sycl::clz(value) : 0;
+  return bin < g_hash_table_stats_bins ? bin : g_hash_table_stats_bins - 1;
+}
+
+// Distribution of a per entry quantity over count entries
+struct HashTableDistribution {
+  int64_t count;
+  int64_t sum;
+  int64_t max;
+  int64_t histogram[g_hash_table_stats_bins];
+};
+
+// Quality of a built table, filled on the device by the builder overloads
+// that take a HashTableStats pointer (device accessible memory).
+// probe_distances is over the occupied entries of a one-to-one or key only
+// table: how far an entry is from the home slot of its key (0 for perfect
+// tables). bucket_sizes is over the non-empty buckets of a one-to-many table
+// (rows per bucket, from its count_buff). cas_retries counts the CASes lost
+// to other inserters while claiming a slot (flat baseline tables only).
+struct HashTableStats {
+  int64_t entry_count;
+  HashTableDistribution probe_distances;
+  HashTableDistribution bucket_sizes;
+  int64_t cas_retries;
+
+  double get_load_factor() const {
+    const int64_t occupied = probe_distances.count ? probe_distances.count
+                                                   : bucket_sizes.count;
+    return entry_count ? static_cast<double>(occupied) / entry_count : 0.;
+  }
+  double get_average_probe_distance() const {
+    return probe_distances.count ? static_cast<double>(probe_distances.sum) /
+                                       probe_distances.count
+                                 : 0.;
+  }
+  double get_average_bucket_size() const {
+    return bucket_sizes.count
+               ? static_cast<double>(bucket_sizes.sum) / bucket_sizes.count
+               : 0.;
+  }
+};
+
+// Zeroes stats
+sycl::event init_hash_table_stats_on_l0_async(
+    ExecutionContext &ctx, HashTableStats *stats,
+    const std::vector<sycl::event> &deps);
+
+// The compute functions set stats->entry_count and add the entries of the
+// table to their distribution of stats, which must have been initialized.
+
+// Flat baseline table of entry_count entries of key_component_count
+// components of T, plus a value slot if with_val_slot
+template <typename T>
+sycl::event compute_baseline_hash_table_stats_on_l0_async(
+    ExecutionContext &ctx, const int8_t *hash_buff, const int64_t entry_count,
+    const size_t key_component_count, const bool with_val_slot,
+    HashTableStats *stats, const std::vector<sycl::event> &deps);
+
+// Perfect one-to-one table of entry_count entries
+template <typename ROW_ID>
+sycl::event compute_perfect_hash_table_stats_on_l0_async(
+    ExecutionContext &ctx, const ROW_ID *buff, const int64_t entry_count,
+    const int32_t invalid_slot_val, HashTableStats *stats,
+    const std::vector<sycl::event> &deps);
+
+// Perfect or baseline one-to-many table (pos|count|row ids) of
+// hash_entry_count buckets
+template <typename ROW_ID>
+sycl::event compute_one_to_many_stats_on_l0_async(
+    ExecutionContext &ctx, const ROW_ID *buff, const int64_t hash_entry_count,
+    HashTableStats *stats, const std::vector<sycl::event> &deps);
+
+// Blocking variants, computing the stats of a single table from scratch
+template <typename T>
+HashTableStats compute_baseline_hash_table_stats_on_l0(
+    ExecutionContext &ctx, const int8_t *hash_buff, const int64_t entry_count,
+    const size_t key_component_count, const bool with_val_slot);
+
+template <typename ROW_ID>
+HashTableStats compute_perfect_hash_table_stats_on_l0(
+    ExecutionContext &ctx, const ROW_ID *buff, const int64_t entry_count,
+    const int32_t invalid_slot_val);
+
+template <typename ROW_ID>
+HashTableStats compute_one_to_many_stats_on_l0(ExecutionContext &ctx,
+                                               const ROW_ID *buff,
+                                               const int64_t hash_entry_count);
+
+#endif // SHARED_HASH_TABLE_STATS_H__
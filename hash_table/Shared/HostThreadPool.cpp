@@ -0,0 +1,115 @@
+#include "HostThreadPool.h"
+
+#include <algorithm>
+
+HostThreadPool::HostThreadPool(const size_t thread_count) {
+  const size_t total_threads =
+      thread_count ? thread_count
+                   : std::max<size_t>(1, std::thread::hardware_concurrency());
+  for (size_t i = 0; i < total_threads; ++i) {
+    queues_.push_back(std::make_unique<TaskQueue>());
+  }
+  // Queue 0 belongs to the thread calling run()
+  for (size_t i = 1; i < total_threads; ++i) {
+    threads_.emplace_back([this, i] { worker_loop(i); });
+  }
+}
+
+HostThreadPool::~HostThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+void HostThreadPool::run(const size_t task_count,
+                         const std::function<void(size_t)> &task) {
+  if (!task_count) {
+    return;
+  }
+  const size_t thread_count = queues_.size();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    remaining_tasks_ = task_count;
+    // Neighbouring tasks (neighbouring rows) start on the same thread
+    for (size_t i = 0; i < thread_count; ++i) {
+      std::lock_guard<std::mutex> queue_lock(queues_[i]->mutex);
+      for (size_t t = i * task_count / thread_count;
+           t < (i + 1) * task_count / thread_count; ++t) {
+        queues_[i]->tasks.push_back(t);
+      }
+    }
+    task_ = &task;
+    ++generation_;
+  }
+  work_cv_.notify_all();
+  work(0, task);
+  std::unique_lock<std::mutex> lock(mutex_);
+  // The workers still stealing must be out before task goes away
+  done_cv_.wait(lock, [this] {
+    return remaining_tasks_ == 0 && active_workers_ == 0;
+  });
+  task_ = nullptr;
+}
+
+bool HostThreadPool::pop_task(const size_t thread_idx, size_t &task_idx) {
+  {
+    auto &own = *queues_[thread_idx];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task_idx = own.tasks.back();
+      own.tasks.pop_back();
+      return true;
+    }
+  }
+  const size_t thread_count = queues_.size();
+  for (size_t i = 1; i < thread_count; ++i) {
+    auto &victim = *queues_[(thread_idx + i) % thread_count];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task_idx = victim.tasks.front();
+      victim.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+void HostThreadPool::work(const size_t thread_idx,
+                          const std::function<void(size_t)> &task) {
+  size_t task_idx;
+  while (pop_task(thread_idx, task_idx)) {
+    task(task_idx);
+    if (--remaining_tasks_ == 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      done_cv_.notify_all();
+    }
+  }
+}
+
+void HostThreadPool::worker_loop(const size_t thread_idx) {
+  size_t seen_generation = 0;
+  while (true) {
+    const std::function<void(size_t)> *task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_cv_.wait(lock, [&] {
+        return stop_ || (task_ && generation_ != seen_generation);
+      });
+      if (stop_) {
+        return;
+      }
+      seen_generation = generation_;
+      task = task_;
+      ++active_workers_;
+    }
+    work(thread_idx, *task);
+    std::lock_guard<std::mutex> lock(mutex_);
+    --active_workers_;
+    done_cv_.notify_all();
+  }
+}
@@ -0,0 +1,59 @@
+#ifndef HOST_THREAD_POOL_H__
+#define HOST_THREAD_POOL_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! Work-stealing thread pool of the host backend (see ExecutionContext).
+//! run() deals the tasks to per-thread deques in contiguous blocks; every
+//! thread pops its own tasks from the back and, once out of work, steals from
+//! the front of the others, so that uneven tasks (e.g. rows of skewed chunks)
+//! balance out. The calling thread takes part in the work. A pool runs one
+//! run() at a time.
+class HostThreadPool {
+public:
+  // thread_count 0 uses one thread per hardware thread
+  explicit HostThreadPool(const size_t thread_count);
+  ~HostThreadPool();
+
+  HostThreadPool(const HostThreadPool &) = delete;
+  HostThreadPool &operator=(const HostThreadPool &) = delete;
+
+  // Threads running the tasks, including the caller of run()
+  size_t get_thread_count() const { return queues_.size(); }
+
+  // Calls task(i) for every i in [0, task_count) and returns when all calls
+  // are done.
+  void run(const size_t task_count, const std::function<void(size_t)> &task);
+
+private:
+  struct TaskQueue {
+    std::mutex mutex;
+    std::deque<size_t> tasks;
+  };
+
+  bool pop_task(const size_t thread_idx, size_t &task_idx);
+  void work(const size_t thread_idx, const std::function<void(size_t)> &task);
+  void worker_loop(const size_t thread_idx);
+
+  std::vector<std::unique_ptr<TaskQueue>> queues_;
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  // Set while run() executes, guarded by mutex_
+  const std::function<void(size_t)> *task_{nullptr};
+  size_t generation_{0};
+  size_t active_workers_{0};
+  bool stop_{false};
+  std::atomic<size_t> remaining_tasks_{0};
+};
+
+#endif // HOST_THREAD_POOL_H__
@@ -0,0 +1,253 @@
+#ifndef SHARED_JOIN_COLUMN_LAUNCH_H__
+#define SHARED_JOIN_COLUMN_LAUNCH_H__
+
+#include <CL/sycl.hpp>
+#include <algorithm>
+
+#include "../JoinColumnIterator.h"
+#include "ExecutionContext.h"
+#include "Profiling.h"
+#include "Shared.h"
+
+// Enough work-groups of launch_config.work_group_size work items to cover
+// num_rows rows with items_per_work_item rows per work item. Kernels launched
+// with it walk the rows in a grid-stride loop (start at the global id, step by
+// the global range).
+inline sycl::nd_range<1> get_grid_stride_nd_range(const LaunchConfig &launch_config,
+                                                  const size_t num_rows) {
+  const size_t rows_per_group =
+      launch_config.work_group_size * launch_config.items_per_work_item;
+  const size_t num_groups =
+      std::max<size_t>(1, (num_rows + rows_per_group - 1) / rows_per_group);
+  return sycl::nd_range<1>{num_groups * launch_config.work_group_size,
+                           launch_config.work_group_size};
+}
+
+// Runs host_func on a host context once deps are complete. Returns a
+// complete event, the host counterpart of the event of the last command.
+template <typename FUNC>
+sycl::event run_on_host(const std::vector<sycl::event> &deps, FUNC host_func) {
+  sycl::event::wait(deps);
+  host_func();
+  return sycl::event{};
+}
+
+// Host counterpart of a grid-stride launch: splits num_rows rows into tasks
+// of the rows of one work-group (work_group_size * items_per_work_item) and
+// calls range_func(begin, end) for every task on the pool of ctx.
+template <typename RANGE_FUNC>
+void host_parallel_for_rows(ExecutionContext &ctx, const size_t num_rows,
+                            RANGE_FUNC range_func) {
+  const auto &launch_config = ctx.get_launch_config();
+  const size_t rows_per_task =
+      launch_config.work_group_size * launch_config.items_per_work_item;
+  ctx.get_host_pool().run(
+      (num_rows + rows_per_task - 1) / rows_per_task, [&](const size_t task) {
+        const size_t begin = task * rows_per_task;
+        range_func(begin, std::min(num_rows, begin + rows_per_task));
+      });
+}
+
+// Bytes of the values of join_column
+inline int64_t get_join_column_bytes(const JoinColumn &join_column) {
+  return join_column.num_elems * join_column.elem_sz;
+}
+
+// Sets count elements of buff to value
+template <typename T>
+sycl::event fill_buff_async(ExecutionContext &ctx, const char *kernel_name,
+                            T *buff, const T value, const size_t count,
+                            const std::vector<sycl::event> &deps) {
+  const KernelInfo info{kernel_name, 0, static_cast<int64_t>(count),
+                        static_cast<int64_t>(count * sizeof(T))};
+  return submit_profiled(ctx, info, [&] {
+    if (ctx.is_host()) {
+      return run_on_host(deps, [&] {
+        host_parallel_for_rows(ctx, count, [&](const size_t begin,
+                                               const size_t end) {
+          std::fill(buff + begin, buff + end, value);
+        });
+      });
+    }
+    return ctx.get_queue().fill(buff, value, count, deps);
+  });
+}
+
+// Builds the chunk offsets of join_column in the scratch memory of the
+// context, returns nullptr for single chunk columns which don't need them.
+// The offsets stay valid until the next call on the same context.
+inline size_t *get_chunk_offsets(ExecutionContext &ctx,
+                                 const JoinColumn &join_column,
+                                 std::vector<sycl::event> &deps) {
+  if (join_column.num_chunks <= 1) {
+    return nullptr;
+  }
+  auto chunk_offsets = reinterpret_cast<size_t *>(
+      ctx.get_scratch(ScratchSlot::ChunkOffsets,
+                      (join_column.num_chunks + 1) * sizeof(size_t)));
+  deps = {build_chunk_offsets_on_l0_async(ctx, join_column, chunk_offsets,
+                                          deps)};
+  return chunk_offsets;
+}
+
+// Calls row_func(iterator) for every row of join_column.
+// When a chunk is about the work of one work-group on average, every
+// work-group takes whole chunks (chunk-major) and needs no search at all.
+// Otherwise every work item steps through the column in a grid-stride loop,
+// binary searching chunk_offsets for its first row and for every step that
+// leaves its chunk.
+template <typename ROW_FUNC>
+void parallel_for_join_column_rows(sycl::handler &h,
+                                   const JoinColumn join_column,
+                                   const JoinColumnTypeInfo type_info,
+                                   const size_t *chunk_offsets,
+                                   const LaunchConfig launch_config,
+                                   ROW_FUNC row_func) {
+  const size_t work_group_size = launch_config.work_group_size;
+  const size_t avg_chunk_size =
+      chunk_offsets ? join_column.num_elems / join_column.num_chunks : 0;
+  if (avg_chunk_size >= work_group_size &&
+      avg_chunk_size <= work_group_size * launch_config.items_per_work_item) {
+    h.parallel_for(
+        sycl::nd_range<1>{join_column.num_chunks * work_group_size,
+                          work_group_size},
+        [=](sycl::nd_item<1> item) {
+          const size_t chunk_idx = item.get_group(0);
+          const size_t chunk_start = chunk_offsets[chunk_idx];
+          const size_t chunk_size = chunk_offsets[chunk_idx + 1] - chunk_start;
+          for (size_t i = item.get_local_id(0); i < chunk_size;
+               i += work_group_size) {
+            row_func(JoinColumnIterator(&join_column, &type_info, chunk_idx, i,
+                                        chunk_start + i, 1));
+          }
+        });
+    return;
+  }
+  h.parallel_for(
+      get_grid_stride_nd_range(launch_config, join_column.num_elems),
+      [=](sycl::nd_item<1> item) {
+        for (JoinColumnIterator it(&join_column, &type_info, chunk_offsets,
+                                   item.get_global_id(0),
+                                   item.get_global_range(0));
+             it; ++it) {
+          row_func(it);
+        }
+      });
+}
+
+// Submits a kernel calling row_func(iterator) for every row of join_column
+// after deps, or calls it from the host pool for a host context. info
+// describes the kernel to the profiler of ctx.
+template <typename ROW_FUNC>
+sycl::event submit_join_column_rows(ExecutionContext &ctx,
+                                    const KernelInfo &info,
+                                    const JoinColumn &join_column,
+                                    const JoinColumnTypeInfo &type_info,
+                                    const size_t *chunk_offsets,
+                                    const std::vector<sycl::event> &deps,
+                                    ROW_FUNC row_func) {
+  return submit_profiled(ctx, info, [&] {
+    if (ctx.is_host()) {
+      return run_on_host(deps, [&] {
+        host_parallel_for_rows(
+            ctx, join_column.num_elems,
+            [&](const size_t begin, const size_t end) {
+              JoinColumnIterator it(&join_column, &type_info, chunk_offsets,
+                                    begin, 1);
+              for (size_t row = begin; row < end && it; ++row, ++it) {
+                row_func(it);
+              }
+            });
+      });
+    }
+    const auto launch_config = ctx.get_launch_config();
+    return ctx.get_queue().submit([&](sycl::handler &h) {
+      h.depends_on(deps);
+      parallel_for_join_column_rows(h, join_column, type_info, chunk_offsets,
+                                    launch_config, row_func);
+    });
+  });
+}
+
+// Same for the rows [row_begin, row_end) of join_column only, e.g. the rows
+// of one device of a sharded build. The iterators keep the row ids of the
+// whole column.
+template <typename ROW_FUNC>
+sycl::event submit_join_column_row_range(
+    ExecutionContext &ctx, const KernelInfo &info,
+    const JoinColumn &join_column, const JoinColumnTypeInfo &type_info,
+    const size_t *chunk_offsets, const size_t row_begin, const size_t row_end,
+    const std::vector<sycl::event> &deps, ROW_FUNC row_func) {
+  const size_t num_rows = row_end - row_begin;
+  return submit_profiled(ctx, info, [&] {
+    if (ctx.is_host()) {
+      return run_on_host(deps, [&] {
+        host_parallel_for_rows(
+            ctx, num_rows, [&](const size_t begin, const size_t end) {
+              JoinColumnIterator it(&join_column, &type_info, chunk_offsets,
+                                    row_begin + begin, 1);
+              for (size_t row = begin; row < end && it; ++row, ++it) {
+                row_func(it);
+              }
+            });
+      });
+    }
+    const auto launch_config = ctx.get_launch_config();
+    return ctx.get_queue().submit([&](sycl::handler &h) {
+      h.depends_on(deps);
+      h.parallel_for(
+          get_grid_stride_nd_range(launch_config, num_rows),
+          [=](sycl::nd_item<1> item) {
+            for (JoinColumnIterator it(&join_column, &type_info, chunk_offsets,
+                                       row_begin + item.get_global_id(0),
+                                       item.get_global_range(0));
+                 it && it.index < row_end; ++it) {
+              row_func(it);
+            }
+          });
+    });
+  });
+}
+
+// Same for the keys of the first num_elems rows of key_handler (see
+// GenericKeyHandler::for_each_key). A non-zero result of key_buff_handler is
+// stored to err_buff unless it is nullptr.
+template <typename T, typename KEY_HANDLER, typename KEY_BUFF_HANDLER>
+sycl::event submit_for_each_key(ExecutionContext &ctx,
+                                const KernelInfo &info,
+                                const KEY_HANDLER *key_handler,
+                                const int64_t num_elems, int *err_buff,
+                                KEY_BUFF_HANDLER key_buff_handler,
+                                const std::vector<sycl::event> &deps) {
+  auto store_err = [err_buff](const int err) {
+    if (err && err_buff) {
+      sycl::atomic_ref<int32_t, sycl::memory_order::relaxed,
+                       sycl::memory_scope::device>
+          atomic_err_buff(*err_buff);
+      atomic_err_buff.store(err);
+    }
+  };
+  return submit_profiled(ctx, info, [&] {
+    if (ctx.is_host()) {
+      return run_on_host(deps, [&] {
+        host_parallel_for_rows(
+            ctx, num_elems, [&](const size_t begin, const size_t end) {
+              store_err(key_handler->template for_each_key_in_range<T>(
+                  begin, end, key_buff_handler));
+            });
+      });
+    }
+    const auto launch_config = ctx.get_launch_config();
+    return ctx.get_queue().submit([&](sycl::handler &h) {
+      h.depends_on(deps);
+      h.parallel_for(get_grid_stride_nd_range(launch_config, num_elems),
+                     [=](sycl::nd_item<1> item) {
+                       store_err(key_handler->template for_each_key<T>(
+                           item.get_global_id(0), item.get_global_range(0),
+                           key_buff_handler));
+                     });
+    });
+  });
+}
+
+#endif // SHARED_JOIN_COLUMN_LAUNCH_H__
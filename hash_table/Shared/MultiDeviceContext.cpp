@@ -0,0 +1,74 @@
+#include "MultiDeviceContext.h"
+
+#include <algorithm>
+#include <string>
+
+std::vector<sycl::device> get_sub_devices(const sycl::device &device) {
+  if (device.get_info<sycl::info::device::partition_max_sub_devices>() < 2) {
+    return {device};
+  }
+  try {
+    return device.create_sub_devices<
+        sycl::info::partition_property::partition_by_affinity_domain>(
+        sycl::info::partition_affinity_domain::next_partitionable);
+  } catch (const sycl::exception &) {
+    // The device supports other partitionings only
+    return {device};
+  }
+}
+
+MultiDeviceContext::MultiDeviceContext(const std::vector<sycl::device> &devices)
+    : context_(devices) {
+  for (const auto &device : devices) {
+    device_contexts_.push_back(std::make_unique<ExecutionContext>(sycl::queue(
+        context_, device,
+        sycl::property_list{sycl::property::queue::in_order{}})));
+    shared_atomics_ &=
+        device.has(sycl::aspect::usm_atomic_shared_allocations);
+  }
+}
+
+MultiDeviceContext::~MultiDeviceContext() {
+  for (auto &ctx : device_contexts_) {
+    ctx->get_queue().wait();
+  }
+  for (auto ptr : retired_scratch_) {
+    sycl::free(ptr, context_);
+  }
+  for (auto ptr : scratch_) {
+    if (ptr) {
+      sycl::free(ptr, context_);
+    }
+  }
+}
+
+void MultiDeviceContext::set_profiler(KernelProfiler *profiler) {
+  for (size_t device_idx = 0; device_idx < device_contexts_.size();
+       ++device_idx) {
+    auto &ctx = *device_contexts_[device_idx];
+    ctx.set_profiler(profiler,
+                     std::to_string(device_idx) + ": " +
+                         ctx.get_device().get_info<sycl::info::device::name>());
+  }
+}
+
+sycl::event MultiDeviceContext::join(const std::vector<sycl::event> &events) {
+  last_join_ =
+      device_contexts_.front()->get_queue().ext_oneapi_submit_barrier(events);
+  return last_join_;
+}
+
+void *MultiDeviceContext::get_scratch(const ScratchSlot slot,
+                                      const size_t bytes) {
+  auto &scratch = scratch_[static_cast<int>(slot)];
+  auto &scratch_size = scratch_size_[static_cast<int>(slot)];
+  if (bytes > scratch_size) {
+    if (scratch) {
+      retired_scratch_.push_back(scratch);
+    }
+    scratch_size = std::max(bytes, 2 * scratch_size);
+    scratch = sycl::malloc_shared(
+        scratch_size, device_contexts_.front()->get_device(), context_);
+  }
+  return scratch;
+}
@@ -0,0 +1,63 @@
+#ifndef MULTI_DEVICE_CONTEXT_H__
+#define MULTI_DEVICE_CONTEXT_H__
+
+#include <CL/sycl.hpp>
+#include <memory>
+#include <vector>
+
+#include "ExecutionContext.h"
+
+// Sub-devices of device by affinity domain (NUMA nodes of a multi-socket CPU,
+// tiles of a multi-tile GPU), or device itself if it can't be partitioned.
+std::vector<sycl::device> get_sub_devices(const sycl::device &device);
+
+//! Devices of a sharded build. They share one sycl::context, so that the USM
+//! allocations made on it (the tables, the join columns, the key handlers)
+//! are accessible from all of them and events of one device can be
+//! dependencies of commands of another. Every device gets its own
+//! ExecutionContext, i.e. its own in-order queue, scratch memory and launch
+//! config. The sharded builders run one shard per device.
+class MultiDeviceContext {
+public:
+  explicit MultiDeviceContext(const std::vector<sycl::device> &devices);
+  ~MultiDeviceContext();
+
+  MultiDeviceContext(const MultiDeviceContext &) = delete;
+  MultiDeviceContext &operator=(const MultiDeviceContext &) = delete;
+
+  size_t get_device_count() const { return device_contexts_.size(); }
+  ExecutionContext &get_device_context(const size_t device_idx) {
+    return *device_contexts_[device_idx];
+  }
+  const sycl::context &get_context() const { return context_; }
+  // Whether all the devices support atomics on shared memory that the other
+  // devices update concurrently (sycl::aspect::usm_atomic_shared_allocations)
+  bool has_shared_atomics() const { return shared_atomics_; }
+
+  // Attaches profiler to the context of every device (track "<idx>: <name>")
+  void set_profiler(KernelProfiler *profiler);
+
+  // Event of the first device that completes after all of events
+  sycl::event join(const std::vector<sycl::event> &events);
+  // The last event join returned: the end of the last sharded build
+  const sycl::event &get_last_join() const { return last_join_; }
+
+  // Shared memory of the context for temporaries of the sharded builds that
+  // several devices access (e.g. the rows they exchange). Unlike the scratch
+  // of one in-order queue, the commands using it must depend on
+  // get_last_join(), so that they don't overwrite what the previous build
+  // still reads on another device. A grown buffer is released with the
+  // context.
+  void *get_scratch(const ScratchSlot slot, const size_t bytes);
+
+private:
+  sycl::context context_;
+  std::vector<std::unique_ptr<ExecutionContext>> device_contexts_;
+  sycl::event last_join_;
+  bool shared_atomics_{true};
+  void *scratch_[static_cast<int>(ScratchSlot::NumSlots)]{};
+  size_t scratch_size_[static_cast<int>(ScratchSlot::NumSlots)]{};
+  std::vector<void *> retired_scratch_;
+};
+
+#endif // MULTI_DEVICE_CONTEXT_H__
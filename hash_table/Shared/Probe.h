@@ -0,0 +1,87 @@
+#ifndef SHARED_PROBE_H__
+#define SHARED_PROBE_H__
+
+#include <CL/sycl.hpp>
+#include <vector>
+
+#include "ExecutionContext.h"
+#include "Profiling.h"
+#include "Scan.h"
+
+// Count-then-write driver shared by the probe operators.
+// matcher(outer_idx, emit) calls emit(inner_row) for every inner row matching
+// the outer row outer_idx, and must produce the same matches when called
+// twice. A first kernel counts the matches of every outer row, a scan turns
+// the counts into output offsets and a second kernel writes the
+// (outer_row, inner_row) pairs ordered by outer row. Pairs past max_matches
+// are dropped, num_matches always receives the total number of matches so
+// that the caller can retry with a bigger output.
+template <typename ROW_MATCHER>
+sycl::event probe_hash_table_impl(ExecutionContext &ctx,
+                                  const int64_t num_outer_rows,
+                                  ROW_MATCHER matcher, int32_t *outer_row_ids,
+                                  int32_t *inner_row_ids,
+                                  const int64_t max_matches,
+                                  int64_t *num_matches,
+                                  const std::vector<sycl::event> &deps) {
+  auto &q = ctx.get_queue();
+  if (num_outer_rows <= 0) {
+    return q.memset(num_matches, 0, sizeof(int64_t), deps);
+  }
+  const size_t wg_size = get_scan_work_group_size(ctx);
+  const size_t scan_scratch_elems = get_scan_scratch_elems(
+      num_outer_rows, wg_size * g_scan_items_per_work_item);
+  int64_t *match_offsets = reinterpret_cast<int64_t *>(ctx.get_scratch(
+      ScratchSlot::Probe, (num_outer_rows + scan_scratch_elems) * sizeof(int64_t)));
+
+  // The bytes of the outer columns and the table are up to the matcher
+  const KernelInfo count_info{"probe_count_matches", num_outer_rows, 0,
+                              num_outer_rows *
+                                  static_cast<int64_t>(sizeof(int64_t))};
+  auto counted = submit_profiled(ctx, count_info, [&] {
+    return q.submit([&](sycl::handler &h) {
+      h.depends_on(deps);
+      h.parallel_for(sycl::range{static_cast<size_t>(num_outer_rows)},
+                     [=](sycl::id<1> outer_idx) {
+                       int64_t match_count = 0;
+                       matcher(outer_idx,
+                               [&](const int32_t) { ++match_count; });
+                       match_offsets[outer_idx] = match_count;
+                     });
+    });
+  });
+
+  auto scanned = exclusive_scan_on_device_impl(
+      ctx, match_offsets, num_outer_rows,
+      [match_offsets, num_matches, num_outer_rows](
+          const size_t idx, const int64_t prefix, const int64_t count) {
+        match_offsets[idx] = prefix;
+        if (idx == static_cast<size_t>(num_outer_rows - 1)) {
+          *num_matches = prefix + count;
+        }
+      },
+      match_offsets + num_outer_rows, wg_size, {counted});
+
+  const KernelInfo write_info{"probe_write_matches", num_outer_rows, 0,
+                              num_outer_rows *
+                                  static_cast<int64_t>(sizeof(int64_t))};
+  return submit_profiled(ctx, write_info, [&] {
+    return q.submit([&](sycl::handler &h) {
+      h.depends_on(scanned);
+      h.parallel_for(sycl::range{static_cast<size_t>(num_outer_rows)},
+                     [=](sycl::id<1> outer_idx) {
+                       int64_t out_idx = match_offsets[outer_idx];
+                       matcher(outer_idx, [&](const int32_t inner_row) {
+                         if (out_idx < max_matches) {
+                           outer_row_ids[out_idx] =
+                               static_cast<int32_t>(outer_idx);
+                           inner_row_ids[out_idx] = inner_row;
+                         }
+                         ++out_idx;
+                       });
+                     });
+    });
+  });
+}
+
+#endif // SHARED_PROBE_H__
@@ -0,0 +1,161 @@
+#include "Profiling.h"
+
+#include <algorithm>
+#include <limits>
+
+KernelProfiler::KernelProfiler(const size_t capacity)
+    : capacity_(std::max<size_t>(1, capacity)) {}
+
+void KernelProfiler::set_callback(Callback callback) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  callback_ = std::move(callback);
+}
+
+uint32_t KernelProfiler::add_track(const std::string &name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  track_names_.push_back(name);
+  return static_cast<uint32_t>(track_names_.size() - 1);
+}
+
+void KernelProfiler::add_pending(const KernelInfo &info, const uint32_t track,
+                                 const sycl::event &event) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.push_back({info, track, event});
+  }
+  collect(false);
+}
+
+void KernelProfiler::add_completed(const KernelInfo &info, const uint32_t track,
+                                   const uint64_t start_ns,
+                                   const uint64_t end_ns) {
+  record({info, track, start_ns, end_ns});
+}
+
+void KernelProfiler::flush() { collect(true); }
+
+void KernelProfiler::collect(const bool wait) {
+  std::vector<PendingKernel> done;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Kernels of different tracks complete in any order, so the queue is
+    // scanned as a whole; it is short unless the host runs far ahead.
+    auto first_pending = pending_.begin();
+    for (auto it = pending_.begin(); it != pending_.end(); ++it) {
+      if (wait ||
+          it->event.get_info<sycl::info::event::command_execution_status>() ==
+              sycl::info::event_command_status::complete) {
+        done.push_back(std::move(*it));
+      } else {
+        *first_pending++ = std::move(*it);
+      }
+    }
+    pending_.erase(first_pending, pending_.end());
+  }
+  for (auto &kernel : done) {
+    try {
+      kernel.event.wait();
+      record({kernel.info, kernel.track,
+              kernel.event.get_profiling_info<
+                  sycl::info::event_profiling::command_start>(),
+              kernel.event.get_profiling_info<
+                  sycl::info::event_profiling::command_end>()});
+    } catch (const sycl::exception &) {
+      // No timestamps (e.g. the queue was replaced without profiling)
+    }
+  }
+}
+
+void KernelProfiler::record(const KernelRecord &record) {
+  Callback callback;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (records_.size() < capacity_) {
+      records_.push_back(record);
+    } else {
+      records_[next_record_] = record;
+      ++dropped_count_;
+    }
+    next_record_ = (next_record_ + 1) % capacity_;
+    callback = callback_;
+  }
+  if (callback) {
+    callback(record);
+  }
+}
+
+std::vector<KernelRecord> KernelProfiler::get_records() {
+  flush();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (records_.size() < capacity_) {
+    return records_;
+  }
+  std::vector<KernelRecord> records(records_.begin() + next_record_,
+                                    records_.end());
+  records.insert(records.end(), records_.begin(),
+                 records_.begin() + next_record_);
+  return records;
+}
+
+size_t KernelProfiler::get_dropped_count() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return dropped_count_;
+}
+
+void KernelProfiler::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  records_.clear();
+  next_record_ = 0;
+  dropped_count_ = 0;
+}
+
+void KernelProfiler::write_chrome_trace(std::ostream &out) {
+  const auto records = get_records();
+  std::vector<std::string> track_names;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    track_names = track_names_;
+  }
+  // Device clocks of different devices are unrelated, so every track starts
+  // at its own first kernel.
+  std::vector<uint64_t> track_start(track_names.size(),
+                                    std::numeric_limits<uint64_t>::max());
+  for (const auto &record : records) {
+    track_start[record.track] =
+        std::min(track_start[record.track], record.start_ns);
+  }
+
+  out << "{\"traceEvents\":[";
+  bool first = true;
+  const auto separator = [&]() -> std::ostream & {
+    out << (first ? "\n" : ",\n");
+    first = false;
+    return out;
+  };
+  for (size_t track = 0; track < track_names.size(); ++track) {
+    std::string name;
+    for (const char c : track_names[track]) {
+      if (c == '"' || c == '\\') {
+        name += '\\';
+      }
+      name += c;
+    }
+    separator() << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,"
+                << "\"tid\":" << track << ",\"args\":{\"name\":\"" << name
+                << "\"}}";
+  }
+  for (const auto &record : records) {
+    const uint64_t start_ns = record.start_ns - track_start[record.track];
+    const uint64_t duration_ns =
+        record.end_ns > record.start_ns ? record.end_ns - record.start_ns : 0;
+    separator() << "{\"name\":\"" << record.info.name
+                << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << record.track
+                << ",\"ts\":" << start_ns / 1000 << "." << start_ns % 1000 / 100
+                << ",\"dur\":" << duration_ns / 1000 << "."
+                << duration_ns % 1000 / 100
+                << ",\"args\":{\"rows\":" << record.info.rows
+                << ",\"entries\":" << record.info.entries
+                << ",\"bytes\":" << record.info.bytes << "}}";
+  }
+  out << "\n]}\n";
+}
@@ -0,0 +1,130 @@
+#ifndef SHARED_PROFILING_H__
+#define SHARED_PROFILING_H__
+
+#include <CL/sycl.hpp>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "ExecutionContext.h"
+
+// What a library kernel works on. bytes is an estimate of the memory read
+// and written by the kernel (columns, tables, scratch), entries the number of
+// table entries (or buckets, registers) it touches, 0 if none.
+struct KernelInfo {
+  const char *name;
+  int64_t rows;
+  int64_t entries;
+  int64_t bytes;
+};
+
+// A completed kernel. Device kernels have the command_start/command_end
+// timestamps of the device (ns, device clock), host backend kernels the
+// steady_clock time of the calling thread (ns).
+struct KernelRecord {
+  KernelInfo info;
+  // Of the ExecutionContext that ran the kernel (see add_track())
+  uint32_t track;
+  uint64_t start_ns;
+  uint64_t end_ns;
+};
+
+//! Collects the kernels of the ExecutionContexts it is attached to (see
+//! ExecutionContext::set_profiler) into a ring buffer of the last capacity
+//! records, and passes every record to the callback if one is set. Device
+//! timestamps are only known once a kernel has completed: pending kernels
+//! are collected when later kernels are submitted and by flush(), which
+//! waits for them. The callback runs on the thread submitting or flushing,
+//! without the lock of the profiler held. A profiler may be shared by the
+//! contexts of several threads (e.g. of a MultiDeviceContext).
+class KernelProfiler {
+public:
+  using Callback = std::function<void(const KernelRecord &)>;
+
+  explicit KernelProfiler(const size_t capacity = 4096);
+
+  KernelProfiler(const KernelProfiler &) = delete;
+  KernelProfiler &operator=(const KernelProfiler &) = delete;
+
+  void set_callback(Callback callback);
+
+  // Registers a context, named e.g. after its device. Returns its track.
+  uint32_t add_track(const std::string &name);
+
+  // Called by the builders after submitting a kernel to a profiling queue
+  void add_pending(const KernelInfo &info, const uint32_t track,
+                   const sycl::event &event);
+  // Called by the builders for host backend kernels
+  void add_completed(const KernelInfo &info, const uint32_t track,
+                     const uint64_t start_ns, const uint64_t end_ns);
+
+  // Waits for the pending kernels and records them
+  void flush();
+
+  // The records in the ring buffer, oldest first (flushes first)
+  std::vector<KernelRecord> get_records();
+  // Records overwritten in the ring buffer since the last clear()
+  size_t get_dropped_count() const;
+  void clear();
+
+  // Writes the records in the Chrome trace event format (chrome://tracing,
+  // Perfetto), one thread per track with timestamps relative to the earliest
+  // record of the track (flushes first).
+  void write_chrome_trace(std::ostream &out);
+
+private:
+  struct PendingKernel {
+    KernelInfo info;
+    uint32_t track;
+    sycl::event event;
+  };
+
+  // Records the completed pending kernels at the front of the queue, or all
+  // of them if wait is set.
+  void collect(const bool wait);
+  void record(const KernelRecord &record);
+
+  mutable std::mutex mutex_;
+  const size_t capacity_;
+  std::vector<KernelRecord> records_;
+  size_t next_record_{0};
+  size_t dropped_count_{0};
+  std::deque<PendingKernel> pending_;
+  std::vector<std::string> track_names_;
+  Callback callback_;
+};
+
+inline uint64_t get_host_timestamp_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Runs submit_func, which submits one kernel and returns its event (or runs
+// it on the host pool for a host context), and reports the kernel to the
+// profiler of ctx if it has one.
+template <typename SUBMIT_FUNC>
+sycl::event submit_profiled(ExecutionContext &ctx, const KernelInfo &info,
+                            SUBMIT_FUNC submit_func) {
+  KernelProfiler *profiler = ctx.get_profiler();
+  if (!profiler) {
+    return submit_func();
+  }
+  if (ctx.is_host()) {
+    const uint64_t start_ns = get_host_timestamp_ns();
+    sycl::event event = submit_func();
+    profiler->add_completed(info, ctx.get_profiler_track(), start_ns,
+                            get_host_timestamp_ns());
+    return event;
+  }
+  sycl::event event = submit_func();
+  profiler->add_pending(info, ctx.get_profiler_track(), event);
+  return event;
+}
+
+#endif // SHARED_PROFILING_H__
@@ -0,0 +1,152 @@
+#ifndef SHARED_SCAN_H__
+#define SHARED_SCAN_H__
+
+#include <CL/sycl.hpp>
+#include <algorithm>
+#include <vector>
+
+#include "ExecutionContext.h"
+#include "Profiling.h"
+
+constexpr size_t g_scan_items_per_work_item{8};
+constexpr size_t g_scan_max_work_group_size{256};
+
+// Writes the exclusive prefix to out[idx], may alias the scan input.
+template <typename T> struct ExclusiveScanWriter {
+  T *out;
+  void operator()(const size_t idx, const T prefix, const T) const {
+    out[idx] = prefix;
+  }
+};
+
+template <typename T> struct InclusiveScanWriter {
+  T *out;
+  void operator()(const size_t idx, const T prefix, const T val) const {
+    out[idx] = prefix + val;
+  }
+};
+
+inline size_t get_scan_work_group_size(ExecutionContext &ctx) {
+  return std::min(
+      g_scan_max_work_group_size,
+      ctx.get_device().get_info<sycl::info::device::max_work_group_size>());
+}
+
+// Number of block sums of all the recursion levels of a scan.
+inline size_t get_scan_scratch_elems(size_t num_elems,
+                                     const size_t block_size) {
+  size_t scratch_elems = 0;
+  while (num_elems > block_size) {
+    num_elems = (num_elems + block_size - 1) / block_size;
+    scratch_elems += num_elems;
+  }
+  return scratch_elems;
+}
+
+template <typename T, typename WRITER>
+sycl::event exclusive_scan_on_device_impl(ExecutionContext &ctx,
+                                          const T *input,
+                                          const size_t num_elems,
+                                          WRITER writer, T *scratch,
+                                          const size_t wg_size,
+                                          const std::vector<sycl::event> &deps) {
+  auto &q = ctx.get_queue();
+  const size_t block_size = wg_size * g_scan_items_per_work_item;
+  const size_t num_blocks = (num_elems + block_size - 1) / block_size;
+  const sycl::nd_range<1> launch_range{num_blocks * wg_size, wg_size};
+
+  T *block_sums = nullptr;
+  sycl::event block_sums_scanned;
+  if (num_blocks > 1) {
+    block_sums = scratch;
+    const KernelInfo reduce_info{"scan_reduce_blocks",
+                                 static_cast<int64_t>(num_elems), 0,
+                                 static_cast<int64_t>(num_elems * sizeof(T))};
+    auto reduced = submit_profiled(ctx, reduce_info, [&] {
+      return q.submit([&](sycl::handler &h) {
+        h.depends_on(deps);
+        h.parallel_for(launch_range, [=](sycl::nd_item<1> item) {
+          const size_t block_start = item.get_group(0) * block_size;
+          T sum = 0;
+          for (size_t k = 0; k < g_scan_items_per_work_item; ++k) {
+            const size_t idx = block_start + k * wg_size + item.get_local_id(0);
+            if (idx < num_elems) {
+              sum += input[idx];
+            }
+          }
+          sum = sycl::reduce_over_group(item.get_group(), sum, sycl::plus<T>());
+          if (item.get_local_id(0) == 0) {
+            block_sums[item.get_group(0)] = sum;
+          }
+        });
+      });
+    });
+    block_sums_scanned = exclusive_scan_on_device_impl(
+        ctx, block_sums, num_blocks, ExclusiveScanWriter<T>{block_sums},
+        scratch + num_blocks, wg_size, {reduced});
+  }
+
+  // Reads the input and writes about as much through the writer
+  const KernelInfo scan_info{"scan_blocks", static_cast<int64_t>(num_elems), 0,
+                             static_cast<int64_t>(2 * num_elems * sizeof(T))};
+  return submit_profiled(ctx, scan_info, [&] {
+    return q.submit([&](sycl::handler &h) {
+      if (block_sums) {
+        h.depends_on(block_sums_scanned);
+      } else {
+        h.depends_on(deps);
+      }
+      h.parallel_for(launch_range, [=](sycl::nd_item<1> item) {
+        const auto group = item.get_group();
+        const size_t block_start = item.get_group(0) * block_size;
+        T carry = block_sums ? block_sums[item.get_group(0)] : 0;
+        for (size_t k = 0; k < g_scan_items_per_work_item; ++k) {
+          const size_t idx = block_start + k * wg_size + item.get_local_id(0);
+          const T val = idx < num_elems ? input[idx] : 0;
+          const T prefix =
+              sycl::exclusive_scan_over_group(group, val, sycl::plus<T>());
+          if (idx < num_elems) {
+            writer(idx, carry + prefix, val);
+          }
+          carry += sycl::reduce_over_group(group, val, sycl::plus<T>());
+        }
+      });
+    });
+  });
+}
+
+// Work-efficient reduce-then-scan. The input is split into blocks of
+// (work group size * g_scan_items_per_work_item) elements, a first kernel
+// reduces every block to its sum, the block sums are scanned recursively and
+// a second kernel rescans each block starting from its block offset.
+// Instead of storing the result, the second kernel calls
+// writer(idx, exclusive_prefix, input[idx]) for every element, so that the
+// callers can fuse their post-processing into the scan. Each work item only
+// writes the elements it has read, so the writer may update the input in
+// place. The block sums live in the scratch memory of the context.
+template <typename T, typename WRITER>
+sycl::event exclusive_scan_on_device(ExecutionContext &ctx, const T *input,
+                                     const int64_t num_elems, WRITER writer,
+                                     const std::vector<sycl::event> &deps = {}) {
+  if (num_elems <= 0) {
+    return ctx.get_queue().ext_oneapi_submit_barrier(deps);
+  }
+  const size_t wg_size = get_scan_work_group_size(ctx);
+  const size_t scratch_elems = get_scan_scratch_elems(
+      num_elems, wg_size * g_scan_items_per_work_item);
+  T *scratch = scratch_elems ? reinterpret_cast<T *>(ctx.get_scratch(
+                                   ScratchSlot::Scan, scratch_elems * sizeof(T)))
+                             : nullptr;
+  return exclusive_scan_on_device_impl(ctx, input, num_elems, writer, scratch,
+                                       wg_size, deps);
+}
+
+template <typename T>
+sycl::event inclusive_scan_on_device(ExecutionContext &ctx, const T *input,
+                                     T *output, const int64_t num_elems,
+                                     const std::vector<sycl::event> &deps = {}) {
+  return exclusive_scan_on_device(ctx, input, num_elems,
+                                  InclusiveScanWriter<T>{output}, deps);
+}
+
+#endif // SHARED_SCAN_H__
@@ -0,0 +1,335 @@
+#ifndef SHARED_SHARD_EXCHANGE_H__
+#define SHARED_SHARD_EXCHANGE_H__
+
+#include <CL/sycl.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "../GenericKeyHandler.h"
+#include "../JoinColumnIterator.h"
+#include "ExecutionContext.h"
+#include "JoinColumnLaunch.h"
+#include "MultiDeviceContext.h"
+#include "Profiling.h"
+#include "Scan.h"
+#include "Sharding.h"
+
+// Exchange of the build rows between the devices of a sharded build, so that
+// every device reads the rows of its get_shard_row_range() once instead of
+// all the rows. It partitions the rows like the partitioned baseline build:
+// every work-group of every device counts its rows per shard, one scan over
+// all the counts gives it its positions in every shard, and the devices
+// scatter the key and row id of their rows there. The rows of shard s are
+// then [shard_offsets[s], shard_offsets[s + 1]) of the exchange, in the
+// scratch memory of the MultiDeviceContext.
+template <typename T> struct ShardExchange {
+  const T *keys; // key_component_count components per row
+  const int32_t *row_ids;
+  const int32_t *shard_offsets; // device count plus one
+  size_t key_component_count;
+};
+
+constexpr size_t g_max_exchange_work_groups{1024};
+constexpr size_t g_shard_exchange_alignment{64};
+
+// Keys of the rows of a perfect hash join column: the value, or the
+// translated null with uses_bw_eq. Other nulls are skipped.
+template <typename DECODER> struct JoinColumnShardKeys {
+  JoinColumn join_column;
+  JoinColumnTypeInfo type_info;
+  const size_t *chunk_offsets;
+  DECODER decoder;
+
+  // Calls f(row_index, key, 1) for the rows before end from start on,
+  // stepping by step rows.
+  template <typename FUNC>
+  int for_each_key(const size_t start, const size_t step, const size_t end,
+                   FUNC f) const {
+    for (JoinColumnIterator it(&join_column, &type_info, chunk_offsets, start,
+                               step);
+         it && it.index < end; ++it) {
+      int64_t elem = decoder(it).element;
+      if (elem == type_info.null_val) {
+        if (!type_info.uses_bw_eq) {
+          continue;
+        }
+        elem = type_info.translated_null_val;
+      }
+      f(static_cast<int64_t>(it.index), &elem, size_t{1});
+    }
+    return 0;
+  }
+};
+
+// Keys of a key handler, returning its errors (unpackable keys)
+template <typename T> struct KeyHandlerShardKeys {
+  const GenericKeyHandler *key_handler; // On GPU
+
+  template <typename FUNC>
+  int for_each_key(const size_t start, const size_t step, const size_t end,
+                   FUNC f) const {
+    return key_handler->template for_each_key_before<T>(start, step, end, f);
+  }
+};
+
+// Average rows of a shard, which sizes the launches over the rows of a shard
+// (only known on the device).
+inline int64_t get_shard_launch_row_count(const int64_t num_rows,
+                                          const size_t device_count) {
+  return get_shard_row_range(num_rows, 0, device_count).size();
+}
+
+// Exchanges the num_rows rows of the build. get_shard_keys(ctx, deps) returns
+// the key source of a device (JoinColumnShardKeys or KeyHandlerShardKeys over
+// keys of key_component_count components of type T), adding what it needs
+// to deps. get_shard(key) returns the shard of a key, or -1 to drop the row.
+// Errors of the key source go to err_buff unless it is nullptr. deps are the
+// dependencies of the exchange on entry and its last events on return.
+template <typename T, typename SHARD_KEYS_FUNC, typename SHARD_FUNC>
+ShardExchange<T> exchange_shard_rows(MultiDeviceContext &mctx,
+                                     SHARD_KEYS_FUNC get_shard_keys,
+                                     const size_t key_component_count,
+                                     const int64_t num_rows,
+                                     SHARD_FUNC get_shard, int *err_buff,
+                                     std::vector<sycl::event> &deps) {
+  const size_t device_count = mctx.get_device_count();
+  // The same work-groups on every device: the counts are shard-major, then
+  // device-major, so that the scan orders the rows of a shard by device
+  size_t group_count = 1;
+  for (size_t device = 0; device < device_count; ++device) {
+    const auto rows = get_shard_row_range(num_rows, device, device_count);
+    group_count = std::max(
+        group_count,
+        get_grid_stride_nd_range(
+            mctx.get_device_context(device).get_launch_config(), rows.size())
+            .get_group_range()[0]);
+  }
+  group_count = std::min(group_count, g_max_exchange_work_groups);
+  const size_t counts_per_shard = device_count * group_count;
+  const size_t group_offsets_count = device_count * counts_per_shard;
+  const size_t key_size_in_bytes = key_component_count * sizeof(T);
+  auto align = [](const size_t bytes) {
+    return (bytes + g_shard_exchange_alignment - 1) /
+           g_shard_exchange_alignment * g_shard_exchange_alignment;
+  };
+  const size_t keys_offset =
+      align((group_offsets_count + device_count + 1) * sizeof(int32_t));
+  const size_t row_ids_offset =
+      keys_offset + align(num_rows * key_size_in_bytes);
+  auto scratch = reinterpret_cast<int8_t *>(mctx.get_scratch(
+      ScratchSlot::Exchange, row_ids_offset + num_rows * sizeof(int32_t)));
+  auto group_offsets = reinterpret_cast<int32_t *>(scratch);
+  auto shard_offsets = group_offsets + group_offsets_count;
+  auto keys = reinterpret_cast<T *>(scratch + keys_offset);
+  auto row_ids = reinterpret_cast<int32_t *>(scratch + row_ids_offset);
+
+  // The previous sharded build may still read the exchange on another device
+  deps.push_back(mctx.get_last_join());
+  using ShardKeys = decltype(get_shard_keys(mctx.get_device_context(0), deps));
+  std::vector<ShardKeys> shard_keys;
+  std::vector<std::vector<sycl::event>> device_deps;
+  for (size_t device = 0; device < device_count; ++device) {
+    device_deps.push_back(deps);
+    shard_keys.push_back(get_shard_keys(mctx.get_device_context(device),
+                                        device_deps.back()));
+  }
+
+  // Histogram: every work-group counts its rows per shard in local memory
+  std::vector<sycl::event> counted;
+  for (size_t device = 0; device < device_count; ++device) {
+    auto &ctx = mctx.get_device_context(device);
+    const auto rows = get_shard_row_range(num_rows, device, device_count);
+    const size_t work_group_size = ctx.get_launch_config().work_group_size;
+    const ShardKeys keys_of_device = shard_keys[device];
+    const KernelInfo info{
+        "shard_exchange_histogram", rows.size(),
+        static_cast<int64_t>(device_count),
+        rows.size() * static_cast<int64_t>(key_size_in_bytes) +
+            static_cast<int64_t>(counts_per_shard * sizeof(int32_t))};
+    counted.push_back(submit_profiled(ctx, info, [&] {
+      return ctx.get_queue().submit([&](sycl::handler &h) {
+        h.depends_on(device_deps[device]);
+        sycl::local_accessor<uint32_t, 1> local_counts(
+            sycl::range<1>{device_count}, h);
+        h.parallel_for(
+            sycl::nd_range<1>{group_count * work_group_size, work_group_size},
+            [=](sycl::nd_item<1> item) {
+              const size_t local_id = item.get_local_id(0);
+              const size_t local_range = item.get_local_range(0);
+              for (size_t i = local_id; i < device_count; i += local_range) {
+                local_counts[i] = 0;
+              }
+              sycl::group_barrier(item.get_group());
+              const int err = keys_of_device.for_each_key(
+                  rows.begin + item.get_global_id(0), item.get_global_range(0),
+                  rows.end, [&](const int64_t, const T *key, const size_t) {
+                    const int64_t shard = get_shard(key);
+                    if (shard >= 0) {
+                      sycl::atomic_ref<uint32_t, sycl::memory_order::relaxed,
+                                       sycl::memory_scope::work_group,
+                                       sycl::access::address_space::local_space>
+                          atomic_count(local_counts[shard]);
+                      atomic_count.fetch_add(1);
+                    }
+                    return 0;
+                  });
+              if (err && err_buff) {
+                sycl::atomic_ref<int32_t, sycl::memory_order::relaxed,
+                                 sycl::memory_scope::device>
+                    atomic_err_buff(*err_buff);
+                atomic_err_buff.store(err);
+              }
+              sycl::group_barrier(item.get_group());
+              for (size_t shard = local_id; shard < device_count;
+                   shard += local_range) {
+                group_offsets[shard * counts_per_shard +
+                              device * group_count + item.get_group(0)] =
+                    local_counts[shard];
+              }
+            });
+      });
+    }));
+  }
+
+  // One scan of the counts of all the devices gives the first position of
+  // every work-group in every shard, and the first row of every shard
+  auto scanned = exclusive_scan_on_device(
+      mctx.get_device_context(0), group_offsets, group_offsets_count,
+      [group_offsets, shard_offsets, counts_per_shard,
+       group_offsets_count](const size_t idx, const int32_t prefix,
+                            const int32_t count) {
+        group_offsets[idx] = prefix;
+        if (idx % counts_per_shard == 0) {
+          shard_offsets[idx / counts_per_shard] = prefix;
+        }
+        if (idx == group_offsets_count - 1) {
+          shard_offsets[idx / counts_per_shard + 1] = prefix + count;
+        }
+      },
+      counted);
+
+  // Scatter: every work-group walks the same rows again and writes them from
+  // its positions on
+  deps.clear();
+  for (size_t device = 0; device < device_count; ++device) {
+    auto &ctx = mctx.get_device_context(device);
+    const auto rows = get_shard_row_range(num_rows, device, device_count);
+    const size_t work_group_size = ctx.get_launch_config().work_group_size;
+    const ShardKeys keys_of_device = shard_keys[device];
+    const KernelInfo info{
+        "shard_exchange_scatter", rows.size(),
+        static_cast<int64_t>(device_count),
+        rows.size() *
+            static_cast<int64_t>(2 * key_size_in_bytes + sizeof(int32_t))};
+    deps.push_back(submit_profiled(ctx, info, [&] {
+      return ctx.get_queue().submit([&](sycl::handler &h) {
+        h.depends_on(scanned);
+        sycl::local_accessor<uint32_t, 1> local_offsets(
+            sycl::range<1>{device_count}, h);
+        h.parallel_for(
+            sycl::nd_range<1>{group_count * work_group_size, work_group_size},
+            [=](sycl::nd_item<1> item) {
+              for (size_t shard = item.get_local_id(0); shard < device_count;
+                   shard += item.get_local_range(0)) {
+                local_offsets[shard] =
+                    group_offsets[shard * counts_per_shard +
+                                  device * group_count + item.get_group(0)];
+              }
+              sycl::group_barrier(item.get_group());
+              keys_of_device.for_each_key(
+                  rows.begin + item.get_global_id(0), item.get_global_range(0),
+                  rows.end,
+                  [&](const int64_t row_index, const T *key, const size_t) {
+                    const int64_t shard = get_shard(key);
+                    if (shard < 0) {
+                      return 0;
+                    }
+                    sycl::atomic_ref<uint32_t, sycl::memory_order::relaxed,
+                                     sycl::memory_scope::work_group,
+                                     sycl::access::address_space::local_space>
+                        atomic_offset(local_offsets[shard]);
+                    const uint32_t pos = atomic_offset.fetch_add(1);
+                    for (size_t i = 0; i < key_component_count; ++i) {
+                      keys[pos * key_component_count + i] = key[i];
+                    }
+                    row_ids[pos] = static_cast<int32_t>(row_index);
+                    return 0;
+                  });
+            });
+      });
+    }));
+  }
+  return {keys, row_ids, shard_offsets, key_component_count};
+}
+
+// Slots of the rows of shard in exchange (see SlotCounting.h): slot_func(key)
+// returns the slot of a key, or -1 to skip it.
+template <typename T, typename SLOT_FUNC> struct ShardExchangeSlots {
+  ShardExchange<T> exchange;
+  size_t shard;
+  int64_t launch_row_count; // get_shard_launch_row_count()
+  SLOT_FUNC slot_func;
+
+  int64_t get_row_count() const {
+    return exchange.shard_offsets[shard + 1] - exchange.shard_offsets[shard];
+  }
+  int64_t get_launch_row_count() const { return launch_row_count; }
+
+  template <typename FUNC>
+  void for_each_in_range(const size_t begin, const size_t end,
+                         FUNC func) const {
+    const size_t first = exchange.shard_offsets[shard];
+    for (size_t row = first + begin; row < first + end; ++row) {
+      func(exchange.row_ids[row],
+           slot_func(exchange.keys + row * exchange.key_component_count));
+    }
+  }
+
+  // rounds steps of a grid-stride loop, slot -1 past the end
+  template <typename FUNC>
+  void for_each_converged(const size_t start, const size_t step,
+                          const size_t rounds, FUNC func) const {
+    const size_t first = exchange.shard_offsets[shard];
+    const size_t row_count = get_row_count();
+    for (size_t round = 0, row = start; round < rounds; ++round, row += step) {
+      if (row < row_count) {
+        func(exchange.row_ids[first + row],
+             slot_func(exchange.keys +
+                       (first + row) * exchange.key_component_count));
+      } else {
+        func(int64_t{-1}, int64_t{-1});
+      }
+    }
+  }
+};
+
+// Submits a kernel calling row_func(row_id, key) for every row of shard in
+// exchange after deps, launched for launch_row_count rows.
+template <typename T, typename ROW_FUNC>
+sycl::event submit_shard_exchange_rows(ExecutionContext &ctx,
+                                       const KernelInfo &info,
+                                       const ShardExchange<T> &exchange,
+                                       const size_t shard,
+                                       const int64_t launch_row_count,
+                                       const std::vector<sycl::event> &deps,
+                                       ROW_FUNC row_func) {
+  return submit_profiled(ctx, info, [&] {
+    return ctx.get_queue().submit([&](sycl::handler &h) {
+      h.depends_on(deps);
+      h.parallel_for(
+          get_grid_stride_nd_range(ctx.get_launch_config(), launch_row_count),
+          [=](sycl::nd_item<1> item) {
+            const size_t end = exchange.shard_offsets[shard + 1];
+            for (size_t row = exchange.shard_offsets[shard] +
+                              item.get_global_id(0);
+                 row < end; row += item.get_global_range(0)) {
+              row_func(exchange.row_ids[row],
+                       exchange.keys + row * exchange.key_component_count);
+            }
+          });
+    });
+  });
+}
+
+#endif // SHARED_SHARD_EXCHANGE_H__
@@ -0,0 +1,93 @@
+#ifndef SHARED_SHARDING_H__
+#define SHARED_SHARDING_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "../MurMurHash.h"
+#include "../Types.h"
+
+// Routing of the keys to the shards of a sharded build, one shard per device
+// of a MultiDeviceContext.
+
+// Every device of a sharded build reads the rows [begin, end) of the build
+// column, whose row ids stay global, and hands the rows of the other shards
+// over to their devices (ShardExchange.h).
+struct ShardRowRange {
+  int64_t begin;
+  int64_t end;
+
+  int64_t size() const { return end - begin; }
+};
+
+inline ShardRowRange get_shard_row_range(const int64_t num_rows,
+                                         const size_t device,
+                                         const size_t device_count) {
+  const int64_t rows_per_device =
+      (num_rows + device_count - 1) / device_count;
+  const int64_t begin = std::min<int64_t>(num_rows, device * rows_per_device);
+  return {begin, std::min(num_rows, begin + rows_per_device)};
+}
+
+// Perfect hash tables are split by key range: shard s holds the slots
+// [slot_begin, slot_end) of the normalized table of the whole key range.
+// Alone, it is a table of get_hash_entry_info() entries starting at key
+// get_min_key(), which the perfect hash probes take as is.
+struct PerfectHashShard {
+  int64_t slot_begin;
+  int64_t slot_end;
+
+  int64_t get_slot_count() const { return slot_end - slot_begin; }
+  HashEntryInfo get_hash_entry_info(const int64_t bucket_normalization) const {
+    return {static_cast<size_t>(get_slot_count() * bucket_normalization),
+            bucket_normalization};
+  }
+  int64_t get_min_key(const int64_t min_key,
+                      const int64_t bucket_normalization) const {
+    return min_key + slot_begin * bucket_normalization;
+  }
+};
+
+inline int64_t get_perfect_hash_shard_slot_count(const int64_t slot_count,
+                                                 const size_t shard_count) {
+  return (slot_count + shard_count - 1) / shard_count;
+}
+
+inline PerfectHashShard get_perfect_hash_shard(const int64_t slot_count,
+                                               const size_t shard,
+                                               const size_t shard_count) {
+  const int64_t shard_slot_count =
+      get_perfect_hash_shard_slot_count(slot_count, shard_count);
+  const int64_t slot_begin = std::min<int64_t>(slot_count, shard * shard_slot_count);
+  return {slot_begin, std::min(slot_count, slot_begin + shard_slot_count)};
+}
+
+// Shard of a key of the table (after null translation)
+inline size_t get_perfect_hash_shard_for_key(const int64_t key,
+                                             const int64_t min_key,
+                                             const int64_t bucket_normalization,
+                                             const int64_t slot_count,
+                                             const size_t shard_count) {
+  return (key - min_key) / bucket_normalization /
+         get_perfect_hash_shard_slot_count(slot_count, shard_count);
+}
+
+// Baseline tables are split by hash: every shard is a flat baseline table of
+// the keys whose MurmurHash1Impl hash maps to it. The slots within a shard
+// use the hash modulo the shard entry count, so the shard takes the most
+// significant bits.
+inline uint32_t get_baseline_shard_for_hash(const uint32_t h,
+                                            const uint32_t shard_count) {
+  return (static_cast<uint64_t>(h) * shard_count) >> 32;
+}
+
+template <typename T>
+inline uint32_t get_baseline_shard_for_key(const T *key,
+                                           const size_t key_component_count,
+                                           const uint32_t shard_count) {
+  return get_baseline_shard_for_hash(
+      MurmurHash1Impl(key, key_component_count * sizeof(T), 0), shard_count);
+}
+
+#endif // SHARED_SHARDING_H__
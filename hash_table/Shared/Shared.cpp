@@ -1,39 +1,128 @@
 #include "Shared.h"
+#include "ExecutionContext.h"
+#include "JoinColumnLaunch.h"
+#include "Profiling.h"
+#include "Scan.h"
 #include <CL/sycl.hpp>
 
-void set_valid_pos_flag(int32_t *pos_buff, const int32_t *count_buff,
-                        const int64_t entry_count) {
-  sycl::queue q;
-  q.submit([&](sycl::handler &h) {
-     h.parallel_for(sycl::range{static_cast<size_t>(entry_count)},
-                    [=](sycl::id<1> idx) {
-                      if (count_buff[idx]) {
-                        pos_buff[idx] = VALID_POS_FLAG;
-                      }
-                    });
-   }).wait();
+template <typename ROW_ID>
+sycl::event set_valid_pos_from_counts(ExecutionContext &ctx, ROW_ID *pos_buff,
+                                      ROW_ID *count_buff,
+                                      const int64_t entry_count,
+                                      const std::vector<sycl::event> &deps) {
+  if (ctx.is_host()) {
+    const KernelInfo info{"set_valid_pos_from_counts", 0, entry_count,
+                          3 * entry_count *
+                              static_cast<int64_t>(sizeof(ROW_ID))};
+    return submit_profiled(ctx, info, [&] {
+      return run_on_host(deps, [=] {
+        ROW_ID prefix = 0;
+        for (int64_t idx = 0; idx < entry_count; ++idx) {
+          if (count_buff[idx]) {
+            pos_buff[idx] = prefix;
+            prefix += count_buff[idx];
+          }
+          count_buff[idx] = 0;
+        }
+      });
+    });
+  }
+  // Single scan pass instead of flag + serial scan + set pos + memset.
+  return exclusive_scan_on_device(
+      ctx, count_buff, entry_count,
+      [pos_buff, count_buff](const size_t idx, const ROW_ID prefix,
+                             const ROW_ID count) {
+        if (count) {
+          pos_buff[idx] = prefix;
+        }
+        count_buff[idx] = 0;
+      },
+      deps);
 }
 
-void set_valid_pos(int32_t *pos_buff, int32_t *count_buff,
-                   const int64_t entry_count) {
-  sycl::queue q;
-  q.submit([&](sycl::handler &h) {
-     h.parallel_for(sycl::range{static_cast<size_t>(entry_count)},
-                    [=](sycl::id<1> idx) {
-                      if (VALID_POS_FLAG == pos_buff[idx]) {
-                        pos_buff[idx] = !idx ? 0 : count_buff[idx - 1];
-                      }
-                    });
-   }).wait();
+sycl::event build_chunk_offsets_on_l0_async(
+    ExecutionContext &ctx, const JoinColumn join_column, size_t *chunk_offsets,
+    const std::vector<sycl::event> &deps) {
+  const auto join_chunk_array =
+      reinterpret_cast<const JoinChunk *>(join_column.col_chunks_buff);
+  const size_t num_offsets = join_column.num_chunks + 1;
+  const KernelInfo info{"gather_chunk_sizes", 0,
+                        static_cast<int64_t>(num_offsets),
+                        static_cast<int64_t>(num_offsets * sizeof(size_t) +
+                                             join_column.col_chunks_buff_sz)};
+  if (ctx.is_host()) {
+    return submit_profiled(ctx, info, [&] {
+      return run_on_host(deps, [=] {
+        chunk_offsets[0] = 0;
+        for (size_t idx = 1; idx < num_offsets; ++idx) {
+          chunk_offsets[idx] =
+              chunk_offsets[idx - 1] + join_chunk_array[idx - 1].num_elems;
+        }
+      });
+    });
+  }
+  auto &q = ctx.get_queue();
+  auto sizes_gathered = submit_profiled(ctx, info, [&] {
+    return q.submit([&](sycl::handler &h) {
+      h.depends_on(deps);
+      h.parallel_for(sycl::range{num_offsets}, [=](sycl::id<1> idx) {
+        chunk_offsets[idx] = idx ? join_chunk_array[idx - 1].num_elems : 0;
+      });
+    });
+  });
+  // In place: [0, n_0, n_1, ...] -> [0, n_0, n_0 + n_1, ...]
+  return inclusive_scan_on_device(ctx, chunk_offsets, chunk_offsets,
+                                  num_offsets, {sizes_gathered});
+}
+
+void build_chunk_offsets_on_l0(ExecutionContext &ctx,
+                               const JoinColumn join_column,
+                               size_t *chunk_offsets) {
+  build_chunk_offsets_on_l0_async(ctx, join_column, chunk_offsets, {}).wait();
+}
+
+template <typename ROW_ID>
+sycl::event
+init_hash_join_buff_on_l0_async(ExecutionContext &ctx, ROW_ID *groups_buffer,
+                                const int64_t hash_entry_count,
+                                const int32_t invalid_slot_val,
+                                const std::vector<sycl::event> &deps) {
+  return fill_buff_async(ctx, "init_hash_join_buff", groups_buffer,
+                         static_cast<ROW_ID>(invalid_slot_val),
+                         static_cast<size_t>(hash_entry_count), deps);
+}
+
+template <typename ROW_ID>
+void init_hash_join_buff_on_l0(ExecutionContext &ctx, ROW_ID *groups_buffer,
+                               const int64_t hash_entry_count,
+                               const int32_t invalid_slot_val) {
+  init_hash_join_buff_on_l0_async(ctx, groups_buffer, hash_entry_count,
+                                  invalid_slot_val, {})
+      .wait();
 }
 
 void init_hash_join_buff_on_l0(int32_t *groups_buffer,
                                const int64_t hash_entry_count,
                                const int32_t invalid_slot_val) {
-  sycl::queue q;
-  q.submit([&](sycl::handler &h) {
-     h.parallel_for(
-         sycl::range{static_cast<size_t>(hash_entry_count)},
-         [=](sycl::id<1> idx) { groups_buffer[idx] = invalid_slot_val; });
-   }).wait();
+  init_hash_join_buff_on_l0(ExecutionContext::get_default(), groups_buffer,
+                            hash_entry_count, invalid_slot_val);
 }
+
+template sycl::event set_valid_pos_from_counts<int32_t>(
+    ExecutionContext &, int32_t *, int32_t *, const int64_t,
+    const std::vector<sycl::event> &);
+template sycl::event set_valid_pos_from_counts<int64_t>(
+    ExecutionContext &, int64_t *, int64_t *, const int64_t,
+    const std::vector<sycl::event> &);
+template sycl::event init_hash_join_buff_on_l0_async<int32_t>(
+    ExecutionContext &, int32_t *, const int64_t, const int32_t,
+    const std::vector<sycl::event> &);
+template sycl::event init_hash_join_buff_on_l0_async<int64_t>(
+    ExecutionContext &, int64_t *, const int64_t, const int32_t,
+    const std::vector<sycl::event> &);
+template void init_hash_join_buff_on_l0<int32_t>(ExecutionContext &,
+                                                 int32_t *, const int64_t,
+                                                 const int32_t);
+template void init_hash_join_buff_on_l0<int64_t>(ExecutionContext &,
+                                                 int64_t *, const int64_t,
+                                                 const int32_t);
@@ -1,26 +1,83 @@
 #ifndef SAHRED_HT_H__
 #define SAHRED_HT_H__
 
+#include <CL/sycl.hpp>
+#include <limits>
+#include <vector>
+
 #include "../CommonDecls.h"
 #include "../Types.h"
 
-#define VALID_POS_FLAG 0
-
 template <typename T = int64_t> inline T get_invalid_key() {
   return EMPTY_KEY_64;
 }
 
 template <> inline int32_t get_invalid_key() { return EMPTY_KEY_32; }
 
-void set_valid_pos_flag(int32_t *pos_buff, const int32_t *count_buff,
-                        const int64_t entry_count);
+// Row ids and one-to-many offsets are ROW_ID (int32_t or int64_t) elements.
+// 32 bits hold the row ids and match counts of builds of up to 2^31 - 1 rows,
+// larger builds need the 64-bit layout.
+inline bool needs_64bit_row_ids(const int64_t num_rows) {
+  return num_rows > std::numeric_limits<int32_t>::max();
+}
+
+// Calls func(ROW_ID{}) with the smallest row id type for num_rows build rows,
+// so that the caller allocates and builds the matching layout.
+template <typename FUNC>
+auto dispatch_row_id_type(const int64_t num_rows, FUNC func) {
+  if (needs_64bit_row_ids(num_rows)) {
+    return func(int64_t{});
+  }
+  return func(int32_t{});
+}
+
+// Elements of a one-to-many table (pos|count|row ids) of hash_entry_count
+// entries over num_rows rows
+inline size_t get_one_to_many_buff_elems(const int64_t hash_entry_count,
+                                         const int64_t num_rows) {
+  return 2 * hash_entry_count + num_rows;
+}
+
+// Turns the per-entry match counts of a one-to-many table into the offsets of
+// the non-empty entries in pos_buff (exclusive scan of count_buff) and resets
+// count_buff to zero for the row id filling pass.
+template <typename ROW_ID>
+sycl::event set_valid_pos_from_counts(ExecutionContext &ctx, ROW_ID *pos_buff,
+                                      ROW_ID *count_buff,
+                                      const int64_t entry_count,
+                                      const std::vector<sycl::event> &deps);
 
-void set_valid_pos(int32_t *pos_buff, int32_t *count_buff,
-                   const int64_t entry_count);
+// Writes the prefix sum of the chunk sizes of join_column to chunk_offsets
+// (num_chunks + 1 entries, chunk_offsets[i] is the index of the first row of
+// chunk i), which lets JoinColumnIterator position itself in O(log(num_chunks)).
+// Build it once per JoinColumn and reuse it for every kernel reading the column.
+sycl::event build_chunk_offsets_on_l0_async(ExecutionContext &ctx,
+                                            const JoinColumn join_column,
+                                            size_t *chunk_offsets,
+                                            const std::vector<sycl::event> &deps);
 
 // Interface call
+void build_chunk_offsets_on_l0(ExecutionContext &ctx,
+                               const JoinColumn join_column,
+                               size_t *chunk_offsets);
+
+// Interface call
+template <typename ROW_ID>
+sycl::event
+init_hash_join_buff_on_l0_async(ExecutionContext &ctx, ROW_ID *groups_buffer,
+                                const int64_t hash_entry_count,
+                                const int32_t invalid_slot_val,
+                                const std::vector<sycl::event> &deps);
+
+// Interface call
+template <typename ROW_ID>
+void init_hash_join_buff_on_l0(ExecutionContext &ctx, ROW_ID *groups_buffer,
+                               const int64_t hash_entry_count,
+                               const int32_t invalid_slot_val);
+
+// Interface call, uses ExecutionContext::get_default()
 void init_hash_join_buff_on_l0(int32_t *groups_buffer,
                                const int64_t hash_entry_count,
                                const int32_t invalid_slot_val);
 
-#endif // SAHRED_HT_H__
\ No newline at end of file
+#endif // SAHRED_HT_H__
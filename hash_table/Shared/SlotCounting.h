@@ -0,0 +1,290 @@
+#ifndef SHARED_SLOT_COUNTING_H__
+#define SHARED_SLOT_COUNTING_H__
+
+#include <CL/sycl.hpp>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "../JoinColumnIterator.h"
+#include "ExecutionContext.h"
+#include "JoinColumnLaunch.h"
+#include "Profiling.h"
+
+// Contention-aware counting of the rows per slot of the one-to-many builders.
+// With skewed keys, most rows of a sub-group hit the same few slots, so
+// every work item doing its own atomic serializes them on one cache line.
+// Instead, the work items of a sub-group holding the same slot elect a leader
+// that does a single atomic for all of them: a count adds the size of the
+// group, a reservation takes a range of that many positions at once, which
+// the group splits by rank. Tables of at most g_local_count_bins slots are
+// counted in a local memory histogram per work-group, merged with one atomic
+// per non-zero bin at the end. The perfect one-to-one and semi-join fills
+// stage tables of that size in local memory too.
+constexpr int64_t g_local_count_bins{4096};
+// Rounds of leader election per sub-group and step, the remaining work items
+// (keys held by few work items) do their own atomic.
+constexpr int g_sub_group_aggregation_rounds{4};
+
+// Groups the work items of sg by slot (slot < 0 takes no part) and calls
+// add_func(slot, count) from the leader of every group, add_func returning
+// the value before the addition. Returns that value plus the rank of the work
+// item in its group. Must be reached by all the work items of sg.
+template <typename ADD_FUNC>
+int64_t aggregate_sub_group_slots(const sycl::sub_group &sg, const int64_t slot,
+                                  ADD_FUNC add_func) {
+  const uint32_t lane = sg.get_local_linear_id();
+  bool pending = slot >= 0;
+  int64_t result = 0;
+  for (int round = 0; round < g_sub_group_aggregation_rounds; ++round) {
+    if (!sycl::any_of_group(sg, pending)) {
+      return result;
+    }
+    const uint32_t leader = sycl::reduce_over_group(
+        sg, pending ? lane : std::numeric_limits<uint32_t>::max(),
+        sycl::minimum<uint32_t>());
+    const int64_t leader_slot = sycl::group_broadcast(sg, slot, leader);
+    const int64_t same = pending && slot == leader_slot ? 1 : 0;
+    const int64_t rank =
+        sycl::exclusive_scan_over_group(sg, same, sycl::plus<int64_t>());
+    const int64_t count =
+        sycl::reduce_over_group(sg, same, sycl::plus<int64_t>());
+    int64_t base = 0;
+    if (lane == leader) {
+      base = add_func(leader_slot, count);
+    }
+    base = sycl::group_broadcast(sg, base, leader);
+    if (same) {
+      result = base + rank;
+      pending = false;
+    }
+  }
+  if (pending) {
+    result = add_func(slot, 1);
+  }
+  return result;
+}
+
+// Rounds of the grid-stride loop of the work-group of item over num_rows
+// rows: every work item runs that many, past the end if need be, so that the
+// steps stay converged.
+inline size_t get_converged_rounds(const sycl::nd_item<1> &item,
+                                   const size_t num_rows) {
+  const size_t group_start = item.get_group(0) * item.get_local_range(0);
+  const size_t global_range = item.get_global_range(0);
+  return group_start < num_rows
+             ? (num_rows - group_start + global_range - 1) / global_range
+             : 0;
+}
+
+// Slots of the rows of a join column: slot_func(iterator) returns the slot
+// of a row, or -1 to skip it. Sources of submit_slot_counts and
+// submit_slot_reservations call func(row_index, slot) for their rows. The
+// launch is sized by get_launch_row_count(), known on the host, while
+// get_row_count() may be known on the device only (ShardExchangeSlots).
+template <typename SLOT_FUNC>
+struct JoinColumnSlots {
+  JoinColumn join_column;
+  JoinColumnTypeInfo type_info;
+  const size_t *chunk_offsets;
+  SLOT_FUNC slot_func;
+
+  int64_t get_row_count() const { return join_column.num_elems; }
+  int64_t get_launch_row_count() const { return get_row_count(); }
+
+  template <typename FUNC>
+  void for_each_in_range(const size_t begin, const size_t end,
+                         FUNC func) const {
+    JoinColumnIterator it(&join_column, &type_info, chunk_offsets, begin, 1);
+    for (size_t row = begin; row < end && it; ++row, ++it) {
+      func(static_cast<int64_t>(it.index), slot_func(it));
+    }
+  }
+
+  // rounds steps of a grid-stride loop, slot -1 past the end
+  template <typename FUNC>
+  void for_each_converged(const size_t start, const size_t step,
+                          const size_t rounds, FUNC func) const {
+    JoinColumnIterator it(&join_column, &type_info, chunk_offsets, start, step);
+    for (size_t round = 0; round < rounds; ++round, ++it) {
+      func(static_cast<int64_t>(it.index), it ? slot_func(it) : -1);
+    }
+  }
+};
+
+// Slots of the keys of a key handler: slot_func(key, key_component_count)
+// returns the slot of a key, or -1 to skip it.
+template <typename T, typename KEY_HANDLER, typename SLOT_FUNC>
+struct KeySlots {
+  const KEY_HANDLER *key_handler; // On GPU
+  int64_t num_elems;
+  SLOT_FUNC slot_func;
+
+  int64_t get_row_count() const { return num_elems; }
+  int64_t get_launch_row_count() const { return num_elems; }
+
+  template <typename FUNC>
+  void for_each_in_range(const size_t begin, const size_t end,
+                         FUNC func) const {
+    key_handler->template for_each_key_in_range<T>(
+        begin, end,
+        [&](const int64_t row_index, const T *key,
+            const size_t key_component_count) {
+          func(row_index, slot_func(key, key_component_count));
+          return 0;
+        });
+  }
+
+  template <typename FUNC>
+  void for_each_converged(const size_t start, const size_t step,
+                          const size_t rounds, FUNC func) const {
+    int64_t row_index = -1;
+    int64_t slot = -1;
+    key_handler->template for_each_key_converged<T>(
+        start, step, rounds,
+        [&](const int64_t key_row_index, const T *key,
+            const size_t key_component_count) {
+          row_index = key_row_index;
+          slot = slot_func(key, key_component_count);
+          return 0;
+        },
+        [&] {
+          func(row_index, slot);
+          slot = -1;
+        });
+  }
+};
+
+// Whether a local memory copy of slot_count slots of slot_size bytes fits a
+// work-group and is cheap to merge (no more slots than rows per work-group)
+inline bool use_local_slots(ExecutionContext &ctx, const int64_t slot_count,
+                            const size_t slot_size) {
+  const auto &launch_config = ctx.get_launch_config();
+  const size_t local_mem_size =
+      ctx.get_device().get_info<sycl::info::device::local_mem_size>();
+  return slot_count <= g_local_count_bins &&
+         static_cast<size_t>(slot_count) <=
+             launch_config.work_group_size *
+                 launch_config.items_per_work_item &&
+         slot_count * slot_size <= local_mem_size / 2;
+}
+
+// Counts the rows of slots (JoinColumnSlots, KeySlots or ShardExchangeSlots)
+// per slot in [0, slot_count): add_func(slot, count) adds count to the slot.
+template <typename SLOTS, typename ADD_FUNC>
+sycl::event submit_slot_counts(ExecutionContext &ctx, const KernelInfo &info,
+                               const SLOTS &slots, const int64_t slot_count,
+                               ADD_FUNC add_func,
+                               const std::vector<sycl::event> &deps) {
+  return submit_profiled(ctx, info, [&] {
+    if (ctx.is_host()) {
+      return run_on_host(deps, [&] {
+        host_parallel_for_rows(
+            ctx, slots.get_row_count(),
+            [&](const size_t begin, const size_t end) {
+              slots.for_each_in_range(
+                  begin, end, [&](const int64_t, const int64_t slot) {
+                    if (slot >= 0) {
+                      add_func(slot, 1);
+                    }
+                  });
+            });
+      });
+    }
+    const auto nd_range = get_grid_stride_nd_range(
+        ctx.get_launch_config(), slots.get_launch_row_count());
+    const bool local_counts =
+        use_local_slots(ctx, slot_count, sizeof(uint32_t));
+    return ctx.get_queue().submit([&](sycl::handler &h) {
+      h.depends_on(deps);
+      sycl::local_accessor<uint32_t, 1> local_histogram(
+          sycl::range<1>{local_counts ? static_cast<size_t>(slot_count) : 1},
+          h);
+      h.parallel_for(nd_range, [=](sycl::nd_item<1> item) {
+        const auto group = item.get_group();
+        const size_t local_id = item.get_local_id(0);
+        const size_t local_range = item.get_local_range(0);
+        if (local_counts) {
+          for (int64_t i = local_id; i < slot_count; i += local_range) {
+            local_histogram[i] = 0;
+          }
+          sycl::group_barrier(group);
+        }
+        auto add_count = [&](const int64_t slot, const int64_t count) {
+          if (local_counts) {
+            sycl::atomic_ref<uint32_t, sycl::memory_order::relaxed,
+                             sycl::memory_scope::work_group,
+                             sycl::access::address_space::local_space>
+                atomic_bin(local_histogram[slot]);
+            atomic_bin.fetch_add(static_cast<uint32_t>(count));
+          } else {
+            add_func(slot, count);
+          }
+          return int64_t{0};
+        };
+        slots.for_each_converged(
+            item.get_global_id(0), item.get_global_range(0),
+            get_converged_rounds(item, slots.get_row_count()),
+            [&](const int64_t, const int64_t slot) {
+              aggregate_sub_group_slots(item.get_sub_group(), slot, add_count);
+            });
+        if (local_counts) {
+          sycl::group_barrier(group);
+          for (int64_t i = local_id; i < slot_count; i += local_range) {
+            if (local_histogram[i]) {
+              add_func(i, local_histogram[i]);
+            }
+          }
+        }
+      });
+    });
+  });
+}
+
+// Reserves a position per row of slots in its slot and calls
+// row_func(row_index, slot, position): reserve_func(slot, count) takes count
+// positions of the slot and returns the first one. Keys held by several work
+// items of a sub-group reserve their range with one atomic.
+template <typename SLOTS, typename RESERVE_FUNC, typename ROW_FUNC>
+sycl::event submit_slot_reservations(ExecutionContext &ctx,
+                                     const KernelInfo &info, const SLOTS &slots,
+                                     RESERVE_FUNC reserve_func,
+                                     ROW_FUNC row_func,
+                                     const std::vector<sycl::event> &deps) {
+  return submit_profiled(ctx, info, [&] {
+    if (ctx.is_host()) {
+      return run_on_host(deps, [&] {
+        host_parallel_for_rows(
+            ctx, slots.get_row_count(),
+            [&](const size_t begin, const size_t end) {
+              slots.for_each_in_range(
+                  begin, end,
+                  [&](const int64_t row_index, const int64_t slot) {
+                    if (slot >= 0) {
+                      row_func(row_index, slot, reserve_func(slot, 1));
+                    }
+                  });
+            });
+      });
+    }
+    const auto nd_range = get_grid_stride_nd_range(
+        ctx.get_launch_config(), slots.get_launch_row_count());
+    return ctx.get_queue().submit([&](sycl::handler &h) {
+      h.depends_on(deps);
+      h.parallel_for(nd_range, [=](sycl::nd_item<1> item) {
+        slots.for_each_converged(
+            item.get_global_id(0), item.get_global_range(0),
+            get_converged_rounds(item, slots.get_row_count()),
+            [&](const int64_t row_index, const int64_t slot) {
+              const int64_t position = aggregate_sub_group_slots(
+                  item.get_sub_group(), slot, reserve_func);
+              if (slot >= 0) {
+                row_func(row_index, slot, position);
+              }
+            });
+      });
+    });
+  });
+}
+
+#endif // SHARED_SLOT_COUNTING_H__
@@ -0,0 +1,1596 @@
+// Correctness tests of the hash table builders on the SYCL CPU device, then on
+// the host backend. Every table is built through the library from multi-chunk
+// columns (including an empty chunk) and compared with a sequential reference
+// build of the same rows. Where the builders may write row ids in any order
+// (one-to-many row id lists, the row kept for a semi-join or duplicate key)
+// the comparison is on the set of row ids. Returns non-zero if any check
+// fails.
+
+#include <CL/sycl.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <optional>
+#include <random>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "hash_table/BaselineHashTable/BaselineHashTableBuilder.h"
+#include "hash_table/BaselineHashTable/BaselineHashTableProbe.h"
+#include "hash_table/BaselineHashTable/BucketizedBaselineHashTableLayout.h"
+#include "hash_table/BaselineHashTable/PartitionedBaselineHashTableLayout.h"
+#include "hash_table/CompositeKeyPacking.h"
+#include "hash_table/GenericKeyHandler.h"
+#include "hash_table/MurMurHash.h"
+#include "hash_table/PerfectHashTable/PerfectHashTableBuilder.h"
+#include "hash_table/Shared/BloomFilter.h"
+#include "hash_table/Shared/ColumnStats.h"
+#include "hash_table/Shared/CompactOneToMany.h"
+#include "hash_table/Shared/ExecutionContext.h"
+#include "hash_table/Shared/HashTableStats.h"
+#include "hash_table/Shared/MultiDeviceContext.h"
+#include "hash_table/Shared/Profiling.h"
+#include "hash_table/Shared/Shared.h"
+#include "hash_table/Shared/Sharding.h"
+#include "hash_table/Types.h"
+
+namespace {
+
+int g_failure_count = 0;
+std::string g_test_name;
+// The backend the tests run on
+const char *g_backend_name = "device";
+
+#define CHECK(cond)                                                           \
+  do {                                                                        \
+    if (!(cond)) {                                                            \
+      std::fprintf(stderr, "FAILED %s on %s (%s:%d): %s\n",                   \
+                   g_test_name.c_str(), g_backend_name, __FILE__, __LINE__,   \
+                   #cond);                                                    \
+      ++g_failure_count;                                                      \
+    }                                                                         \
+  } while (0)
+
+constexpr int32_t g_invalid_slot_val{-1};
+
+// USM shared allocations of one context, freed with it
+class TestMemory {
+public:
+  TestMemory(const sycl::device &device, const sycl::context &context)
+      : device_(device), context_(context) {}
+  ~TestMemory() {
+    for (auto ptr : ptrs_) {
+      sycl::free(ptr, context_);
+    }
+  }
+
+  template <typename T> T *alloc(const size_t count, const T &value = T{}) {
+    T *ptr = sycl::malloc_shared<T>(std::max<size_t>(1, count), device_,
+                                    context_);
+    std::fill(ptr, ptr + count, value);
+    ptrs_.push_back(ptr);
+    return ptr;
+  }
+
+  template <typename T> T *copy(const std::vector<T> &values) {
+    T *ptr = alloc<T>(values.size());
+    std::copy(values.begin(), values.end(), ptr);
+    return ptr;
+  }
+
+private:
+  sycl::device device_;
+  sycl::context context_;
+  std::vector<void *> ptrs_;
+};
+
+struct ColumnSpec {
+  ColumnType column_type;
+  size_t elem_sz;
+
+  int64_t get_null_val() const {
+    if (column_type == ColumnType::Unsigned) {
+      return (int64_t{1} << (8 * elem_sz)) - 1;
+    }
+    return elem_sz == 1   ? NULL_TINYINT
+           : elem_sz == 2 ? NULL_SMALLINT
+           : elem_sz == 4 ? NULL_INT
+                          : NULL_BIGINT;
+  }
+
+  // Decoded value of a stored value (days to seconds for small dates)
+  int64_t get_scale() const {
+    return column_type == ColumnType::SmallDate ? 86400 : 1;
+  }
+};
+
+// Stored values of the rows of a column, nullopt for nulls
+using ColumnValues = std::vector<std::optional<int64_t>>;
+
+struct TestColumn {
+  ColumnSpec spec;
+  ColumnValues values;
+  JoinColumn join_column;
+
+  // The value the builders decode for row
+  int64_t decode(const size_t row) const {
+    return values[row] ? *values[row] * spec.get_scale() : spec.get_null_val();
+  }
+};
+
+// Chunk sizes of row_count rows: uneven, the second one empty
+std::vector<size_t> get_chunk_sizes(const size_t row_count,
+                                    const size_t chunk_count) {
+  std::vector<size_t> sizes(chunk_count);
+  size_t remaining = row_count;
+  for (size_t c = 0; c + 1 < chunk_count; ++c) {
+    sizes[c] = c == 1 ? 0 : std::min(remaining, row_count / chunk_count + c * 3);
+    remaining -= sizes[c];
+  }
+  sizes.back() = remaining;
+  return sizes;
+}
+
+TestColumn make_column(TestMemory &memory, const ColumnSpec &spec,
+                       const ColumnValues &values,
+                       const size_t chunk_count = 5) {
+  const auto chunk_sizes = get_chunk_sizes(values.size(), chunk_count);
+  auto chunks = memory.alloc<JoinChunk>(chunk_count);
+  size_t row = 0;
+  for (size_t c = 0; c < chunk_count; ++c) {
+    auto data = memory.alloc<int8_t>(chunk_sizes[c] * spec.elem_sz);
+    for (size_t i = 0; i < chunk_sizes[c]; ++i, ++row) {
+      const int64_t stored =
+          values[row] ? *values[row] : spec.get_null_val();
+      if (spec.column_type == ColumnType::Double) {
+        reinterpret_cast<double *>(data)[i] = static_cast<double>(stored);
+      } else if (spec.elem_sz == 1) {
+        reinterpret_cast<int8_t *>(data)[i] = static_cast<int8_t>(stored);
+      } else if (spec.elem_sz == 2) {
+        reinterpret_cast<int16_t *>(data)[i] = static_cast<int16_t>(stored);
+      } else if (spec.elem_sz == 4) {
+        reinterpret_cast<int32_t *>(data)[i] = static_cast<int32_t>(stored);
+      } else {
+        reinterpret_cast<int64_t *>(data)[i] = stored;
+      }
+    }
+    chunks[c] = {data, chunk_sizes[c]};
+  }
+  return {spec, values,
+          JoinColumn{reinterpret_cast<const int8_t *>(chunks),
+                     chunk_count * sizeof(JoinChunk), chunk_count,
+                     values.size(), spec.elem_sz}};
+}
+
+// row_count values in [min_val, max_val], nulls with probability null_rate
+ColumnValues random_values(std::mt19937 &rng, const size_t row_count,
+                           const int64_t min_val, const int64_t max_val,
+                           const double null_rate) {
+  std::uniform_int_distribution<int64_t> value(min_val, max_val);
+  std::bernoulli_distribution is_null(null_rate);
+  ColumnValues values(row_count);
+  for (auto &v : values) {
+    if (!is_null(rng)) {
+      v = value(rng);
+    }
+  }
+  return values;
+}
+
+// Every value of [min_val, max_val] once, shuffled, with null_count nulls
+ColumnValues unique_values(std::mt19937 &rng, const int64_t min_val,
+                           const int64_t max_val, const size_t null_count) {
+  ColumnValues values(null_count);
+  for (int64_t v = min_val; v <= max_val; ++v) {
+    values.push_back(v);
+  }
+  std::shuffle(values.begin(), values.end(), rng);
+  return values;
+}
+
+// Inner to outer string id map over inner ids [0, inner_count): random outer
+// ids in [min_outer, max_outer], some INVALID_STR_ID
+std::vector<int32_t> random_translation_map(std::mt19937 &rng,
+                                            const size_t inner_count,
+                                            const int32_t min_outer,
+                                            const int32_t max_outer) {
+  std::uniform_int_distribution<int32_t> outer(min_outer, max_outer);
+  std::bernoulli_distribution is_invalid(0.2);
+  std::vector<int32_t> map(inner_count);
+  for (auto &id : map) {
+    id = is_invalid(rng) ? StringDictionary_INVALID_STR_ID : outer(rng);
+  }
+  return map;
+}
+
+bool is_member(const std::vector<int32_t> &rows, const int64_t row) {
+  return std::find(rows.begin(), rows.end(), row) != rows.end();
+}
+
+bool has_duplicates(const std::map<int64_t, std::vector<int32_t>> &ref) {
+  return std::any_of(ref.begin(), ref.end(),
+                     [](const auto &slot) { return slot.second.size() > 1; });
+}
+
+// Checks the pos|count|row ids layout of a one-to-many table of entry_count
+// entries: entry e holds the rows of row_lists(e), its row ids are placed
+// after those of the entries before it.
+template <typename ROW_ID, typename ROW_LISTS>
+bool check_one_to_many_layout(const ROW_ID *buff, const int64_t entry_count,
+                              ROW_LISTS row_lists) {
+  const ROW_ID *pos_buff = buff;
+  const ROW_ID *count_buff = buff + entry_count;
+  const ROW_ID *id_buff = count_buff + entry_count;
+  bool ok = true;
+  ROW_ID pos = 0;
+  for (int64_t e = 0; e < entry_count; ++e) {
+    const std::vector<int32_t> rows = row_lists(e);
+    ok &= count_buff[e] == static_cast<ROW_ID>(rows.size());
+    if (!ok || rows.empty()) {
+      continue;
+    }
+    ok &= pos_buff[e] == pos;
+    std::multiset<ROW_ID> ids(id_buff + pos, id_buff + pos + count_buff[e]);
+    ok &= ids == std::multiset<ROW_ID>(rows.begin(), rows.end());
+    pos += count_buff[e];
+  }
+  return ok;
+}
+
+// Checks that the compact layouts of the one-to-many table buff hold the row
+// ids of its entries. Reorders the row ids of the entries of buff.
+template <typename ROW_ID>
+void check_compact_one_to_many(ExecutionContext &ctx, TestMemory &memory,
+                               ROW_ID *buff, const int64_t entry_count,
+                               const int64_t num_rows) {
+  std::vector<std::multiset<int64_t>> ref(entry_count);
+  for (int64_t e = 0; e < entry_count; ++e) {
+    const ROW_ID *ids = buff + 2 * entry_count + buff[e];
+    ref[e].insert(ids, ids + buff[entry_count + e]);
+  }
+  for (const CompactOneToManyOptions options :
+       {CompactOneToManyOptions{8, false}, CompactOneToManyOptions{16, true},
+        CompactOneToManyOptions{8, true}}) {
+    const CompactOneToManySpec spec = plan_compact_one_to_many_on_l0(
+        ctx, buff, entry_count, num_rows, options);
+    // compress must not rely on the plan having sorted the row ids
+    for (int64_t e = 0; e < entry_count; ++e) {
+      ROW_ID *ids = buff + 2 * entry_count + buff[e];
+      std::reverse(ids, ids + buff[entry_count + e]);
+    }
+    int8_t *compact_buff = memory.alloc<int8_t>(spec.get_buff_size(), 7);
+    compress_one_to_many_on_l0(ctx, buff, spec, compact_buff);
+    const CompactOneToManyTable table{compact_buff, spec};
+    bool ok = true;
+    for (int64_t e = 0; e < entry_count; ++e) {
+      std::multiset<int64_t> ids;
+      table.for_each_row_id(e, [&](const int64_t row_id) { ids.insert(row_id); });
+      ok &= ids == ref[e];
+      ok &= table.get_count(e) == static_cast<int64_t>(ref[e].size());
+    }
+    CHECK(ok);
+  }
+}
+
+// Distribution of values (reference for HashTableStats)
+HashTableDistribution reference_distribution(const std::vector<int64_t> &values) {
+  HashTableDistribution distribution{};
+  for (const int64_t value : values) {
+    ++distribution.count;
+    distribution.sum += value;
+    distribution.max = std::max(distribution.max, value);
+    ++distribution.histogram[get_hash_table_stats_bin(value)];
+  }
+  return distribution;
+}
+
+bool distributions_equal(const HashTableDistribution &a,
+                         const HashTableDistribution &b) {
+  return a.count == b.count && a.sum == b.sum && a.max == b.max &&
+         std::equal(a.histogram, a.histogram + g_hash_table_stats_bins,
+                    b.histogram);
+}
+
+// Row counts of the entries of a one-to-many reference
+template <typename KEY>
+std::vector<int64_t>
+get_bucket_sizes(const std::map<KEY, std::vector<int32_t>> &ref) {
+  std::vector<int64_t> sizes;
+  for (const auto &[key, rows] : ref) {
+    sizes.push_back(rows.size());
+  }
+  return sizes;
+}
+
+// Checks that the rows selected by a filter are in increasing order and
+// include every row of ref (no false negatives).
+template <typename KEY>
+void check_no_false_negatives(const int32_t *selection,
+                              const int64_t num_selected,
+                              const std::map<KEY, std::vector<int32_t>> &ref) {
+  const std::vector<int32_t> selected(selection, selection + num_selected);
+  CHECK(std::is_sorted(selected.begin(), selected.end()));
+  bool ok = true;
+  for (const auto &[key, rows] : ref) {
+    for (const int32_t row : rows) {
+      ok &= std::binary_search(selected.begin(), selected.end(), row);
+    }
+  }
+  CHECK(ok);
+}
+
+BloomFilter alloc_bloom_filter(TestMemory &memory, const int64_t cardinality) {
+  const size_t block_count = get_bloom_filter_block_count(cardinality);
+  return {memory.alloc<uint64_t>(block_count * g_bloom_filter_block_words, 7),
+          block_count};
+}
+
+// Checks the rows of column selected by a filter of the perfect table of
+// reference ref: every row of ref passes, null rows only with uses_bw_eq.
+void check_perfect_filter(const int32_t *selection, const int64_t num_selected,
+                          const TestColumn &column, const bool uses_bw_eq,
+                          const std::map<int64_t, std::vector<int32_t>> &ref) {
+  check_no_false_negatives(selection, num_selected, ref);
+  bool nulls_ok = true;
+  for (int64_t i = 0; i < num_selected; ++i) {
+    nulls_ok &= uses_bw_eq || column.values[selection[i]].has_value();
+  }
+  CHECK(nulls_ok);
+}
+
+// Perfect hash tables
+
+struct PerfectTableSpec {
+  int64_t min_val;
+  int64_t max_val;
+  bool uses_bw_eq;
+  int64_t bucket_normalization;
+  // Inner to outer string ids, nullptr without
+  const std::vector<int32_t> *translation_map;
+  int32_t min_inner_elem;
+
+  int64_t get_translated_null_val() const {
+    return max_val + bucket_normalization;
+  }
+
+  JoinColumnTypeInfo get_type_info(const ColumnSpec &spec) const {
+    return {spec.elem_sz,   min_val,
+            max_val,        spec.get_null_val(),
+            uses_bw_eq,     get_translated_null_val(),
+            spec.column_type};
+  }
+
+  // Key range of the table, with room for the translated null
+  HashEntryInfo get_hash_entry_info(const int64_t normalization) const {
+    return {static_cast<size_t>(get_translated_null_val() - min_val + 1),
+            normalization};
+  }
+};
+
+// Rows of every slot of the table (reference build)
+std::map<int64_t, std::vector<int32_t>>
+reference_perfect_slots(const TestColumn &column, const PerfectTableSpec &table,
+                        const int64_t bucket_normalization) {
+  std::map<int64_t, std::vector<int32_t>> slots;
+  for (size_t row = 0; row < column.values.size(); ++row) {
+    int64_t elem = column.decode(row);
+    if (elem == column.spec.get_null_val()) {
+      if (!table.uses_bw_eq) {
+        continue;
+      }
+      elem = table.get_translated_null_val();
+    } else if (table.translation_map) {
+      elem = (*table.translation_map)[elem - table.min_inner_elem];
+      if (elem == StringDictionary_INVALID_STR_ID || elem < table.min_val ||
+          elem > table.max_val) {
+        continue;
+      }
+    }
+    slots[(elem - table.min_val) / bucket_normalization].push_back(row);
+  }
+  return slots;
+}
+
+void check_perfect_one_to_one(const int32_t *buff, const int64_t slot_count,
+                              const std::map<int64_t, std::vector<int32_t>> &ref,
+                              const bool for_semi_join, const int err) {
+  CHECK(err == (!for_semi_join && has_duplicates(ref) ? -1 : 0));
+  bool ok = true;
+  for (int64_t slot = 0; slot < slot_count; ++slot) {
+    const auto it = ref.find(slot);
+    ok &= it == ref.end() ? buff[slot] == g_invalid_slot_val
+                          : is_member(it->second, buff[slot]);
+  }
+  CHECK(ok);
+}
+
+template <typename ROW_ID>
+bool check_perfect_one_to_many(const ROW_ID *buff, const int64_t slot_count,
+                               const std::map<int64_t, std::vector<int32_t>> &ref,
+                               const int64_t first_slot = 0) {
+  return check_one_to_many_layout(buff, slot_count, [&](const int64_t e) {
+    const auto it = ref.find(first_slot + e);
+    return it == ref.end() ? std::vector<int32_t>{} : it->second;
+  });
+}
+
+void test_perfect_tables(ExecutionContext &ctx, TestMemory &memory,
+                         const TestColumn &column, const PerfectTableSpec &table) {
+  const JoinColumnTypeInfo type_info = table.get_type_info(column.spec);
+  const int64_t norm = table.bucket_normalization;
+  const HashEntryInfo hash_entry_info = table.get_hash_entry_info(norm);
+  const int64_t slot_count = hash_entry_info.getNormalizedHashEntryCount();
+  const size_t row_count = column.values.size();
+  int *err = memory.alloc<int>(1);
+  const int32_t *device_map =
+      table.translation_map ? memory.copy(*table.translation_map) : nullptr;
+  const auto ref = reference_perfect_slots(column, table, norm);
+  const BloomFilter bloom_filter = alloc_bloom_filter(memory, row_count);
+  int32_t *selection = memory.alloc<int32_t>(row_count);
+  int64_t *num_selected = memory.alloc<int64_t>(1);
+
+  for (const bool for_semi_join : {false, true}) {
+    // Separate init and fill
+    int32_t *buff = memory.alloc<int32_t>(slot_count, 7);
+    init_hash_join_buff_on_l0(ctx, buff, slot_count, g_invalid_slot_val);
+    *err = 0;
+    fill_hash_join_buff_bucketized_on_l0(
+        ctx, buff, g_invalid_slot_val, for_semi_join, column.join_column,
+        type_info, device_map, table.min_inner_elem, norm, err);
+    check_perfect_one_to_one(buff, slot_count, ref, for_semi_join, *err);
+
+    // Same with a Bloom filter, which every build row passes. The probe side
+    // of a translated column holds outer ids, not the inner ones of column.
+    if (!table.translation_map) {
+      init_hash_join_buff_on_l0(ctx, buff, slot_count, g_invalid_slot_val);
+      init_bloom_filter_on_l0(ctx, bloom_filter);
+      *err = 0;
+      fill_hash_join_buff_bucketized_on_l0_async(
+          ctx, buff, g_invalid_slot_val, for_semi_join, column.join_column,
+          type_info, nullptr, 0, norm, err, bloom_filter, {})
+          .wait();
+      check_perfect_one_to_one(buff, slot_count, ref, for_semi_join, *err);
+      filter_join_column_on_l0(ctx, bloom_filter, column.join_column,
+                               type_info, selection, num_selected);
+      check_perfect_filter(selection, *num_selected, column, table.uses_bw_eq,
+                           ref);
+    }
+
+    // Fused build, err and table are reset by it
+    *err = 5;
+    std::fill(buff, buff + slot_count, 7);
+    build_hash_join_buff_bucketized_on_l0(
+        ctx, buff, hash_entry_info, g_invalid_slot_val, for_semi_join,
+        column.join_column, type_info, device_map, table.min_inner_elem, false,
+        err);
+    check_perfect_one_to_one(buff, slot_count, ref, for_semi_join, *err);
+
+    // Same with stats: every key in its own slot
+    HashTableStats *stats = memory.alloc<HashTableStats>(1);
+    build_hash_join_buff_bucketized_on_l0_async(
+        ctx, buff, hash_entry_info, g_invalid_slot_val, for_semi_join,
+        column.join_column, type_info, device_map, table.min_inner_elem, false,
+        err, BloomFilter{}, stats, {})
+        .wait();
+    CHECK(stats->entry_count == slot_count);
+    CHECK(distributions_equal(
+        stats->probe_distances,
+        reference_distribution(std::vector<int64_t>(ref.size(), 0))));
+    CHECK(stats->bucket_sizes.count == 0);
+  }
+
+  if (table.translation_map) {
+    return; // the one-to-many builders take no translation map
+  }
+  if (norm == 1) {
+    // Non-bucketized one-to-many, indexed by key - min_val
+    int32_t *buff = memory.alloc<int32_t>(2 * slot_count + row_count, 7);
+    fill_one_to_many_hash_table_on_l0(ctx, buff, hash_entry_info,
+                                      g_invalid_slot_val, column.join_column,
+                                      type_info);
+    CHECK(check_perfect_one_to_many(buff, slot_count, ref));
+
+    // Same with 64-bit row ids and offsets
+    int64_t *buff64 = memory.alloc<int64_t>(2 * slot_count + row_count, 7);
+    fill_one_to_many_hash_table_on_l0_async(ctx, buff64, hash_entry_info,
+                                            g_invalid_slot_val,
+                                            column.join_column, type_info, {})
+        .wait();
+    CHECK(check_perfect_one_to_many(buff64, slot_count, ref));
+    check_compact_one_to_many(ctx, memory, buff, slot_count, row_count);
+    check_compact_one_to_many(ctx, memory, buff64, slot_count, row_count);
+  }
+  // Bucketized one-to-many, at the table normalization and twice as coarse
+  for (const int64_t one_to_many_norm : {norm, 2 * norm}) {
+    const HashEntryInfo one_to_many_info =
+        table.get_hash_entry_info(one_to_many_norm);
+    const int64_t one_to_many_slots =
+        one_to_many_info.getNormalizedHashEntryCount();
+    int32_t *buff = memory.alloc<int32_t>(2 * one_to_many_slots + row_count, 7);
+    fill_one_to_many_hash_table_on_l0_bucketized(
+        ctx, buff, one_to_many_info, g_invalid_slot_val, column.join_column,
+        type_info);
+    const auto one_to_many_ref =
+        reference_perfect_slots(column, table, one_to_many_norm);
+    CHECK(check_perfect_one_to_many(buff, one_to_many_slots, one_to_many_ref));
+
+    HashTableStats *stats = memory.alloc<HashTableStats>(1);
+    fill_one_to_many_hash_table_on_l0_bucketized_async(
+        ctx, buff, one_to_many_info, g_invalid_slot_val, column.join_column,
+        type_info, BloomFilter{}, stats, {})
+        .wait();
+    CHECK(stats->entry_count == one_to_many_slots);
+    CHECK(distributions_equal(
+        stats->bucket_sizes,
+        reference_distribution(get_bucket_sizes(one_to_many_ref))));
+  }
+}
+
+void test_perfect_hash(ExecutionContext &ctx, TestMemory &memory,
+                       std::mt19937 &rng) {
+  struct Case {
+    const char *name;
+    ColumnSpec spec;
+    int64_t min_val; // stored values
+    int64_t max_val;
+  };
+  const Case cases[] = {
+      {"int32", {ColumnType::Signed, 4}, -20, 150},
+      {"int16", {ColumnType::Signed, 2}, 1000, 1100},
+      {"int8", {ColumnType::Signed, 1}, -100, 100},
+      {"uint8", {ColumnType::Unsigned, 1}, 3, 200},
+      {"int64", {ColumnType::Signed, 8}, -5, 60},
+      {"small date 4", {ColumnType::SmallDate, 4}, 17000, 17100},
+      {"small date 2", {ColumnType::SmallDate, 2}, 100, 180},
+  };
+  for (const auto &c : cases) {
+    const int64_t scale = c.spec.get_scale();
+    const TestColumn unique_column =
+        make_column(memory, c.spec, unique_values(rng, c.min_val, c.max_val, 9));
+    const TestColumn random_column = make_column(
+        memory, c.spec, random_values(rng, 1500, c.min_val, c.max_val, 0.1));
+    for (const bool uses_bw_eq : {false, true}) {
+      const PerfectTableSpec table{c.min_val * scale, c.max_val * scale,
+                                   uses_bw_eq, scale, nullptr, 0};
+      const std::string suffix = uses_bw_eq ? " (bw_eq nulls)" : "";
+      g_test_name = std::string("perfect ") + c.name + " unique keys" + suffix;
+      test_perfect_tables(ctx, memory, unique_column, table);
+      g_test_name = std::string("perfect ") + c.name + " duplicate keys" + suffix;
+      test_perfect_tables(ctx, memory, random_column, table);
+    }
+  }
+
+  // Most rows on one key, more than the 8-bit counts of the compact layout
+  {
+    const ColumnSpec spec{ColumnType::Signed, 4};
+    ColumnValues values = random_values(rng, 2000, 0, 40, 0.05);
+    for (size_t row = 0; row < values.size(); row += 2) {
+      values[row] = 7;
+    }
+    g_test_name = "perfect skewed keys";
+    test_perfect_tables(ctx, memory, make_column(memory, spec, values),
+                        PerfectTableSpec{0, 40, false, 1, nullptr, 0});
+  }
+
+  // String ids of an inner dictionary translated to the outer one, whose ids
+  // [100, 160] the table covers; ids mapped outside of it are dropped.
+  const ColumnSpec spec{ColumnType::Signed, 4};
+  const size_t inner_count = 60;
+  const auto translation_map = random_translation_map(rng, inner_count, 100, 170);
+  for (const bool unique : {true, false}) {
+    const TestColumn column = make_column(
+        memory, spec,
+        unique ? unique_values(rng, 0, inner_count - 1, 7)
+               : random_values(rng, 800, 0, inner_count - 1, 0.1));
+    for (const bool uses_bw_eq : {false, true}) {
+      g_test_name = std::string("perfect translated string ids") +
+                    (unique ? " unique" : " duplicate") +
+                    (uses_bw_eq ? " (bw_eq nulls)" : "");
+      test_perfect_tables(
+          ctx, memory, column,
+          PerfectTableSpec{100, 160, uses_bw_eq, 1, &translation_map, 0});
+    }
+  }
+}
+
+// Baseline hash tables
+
+using Key = std::vector<int64_t>;
+using KeyRows = std::map<Key, std::vector<int32_t>>;
+
+struct KeyColumns {
+  std::vector<TestColumn> columns;
+  std::vector<bool> uses_bw_eq;
+  // Per column, host copies, nullptr without
+  std::vector<const std::vector<int32_t> *> translation_maps;
+  const GenericKeyHandler *key_handler;
+  size_t row_count;
+};
+
+KeyColumns make_key_columns(TestMemory &memory, std::vector<TestColumn> columns,
+                            const std::vector<bool> &uses_bw_eq,
+                            const std::vector<const std::vector<int32_t> *>
+                                &translation_maps) {
+  const size_t kcc = columns.size();
+  auto join_columns = memory.alloc<JoinColumn>(kcc);
+  auto type_infos = static_cast<JoinColumnTypeInfo *>(
+      static_cast<void *>(memory.alloc<int8_t>(kcc * sizeof(JoinColumnTypeInfo))));
+  auto maps = memory.alloc<const int32_t *>(kcc, nullptr);
+  auto min_inner_elems = memory.alloc<int32_t>(kcc, 0);
+  bool any_map = false;
+  for (size_t i = 0; i < kcc; ++i) {
+    const ColumnSpec &spec = columns[i].spec;
+    join_columns[i] = columns[i].join_column;
+    new (&type_infos[i]) JoinColumnTypeInfo{
+        spec.elem_sz, 0,          0,
+        spec.get_null_val(), uses_bw_eq[i], 0,
+        spec.column_type};
+    if (translation_maps[i]) {
+      maps[i] = memory.copy(*translation_maps[i]);
+      any_map = true;
+    }
+  }
+  auto key_handler = static_cast<GenericKeyHandler *>(
+      static_cast<void *>(memory.alloc<int8_t>(sizeof(GenericKeyHandler))));
+  new (key_handler) GenericKeyHandler(kcc, true, join_columns, type_infos,
+                                      any_map ? maps : nullptr,
+                                      any_map ? min_inner_elems : nullptr);
+  const size_t row_count = columns[0].values.size();
+  return {std::move(columns), uses_bw_eq, translation_maps, key_handler,
+          row_count};
+}
+
+// Rows of every key (reference build)
+KeyRows reference_keys(const KeyColumns &keys) {
+  KeyRows key_rows;
+  for (size_t row = 0; row < keys.row_count; ++row) {
+    Key key;
+    for (size_t i = 0; i < keys.columns.size(); ++i) {
+      const TestColumn &column = keys.columns[i];
+      int64_t elem = column.decode(row);
+      const bool is_null = elem == column.spec.get_null_val();
+      if (is_null && !keys.uses_bw_eq[i]) {
+        break;
+      }
+      if (keys.translation_maps[i] && !is_null) {
+        elem = (*keys.translation_maps[i])[elem];
+        if (elem == StringDictionary_INVALID_STR_ID) {
+          break;
+        }
+      }
+      key.push_back(elem);
+    }
+    if (key.size() == keys.columns.size()) {
+      key_rows[key].push_back(row);
+    }
+  }
+  return key_rows;
+}
+
+// Key of a table slot, nullopt if empty
+template <typename T>
+std::optional<Key> read_key(const T *slot_key, const size_t kcc) {
+  if (slot_key[0] == get_invalid_key<T>()) {
+    return std::nullopt;
+  }
+  return Key(slot_key, slot_key + kcc);
+}
+
+// The (key, value) pairs of a one-to-one table with a value slot, or the
+// keys (value 0) of a key only table.
+using TableEntries = std::vector<std::pair<Key, int64_t>>;
+
+template <typename T>
+TableEntries read_flat_entries(const int8_t *entries, const int64_t entry_count,
+                               const size_t kcc, const bool with_val_slot) {
+  const size_t entry_size = kcc + (with_val_slot ? 1 : 0);
+  const T *slots = reinterpret_cast<const T *>(entries);
+  TableEntries table_entries;
+  for (int64_t e = 0; e < entry_count; ++e) {
+    if (const auto key = read_key(slots + e * entry_size, kcc)) {
+      table_entries.emplace_back(*key, with_val_slot ? slots[e * entry_size + kcc] : 0);
+    }
+  }
+  return table_entries;
+}
+
+template <typename T>
+TableEntries read_bucketized_entries(const int8_t *hash_buff,
+                                     const size_t bucket_count, const size_t kcc,
+                                     const bool with_val_slot) {
+  const T *keys = reinterpret_cast<const T *>(
+      hash_buff + get_bucketized_baseline_keys_offset(bucket_count));
+  const int32_t *vals = reinterpret_cast<const int32_t *>(
+      hash_buff + get_bucketized_baseline_vals_offset(bucket_count, kcc * sizeof(T)));
+  TableEntries table_entries;
+  for (size_t slot = 0; slot < bucket_count * g_baseline_bucket_slots; ++slot) {
+    if (const auto key = read_key(keys + slot * kcc, kcc)) {
+      table_entries.emplace_back(*key, with_val_slot ? vals[slot] : 0);
+    }
+  }
+  return table_entries;
+}
+
+void check_baseline_one_to_one(const TableEntries &entries, const KeyRows &ref,
+                               const bool with_val_slot, const bool for_semi_join,
+                               const int err) {
+  const bool duplicates = std::any_of(
+      ref.begin(), ref.end(), [](const auto &key) { return key.second.size() > 1; });
+  CHECK(err == (with_val_slot && !for_semi_join && duplicates ? -1 : 0));
+  std::set<Key> keys;
+  bool ok = true;
+  for (const auto &[key, val] : entries) {
+    ok &= keys.insert(key).second;
+    const auto it = ref.find(key);
+    ok &= it != ref.end() && (!with_val_slot || is_member(it->second, val));
+  }
+  CHECK(ok);
+  CHECK(keys.size() == ref.size());
+}
+
+// Checks a one-to-many table of entry_count entries whose keys are read by
+// slot_key(e).
+template <typename ROW_ID, typename SLOT_KEY>
+bool check_baseline_one_to_many(const ROW_ID *buff, const int64_t entry_count,
+                                const KeyRows &ref, SLOT_KEY slot_key) {
+  size_t key_count = 0;
+  const bool ok = check_one_to_many_layout(buff, entry_count, [&](const int64_t e) {
+    const std::optional<Key> key = slot_key(e);
+    const auto it = key ? ref.find(*key) : ref.end();
+    key_count += it != ref.end();
+    return it == ref.end() ? std::vector<int32_t>{} : it->second;
+  });
+  return ok && key_count == ref.size();
+}
+
+// Distances of the keys of a flat table from their home slot
+template <typename T>
+std::vector<int64_t> get_probe_distances(const int8_t *hash_buff,
+                                         const int64_t entry_count,
+                                         const size_t kcc,
+                                         const bool with_val_slot) {
+  const T *entries = reinterpret_cast<const T *>(hash_buff);
+  const size_t entry_size = kcc + (with_val_slot ? 1 : 0);
+  std::vector<int64_t> distances;
+  for (int64_t e = 0; e < entry_count; ++e) {
+    const T *key = entries + e * entry_size;
+    if (read_key(key, kcc)) {
+      const int64_t home = MurmurHash1Impl(key, kcc * sizeof(T), 0) % entry_count;
+      distances.push_back((e - home + entry_count) % entry_count);
+    }
+  }
+  return distances;
+}
+
+template <typename T>
+void test_flat_baseline(ExecutionContext &ctx, TestMemory &memory,
+                        const KeyColumns &keys, const KeyRows &ref) {
+  const size_t kcc = keys.columns.size();
+  const int64_t entry_count = 2 * ref.size() + 3;
+  int *err = memory.alloc<int>(1);
+  const BloomFilter bloom_filter = alloc_bloom_filter(memory, ref.size());
+  int32_t *selection = memory.alloc<int32_t>(keys.row_count);
+  int64_t *num_selected = memory.alloc<int64_t>(1);
+  for (const bool with_val_slot : {true, false}) {
+    for (const bool for_semi_join : {false, true}) {
+      const size_t entry_size = kcc + (with_val_slot ? 1 : 0);
+      int8_t *hash_buff = memory.alloc<int8_t>(entry_count * entry_size * sizeof(T), 7);
+      init_baseline_hash_join_buff_on_l0<T>(ctx, hash_buff, entry_count, kcc,
+                                            with_val_slot, g_invalid_slot_val);
+      *err = 0;
+      fill_baseline_hash_join_buff_on_l0<T>(
+          ctx, hash_buff, entry_count, g_invalid_slot_val, for_semi_join, kcc,
+          with_val_slot, err, keys.key_handler, keys.row_count);
+      check_baseline_one_to_one(
+          read_flat_entries<T>(hash_buff, entry_count, kcc, with_val_slot), ref,
+          with_val_slot, for_semi_join, *err);
+
+      if (!with_val_slot && !for_semi_join) {
+        const T *dict = reinterpret_cast<const T *>(hash_buff);
+        int32_t *buff = memory.alloc<int32_t>(2 * entry_count + keys.row_count, 7);
+        fill_one_to_many_baseline_hash_table_on_l0<T>(
+            ctx, buff, dict, entry_count, g_invalid_slot_val, keys.key_handler,
+            keys.row_count);
+        CHECK(check_baseline_one_to_many(
+            buff, entry_count, ref,
+            [&](const int64_t e) { return read_key(dict + e * kcc, kcc); }));
+
+        int64_t *buff64 =
+            memory.alloc<int64_t>(2 * entry_count + keys.row_count, 7);
+        fill_one_to_many_baseline_hash_table_on_l0<T>(
+            ctx, buff64, dict, entry_count, g_invalid_slot_val,
+            keys.key_handler, keys.row_count);
+        CHECK(check_baseline_one_to_many(
+            buff64, entry_count, ref,
+            [&](const int64_t e) { return read_key(dict + e * kcc, kcc); }));
+        check_compact_one_to_many(ctx, memory, buff, entry_count,
+                                  keys.row_count);
+      }
+
+      // Same with stats and a Bloom filter, which every build row passes. The
+      // one-to-many table adds its bucket sizes to the stats.
+      HashTableStats *stats = memory.alloc<HashTableStats>(1);
+      init_baseline_hash_join_buff_on_l0<T>(ctx, hash_buff, entry_count, kcc,
+                                            with_val_slot, g_invalid_slot_val);
+      init_bloom_filter_on_l0(ctx, bloom_filter);
+      fill_baseline_hash_join_buff_on_l0_async<T>(
+          ctx, hash_buff, entry_count, g_invalid_slot_val, for_semi_join, kcc,
+          with_val_slot, err, keys.key_handler, keys.row_count, bloom_filter,
+          stats, {})
+          .wait();
+      filter_keys_on_l0<T>(ctx, bloom_filter, keys.key_handler, keys.row_count,
+                           selection, num_selected);
+      check_no_false_negatives(selection, *num_selected, ref);
+      CHECK(stats->entry_count == entry_count);
+      CHECK(stats->cas_retries >= 0);
+      CHECK(distributions_equal(
+          stats->probe_distances,
+          reference_distribution(get_probe_distances<T>(
+              hash_buff, entry_count, kcc, with_val_slot))));
+      CHECK(stats->probe_distances.count == static_cast<int64_t>(ref.size()));
+      if (!with_val_slot && !for_semi_join) {
+        int32_t *buff = memory.alloc<int32_t>(2 * entry_count + keys.row_count);
+        fill_one_to_many_baseline_hash_table_on_l0_async<T>(
+            ctx, buff, reinterpret_cast<const T *>(hash_buff), entry_count,
+            g_invalid_slot_val, keys.key_handler, keys.row_count, stats, {})
+            .wait();
+        CHECK(stats->probe_distances.count == static_cast<int64_t>(ref.size()));
+        CHECK(distributions_equal(stats->bucket_sizes,
+                                  reference_distribution(get_bucket_sizes(ref))));
+      }
+    }
+  }
+
+  // A table with fewer entries than keys is full
+  if (ref.size() > 1) {
+    const int64_t small_entry_count = ref.size() - 1;
+    int8_t *hash_buff =
+        memory.alloc<int8_t>(small_entry_count * (kcc + 1) * sizeof(T));
+    init_baseline_hash_join_buff_on_l0<T>(ctx, hash_buff, small_entry_count, kcc,
+                                          true, g_invalid_slot_val);
+    *err = 0;
+    fill_baseline_hash_join_buff_on_l0<T>(
+        ctx, hash_buff, small_entry_count, g_invalid_slot_val, true, kcc, true,
+        err, keys.key_handler, keys.row_count);
+    CHECK(*err == -2);
+  }
+}
+
+template <typename T>
+void test_bucketized_baseline(ExecutionContext &ctx, TestMemory &memory,
+                              const KeyColumns &keys, const KeyRows &ref) {
+  const size_t kcc = keys.columns.size();
+  const size_t bucket_count = get_bucketized_baseline_bucket_count(2 * ref.size() + 3);
+  const int64_t slot_count = bucket_count * g_baseline_bucket_slots;
+  int *err = memory.alloc<int>(1);
+  for (const bool with_val_slot : {true, false}) {
+    for (const bool for_semi_join : {false, true}) {
+      int8_t *hash_buff = memory.alloc<int8_t>(
+          get_bucketized_baseline_hash_buff_size(bucket_count, kcc * sizeof(T),
+                                                 with_val_slot),
+          7);
+      init_bucketized_baseline_hash_buff_on_l0<T>(
+          ctx, hash_buff, bucket_count, kcc, with_val_slot, g_invalid_slot_val);
+      *err = 0;
+      fill_bucketized_baseline_hash_buff_on_l0<T>(
+          ctx, hash_buff, bucket_count, g_invalid_slot_val, for_semi_join, kcc,
+          with_val_slot, err, keys.key_handler, keys.row_count);
+      check_baseline_one_to_one(
+          read_bucketized_entries<T>(hash_buff, bucket_count, kcc, with_val_slot),
+          ref, with_val_slot, for_semi_join, *err);
+
+      if (!with_val_slot && !for_semi_join) {
+        const T *slot_keys = reinterpret_cast<const T *>(
+            hash_buff + get_bucketized_baseline_keys_offset(bucket_count));
+        int32_t *buff = memory.alloc<int32_t>(2 * slot_count + keys.row_count, 7);
+        fill_one_to_many_bucketized_baseline_hash_table_on_l0<T>(
+            ctx, buff, hash_buff, bucket_count, kcc, keys.key_handler,
+            keys.row_count);
+        CHECK(check_baseline_one_to_many(
+            buff, slot_count, ref,
+            [&](const int64_t e) { return read_key(slot_keys + e * kcc, kcc); }));
+      }
+    }
+  }
+}
+
+template <typename T>
+void test_partitioned_baseline(ExecutionContext &ctx, TestMemory &memory,
+                               const KeyColumns &keys, const KeyRows &ref) {
+  const size_t kcc = keys.columns.size();
+  // Sized by the distinct keys, which the partitions share
+  const int64_t entry_count = std::max<int64_t>(2, 2 * ref.size());
+  int *err = memory.alloc<int>(1);
+  const uint32_t default_bits =
+      get_baseline_partition_bits(ctx, entry_count, (kcc + 1) * sizeof(T));
+  for (const uint32_t partition_bits : {default_bits, uint32_t{0}, uint32_t{4}}) {
+    for (const bool with_val_slot : {true, false}) {
+      for (const bool for_semi_join : {false, true}) {
+        const size_t entry_size = (kcc + (with_val_slot ? 1 : 0)) * sizeof(T);
+        int8_t *hash_buff = memory.alloc<int8_t>(
+            get_partitioned_baseline_hash_buff_size(partition_bits, entry_count,
+                                                    entry_size),
+            7);
+        *err = 0;
+        fill_partitioned_baseline_hash_buff_on_l0<T>(
+            ctx, hash_buff, partition_bits, entry_count, g_invalid_slot_val,
+            for_semi_join, kcc, with_val_slot, err, keys.key_handler,
+            keys.row_count);
+        const int8_t *entries =
+            hash_buff + get_partitioned_baseline_entries_offset(partition_bits);
+        check_baseline_one_to_one(
+            read_flat_entries<T>(entries, entry_count, kcc, with_val_slot), ref,
+            with_val_slot, for_semi_join, *err);
+
+        if (!with_val_slot && !for_semi_join) {
+          const T *dict = reinterpret_cast<const T *>(entries);
+          int32_t *buff = memory.alloc<int32_t>(2 * entry_count + keys.row_count, 7);
+          fill_one_to_many_partitioned_baseline_hash_table_on_l0<T>(
+              ctx, buff, hash_buff, partition_bits, entry_count, kcc,
+              keys.key_handler, keys.row_count);
+          CHECK(check_baseline_one_to_many(
+              buff, entry_count, ref,
+              [&](const int64_t e) { return read_key(dict + e * kcc, kcc); }));
+        }
+      }
+    }
+  }
+  // Too many rows for the partitioning, which only reports it
+  *err = 0;
+  fill_partitioned_baseline_hash_buff_on_l0<T>(
+      ctx, nullptr, 0, entry_count, g_invalid_slot_val, false, kcc, true, err,
+      keys.key_handler, int64_t{1} << 31);
+  CHECK(*err == g_partitioned_baseline_row_count_err);
+}
+
+// Sequential HyperLogLog sketch of the keys, as approximate_distinct_tuples
+// computes it
+std::vector<uint8_t> reference_hll(const KeyRows &ref, const uint32_t b) {
+  std::vector<uint8_t> hll(size_t{1} << b);
+  for (const auto &[key, rows] : ref) {
+    const uint64_t hash =
+        MurmurHash64AImpl(key.data(), key.size() * sizeof(int64_t), 0);
+    const uint64_t rest = hash << b;
+    uint8_t rank = 1;
+    while (rank <= 64 - b && !(rest & (uint64_t{1} << (64 - rank)))) {
+      ++rank;
+    }
+    auto &reg = hll[hash >> (64 - b)];
+    reg = std::max(reg, rank);
+  }
+  return hll;
+}
+
+void test_hll(ExecutionContext &ctx, TestMemory &memory, const KeyColumns &keys,
+              const KeyRows &ref) {
+  // The first sketch fits in local memory, the second one not on most devices
+  for (const uint32_t b : {11u, 18u}) {
+    uint8_t *hll = reinterpret_cast<uint8_t *>(
+        memory.alloc<uint32_t>((size_t{1} << b) / sizeof(uint32_t), 0));
+    int32_t *row_counts = memory.alloc<int32_t>(keys.row_count, 0);
+    approximate_distinct_tuples_on_l0(ctx, hll, row_counts, b, keys.row_count,
+                                      keys.key_handler);
+    CHECK(std::vector<uint8_t>(hll, hll + (size_t{1} << b)) == reference_hll(ref, b));
+    std::vector<int32_t> ref_row_counts(keys.row_count);
+    for (const auto &[key, rows] : ref) {
+      for (const auto row : rows) {
+        ref_row_counts[row] = 1;
+      }
+    }
+    CHECK(std::vector<int32_t>(row_counts, row_counts + keys.row_count) ==
+          ref_row_counts);
+
+    // Merging into an empty sketch copies it, the estimate is within a few
+    // standard errors (1.04 / sqrt(2^b)) of the distinct count
+    uint8_t *merged = reinterpret_cast<uint8_t *>(
+        memory.alloc<uint32_t>((size_t{1} << b) / sizeof(uint32_t), 0));
+    merge_hll_sketches_on_l0(ctx, merged, hll, b);
+    CHECK(std::vector<uint8_t>(merged, merged + (size_t{1} << b)) ==
+          reference_hll(ref, b));
+    const int64_t estimate = estimate_hll_cardinality_on_l0(ctx, merged, b);
+    CHECK(std::abs(estimate - static_cast<int64_t>(ref.size())) <=
+          std::max<int64_t>(2, ref.size() / 10));
+  }
+}
+
+template <typename T>
+void test_baseline_tables(ExecutionContext &ctx, TestMemory &memory,
+                          const KeyColumns &keys) {
+  const KeyRows ref = reference_keys(keys);
+  test_flat_baseline<T>(ctx, memory, keys, ref);
+  // Not supported by the host backend
+  if (!ctx.is_host()) {
+    test_bucketized_baseline<T>(ctx, memory, keys, ref);
+    test_partitioned_baseline<T>(ctx, memory, keys, ref);
+  }
+  if constexpr (std::is_same_v<T, int64_t>) {
+    test_hll(ctx, memory, keys, ref);
+  }
+}
+
+// Key handler over the columns of keys packing their keys into one T, the
+// range of column i being ranges[i]. nullptr if they don't fit.
+template <typename T>
+const GenericKeyHandler *
+make_packed_key_handler(TestMemory &memory, const KeyColumns &keys,
+                        const std::vector<std::pair<int64_t, int64_t>> &ranges,
+                        CompositeKeyPacking &packing) {
+  const size_t kcc = keys.columns.size();
+  const GenericKeyHandler *key_handler = keys.key_handler;
+  auto type_infos = static_cast<JoinColumnTypeInfo *>(static_cast<void *>(
+      memory.alloc<int8_t>(kcc * sizeof(JoinColumnTypeInfo))));
+  for (size_t i = 0; i < kcc; ++i) {
+    const JoinColumnTypeInfo &type_info =
+        key_handler->get_join_column_type_infos()[i];
+    new (&type_infos[i]) JoinColumnTypeInfo{
+        type_info.elem_sz,   ranges[i].first,
+        ranges[i].second,    type_info.null_val,
+        type_info.uses_bw_eq, type_info.translated_null_val,
+        type_info.column_type};
+  }
+  if (!init_composite_key_packing<T>(packing, type_infos, kcc)) {
+    return nullptr;
+  }
+  auto device_packing = static_cast<CompositeKeyPacking *>(static_cast<void *>(
+      memory.alloc<int8_t>(sizeof(CompositeKeyPacking))));
+  *device_packing = packing;
+  auto packed_key_handler = static_cast<GenericKeyHandler *>(
+      static_cast<void *>(memory.alloc<int8_t>(sizeof(GenericKeyHandler))));
+  new (packed_key_handler) GenericKeyHandler(
+      kcc, true, key_handler->get_join_columns(), type_infos,
+      key_handler->sd_inner_to_outer_translation_maps_,
+      key_handler->sd_min_inner_elems_, nullptr, device_packing);
+  return packed_key_handler;
+}
+
+// The (outer row, inner row) pairs of a probe
+using JoinPairs = std::multiset<std::pair<int32_t, int32_t>>;
+
+// Baseline tables of packed composite keys hold the same rows per key as the
+// unpacked ones, and probes of them give the same pairs. A build key outside
+// of the packing ranges fails the build.
+template <typename T>
+void test_packed_baseline(ExecutionContext &ctx, TestMemory &memory,
+                          std::mt19937 &rng) {
+  const size_t row_count = 1200;
+  const ColumnSpec int32_spec{ColumnType::Signed, 4};
+  const ColumnSpec int16_spec{ColumnType::Signed, 2};
+  const std::vector<std::pair<int64_t, int64_t>> ranges = {{-20, 40}, {0, 6}};
+  int *err = memory.alloc<int>(1);
+  for (const bool uses_bw_eq : {false, true}) {
+    g_test_name = std::string("baseline packed keys ") +
+                  (sizeof(T) == 4 ? "int32" : "int64") +
+                  (uses_bw_eq ? " (bw_eq nulls)" : "");
+    const auto keys = make_key_columns(
+        memory,
+        {make_column(memory, int32_spec,
+                     random_values(rng, row_count, -20, 40, 0.05)),
+         make_column(memory, int16_spec,
+                     random_values(rng, row_count, 0, 6, 0.05))},
+        {uses_bw_eq, uses_bw_eq}, {nullptr, nullptr});
+    // Outer keys partly outside of the ranges, which can't match
+    const auto outer_keys = make_key_columns(
+        memory,
+        {make_column(memory, int32_spec,
+                     random_values(rng, row_count, -30, 50, 0.05)),
+         make_column(memory, int16_spec,
+                     random_values(rng, row_count, -1, 7, 0.05))},
+        {uses_bw_eq, uses_bw_eq}, {nullptr, nullptr});
+    CompositeKeyPacking packing;
+    const GenericKeyHandler *packed_key_handler =
+        make_packed_key_handler<T>(memory, keys, ranges, packing);
+    const GenericKeyHandler *packed_outer_key_handler =
+        make_packed_key_handler<T>(memory, outer_keys, ranges, packing);
+    CHECK(packed_key_handler && packed_outer_key_handler);
+    if (!packed_key_handler || !packed_outer_key_handler) {
+      continue;
+    }
+
+    // The reference with the keys packed
+    const KeyRows ref = reference_keys(keys);
+    KeyRows packed_ref;
+    for (const auto &[key, rows] : ref) {
+      const std::vector<T> components(key.begin(), key.end());
+      T packed_key;
+      CHECK(packing.pack(components.data(), packed_key));
+      packed_ref[{packed_key}] = rows;
+    }
+    CHECK(packed_ref.size() == ref.size());
+
+    // Key only tables and their one-to-many tables, unpacked then packed
+    const int64_t entry_count = 2 * ref.size() + 3;
+    JoinPairs pairs[2];
+    for (const bool packed : {false, true}) {
+      const size_t kcc = packed ? 1 : keys.columns.size();
+      const GenericKeyHandler *key_handler =
+          packed ? packed_key_handler : keys.key_handler;
+      int8_t *dict_buff = memory.alloc<int8_t>(entry_count * kcc * sizeof(T));
+      init_baseline_hash_join_buff_on_l0<T>(ctx, dict_buff, entry_count, kcc,
+                                            false, g_invalid_slot_val);
+      *err = 0;
+      fill_baseline_hash_join_buff_on_l0<T>(
+          ctx, dict_buff, entry_count, g_invalid_slot_val, false, kcc, false,
+          err, key_handler, row_count);
+      CHECK(*err == 0);
+      const T *dict = reinterpret_cast<const T *>(dict_buff);
+      int32_t *buff = memory.alloc<int32_t>(2 * entry_count + row_count, 7);
+      fill_one_to_many_baseline_hash_table_on_l0<T>(
+          ctx, buff, dict, entry_count, g_invalid_slot_val, key_handler,
+          row_count);
+      CHECK(check_baseline_one_to_many(
+          buff, entry_count, packed ? packed_ref : ref,
+          [&](const int64_t e) { return read_key(dict + e * kcc, kcc); }));
+
+      if (ctx.is_host()) {
+        continue; // no probes on the host backend
+      }
+      const int64_t max_matches = 32 * row_count;
+      int32_t *outer_row_ids = memory.alloc<int32_t>(max_matches);
+      int32_t *inner_row_ids = memory.alloc<int32_t>(max_matches);
+      int64_t *num_matches = memory.alloc<int64_t>(1);
+      probe_one_to_many_baseline_hash_table_on_l0<T>(
+          ctx, buff, dict, entry_count, kcc,
+          packed ? packed_outer_key_handler : outer_keys.key_handler, row_count,
+          outer_row_ids, inner_row_ids, max_matches, num_matches);
+      CHECK(*num_matches <= max_matches);
+      for (int64_t i = 0; i < std::min(*num_matches, max_matches); ++i) {
+        pairs[packed].emplace(outer_row_ids[i], inner_row_ids[i]);
+      }
+    }
+    CHECK(pairs[0] == pairs[1]);
+    CHECK(ctx.is_host() || !pairs[0].empty());
+
+    // Ranges missing some build keys
+    CompositeKeyPacking narrow_packing;
+    const GenericKeyHandler *narrow_key_handler = make_packed_key_handler<T>(
+        memory, keys, {{-20, 30}, {0, 6}}, narrow_packing);
+    int8_t *hash_buff = memory.alloc<int8_t>(entry_count * 2 * sizeof(T));
+    init_baseline_hash_join_buff_on_l0<T>(ctx, hash_buff, entry_count, 1, true,
+                                          g_invalid_slot_val);
+    *err = 0;
+    fill_baseline_hash_join_buff_on_l0<T>(ctx, hash_buff, entry_count,
+                                          g_invalid_slot_val, true, 1, true,
+                                          err, narrow_key_handler, row_count);
+    CHECK(*err == g_unpackable_key_err);
+    if (!ctx.is_host()) {
+      const uint32_t partition_bits = 2;
+      int8_t *partitioned_buff =
+          memory.alloc<int8_t>(get_partitioned_baseline_hash_buff_size(
+              partition_bits, entry_count, 2 * sizeof(T)));
+      *err = 0;
+      fill_partitioned_baseline_hash_buff_on_l0<T>(
+          ctx, partitioned_buff, partition_bits, entry_count,
+          g_invalid_slot_val, true, 1, true, err, narrow_key_handler,
+          row_count);
+      CHECK(*err == g_unpackable_key_err);
+    }
+  }
+}
+
+void test_baseline_hash(ExecutionContext &ctx, TestMemory &memory,
+                        std::mt19937 &rng) {
+  const ColumnSpec int32_spec{ColumnType::Signed, 4};
+  const ColumnSpec int16_spec{ColumnType::Signed, 2};
+  const ColumnSpec date_spec{ColumnType::SmallDate, 4};
+  const size_t inner_count = 50;
+  const auto translation_map = random_translation_map(rng, inner_count, 0, 30);
+
+  for (const bool uses_bw_eq : {false, true}) {
+    const std::string suffix = uses_bw_eq ? " (bw_eq nulls)" : "";
+    {
+      g_test_name = "baseline one key" + suffix;
+      const auto keys = make_key_columns(
+          memory,
+          {make_column(memory, int32_spec,
+                       random_values(rng, 1200, -300, 300, 0.05))},
+          {uses_bw_eq}, {nullptr});
+      test_baseline_tables<int64_t>(ctx, memory, keys);
+      test_baseline_tables<int32_t>(ctx, memory, keys);
+    }
+    {
+      g_test_name = "baseline unique composite keys" + suffix;
+      // All (a, b) pairs once, in shuffled order
+      ColumnValues a, b;
+      std::vector<std::pair<int64_t, int64_t>> pairs;
+      for (int64_t i = 0; i < 40; ++i) {
+        for (int64_t j = 0; j < 12; ++j) {
+          pairs.emplace_back(i, j);
+        }
+      }
+      std::shuffle(pairs.begin(), pairs.end(), rng);
+      for (const auto &[i, j] : pairs) {
+        a.push_back(i);
+        b.push_back(j);
+      }
+      a.push_back(std::nullopt);
+      b.push_back(3);
+      const auto keys = make_key_columns(
+          memory,
+          {make_column(memory, int32_spec, a), make_column(memory, int16_spec, b)},
+          {uses_bw_eq, uses_bw_eq}, {nullptr, nullptr});
+      test_baseline_tables<int64_t>(ctx, memory, keys);
+      test_baseline_tables<int32_t>(ctx, memory, keys);
+    }
+    {
+      g_test_name = "baseline composite keys" + suffix;
+      const auto keys = make_key_columns(
+          memory,
+          {make_column(memory, int32_spec, random_values(rng, 1500, 0, 40, 0.05)),
+           make_column(memory, int16_spec, random_values(rng, 1500, -3, 3, 0.05)),
+           make_column(memory, date_spec,
+                       random_values(rng, 1500, 18000, 18004, 0.05))},
+          {uses_bw_eq, uses_bw_eq, false}, {nullptr, nullptr, nullptr});
+      test_baseline_tables<int64_t>(ctx, memory, keys);
+    }
+    {
+      g_test_name = "baseline skewed keys" + suffix;
+      // Three rows in four on one key
+      ColumnValues values = random_values(rng, 3000, 0, 200, 0.05);
+      for (size_t row = 0; row < values.size(); ++row) {
+        if (row % 4) {
+          values[row] = 7;
+        }
+      }
+      const auto keys = make_key_columns(
+          memory, {make_column(memory, int32_spec, values)}, {uses_bw_eq},
+          {nullptr});
+      test_baseline_tables<int64_t>(ctx, memory, keys);
+      test_baseline_tables<int32_t>(ctx, memory, keys);
+    }
+    {
+      g_test_name = "baseline translated string ids" + suffix;
+      const auto keys = make_key_columns(
+          memory,
+          {make_column(memory, int32_spec,
+                       random_values(rng, 1000, 0, inner_count - 1, 0.05)),
+           make_column(memory, int32_spec, random_values(rng, 1000, 0, 4, 0.05))},
+          {uses_bw_eq, uses_bw_eq}, {&translation_map, nullptr});
+      test_baseline_tables<int64_t>(ctx, memory, keys);
+      test_baseline_tables<int32_t>(ctx, memory, keys);
+    }
+  }
+}
+
+// Bloom filters
+
+// Filters of the perfect builders over int32 keys, probed with the same
+// column and with the keys widened to int64, whose nulls map to the same
+// translated null.
+void test_perfect_bloom_filter(ExecutionContext &ctx, TestMemory &memory,
+                               std::mt19937 &rng) {
+  const ColumnValues values = random_values(rng, 1500, -300, 2000, 0.1);
+  const size_t row_count = values.size();
+  const TestColumn build_column =
+      make_column(memory, ColumnSpec{ColumnType::Signed, 4}, values);
+  const TestColumn probe_columns[] = {
+      build_column,
+      make_column(memory, ColumnSpec{ColumnType::Signed, 8}, values)};
+  // None of the build keys, only false positives pass
+  const TestColumn miss_column =
+      make_column(memory, ColumnSpec{ColumnType::Signed, 8},
+                  random_values(rng, row_count, 5000, 1000000, 0));
+  const BloomFilter bloom_filter = alloc_bloom_filter(memory, row_count);
+  int32_t *selection = memory.alloc<int32_t>(row_count);
+  int64_t *num_selected = memory.alloc<int64_t>(1);
+  int *err = memory.alloc<int>(1);
+  for (const bool uses_bw_eq : {false, true}) {
+    const PerfectTableSpec table{-300, 2000, uses_bw_eq, 1, nullptr, 0};
+    const HashEntryInfo hash_entry_info = table.get_hash_entry_info(1);
+    const int64_t slot_count = hash_entry_info.getNormalizedHashEntryCount();
+    const auto ref = reference_perfect_slots(build_column, table, 1);
+    for (const bool one_to_many : {false, true}) {
+      g_test_name = std::string("bloom filter perfect ") +
+                    (one_to_many ? "one-to-many" : "one-to-one") +
+                    (uses_bw_eq ? " (bw_eq nulls)" : "");
+      const JoinColumnTypeInfo type_info =
+          table.get_type_info(build_column.spec);
+      init_bloom_filter_on_l0(ctx, bloom_filter);
+      if (one_to_many) {
+        int32_t *buff = memory.alloc<int32_t>(2 * slot_count + row_count);
+        fill_one_to_many_hash_table_on_l0_async(
+            ctx, buff, hash_entry_info, g_invalid_slot_val,
+            build_column.join_column, type_info, bloom_filter, {})
+            .wait();
+      } else {
+        int32_t *buff = memory.alloc<int32_t>(slot_count);
+        build_hash_join_buff_bucketized_on_l0_async(
+            ctx, buff, hash_entry_info, g_invalid_slot_val, false,
+            build_column.join_column, type_info, nullptr, 0, false, err,
+            bloom_filter, {})
+            .wait();
+      }
+      for (const TestColumn &probe_column : probe_columns) {
+        filter_join_column_on_l0(ctx, bloom_filter, probe_column.join_column,
+                                 table.get_type_info(probe_column.spec),
+                                 selection, num_selected);
+        check_perfect_filter(selection, *num_selected, probe_column,
+                             uses_bw_eq, ref);
+      }
+      filter_join_column_on_l0(ctx, bloom_filter, miss_column.join_column,
+                               table.get_type_info(miss_column.spec),
+                               selection, num_selected);
+      CHECK(*num_selected < static_cast<int64_t>(row_count / 50));
+    }
+  }
+}
+
+// Filters of the baseline builders over int32 keys, probed as int64 keys of
+// the same columns and of the columns widened to int64.
+void test_baseline_bloom_filter(ExecutionContext &ctx, TestMemory &memory,
+                                std::mt19937 &rng) {
+  const size_t row_count = 1500;
+  const ColumnValues a = random_values(rng, row_count, -5000, 5000, 0.05);
+  const ColumnValues b = random_values(rng, row_count, 0, 20, 0.05);
+  const ColumnSpec wide_spec{ColumnType::Signed, 8};
+  const std::vector<TestColumn> columns = {
+      make_column(memory, ColumnSpec{ColumnType::Signed, 4}, a),
+      make_column(memory, ColumnSpec{ColumnType::Signed, 2}, b)};
+  const std::vector<TestColumn> wide_columns = {
+      make_column(memory, wide_spec, a), make_column(memory, wide_spec, b)};
+  const BloomFilter bloom_filter = alloc_bloom_filter(memory, row_count);
+  int32_t *selection = memory.alloc<int32_t>(row_count);
+  int64_t *num_selected = memory.alloc<int64_t>(1);
+  int *err = memory.alloc<int>(1);
+  for (const bool uses_bw_eq : {false, true}) {
+    const auto keys = make_key_columns(memory, columns,
+                                       {uses_bw_eq, uses_bw_eq},
+                                       {nullptr, nullptr});
+    const KeyRows ref = reference_keys(keys);
+    const int64_t entry_count = 2 * ref.size() + 3;
+    const size_t bucket_count =
+        get_bucketized_baseline_bucket_count(entry_count);
+    std::vector<const GenericKeyHandler *> probe_key_handlers = {
+        keys.key_handler};
+    // The widened nulls differ from the build ones, like in the probes
+    if (!uses_bw_eq) {
+      probe_key_handlers.push_back(
+          make_key_columns(memory, wide_columns, {false, false},
+                           {nullptr, nullptr})
+              .key_handler);
+    }
+    for (const bool bucketized : {false, true}) {
+      if (bucketized && ctx.is_host()) {
+        continue; // not supported by the host backend
+      }
+      g_test_name = std::string("bloom filter baseline ") +
+                    (bucketized ? "bucketized" : "flat") +
+                    (uses_bw_eq ? " (bw_eq nulls)" : "");
+      init_bloom_filter_on_l0(ctx, bloom_filter);
+      if (bucketized) {
+        int8_t *hash_buff = memory.alloc<int8_t>(
+            get_bucketized_baseline_hash_buff_size(bucket_count,
+                                                   2 * sizeof(int32_t), false));
+        init_bucketized_baseline_hash_buff_on_l0<int32_t>(
+            ctx, hash_buff, bucket_count, 2, false, g_invalid_slot_val);
+        fill_bucketized_baseline_hash_buff_on_l0_async<int32_t>(
+            ctx, hash_buff, bucket_count, g_invalid_slot_val, false, 2, false,
+            err, keys.key_handler, row_count, bloom_filter, {})
+            .wait();
+      } else {
+        int8_t *hash_buff =
+            memory.alloc<int8_t>(entry_count * 2 * sizeof(int32_t));
+        init_baseline_hash_join_buff_on_l0<int32_t>(
+            ctx, hash_buff, entry_count, 2, false, g_invalid_slot_val);
+        fill_baseline_hash_join_buff_on_l0_async<int32_t>(
+            ctx, hash_buff, entry_count, g_invalid_slot_val, false, 2, false,
+            err, keys.key_handler, row_count, bloom_filter, {})
+            .wait();
+      }
+      for (const GenericKeyHandler *key_handler : probe_key_handlers) {
+        filter_keys_on_l0<int64_t>(ctx, bloom_filter, key_handler, row_count,
+                                   selection, num_selected);
+        check_no_false_negatives(selection, *num_selected, ref);
+      }
+    }
+  }
+}
+
+// Sharded builds over the sub-devices of the CPU device (or the device
+// itself if it can't be partitioned)
+void test_sharded(const sycl::device &device, std::mt19937 &rng) {
+  const auto devices = get_sub_devices(device);
+  MultiDeviceContext mctx(devices);
+  TestMemory memory(devices[0], mctx.get_context());
+  const size_t shard_count = mctx.get_device_count();
+
+  const ColumnSpec spec{ColumnType::Signed, 4};
+  for (const bool uses_bw_eq : {false, true}) {
+    const TestColumn column =
+        make_column(memory, spec, random_values(rng, 2000, -50, 400, 0.05));
+    const PerfectTableSpec table{-50, 400, uses_bw_eq, 1, nullptr, 0};
+    const JoinColumnTypeInfo type_info = table.get_type_info(spec);
+    const HashEntryInfo hash_entry_info = table.get_hash_entry_info(1);
+    const int64_t slot_count = hash_entry_info.getNormalizedHashEntryCount();
+    const auto ref = reference_perfect_slots(column, table, 1);
+    int *err = memory.alloc<int>(1);
+
+    g_test_name = std::string("sharded perfect") + (uses_bw_eq ? " (bw_eq nulls)" : "");
+    for (const bool for_semi_join : {false, true}) {
+      int32_t *buff = memory.alloc<int32_t>(slot_count, 7);
+      build_hash_join_buff_bucketized_sharded_on_l0(
+          mctx, buff, hash_entry_info, g_invalid_slot_val, for_semi_join,
+          column.join_column, type_info, err);
+      check_perfect_one_to_one(buff, slot_count, ref, for_semi_join, *err);
+    }
+    std::vector<int32_t *> shard_buffs;
+    for (size_t s = 0; s < shard_count; ++s) {
+      const auto shard = get_perfect_hash_shard(slot_count, s, shard_count);
+      shard_buffs.push_back(memory.alloc<int32_t>(
+          2 * shard.get_slot_count() + column.values.size(), 7));
+    }
+    int32_t *const *device_shard_buffs = memory.copy(shard_buffs);
+    fill_one_to_many_hash_table_sharded_on_l0(mctx, device_shard_buffs,
+                                              hash_entry_info, g_invalid_slot_val,
+                                              column.join_column, type_info);
+    for (size_t s = 0; s < shard_count; ++s) {
+      const auto shard = get_perfect_hash_shard(slot_count, s, shard_count);
+      CHECK(check_perfect_one_to_many(shard_buffs[s], shard.get_slot_count(), ref,
+                                      shard.slot_begin));
+    }
+
+    g_test_name = std::string("sharded baseline") + (uses_bw_eq ? " (bw_eq nulls)" : "");
+    const auto keys = make_key_columns(
+        memory,
+        {column, make_column(memory, spec, random_values(rng, 2000, 0, 3, 0.05))},
+        {uses_bw_eq, uses_bw_eq}, {nullptr, nullptr});
+    const KeyRows key_ref = reference_keys(keys);
+    const size_t kcc = 2;
+    const int64_t shard_entry_count = 2 * key_ref.size() / shard_count + 8;
+    for (const bool with_val_slot : {true, false}) {
+      std::vector<int8_t *> hash_buffs;
+      for (size_t s = 0; s < shard_count; ++s) {
+        hash_buffs.push_back(memory.alloc<int8_t>(
+            shard_entry_count * (kcc + with_val_slot) * sizeof(int64_t), 7));
+      }
+      int8_t *const *device_hash_buffs = memory.copy(hash_buffs);
+      *err = 0;
+      fill_baseline_hash_join_buff_sharded_on_l0<int64_t>(
+          mctx, device_hash_buffs, shard_entry_count, g_invalid_slot_val, false,
+          kcc, with_val_slot, err, keys.key_handler, keys.row_count);
+      TableEntries entries;
+      for (size_t s = 0; s < shard_count; ++s) {
+        const auto shard_entries = read_flat_entries<int64_t>(
+            hash_buffs[s], shard_entry_count, kcc, with_val_slot);
+        for (const auto &[key, val] : shard_entries) {
+          CHECK(get_baseline_shard_for_key(key.data(), kcc, shard_count) == s);
+        }
+        entries.insert(entries.end(), shard_entries.begin(), shard_entries.end());
+      }
+      check_baseline_one_to_one(entries, key_ref, with_val_slot, false, *err);
+
+      if (!with_val_slot) {
+        std::vector<int32_t *> one_to_many_buffs;
+        std::vector<const int64_t *> dicts;
+        for (size_t s = 0; s < shard_count; ++s) {
+          one_to_many_buffs.push_back(
+              memory.alloc<int32_t>(2 * shard_entry_count + keys.row_count, 7));
+          dicts.push_back(reinterpret_cast<const int64_t *>(hash_buffs[s]));
+        }
+        fill_one_to_many_baseline_hash_table_sharded_on_l0<int64_t>(
+            mctx, memory.copy(one_to_many_buffs), memory.copy(dicts),
+            shard_entry_count, kcc, keys.key_handler, keys.row_count);
+        size_t key_count = 0;
+        for (size_t s = 0; s < shard_count; ++s) {
+          KeyRows shard_ref;
+          for (const auto &[key, rows] : key_ref) {
+            if (get_baseline_shard_for_key(key.data(), kcc, shard_count) == s) {
+              shard_ref[key] = rows;
+            }
+          }
+          key_count += shard_ref.size();
+          CHECK(check_baseline_one_to_many(
+              one_to_many_buffs[s], shard_entry_count, shard_ref,
+              [&](const int64_t e) { return read_key(dicts[s] + e * kcc, kcc); }));
+        }
+        CHECK(key_count == key_ref.size());
+      }
+    }
+  }
+}
+
+void test_column_stats(ExecutionContext &ctx, TestMemory &memory,
+                       std::mt19937 &rng) {
+  g_test_name = "column stats";
+  const ColumnSpec spec{ColumnType::Signed, 2};
+  const TestColumn column =
+      make_column(memory, spec, random_values(rng, 3000, -700, 900, 0.1));
+  const JoinColumnTypeInfo type_info{spec.elem_sz, -700, 900, spec.get_null_val(),
+                                     false, 0, spec.column_type};
+  std::set<int64_t> distinct;
+  int64_t null_count = 0;
+  for (const auto &v : column.values) {
+    if (v) {
+      distinct.insert(*v);
+    } else {
+      ++null_count;
+    }
+  }
+  for (const int64_t max_distinct_range : {int64_t{0}, int64_t{1} << 20}) {
+    const ColumnStats stats =
+        compute_column_stats_on_l0(ctx, column.join_column, type_info,
+                                   max_distinct_range);
+    CHECK(stats.min_val == *distinct.begin());
+    CHECK(stats.max_val == *distinct.rbegin());
+    CHECK(stats.null_count == null_count);
+    CHECK(stats.distinct_count ==
+          (max_distinct_range ? static_cast<int64_t>(distinct.size()) : -1));
+  }
+}
+
+// Kernels of a one-to-many build reported to a profiler attached to ctx
+void test_profiler(ExecutionContext &ctx, TestMemory &memory,
+                   std::mt19937 &rng) {
+  g_test_name = "profiler";
+  const TestColumn column = make_column(memory, {ColumnType::Signed, 4},
+                                        random_values(rng, 1000, 0, 99, 0.1));
+  const int64_t row_count = column.values.size();
+  const PerfectTableSpec table{0, 99, false, 1, nullptr, 0};
+  const HashEntryInfo hash_entry_info = table.get_hash_entry_info(1);
+  const int64_t slot_count = hash_entry_info.getNormalizedHashEntryCount();
+  int32_t *buff = memory.alloc<int32_t>(2 * slot_count + row_count, 7);
+
+  KernelProfiler profiler;
+  ctx.set_profiler(&profiler, "test");
+  const uint32_t track = ctx.get_profiler_track();
+  fill_one_to_many_hash_table_on_l0(ctx, buff, hash_entry_info,
+                                    g_invalid_slot_val, column.join_column,
+                                    table.get_type_info(column.spec));
+  const std::vector<KernelRecord> records = profiler.get_records();
+  ctx.set_profiler(nullptr);
+  CHECK(check_perfect_one_to_many(buff, slot_count,
+                                  reference_perfect_slots(column, table, 1)));
+
+  CHECK(profiler.get_dropped_count() == 0);
+  std::map<std::string, KernelInfo> kernels;
+  bool ok = true;
+  for (const KernelRecord &record : records) {
+    ok &= record.track == track && record.end_ns >= record.start_ns &&
+          record.info.bytes >= 0;
+    kernels[record.info.name] = record.info;
+  }
+  CHECK(ok);
+  for (const char *name : {"perfect_count_matches", "perfect_fill_row_ids"}) {
+    const auto it = kernels.find(name);
+    CHECK(it != kernels.end() && it->second.rows == row_count);
+  }
+}
+
+// The table tests, on a device or a host context
+void test_tables(ExecutionContext &ctx, TestMemory &memory, std::mt19937 &rng) {
+  test_perfect_hash(ctx, memory, rng);
+  test_baseline_hash(ctx, memory, rng);
+  test_packed_baseline<int64_t>(ctx, memory, rng);
+  test_packed_baseline<int32_t>(ctx, memory, rng);
+  test_perfect_bloom_filter(ctx, memory, rng);
+  test_baseline_bloom_filter(ctx, memory, rng);
+  test_profiler(ctx, memory, rng);
+}
+
+} // namespace
+
+int main() {
+  const sycl::device device{sycl::cpu_selector_v};
+  ExecutionContext ctx(device);
+  TestMemory memory(device, ctx.get_queue().get_context());
+  std::mt19937 rng(20240611);
+
+  test_tables(ctx, memory, rng);
+  test_column_stats(ctx, memory, rng);
+  test_sharded(device, rng);
+
+  // Same tables on the host backend, with the same layouts
+  g_backend_name = "host";
+  ExecutionContext host_ctx(HostBackend{4});
+  test_tables(host_ctx, memory, rng);
+
+  if (g_failure_count) {
+    std::fprintf(stderr, "%d checks failed\n", g_failure_count);
+    return 1;
+  }
+  std::printf("All checks passed\n");
+  return 0;
+}